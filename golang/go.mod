@@ -0,0 +1,3 @@
+module github.com/injinj/sassrv/golang
+
+go 1.18
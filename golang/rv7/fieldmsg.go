@@ -0,0 +1,73 @@
+package rv7
+
+/*
+#include <stdlib.h>
+#include "rv7_bridge.h"
+*/
+import "C"
+
+import (
+	"fmt"
+	"unsafe"
+)
+
+// fieldMsg is a message of the field types i32, f64, string and u64 in
+// turn, which is read both ways by the Reader benchmark: by name through a
+// tibrvMsg_Get*() cgo call for each field, the way the test programs do it,
+// and with a Reader over its bytes.
+type fieldMsg struct {
+	msg   C.tibrvMsg
+	names []*C.char
+}
+
+func newFieldMsg(nfields int) (*fieldMsg, error) {
+	m := &fieldMsg{}
+	if err := status(C.rv7_field_msg(&m.msg, C.tibrv_u32(nfields))); err != nil {
+		return nil, err
+	}
+	for i := 0; i < nfields; i++ {
+		m.names = append(m.names, C.CString(fmt.Sprintf("F%d", i)))
+	}
+	return m, nil
+}
+
+func (m *fieldMsg) destroy() {
+	for _, nm := range m.names {
+		C.free(unsafe.Pointer(nm))
+	}
+	C.tibrvMsg_Destroy(m.msg)
+}
+
+// bytes is the message encoded, owned by the message.
+func (m *fieldMsg) bytes() []byte {
+	var p unsafe.Pointer
+	var sz C.tibrv_u32
+	C.tibrvMsg_GetAsBytes(m.msg, &p)
+	C.tibrvMsg_GetByteSize(m.msg, &sz)
+	return unsafe.Slice((*byte)(p), int(sz))
+}
+
+// readCgo gets each field by name with a cgo call, strings are copied.
+func (m *fieldMsg) readCgo() (ival int64, fval float64, strs []string) {
+	for i, nm := range m.names {
+		switch i % 4 {
+		case 0:
+			var v C.tibrv_i32
+			C.tibrvMsg_GetI32Ex(m.msg, nm, &v, 0)
+			ival += int64(v)
+		case 1:
+			var v C.tibrv_f64
+			C.tibrvMsg_GetF64Ex(m.msg, nm, &v, 0)
+			fval += float64(v)
+		case 2:
+			var v *C.char
+			C.tibrvMsg_GetStringEx(m.msg, nm, &v, 0)
+			strs = append(strs, C.GoString(v))
+		default:
+			var v C.tibrv_u64
+			C.tibrvMsg_GetU64Ex(m.msg, nm, &v, 0)
+			ival += int64(v)
+		}
+	}
+	return
+}
@@ -0,0 +1,254 @@
+package rv7
+
+import (
+	"encoding/binary"
+	"errors"
+	"math"
+)
+
+// Reader decodes the fields of an rv message in Go, over the bytes of
+// Msg.Data() or tibrvMsg_GetAsBytes(), without a cgo call for each field.
+// The fields point into those bytes, so they are only valid as long as the
+// message is, for a dispatched Msg that is until the callback of its batch
+// returns.
+//
+// The encoding is the rv wire format written by RvMsgWriter:
+//
+//	message:  u32 size (including itself), u32 magic 0x9955eeaa, fields
+//	field:    u8 name length, name, u8 type, size, data
+//	name:     nul terminated, a field id follows the nul as u16
+//	size:     u8 <= 120, or 121 and u16, or 122 and u32, the u16 and u32
+//	          include their own 2 or 4 bytes
+//
+// Numbers are big endian, the integer and real types carry their width in
+// the size.
+type Reader struct {
+	buf []byte
+	off int
+	err error
+}
+
+// Field is one field of a message.
+type Field struct {
+	Name []byte // without the nul, nil when unnamed
+	ID   uint16 // 0 when the name has no id
+	Type uint8  // wire type, RvInt, RvString, ...
+	Data []byte
+}
+
+// Wire types, the array types are the same as the TIBRVMSG_*ARRAY types.
+const (
+	RvMsg        = 1
+	RvSubject    = 2
+	RvDateTime   = 3
+	RvOpaque     = 7
+	RvString     = 8
+	RvBool       = 9
+	RvIPData     = 10
+	RvInt        = 11
+	RvUint       = 12
+	RvReal       = 13
+	RvEncrypted  = 32
+	RvI8Array    = 34
+	RvU8Array    = 35
+	RvI16Array   = 36
+	RvU16Array   = 37
+	RvI32Array   = 38
+	RvU32Array   = 39
+	RvI64Array   = 40
+	RvU64Array   = 41
+	RvF32Array   = 44
+	RvF64Array   = 45
+	RvXML        = 47
+	RvStrArray   = 48
+	RvMsgArray   = 49
+	rvMagic      = 0x9955eeaa
+	rvTinySize   = 120
+	rvShortSize  = 121
+	rvLongSize   = 122
+	rvHeaderSize = 8
+)
+
+var (
+	// ErrBadHeader is a message without the size and magic.
+	ErrBadHeader = errors.New("rv7: bad message header")
+	// ErrBadField is a field that runs past the end of the message.
+	ErrBadField = errors.New("rv7: bad field bounds")
+)
+
+// NewReader checks the message header, the fields follow.
+func NewReader(data []byte) (Reader, error) {
+	if len(data) < rvHeaderSize ||
+		binary.BigEndian.Uint32(data[4:]) != rvMagic {
+		return Reader{}, ErrBadHeader
+	}
+	sz := int(binary.BigEndian.Uint32(data))
+	if sz < rvHeaderSize || sz > len(data) {
+		return Reader{}, ErrBadHeader
+	}
+	return Reader{buf: data[:sz], off: rvHeaderSize}, nil
+}
+
+// Reader decodes the fields of a dispatched message.
+func (m *Msg) Reader() (Reader, error) { return NewReader(m.Data()) }
+
+// Err is the decode error which stopped Next, nil at the end.
+func (r *Reader) Err() error { return r.err }
+
+// Reset goes back to the first field.
+func (r *Reader) Reset() {
+	r.off = rvHeaderSize
+	r.err = nil
+}
+
+// Next decodes the next field into f, false at the end or on an error.
+func (r *Reader) Next(f *Field) bool {
+	b, i := r.buf, r.off
+	if i >= len(b) || r.err != nil {
+		return false
+	}
+	nlen := int(b[i])
+	i++
+	if i+nlen+2 > len(b) {
+		r.err = ErrBadField
+		return false
+	}
+	f.Name, f.ID = nil, 0
+	if nlen > 0 {
+		nm := b[i : i+nlen]
+		n := 0
+		for n < nlen && nm[n] != 0 {
+			n++
+		}
+		f.Name = nm[:n]
+		if nlen == n+3 {
+			f.ID = binary.BigEndian.Uint16(nm[n+1:])
+		}
+		i += nlen
+	}
+	f.Type = b[i]
+	sz := int(b[i+1])
+	i += 2
+	if sz > rvTinySize {
+		switch {
+		case sz == rvShortSize && i+2 <= len(b):
+			sz = int(binary.BigEndian.Uint16(b[i:])) - 2
+			i += 2
+		case sz == rvLongSize && i+4 <= len(b):
+			sz = int(binary.BigEndian.Uint32(b[i:])) - 4
+			i += 4
+		default:
+			sz = -1
+		}
+	}
+	if sz < 0 || i+sz > len(b) {
+		r.err = ErrBadField
+		return false
+	}
+	f.Data = b[i : i+sz]
+	r.off = i + sz
+	return true
+}
+
+// Find scans from the first field for name, its id is not compared.
+func (r *Reader) Find(name string, f *Field) bool {
+	r.Reset()
+	for r.Next(f) {
+		if string(f.Name) == name {
+			return true
+		}
+	}
+	return false
+}
+
+// Int is the value of an RvInt, RvUint or RvBool field.
+func (f *Field) Int() (int64, bool) {
+	d := f.Data
+	switch f.Type {
+	case RvInt:
+		switch len(d) {
+		case 1:
+			return int64(int8(d[0])), true
+		case 2:
+			return int64(int16(binary.BigEndian.Uint16(d))), true
+		case 4:
+			return int64(int32(binary.BigEndian.Uint32(d))), true
+		case 8:
+			return int64(binary.BigEndian.Uint64(d)), true
+		}
+	case RvUint, RvBool:
+		u, ok := f.Uint()
+		return int64(u), ok
+	}
+	return 0, false
+}
+
+// Uint is the value of an RvUint, RvInt or RvBool field.
+func (f *Field) Uint() (uint64, bool) {
+	d := f.Data
+	switch f.Type {
+	case RvUint, RvBool:
+		switch len(d) {
+		case 1:
+			return uint64(d[0]), true
+		case 2:
+			return uint64(binary.BigEndian.Uint16(d)), true
+		case 4:
+			return uint64(binary.BigEndian.Uint32(d)), true
+		case 8:
+			return binary.BigEndian.Uint64(d), true
+		}
+	case RvInt:
+		i, ok := f.Int()
+		return uint64(i), ok
+	}
+	return 0, false
+}
+
+// Float is the value of an RvReal field, or an integer converted.
+func (f *Field) Float() (float64, bool) {
+	d := f.Data
+	switch f.Type {
+	case RvReal:
+		switch len(d) {
+		case 4:
+			return float64(math.Float32frombits(binary.BigEndian.Uint32(d))), true
+		case 8:
+			return math.Float64frombits(binary.BigEndian.Uint64(d)), true
+		}
+	case RvInt:
+		i, ok := f.Int()
+		return float64(i), ok
+	case RvUint:
+		u, ok := f.Uint()
+		return float64(u), ok
+	}
+	return 0, false
+}
+
+// Bool is true when an RvBool or integer field is not zero.
+func (f *Field) Bool() bool {
+	u, ok := f.Uint()
+	return ok && u != 0
+}
+
+// Str is the bytes of an RvString, RvSubject or RvXML field without the
+// nul, not copied.
+func (f *Field) Str() []byte {
+	d := f.Data
+	if f.Type != RvString && f.Type != RvSubject && f.Type != RvXML {
+		return nil
+	}
+	if n := len(d); n > 0 && d[n-1] == 0 {
+		d = d[:n-1]
+	}
+	return d
+}
+
+// Msg is the Reader of an RvMsg field.
+func (f *Field) Msg() (Reader, error) {
+	if f.Type != RvMsg {
+		return Reader{}, ErrBadHeader
+	}
+	return NewReader(f.Data)
+}
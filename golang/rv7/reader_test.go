@@ -0,0 +1,100 @@
+package rv7
+
+import (
+	"testing"
+)
+
+const benchFields = 20
+
+// readNative decodes the same fields as fieldMsg.readCgo with a Reader.
+func readNative(data []byte) (ival int64, fval float64, strs [][]byte, err error) {
+	var f Field
+	r, err := NewReader(data)
+	if err != nil {
+		return
+	}
+	for r.Next(&f) {
+		switch f.Type {
+		case RvInt, RvUint:
+			v, _ := f.Int()
+			ival += v
+		case RvReal:
+			v, _ := f.Float()
+			fval += v
+		case RvString:
+			strs = append(strs, f.Str())
+		}
+	}
+	err = r.Err()
+	return
+}
+
+func TestReader(t *testing.T) {
+	if err := Open(); err != nil {
+		t.Fatal(err)
+	}
+	defer Close()
+	m, err := newFieldMsg(benchFields)
+	if err != nil {
+		t.Fatal(err)
+	}
+	defer m.destroy()
+
+	ci, cf, cs := m.readCgo()
+	ni, nf, ns, err := readNative(m.bytes())
+	if err != nil {
+		t.Fatal(err)
+	}
+	if ci != ni || cf != nf || len(cs) != len(ns) {
+		t.Fatalf("cgo %d %g %d strings, native %d %g %d strings",
+			ci, cf, len(cs), ni, nf, len(ns))
+	}
+	for i := range cs {
+		if cs[i] != string(ns[i]) {
+			t.Fatalf("string %d: cgo %q native %q", i, cs[i], ns[i])
+		}
+	}
+	var f Field
+	r, _ := NewReader(m.bytes())
+	if !r.Find("F5", &f) || f.Type != RvReal {
+		t.Fatalf("F5 not found as a real")
+	}
+	if v, _ := f.Float(); v != 5.5 {
+		t.Fatalf("F5 = %g, not 5.5", v)
+	}
+}
+
+func BenchmarkFieldsCgo(b *testing.B) {
+	if err := Open(); err != nil {
+		b.Fatal(err)
+	}
+	defer Close()
+	m, err := newFieldMsg(benchFields)
+	if err != nil {
+		b.Fatal(err)
+	}
+	defer m.destroy()
+	b.ResetTimer()
+	for i := 0; i < b.N; i++ {
+		m.readCgo()
+	}
+}
+
+func BenchmarkFieldsNative(b *testing.B) {
+	if err := Open(); err != nil {
+		b.Fatal(err)
+	}
+	defer Close()
+	m, err := newFieldMsg(benchFields)
+	if err != nil {
+		b.Fatal(err)
+	}
+	defer m.destroy()
+	data := m.bytes() // once for the msg, as in a dispatch
+	b.ResetTimer()
+	for i := 0; i < b.N; i++ {
+		if _, _, _, err = readNative(data); err != nil {
+			b.Fatal(err)
+		}
+	}
+}
@@ -0,0 +1,244 @@
+// Package rv7 delivers the messages of an rv7 listener into Go in batches.
+//
+// A vector listener (tibrvEvent_CreateVectorListener) gets the messages
+// that were queued back to back for it as one array.  The C side fills the
+// subject, reply and payload of each into a Msg array and calls Go once
+// for the array, so the cost of the cgo crossing is paid per batch instead
+// of per message.  The per-message Listen is kept to compare against.
+package rv7
+
+/*
+#include <stdlib.h>
+#include "rv7_bridge.h"
+*/
+import "C"
+
+import (
+	"errors"
+	"sync"
+	"unsafe"
+)
+
+// Msg is one message of a batch.  The subject, reply and data point into
+// the message buffer, they are only valid until the callback returns.
+type Msg C.rv7_vec_msg_t
+
+// Handle is the tibrvMsg, for the tibrvMsg_Get*() calls of the caller.
+func (m *Msg) Handle() unsafe.Pointer { return unsafe.Pointer(m.msg) }
+
+// SubjectBytes is the send subject without a copy.
+func (m *Msg) SubjectBytes() []byte { return cbytes(m.subject, m.subject_len) }
+
+// Subject is a copy of the send subject.
+func (m *Msg) Subject() string { return string(cbytes(m.subject, m.subject_len)) }
+
+// ReplyBytes is the reply subject without a copy, nil when none.
+func (m *Msg) ReplyBytes() []byte { return cbytes(m.reply, m.reply_len) }
+
+// Data is the rv encoded message without a copy.
+func (m *Msg) Data() []byte {
+	if m.data == nil || m.size == 0 {
+		return nil
+	}
+	return unsafe.Slice((*byte)(m.data), int(m.size))
+}
+
+// cbytes slices a string of the message, the length is filled by rv7_fill.
+func cbytes(s *C.char, n C.tibrv_u32) []byte {
+	if s == nil {
+		return nil
+	}
+	return unsafe.Slice((*byte)(unsafe.Pointer(s)), int(n))
+}
+
+// VectorFunc gets the messages of one dispatch as one slice.
+type VectorFunc func(msgs []Msg)
+
+// MsgFunc gets one message.
+type MsgFunc func(msg *Msg)
+
+// Status is a tibrv_status error.
+type Status int
+
+func (s Status) Error() string {
+	return C.GoString(C.tibrvStatus_GetText(C.tibrv_status(s)))
+}
+
+// ErrTimeout is returned by Dispatch when no event arrived in time.
+var ErrTimeout error = Status(C.TIBRV_TIMEOUT)
+
+func status(err C.tibrv_status) error {
+	if err == C.TIBRV_OK {
+		return nil
+	}
+	return Status(err)
+}
+
+// Listener is a vector or a per-message listener.
+type Listener struct {
+	id  uintptr
+	ev  C.tibrvEvent
+	vfn VectorFunc
+	mfn MsgFunc
+}
+
+// The C closure is the listener id, messages still queued for a destroyed
+// listener find no entry and are dropped.
+var (
+	lmu    sync.RWMutex
+	lmap   = make(map[uintptr]*Listener)
+	nextID uintptr
+)
+
+func lookup(id uintptr) *Listener {
+	lmu.RLock()
+	l := lmap[id]
+	lmu.RUnlock()
+	return l
+}
+
+//export go_rv7_vector
+func go_rv7_vector(vec *C.rv7_vec_msg_t, n C.tibrv_u32, id C.uintptr_t) {
+	if l := lookup(uintptr(id)); l != nil && l.vfn != nil {
+		l.vfn(unsafe.Slice((*Msg)(unsafe.Pointer(vec)), int(n)))
+	}
+}
+
+//export go_rv7_msg
+func go_rv7_msg(m *C.rv7_vec_msg_t, id C.uintptr_t) {
+	if l := lookup(uintptr(id)); l != nil && l.mfn != nil {
+		l.mfn((*Msg)(unsafe.Pointer(m)))
+	}
+}
+
+// Open starts the rv7 api, each Open is paired with a Close.
+func Open() error { return status(C.tibrv_Open()) }
+
+// Close stops the rv7 api.
+func Close() error { return status(C.tibrv_Close()) }
+
+// Queue is a tibrvQueue, the listener callbacks run in Dispatch.
+type Queue struct {
+	q C.tibrvQueue
+}
+
+// DefaultQueue is TIBRV_DEFAULT_QUEUE.
+var DefaultQueue = &Queue{C.TIBRV_DEFAULT_QUEUE}
+
+// NewQueue creates a queue.
+func NewQueue() (*Queue, error) {
+	q := &Queue{}
+	if err := status(C.tibrvQueue_Create(&q.q)); err != nil {
+		return nil, err
+	}
+	return q, nil
+}
+
+// Destroy destroys the queue.
+func (q *Queue) Destroy() error {
+	return status(C.tibrvQueue_DestroyEx(q.q, nil, nil))
+}
+
+// Dispatch runs the events queued, waiting up to timeout seconds for one,
+// -1 waits forever and 0 polls.
+func (q *Queue) Dispatch(timeout float64) error {
+	return status(C.tibrvQueue_TimedDispatch(q.q, C.tibrv_f64(timeout)))
+}
+
+// Transport is a tibrvTransport.
+type Transport struct {
+	t C.tibrvTransport
+}
+
+// ProcessTransport is TIBRV_PROCESS_TRANSPORT.
+var ProcessTransport = &Transport{C.TIBRV_PROCESS_TRANSPORT}
+
+func cstr(s string) *C.char {
+	if s == "" {
+		return nil
+	}
+	return C.CString(s)
+}
+
+// NewTransport connects to the daemon, empty strings are the defaults.
+func NewTransport(service, network, daemon string) (*Transport, error) {
+	svc, net, dmn := cstr(service), cstr(network), cstr(daemon)
+	defer C.free(unsafe.Pointer(svc))
+	defer C.free(unsafe.Pointer(net))
+	defer C.free(unsafe.Pointer(dmn))
+	t := &Transport{}
+	if err := status(C.tibrvTransport_Create(&t.t, svc, net, dmn)); err != nil {
+		return nil, err
+	}
+	return t, nil
+}
+
+// Destroy closes the transport.
+func (t *Transport) Destroy() error {
+	return status(C.tibrvTransport_Destroy(t.t))
+}
+
+func (t *Transport) listen(q *Queue, subject string, l *Listener) error {
+	subj := C.CString(subject)
+	defer C.free(unsafe.Pointer(subj))
+	lmu.Lock()
+	nextID++
+	l.id = nextID
+	lmap[l.id] = l
+	lmu.Unlock()
+	var err C.tibrv_status
+	if l.vfn != nil {
+		err = C.rv7_listen_vector(&l.ev, q.q, t.t, subj, C.uintptr_t(l.id))
+	} else {
+		err = C.rv7_listen(&l.ev, q.q, t.t, subj, C.uintptr_t(l.id))
+	}
+	if err != C.TIBRV_OK {
+		lmu.Lock()
+		delete(lmap, l.id)
+		lmu.Unlock()
+		return Status(err)
+	}
+	return nil
+}
+
+// ListenVector creates a vector listener, fn runs in q.Dispatch with the
+// messages queued for the listener since the last dispatch.
+func (t *Transport) ListenVector(q *Queue, subject string, fn VectorFunc) (*Listener, error) {
+	if fn == nil {
+		return nil, errors.New("rv7: nil callback")
+	}
+	l := &Listener{vfn: fn}
+	if err := t.listen(q, subject, l); err != nil {
+		return nil, err
+	}
+	return l, nil
+}
+
+// Listen creates a listener which calls fn once for each message.
+func (t *Transport) Listen(q *Queue, subject string, fn MsgFunc) (*Listener, error) {
+	if fn == nil {
+		return nil, errors.New("rv7: nil callback")
+	}
+	l := &Listener{mfn: fn}
+	if err := t.listen(q, subject, l); err != nil {
+		return nil, err
+	}
+	return l, nil
+}
+
+// Destroy stops the listener.
+func (l *Listener) Destroy() error {
+	lmu.Lock()
+	delete(lmap, l.id)
+	lmu.Unlock()
+	return status(C.tibrvEvent_DestroyEx(l.ev, nil))
+}
+
+func (t *Transport) sendRepeat(subject string, data []byte, count int) error {
+	subj := C.CString(subject)
+	defer C.free(unsafe.Pointer(subj))
+	buf := C.CBytes(data)
+	defer C.free(buf)
+	return status(C.rv7_send_repeat(t.t, subj, buf, C.tibrv_u32(len(data)),
+		C.tibrv_u32(count)))
+}
@@ -0,0 +1,122 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "rv7_bridge.h"
+#include "_cgo_export.h"
+
+/* the batch array of the dispatching thread, reused by each batch */
+static __thread rv7_vec_msg_t * rv7_vec;
+static __thread tibrv_u32       rv7_vec_size;
+
+static void
+rv7_fill( rv7_vec_msg_t *m,  tibrvMsg msg )
+{
+  m->msg     = msg;
+  m->subject = NULL;
+  m->reply   = NULL;
+  m->data    = NULL;
+  m->size    = 0;
+  tibrvMsg_GetSendSubject( msg, &m->subject );
+  tibrvMsg_GetReplySubject( msg, &m->reply );
+  tibrvMsg_GetAsBytes( msg, &m->data );
+  tibrvMsg_GetByteSize( msg, &m->size );
+  /* lengths here, Go slices the strings without a strlen call */
+  m->subject_len = ( m->subject == NULL ? 0 :
+                     (tibrv_u32) strlen( m->subject ) );
+  m->reply_len   = ( m->reply == NULL ? 0 : (tibrv_u32) strlen( m->reply ) );
+}
+
+/* the msgs of a vector are all from one listener, the closure is its id */
+static void
+rv7_vector_bridge( tibrvMsg *msgs,  tibrv_u32 n )
+{
+  void    * cl = NULL;
+  tibrv_u32 i;
+  if ( n == 0 )
+    return;
+  if ( n > rv7_vec_size ) {
+    tibrv_u32       sz = ( n + 255 ) & ~255u;
+    rv7_vec_msg_t * p  = realloc( rv7_vec, sz * sizeof( rv7_vec_msg_t ) );
+    if ( p == NULL )
+      return;
+    rv7_vec      = p;
+    rv7_vec_size = sz;
+  }
+  for ( i = 0; i < n; i++ )
+    rv7_fill( &rv7_vec[ i ], msgs[ i ] );
+  tibrvMsg_GetClosure( msgs[ 0 ], &cl );
+  go_rv7_vector( rv7_vec, n, (uintptr_t) cl );
+}
+
+static void
+rv7_msg_bridge( tibrvEvent ev,  tibrvMsg msg,  void *cl )
+{
+  rv7_vec_msg_t m;
+  (void) ev;
+  rv7_fill( &m, msg );
+  go_rv7_msg( &m, (uintptr_t) cl );
+}
+
+tibrv_status
+rv7_listen_vector( tibrvEvent *ev,  tibrvQueue q,  tibrvTransport t,
+                   const char *subj,  uintptr_t id )
+{
+  return tibrvEvent_CreateVectorListener( ev, q, rv7_vector_bridge, t, subj,
+                                          (const void *) id );
+}
+
+tibrv_status
+rv7_listen( tibrvEvent *ev,  tibrvQueue q,  tibrvTransport t,
+            const char *subj,  uintptr_t id )
+{
+  return tibrvEvent_CreateListener( ev, q, rv7_msg_bridge, t, subj,
+                                    (const void *) id );
+}
+
+/* send the same payload count times in one call, for the benchmark */
+tibrv_status
+rv7_send_repeat( tibrvTransport t,  const char *subj,  const void *data,
+                 tibrv_u32 len,  tibrv_u32 count )
+{
+  tibrvMsg     msg;
+  tibrv_status err = TIBRV_OK;
+  tibrv_u32    i;
+  for ( i = 0; i < count && err == TIBRV_OK; i++ ) {
+    if ( (err = tibrvMsg_Create( &msg )) != TIBRV_OK )
+      break;
+    tibrvMsg_SetSendSubject( msg, subj );
+    tibrvMsg_AddOpaque( msg, "data", data, len );
+    err = tibrvTransport_Send( t, msg );
+    tibrvMsg_Destroy( msg );
+  }
+  return err;
+}
+
+tibrv_status
+rv7_field_msg( tibrvMsg *msg,  tibrv_u32 nfields )
+{
+  tibrv_status err;
+  tibrv_u32    i;
+  char         name[ 16 ], val[ 32 ];
+  if ( (err = tibrvMsg_Create( msg )) != TIBRV_OK )
+    return err;
+  for ( i = 0; i < nfields && err == TIBRV_OK; i++ ) {
+    snprintf( name, sizeof( name ), "F%u", i );
+    switch ( i % 4 ) {
+      case 0:
+        err = tibrvMsg_AddI32( *msg, name, (tibrv_i32) i * -100 );
+        break;
+      case 1:
+        err = tibrvMsg_AddF64( *msg, name, (tibrv_f64) i + 0.5 );
+        break;
+      case 2:
+        snprintf( val, sizeof( val ), "value-%u", i );
+        err = tibrvMsg_AddString( *msg, name, val );
+        break;
+      default:
+        err = tibrvMsg_AddU64( *msg, name, ( (tibrv_u64) 1 << 40 ) + i );
+        break;
+    }
+  }
+  return err;
+}
@@ -0,0 +1,27 @@
+#ifndef __rv7_bridge_h__
+#define __rv7_bridge_h__
+
+#include <stdint.h>
+#include <sassrv/rv7api.h>
+
+/* a message of a batch, filled on the C side so Go reads it without a call */
+typedef struct {
+  tibrvMsg     msg;
+  const char * subject;
+  const char * reply;
+  const void * data;
+  tibrv_u32    size,
+               subject_len,
+               reply_len;
+} rv7_vec_msg_t;
+
+tibrv_status rv7_listen_vector( tibrvEvent *ev, tibrvQueue q, tibrvTransport t,
+                                const char *subj, uintptr_t id );
+tibrv_status rv7_listen( tibrvEvent *ev, tibrvQueue q, tibrvTransport t,
+                         const char *subj, uintptr_t id );
+tibrv_status rv7_send_repeat( tibrvTransport t, const char *subj,
+                              const void *data, tibrv_u32 len,
+                              tibrv_u32 count );
+/* a message of nfields named F0, F1, ... of types i32, f64, string, u64 */
+tibrv_status rv7_field_msg( tibrvMsg *msg,  tibrv_u32 nfields );
+#endif
@@ -0,0 +1,67 @@
+package rv7
+
+import (
+	"testing"
+)
+
+// Messages are published on the process transport before the timer starts,
+// then dispatched until all are received, so the time is the delivery into
+// Go: one cgo crossing for each message against one for each batch.
+
+const benchSubject = "RV7GO.BENCH"
+
+var benchData = make([]byte, 64)
+
+func benchDispatch(b *testing.B, vector bool) {
+	b.StopTimer()
+	if err := Open(); err != nil {
+		b.Fatal(err)
+	}
+	defer Close()
+	q, err := NewQueue()
+	if err != nil {
+		b.Fatal(err)
+	}
+	defer q.Destroy()
+
+	var recv, bytes, batches int
+	var l *Listener
+	if vector {
+		l, err = ProcessTransport.ListenVector(q, benchSubject, func(msgs []Msg) {
+			for i := range msgs {
+				bytes += len(msgs[i].Data())
+			}
+			recv += len(msgs)
+			batches++
+		})
+	} else {
+		l, err = ProcessTransport.Listen(q, benchSubject, func(m *Msg) {
+			bytes += len(m.Data())
+			recv++
+			batches++
+		})
+	}
+	if err != nil {
+		b.Fatal(err)
+	}
+	defer l.Destroy()
+
+	if err = ProcessTransport.sendRepeat(benchSubject, benchData, b.N); err != nil {
+		b.Fatal(err)
+	}
+	b.StartTimer()
+	for recv < b.N {
+		if err = q.Dispatch(1.0); err != nil && err != ErrTimeout {
+			b.Fatal(err)
+		}
+	}
+	b.StopTimer()
+	if batches > 0 {
+		b.ReportMetric(float64(recv)/float64(batches), "msgs/batch")
+	}
+	b.SetBytes(int64(bytes / recv))
+}
+
+func BenchmarkPerMessage(b *testing.B) { benchDispatch(b, false) }
+
+func BenchmarkVector(b *testing.B) { benchDispatch(b, true) }
@@ -19,6 +19,7 @@ extern "C" {
 #define RV_NO_SERVICE 11
 
 typedef int rv_Status;
+typedef int rv_IdleStrategy;
 typedef void * rv_Session;
 typedef void * rv_Listener;
 typedef void * rv_Timer;
@@ -31,6 +32,11 @@ typedef int rvmsg_Type;
 #define RV_TRUE 1
 #define RV_FALSE 0
 
+#define RV_IDLE_SLEEP 0 /* spin, then wait up to 100ms for an event (default) */
+#define RV_IDLE_SPIN  1 /* never wait, lowest latency, a cpu at 100% */
+#define RV_IDLE_YIELD 2 /* spin, then yield the cpu between polls */
+#define RV_IDLE_BLOCK 3 /* spin, then wait until an event, timer or signal */
+
 typedef unsigned long long rv_stats_t;
 typedef unsigned int rv_ipaddr_t;
 
@@ -54,6 +60,16 @@ struct rv_Stats {
 typedef void (*rv_MessageCallback)( rv_Listener listener, rv_Name subject,
                                     rv_Name reply, rvmsg_Type type,
                                     size_t data_len, void *data, void * cl );
+/* a message of a vector listener, valid until the callback returns */
+typedef struct {
+  rv_Name    subject,
+             reply;
+  rvmsg_Type type;
+  size_t     data_len;
+  void     * data;
+} rv_Message;
+typedef void (*rv_VectorCallback)( rv_Listener listener, rv_Message * vec,
+                                   size_t count, void * cl );
 typedef void (*rv_TimerCallback)( rv_Timer timer, void * cl );
 typedef void (*rv_SignalCallback)( rv_Signal shandle, void * cl );
 
@@ -67,6 +83,11 @@ rv_Status rv_ListenSubject( rv_Session session, rv_Listener * listener,
 rv_Status rv_ListenInbox( rv_Session session, rv_Listener * listener,
                           char *inbox_str,  size_t inbox_len,
                           rv_MessageCallback callback, void * closure );
+/* callback gets the msgs of the subject that arrived in one poll of
+ * rv_MainLoop as one array */
+rv_Status rv_ListenSubjectVector( rv_Session session, rv_Listener * listener,
+                                  rv_Name subject, rv_VectorCallback callback,
+                                  rv_Name reply,  void * closure );
 
 rv_Status rv_Close( rv_Listener listener );
 const char *rv_Subject( rv_Listener listener );
@@ -76,6 +97,15 @@ rv_Status rv_Send( rv_Session session, rv_Name subject, rvmsg_Type type,
                    size_t data_len, void *data );
 rv_Status rv_SendWithReply( rv_Session session, rv_Name subject, rv_Name reply,
                             rvmsg_Type type, size_t data_len, void *data );
+/* rv_Send and rv_SendWithReply copy into a batch which is sent when it has
+ * batch_bytes, on rv_Flush() or every ival_ms by a timer, both 0 sends each
+ * message as it is made */
+rv_Status rv_SetSendBatch( rv_Session session, size_t batch_bytes,
+                           float ival_ms );
+rv_Status rv_Flush( rv_Session session );
+/* how rv_MainLoop waits after spin_count polls in a row found no work */
+rv_Status rv_SetIdleStrategy( rv_Session session, rv_IdleStrategy strategy,
+                              unsigned int spin_count );
 rv_Status rv_MainLoop( rv_Session session );
 rv_Status rv_CreateTimer( rv_Session session, rv_Timer * timer,
                           float interval,  rv_TimerCallback callback,
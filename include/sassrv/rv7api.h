@@ -72,6 +72,14 @@ typedef struct {
   tibrv_u8       type;
 } tibrvMsgField;
 
+/* a field of a prepared message, written in place by tibrvMsg_SetSlot() */
+typedef struct {
+  tibrv_u32 off;   /* offset of the field data in the message buffer */
+  tibrv_u32 size;  /* size of the field data, capacity for strings */
+  tibrv_u8  type;  /* TIBRVMSG_I32, TIBRVMSG_STRING, ... */
+  tibrv_u8  swap;  /* numeric data is stored in the other byte order */
+} tibrvMsgSlot;
+
 typedef enum {
   TIBRVFT_PREPARE_TO_ACTIVATE = 1,
   TIBRVFT_ACTIVATE            = 2,
@@ -203,6 +211,13 @@ const char * tibrvStatus_GetText( tibrv_status status );
 const char * tibrv_Version( void );
 tibrv_status tibrv_Open( void );
 tibrv_status tibrv_Close( void );
+/* before tibrv_Open: spread transports over num_threads I/O threads, thread i
+ * is pinned to cpus[ i ] when cpus is not NULL and cpus[ i ] >= 0 */
+tibrv_status tibrv_SetIoThreads( tibrv_u32 num_threads, const tibrv_i32 * cpus );
+/* transports created with the same service, network and daemon share one
+ * daemon connection, each has its own session under the connection's, with
+ * its own listeners and inboxes; off by default, each transport connects */
+tibrv_status tibrv_SetTransportSharing( tibrv_bool on );
 tibrv_status tibrv_SetCodePages( char *host_codepage, char *net_codepage );
 tibrv_status tibrv_SetRVParameters( tibrv_u32 argc, const char **argv );
 tibrv_status tibrv_OpenEx( const char  *pathname );
@@ -220,6 +235,12 @@ tibrv_status tibrvEvent_GetType( tibrvEvent event,  tibrvEventType * type );
 tibrv_status tibrvEvent_GetQueue( tibrvEvent event,  tibrvQueue * q );
 tibrv_status tibrvEvent_GetListenerSubject( tibrvEvent event,  const char ** subject );
 tibrv_status tibrvEvent_GetListenerTransport( tibrvEvent event,  tibrvTransport * tport );
+/* Drop messages for the listener on the I/O thread unless expr is true, they
+ * are not copied or queued.  expr is terms joined by && and ||, with && binding
+ * tighter, no parentheses: FIELD op value, op is one of == != < <= > >=, or
+ * FIELD in { value, ... }.  A value is a number or a "string", a term on a
+ * missing field or of another type is false.  NULL removes the filter */
+tibrv_status tibrvEvent_SetListenerFilter( tibrvEvent event,  const char * expr );
 tibrv_status tibrvEvent_GetTimerInterval( tibrvEvent event,  tibrv_f64 * ival );
 tibrv_status tibrvEvent_ResetTimerInterval( tibrvEvent event,  tibrv_f64 ival );
 
@@ -227,16 +248,53 @@ typedef enum {
   TIBRVQUEUE_DISCARD_NONE  = 0,
   TIBRVQUEUE_DISCARD_NEW   = 1,
   TIBRVQUEUE_DISCARD_FIRST = 2,
-  TIBRVQUEUE_DISCARD_LAST  = 3
+  TIBRVQUEUE_DISCARD_LAST  = 3,
+  /* not a limit: a msg replaces the waiting msg of the same listener and
+   * subject, which keeps its place in the queue, max_ev is not used */
+  TIBRVQUEUE_CONFLATE_BY_SUBJECT = 4
 } tibrvQueueLimitPolicy;
 typedef enum
 {
   TIBRV_TRANSPORT_DEFAULT_BATCH = 0,
   TIBRV_TRANSPORT_TIMER_BATCH   = 1, /* per-thread accumulator, pipe-RPC flush */
-  TIBRV_TRANSPORT_SINGLE_BATCH  = 2  /* one shared buffer, inline flush on E +
+  TIBRV_TRANSPORT_SINGLE_BATCH  = 2, /* one shared buffer, inline flush on E +
                                         periodic batch timer (coalescing) */
+  TIBRV_TRANSPORT_ASYNC_BATCH   = 3  /* per-thread ring drained by E, send
+                                        only waits when the ring is full */
 } tibrvTransportBatchMode;
 
+/* stats histograms are log2: [ 0 ] counts zero, [ i ] counts values in
+ * [ 2^(i-1), 2^i ), the last bucket also counts everything above */
+#define TIBRV_STATS_HIST_SIZE 24
+typedef struct {
+  tibrv_u64 enqueued,       /* msgs pushed (timer and request events too) */
+            dispatched,     /* msgs passed to callbacks */
+            discarded,      /* msgs dropped by a limit policy, not enforced */
+            conflated,      /* msgs replaced by a newer one of the subject */
+            depth,          /* events queued now */
+            max_depth,      /* most events queued since the last GetStats */
+            delay_events,   /* events with an enqueue to dispatch delay */
+            delay_ns,       /* sum of the delays */
+            delay_max_ns,   /* largest delay since the last GetStats */
+            delay_hist[ TIBRV_STATS_HIST_SIZE ]; /* delay in microseconds */
+} tibrvQueueStats;
+typedef struct {
+  tibrv_u64 msgs_in,
+            bytes_in,
+            msgs_filtered,  /* listener deliveries dropped by a filter */
+            msgs_out,
+            bytes_out,
+            msgs_buffered,  /* sent while the daemon was down, kept for replay */
+            msgs_dropped,   /* sent while down, over the buffer limit */
+            reconnects,
+            batches,        /* publish loops run on the transport's thread */
+            batch_hist[ TIBRV_STATS_HIST_SIZE ], /* msgs per batch */
+            pipe_ops,       /* ops sent to the transport's thread and waited on */
+            pipe_rtt_ns,    /* sum of the round trips */
+            pipe_rtt_max_ns,/* largest round trip since the last GetStats */
+            pipe_rtt_hist[ TIBRV_STATS_HIST_SIZE ]; /* rtt in microseconds */
+} tibrvTransportStats;
+
 #define TIBRVQUEUE_DEFAULT_POLICY TIBRVQUEUE_DISCARD_NONE
 #define TIBRVQUEUE_DEFAULT_PRIORITY 1
 #define TIBRV_WAIT_FOREVER -1.0
@@ -256,6 +314,19 @@ tibrv_status tibrvQueue_GetName( tibrvQueue q, const char ** name );
 typedef void (* tibrvQueueHook )( tibrvQueue , void * );
 tibrv_status tibrvQueue_SetHook( tibrvQueue q, tibrvQueueHook hook, void * closure );
 tibrv_status tibrvQueue_GetHook( tibrvQueue q, tibrvQueueHook * hook );
+/* run callbacks on the I/O thread as messages arrive, no dispatch needed;
+ * the callbacks run without transport locks held and may call the API, but
+ * a SendRequest() on a transport of the same I/O thread returns
+ * TIBRV_NOT_PERMITTED (use SendRequestAsync()), one on another I/O thread
+ * blocks this one until the reply or timeout */
+tibrv_status tibrvQueue_SetInlineDispatch( tibrvQueue q, tibrv_bool on );
+tibrv_status tibrvQueue_GetInlineDispatch( tibrvQueue q, tibrv_bool * on );
+/* poll an empty queue for up to spin_us microseconds before sleeping */
+tibrv_status tibrvQueue_SetSpinTime( tibrvQueue q, tibrv_u32 spin_us );
+tibrv_status tibrvQueue_GetSpinTime( tibrvQueue q, tibrv_u32 * spin_us );
+/* counters are totals since the queue was created, diff two samples for
+ * rates; the max fields restart at each call */
+tibrv_status tibrvQueue_GetStats( tibrvQueue q, tibrvQueueStats * stats );
 #define tibrvQueue_Dispatch( q ) tibrvQueue_TimedDispatch( q, TIBRV_WAIT_FOREVER )
 #define tibrvQueue_Poll( q ) tibrvQueue_TimedDispatch( q, TIBRV_NO_WAIT )
 #define tibrvQueue_Destroy( q ) tibrvQueue_DestroyEx( q, NULL, NULL )
@@ -267,14 +338,20 @@ tibrv_status tibrvQueueGroup_TimedDispatch( tibrvQueueGroup grp, tibrv_f64 timeo
 tibrv_status tibrvQueueGroup_Destroy( tibrvQueueGroup grp );
 tibrv_status tibrvQueueGroup_Add( tibrvQueueGroup grp, tibrvQueue q );
 tibrv_status tibrvQueueGroup_Remove( tibrvQueueGroup grp, tibrvQueue q );
+tibrv_status tibrvQueueGroup_SetSpinTime( tibrvQueueGroup grp, tibrv_u32 spin_us );
 
 tibrv_status tibrvTransport_Create( tibrvTransport * tport, const char * service,
                                     const char * network, const char * daemon );
+/* on TIBRV_PROCESS_TRANSPORT the listeners get the message data by
+ * reference, the sender's next change to msg copies it first */
 tibrv_status tibrvTransport_Send( tibrvTransport tport, tibrvMsg msg );
 tibrv_status tibrvTransport_Sendv( tibrvTransport tport, tibrvMsg * vec, tibrv_u32 len );
 tibrv_status tibrvTransport_Flush( tibrvTransport tport );
 tibrv_status tibrvTransport_SendRequest( tibrvTransport tport, tibrvMsg msg,
                                          tibrvMsg * reply, tibrv_f64 idle_timeout );
+/* reply or timeout (msg NULL) is dispatched from q as cb( tport, msg, closure ) */
+tibrv_status tibrvTransport_SendRequestAsync( tibrvTransport tport, tibrvMsg msg, tibrvEventCallback cb,
+                                              tibrvQueue q, tibrv_f64 idle_timeout, const void * closure );
 tibrv_status tibrvTransport_SendReply( tibrvTransport tport, tibrvMsg msg, tibrvMsg request_msg );
 tibrv_status tibrvTransport_Destroy( tibrvTransport tport );
 tibrv_status tibrvTransport_CreateInbox( tibrvTransport tport, char * inbox_str, tibrv_u32 inbox_len );
@@ -288,12 +365,36 @@ tibrv_status tibrvTransport_GetSendingWaitLimit( tibrvTransport tport, tibrv_u32
 tibrv_status tibrvTransport_SetBatchMode( tibrvTransport tport, tibrvTransportBatchMode mode );
 tibrv_status tibrvTransport_SetBatchSize( tibrvTransport tport, tibrv_u32 num_bytes );
 tibrv_status tibrvTransport_SetBatchInterval( tibrvTransport tport, tibrv_f64 secs );
+/* totals since the transport was created, pipe_rtt_max_ns restarts */
+tibrv_status tibrvTransport_GetStats( tibrvTransport tport, tibrvTransportStats * stats );
+/* after a disconnect the transport waits min_ival seconds, doubling for each
+ * failed attempt up to max_ival, less a random part of up to half; publishes
+ * made while down are kept up to buffer_bytes and sent once the listeners are
+ * subscribed again (defaults 1, 30 and 1MB) */
+tibrv_status tibrvTransport_SetReconnect( tibrvTransport tport, tibrv_f64 min_ival,
+                                          tibrv_f64 max_ival, tibrv_u32 buffer_bytes );
+/* daemons a reconnect tries in order after the transport's own */
+tibrv_status tibrvTransport_SetAlternateDaemons( tibrvTransport tport, const char ** daemons,
+                                                 tibrv_u32 count );
+/* receive on count daemon connections, each serviced by its own I/O thread
+ * when tibrv_SetIoThreads() started enough; listeners are spread over them by
+ * subject hash, so the msgs of a subject stay in order; sends, inboxes and
+ * requests use the first; before any listener and not on a shared transport */
+tibrv_status tibrvTransport_SetReceiveLanes( tibrvTransport tport, tibrv_u32 count );
 tibrv_status tibrvTransport_CreateLicensed( tibrvTransport * tport, const char * service,
                                             const char * network, const char * daemon, const char * );
 tibrv_status tibrvTransport_RequestReliability( tibrvTransport tport, tibrv_f64 reliability );
 
+typedef enum
+{
+  TIBRV_DISPATCH_BY_SUBJECT  = 0, /* events with the same subject run in order */
+  TIBRV_DISPATCH_BY_LISTENER = 1  /* events of the same listener run in order */
+} tibrvDispatchPartition;
+
 #define tibrvDispatcher_Create( disp, able ) tibrvDispatcher_CreateEx( disp, able, TIBRV_WAIT_FOREVER )
 tibrv_status tibrvDispatcher_CreateEx( tibrvDispatcher * disp, tibrvDispatchable able, tibrv_f64 idle_timeout );
+tibrv_status tibrvDispatcher_CreatePool( tibrvDispatcher * disp, tibrvDispatchable able, tibrv_f64 idle_timeout,
+                                         tibrv_u32 num_threads, tibrvDispatchPartition part );
 tibrv_status tibrvDispatcher_Join( tibrvDispatcher disp );
 tibrv_status tibrvDispatcher_Destroy( tibrvDispatcher disp );
 tibrv_status tibrvDispatcher_SetName( tibrvDispatcher disp, const char * name );
@@ -327,6 +428,23 @@ tibrv_status tibrvMsg_CreateCopy( const tibrvMsg msg,  tibrvMsg * copy );
 tibrv_status tibrvMsg_MarkReferences( tibrvMsg msg );
 tibrv_status tibrvMsg_ClearReferences( tibrvMsg msg );
 tibrv_status tibrvMsg_GetCurrentTime( tibrvMsgDateTime * cur );
+/* destroyed msgs are kept on per thread free lists, max_free per size class
+ * (default 64, 0 disables); the stats are for the calling thread, allocs
+ * counts the mallocs made for msg shells and buffers */
+tibrv_status tibrvMsg_SetPoolSize( tibrv_u32 max_free );
+tibrv_status tibrvMsg_GetPoolStats( tibrv_u64 * hits, tibrv_u64 * misses, tibrv_u64 * allocs );
+/* in a callback on a TIBRVQUEUE_CONFLATE_BY_SUBJECT queue, the number of
+ * msgs of the subject this one replaced while it waited, 0 otherwise */
+tibrv_status tibrvMsg_GetConflateCount( tibrvMsg msg, tibrv_u32 * count );
+/* prepared messages: add every field once, strings and opaques at their
+ * largest size, then take a slot for each field that changes; setting a slot
+ * overwrites the field data, no encoding, as long as no field is added,
+ * removed or updated after the slots are taken */
+tibrv_status tibrvMsg_GetSlot( tibrvMsg msg, const char * name, tibrv_u16 id, tibrvMsgSlot * slot );
+tibrv_status tibrvMsg_SetSlot( tibrvMsg msg, const tibrvMsgSlot * slot, const void * value, tibrv_u32 size );
+/* slot data is at base + slot.off, valid while the field layout is fixed and
+ * the msg does not grow, which moves the buffer */
+tibrv_status tibrvMsg_GetSlotBase( tibrvMsg msg, void ** base );
 tibrv_status tibrvMsg_GetCurrentTimeString( char * local,  char * gmt );
 
 tibrv_status tibrvMsg_AddMsgEx( tibrvMsg msg, const char * name, tibrvMsg value, tibrv_u16 id );
@@ -532,6 +650,14 @@ tibrv_status tibrvftMember_GetTransport( tibrvftMember memb, tibrvTransport * tp
 tibrv_status tibrvftMember_GetGroupName( tibrvftMember memb, const char ** name );
 tibrv_status tibrvftMember_GetWeight( tibrvftMember memb, tibrv_u16 * weight );
 tibrv_status tibrvftMember_SetWeight( tibrvftMember memb, tibrv_u16 weight );
+/* fast mode: while active, heartbeat every hb_ival seconds (0.001 to 0.1) on
+ * a private daemon connection, sent by its own I/O thread from a timerfd; a
+ * peer not heard for miss_count intervals in a row is lost and the next
+ * ranked member activates, it is ranked again after recover_count intervals
+ * heard in a row; every member of the group should use it, the hb_ival and
+ * activate_ival of tibrvftMember_Create() still apply to members not lost */
+tibrv_status tibrvftMember_SetFastMode( tibrvftMember memb, tibrv_f64 hb_ival,
+                                        tibrv_u32 miss_count, tibrv_u32 recover_count );
 tibrv_status tibrvftMonitor_Create( tibrvftMonitor * mon, tibrvQueue q, tibrvftMonitorCallback cb, tibrvTransport tport, const char * name, tibrv_f64 lost_ival, const void * closure );
 tibrv_status tibrvftMonitor_Destroy( tibrvftMonitor mon );
 tibrv_status tibrvftMonitor_DestroyEx( tibrvftMonitor mon, tibrvftMonitorOnComplete cb );
@@ -541,5 +667,86 @@ tibrv_status tibrvftMonitor_GetGroupName( tibrvftMonitor mon, const char ** name
 
 #ifdef __cplusplus
 }
+
+namespace rv7 {
+/* typed front-end for prepared message slots, the slot type is checked when
+ * bound and set() is a tibrvMsg_SetSlot() of the value:
+ *
+ *   rv7::MsgSlot<tibrv_u64> seq;
+ *   rv7::MsgSlot<tibrv_f64> price;
+ *   tibrvMsg_AddU64( msg, "SEQ", 0 );
+ *   tibrvMsg_AddF64( msg, "PRICE", 0 );
+ *   seq.bind( msg, "SEQ" );  price.bind( msg, "PRICE" );
+ *   for (;;) { seq.set( n++ ); price.set( px ); tibrvTransport_Send( t, msg ); }
+ */
+template <class T> struct MsgSlotType;
+template <> struct MsgSlotType<tibrv_i8>  { enum { type = TIBRVMSG_I8 }; };
+template <> struct MsgSlotType<tibrv_u8>  { enum { type = TIBRVMSG_U8 }; };
+template <> struct MsgSlotType<tibrv_i16> { enum { type = TIBRVMSG_I16 }; };
+template <> struct MsgSlotType<tibrv_u16> { enum { type = TIBRVMSG_U16 }; };
+template <> struct MsgSlotType<tibrv_i32> { enum { type = TIBRVMSG_I32 }; };
+template <> struct MsgSlotType<tibrv_u32> { enum { type = TIBRVMSG_U32 }; };
+template <> struct MsgSlotType<tibrv_i64> { enum { type = TIBRVMSG_I64 }; };
+template <> struct MsgSlotType<tibrv_u64> { enum { type = TIBRVMSG_U64 }; };
+template <> struct MsgSlotType<tibrv_f32> { enum { type = TIBRVMSG_F32 }; };
+template <> struct MsgSlotType<tibrv_f64> { enum { type = TIBRVMSG_F64 }; };
+
+struct MsgSlotBase {
+  tibrvMsgSlot slot;
+  tibrvMsg     msg;
+
+  MsgSlotBase() : msg( 0 ) {}
+  tibrv_status bind( tibrvMsg m,  const char * name,  tibrv_u16 id,
+                     tibrv_u8 type ) {
+    tibrv_status status = tibrvMsg_GetSlot( m, name, id, &this->slot );
+    if ( status == TIBRV_OK && this->slot.type != type )
+      status = TIBRV_ARG_CONFLICT;
+    this->msg = ( status != TIBRV_OK ? 0 : m );
+    return status;
+  }
+  /* the buffer moves when the msg grows, the slot is found from the msg on
+   * each set, not from a pointer taken at bind */
+  tibrv_status store( const void * value,  tibrv_u32 size ) {
+    if ( this->msg == 0 )
+      return TIBRV_INVALID_MSG;
+    return tibrvMsg_SetSlot( this->msg, &this->slot, value, size );
+  }
+};
+
+template <class T>
+struct MsgSlot : public MsgSlotBase {
+  tibrv_status bind( tibrvMsg msg,  const char * name,  tibrv_u16 id = 0 ) {
+    return this->MsgSlotBase::bind( msg, name, id, MsgSlotType<T>::type );
+  }
+  tibrv_status set( T value ) {
+    return this->store( &value, sizeof( T ) );
+  }
+};
+
+template <>
+struct MsgSlot<tibrv_bool> : public MsgSlotBase {
+  tibrv_status bind( tibrvMsg msg,  const char * name,  tibrv_u16 id = 0 ) {
+    return this->MsgSlotBase::bind( msg, name, id, TIBRVMSG_BOOL );
+  }
+  tibrv_status set( tibrv_bool value ) {
+    unsigned char b = ( value ? 1 : 0 );
+    return this->store( &b, 1 );
+  }
+};
+
+template <>
+struct MsgSlot<const char *> : public MsgSlotBase {
+  tibrv_status bind( tibrvMsg msg,  const char * name,  tibrv_u16 id = 0 ) {
+    return this->MsgSlotBase::bind( msg, name, id, TIBRVMSG_STRING );
+  }
+  /* truncated to the capacity given when the field was added, less the nul */
+  tibrv_status set( const char * value ) {
+    tibrv_u32 len = 0;
+    while ( len + 1 < this->slot.size && value[ len ] != '\0' )
+      len++;
+    return this->store( value, len );
+  }
+};
+}
 #endif
 #endif
@@ -19,32 +19,114 @@ typedef enum { TIBRV_NONE     = 0,
                TIBRV_FTMEMBER,
                TIBRV_FTMONITOR } ElemType;
 
+/* A handle is slot | gen << API_GEN_SHIFT, the gen is bumped when the slot
+ * is freed, so a stale handle no longer matches id after reuse.  The handle
+ * has 12 bits of gen and 20 of slot (1M live objects), the gen wraps and the
+ * slot is reused, a stale handle matches again only after 4096 reuses */
+static const uint32_t API_GEN_SHIFT = 20,
+                      API_GEN_MAX   = 0xfff,
+                      API_SLOT_MASK = ( 1U << API_GEN_SHIFT ) - 1,
+                      API_SEG_BITS  = 12, /* slots per segment, 4096 */
+                      API_SEG_SIZE  = 1U << API_SEG_BITS,
+                      API_SEG_COUNT = 1U << ( API_GEN_SHIFT - API_SEG_BITS );
+
 struct tibrv_Elem {
-  tibrvId  id;
+  tibrvId  id;   /* handle, 0 when free, written last by make, first by rem */
   ElemType type;
   void   * ptr;
+  uint32_t gen;  /* generation of the next handle for this slot, wraps */
+};
+
+/* Per thread epoch, active is the epoch entered or 0 when outside a guard */
+struct api_EpochRec {
+  api_EpochRec * next;
+  uint64_t       active;
+  uint32_t       depth;
+};
+
+/* An object removed from the map, freed after two epoch advances */
+struct api_Retired {
+  api_Retired * next;
+  void        * ptr;
+  void       (* free_fn)( void * );
+  uint64_t      epoch;
 };
 
 struct EvPipe;
+
+/* An I/O thread after the first, which is Tibrv_API::poll and ev_read.
+ * Transports are assigned to one at create and stay there */
+static const uint32_t API_MAX_IO_THREADS = 64;
+static const uint32_t API_MAX_LANES      = 16; /* receive conns of a tport */
+static const uint32_t API_FT_IO          = API_MAX_IO_THREADS; /* FAST_HB */
+struct api_IoThread {
+  EvPoll   poll;
+  EvPipe * pipe;
+  int      pfd[ 2 ];
+  void * operator new( size_t, void *ptr ) { return ptr; }
+  api_IoThread() : pipe( 0 ) {}
+};
+
 struct api_Queue;
 struct api_Transport;
+struct api_Dispatcher;
 struct SendCtx;
+struct api_SendRing;
+struct api_FtFast;
 
 struct Tibrv_API {
   EvPoll          poll;
-  tibrvId         next_id, free_id, map_size;
+  tibrvId         next_id, free_id;   /* slot numbers */
   int             idle_count;
-  tibrv_Elem    * map;
-  pthread_mutex_t map_mutex;
+  tibrv_Elem    * seg[ API_SEG_COUNT ]; /* segments never move or shrink */
+  pthread_mutex_t map_mutex;          /* writers only, get<> is lock free */
+  uint64_t        epoch;
+  api_EpochRec  * epoch_list;
+  api_Retired   * limbo;
   pthread_cond_t  cond;
   EvPipe        * ev_read;
   int             pfd[ 2 ];
   api_Queue     * default_queue;
   api_Transport * process_tport;
+  TimerWheel      timers;             /* api timers, ticked on poll */
+  api_IoThread  * io_thr[ API_FT_IO + 1 ]; /* [ 0 ] is poll, ev_read */
+  uint32_t        io_load[ API_FT_IO + 1 ], /* transports on each */
+                  io_count;
+  int             io_cpu[ API_FT_IO + 1 ];  /* -1 = not pinned */
+  bool            share_tports;       /* same daemon params, one connection */
   void * operator new( size_t, void *ptr ) { return ptr; }
-  Tibrv_API() : next_id( 11 ), free_id( 0 ), map_size( 0 ), idle_count( 0 ),
-               map( 0 ), ev_read( 0 ), default_queue( 0 ), process_tport( 0 ) {}
+  Tibrv_API() : next_id( 11 ), free_id( 0 ), idle_count( 0 ), epoch( 1 ),
+               epoch_list( 0 ), limbo( 0 ), ev_read( 0 ), default_queue( 0 ),
+               process_tport( 0 ), timers( this->poll ), io_count( 1 ),
+               share_tports( false ) {
+    ::memset( this->seg, 0, sizeof( this->seg ) );
+    ::memset( this->io_thr, 0, sizeof( this->io_thr ) );
+    ::memset( this->io_load, 0, sizeof( this->io_load ) );
+    for ( uint32_t k = 0; k <= API_FT_IO; k++ )
+      this->io_cpu[ k ] = -1;
+  }
   bool do_poll( uint64_t nsecs,  bool once ) noexcept;
+  bool start_io( uint32_t k ) noexcept;
+  bool start_ft_io( void ) noexcept;
+  uint32_t io_assign( tibrvId id ) noexcept;
+  EvPoll & io_poll( uint32_t k ) {
+    return ( k == 0 ? this->poll : this->io_thr[ k ]->poll );
+  }
+  EvPipe * io_pipe( uint32_t k ) {
+    return ( k == 0 ? this->ev_read : this->io_thr[ k ]->pipe );
+  }
+
+  tibrv_Elem *elem( tibrvId id ) const {
+    uint32_t     slot = id & API_SLOT_MASK;
+    tibrv_Elem * s    = __atomic_load_n( &this->seg[ slot >> API_SEG_BITS ],
+                                         __ATOMIC_ACQUIRE );
+    return ( s == NULL ? NULL : &s[ slot & ( API_SEG_SIZE - 1 ) ] );
+  }
+  /* current handle of slot, 0 if free, for walking the table */
+  tibrvId slot_id( uint32_t slot ) const {
+    tibrv_Elem * e = this->elem( slot );
+    return ( e == NULL ? 0 : __atomic_load_n( &e->id, __ATOMIC_ACQUIRE ) );
+  }
 
   template<class T>
   T *make( ElemType type,  size_t add = 0,  tibrvId id = 0 ) {
@@ -55,76 +137,100 @@ struct Tibrv_API {
       mem = ::malloc( sizeof( T ) + add );
 
     pthread_mutex_lock( &this->map_mutex );
-    if ( id == 0 ) {
+    uint32_t slot = id;
+    if ( slot == 0 ) {
       if ( this->free_id != 0 ) {
         for (;;) {
-          id = this->free_id++;
-          if ( id >= this->next_id ) {
-            id = this->next_id++;
+          slot = this->free_id++;
+          if ( slot >= this->next_id ) {
+            slot = this->next_id++;
             this->free_id = 0;
             break;
           }
-          if ( this->map[ id ].ptr == NULL )
+          if ( this->slot_id( slot ) == 0 )
             break;
         }
       }
       else {
-        id = this->next_id++;
+        slot = this->next_id++;
       }
     }
-    T *p = new ( mem ) T( *this, id );
-    if ( id >= this->map_size ) {
-      this->map = (tibrv_Elem *)
-        ::realloc( this->map, ( this->map_size + 16 ) * sizeof( tibrv_Elem ) );
-      ::memset( &this->map[ this->map_size ], 0, 16 * sizeof( tibrv_Elem ) );
-      this->map_size += 16;
+    tibrv_Elem *& s = this->seg[ slot >> API_SEG_BITS ];
+    if ( s == NULL ) {
+      tibrv_Elem * x = (tibrv_Elem *)
+        ::calloc( API_SEG_SIZE, sizeof( tibrv_Elem ) );
+      __atomic_store_n( &s, x, __ATOMIC_RELEASE );
     }
-    this->map[ id ].id   = id;
-    this->map[ id ].type = type;
-    this->map[ id ].ptr  = p;
+    tibrv_Elem & e = s[ slot & ( API_SEG_SIZE - 1 ) ];
+    id = slot | ( e.gen << API_GEN_SHIFT );
+    T *p = new ( mem ) T( *this, id );
+    __atomic_thread_fence( __ATOMIC_RELEASE ); /* after a previous rem id=0 */
+    e.type = type;
+    __atomic_store_n( &e.ptr, (void *) p, __ATOMIC_RELAXED );
+    __atomic_store_n( &e.id, id, __ATOMIC_RELEASE );
     pthread_mutex_unlock( &this->map_mutex );
     return p;
   }
 
+  /* Lock free: load id, ptr, type, then check that id did not change; the
+   * object stays valid while an api_EpochGuard is held */
   template<class T>
-  T *get( tibrvId id, ElemType type ) {
-    pthread_mutex_lock( &this->map_mutex );
-    bool b = ( id < this->map_size && id == this->map[ id ].id &&
-               type == this->map[ id ].type );
-    T  * p = (T *) ( b ? this->map[ id ].ptr : NULL );
-    pthread_mutex_unlock( &this->map_mutex );
+  T *get( tibrvId id, ElemType type ) const {
+    tibrv_Elem * e = this->elem( id );
+    if ( e == NULL || id == 0 ||
+         __atomic_load_n( &e->id, __ATOMIC_ACQUIRE ) != id )
+      return NULL;
+    ElemType t = e->type;
+    T      * p = (T *) __atomic_load_n( &e->ptr, __ATOMIC_RELAXED );
+    __atomic_thread_fence( __ATOMIC_ACQUIRE );
+    if ( __atomic_load_n( &e->id, __ATOMIC_RELAXED ) != id || t != type )
+      return NULL;
     return p;
   }
 
+  /* Unmap id, the caller retires the object instead of deleting it */
   template<class T>
   T *rem( tibrvId id, ElemType type ) {
-    pthread_mutex_lock( &this->map_mutex );
-    bool b = ( id < this->map_size && id == this->map[ id ].id &&
-               type == this->map[ id ].type );
+    tibrv_Elem * e = this->elem( id );
+    uint32_t slot = id & API_SLOT_MASK;
     T  * p = NULL;
-    if ( b ) {
-      p = (T *) this->map[ id ].ptr;
-      this->map[ id ].ptr = NULL;
+    pthread_mutex_lock( &this->map_mutex );
+    if ( e != NULL && id != 0 && e->id == id && e->type == type ) {
+      p = (T *) e->ptr;
+      __atomic_store_n( &e->id, 0, __ATOMIC_RELEASE );
+      __atomic_store_n( &e->ptr, (void *) NULL, __ATOMIC_RELAXED );
+      e->gen = ( e->gen + 1 ) & API_GEN_MAX;
     }
-    if ( this->free_id == 0 || id < this->free_id )
-      this->free_id = id;
+    if ( this->free_id == 0 || slot < this->free_id )
+      this->free_id = slot;
     pthread_mutex_unlock( &this->map_mutex );
     return p;
   }
 
+  template<class T>
+  static void free_obj( void *p ) { delete (T *) p; }
+  template<class T>
+  void retire( T *p ) { this->retire_ptr( p, free_obj<T> ); }
+  void retire_ptr( void *p,  void (*fn)( void * ) ) noexcept;
+  api_Retired *reclaim( void ) noexcept;
+  api_EpochRec & epoch_rec( void ) noexcept;
+
   void set_string( char *&str,  const char *value ) {
     if ( str != NULL ) { ::free( str ); str = NULL; }
     if ( value != NULL ) { str = ::strdup( value ); }
   }
 
   tibrv_status Open( void ) noexcept;
+  void Close( void ) noexcept;
   tibrv_status CreateListener( tibrvEvent * event,  tibrvQueue queue, tibrvTransport tport,  tibrvEventCallback cb, tibrvEventVectorCallback vcb,  const char * subj, const void * closure ) noexcept;
   tibrv_status CreateTimer( tibrvEvent * event,  tibrvQueue queue, tibrvEventCallback cb,  tibrv_f64 ival, const void * closure ) noexcept;
+  void wake_timers( void ) noexcept;
   tibrv_status DestroyEvent( tibrvEvent event, tibrvEventOnComplete cb ) noexcept;
   tibrv_status GetEventType( tibrvEvent event,  tibrvEventType * type ) noexcept;
   tibrv_status GetEventQueue( tibrvEvent event,  tibrvQueue * queue ) noexcept;
   tibrv_status GetListenerSubject( tibrvEvent event,  const char ** subject ) noexcept;
   tibrv_status GetListenerTransport( tibrvEvent event,  tibrvTransport * tport ) noexcept;
+  tibrv_status SetListenerFilter( tibrvEvent event,  const char * expr ) noexcept;
   tibrv_status GetTimerInterval( tibrvEvent event,  tibrv_f64 * ival ) noexcept;
   tibrv_status ResetTimerInterval( tibrvEvent event,  tibrv_f64 ival ) noexcept;
   tibrv_status CreateQueue( tibrvQueue * q ) noexcept;
@@ -140,6 +246,12 @@ struct Tibrv_API {
   tibrv_status GetQueueName( tibrvQueue q, const char ** name ) noexcept;
   tibrv_status SetQueueHook( tibrvQueue q, tibrvQueueHook hook, void * closure ) noexcept;
   tibrv_status GetQueueHook( tibrvQueue q, tibrvQueueHook * hook ) noexcept;
+  tibrv_status SetQueueInline( tibrvQueue q, tibrv_bool on ) noexcept;
+  tibrv_status GetQueueInline( tibrvQueue q, tibrv_bool * on ) noexcept;
+  tibrv_status SetQueueSpin( tibrvQueue q, tibrv_u32 spin_us ) noexcept;
+  tibrv_status GetQueueSpin( tibrvQueue q, tibrv_u32 * spin_us ) noexcept;
+  tibrv_status GetQueueStats( tibrvQueue q, tibrvQueueStats * stats ) noexcept;
+  tibrv_status SetQueueGroupSpin( tibrvQueueGroup grp, tibrv_u32 spin_us ) noexcept;
   tibrv_status CreateQueueGroup( tibrvQueueGroup * grp ) noexcept;
   tibrv_status TimedDispatchGroup( tibrvQueueGroup grp, tibrv_f64 timeout ) noexcept;
   tibrv_status DestroyQueueGroup( tibrvQueueGroup grp ) noexcept;
@@ -154,9 +266,22 @@ struct Tibrv_API {
   void drain_send_buf( api_Transport * t ) noexcept; /* inline publish on E */
   void free_send_buf( api_Transport * t ) noexcept;
   void free_transport_writers( api_Transport * t ) noexcept;
+  api_SendRing * get_send_ring( api_Transport * t ) noexcept;
+  bool ring_send( api_Transport * t, const char * subj, size_t subj_len,
+                  const char * reply, size_t reply_len, const void * data,
+                  size_t datalen ) noexcept;
+  void free_send_rings( api_Transport * t ) noexcept;
   tibrv_status SendRequest( tibrvTransport tport, tibrvMsg msg, tibrvMsg * reply, tibrv_f64 idle_timeout ) noexcept;
+  tibrv_status SendRequestAsync( tibrvTransport tport, tibrvMsg msg, tibrvEventCallback cb, tibrvQueue q, tibrv_f64 idle_timeout, const void * closure ) noexcept;
+  void free_rpc_wheel( api_Transport * t ) noexcept;
   tibrv_status SendReply( tibrvTransport tport, tibrvMsg msg, tibrvMsg request_msg ) noexcept;
   tibrv_status DestroyTransport( tibrvTransport tport ) noexcept;
+  api_Transport * find_conn( api_Transport * t ) noexcept;
+  tibrv_status connect_tport( api_Transport * t,  EvRvClientParameters &parm ) noexcept;
+  tibrv_status open_aux( api_Transport * t,  api_Transport *& c,
+                         uint32_t k = 0 ) noexcept;
+  void close_aux( api_Transport * c ) noexcept;
+  void drop_subs( api_Transport * t ) noexcept;
   tibrv_status CreateInbox( tibrvTransport tport, char * inbox_str, tibrv_u32 inbox_len ) noexcept;
   tibrv_status GetService( tibrvTransport tport, const char ** service_string ) noexcept;
   tibrv_status GetNetwork( tibrvTransport tport, const char ** network_string ) noexcept;
@@ -168,8 +293,14 @@ struct Tibrv_API {
   tibrv_status SetBatchMode( tibrvTransport tport, tibrvTransportBatchMode mode ) noexcept;
   tibrv_status SetBatchSize( tibrvTransport tport, tibrv_u32 num_bytes ) noexcept;
   tibrv_status SetBatchInterval( tibrvTransport tport, tibrv_f64 secs ) noexcept;
+  tibrv_status GetTransportStats( tibrvTransport tport, tibrvTransportStats * stats ) noexcept;
+  tibrv_status SetReconnect( tibrvTransport tport, tibrv_f64 min_ival, tibrv_f64 max_ival, tibrv_u32 buffer_bytes ) noexcept;
+  tibrv_status SetAlternateDaemons( tibrvTransport tport, const char ** daemons, tibrv_u32 count ) noexcept;
+  tibrv_status SetReceiveLanes( tibrvTransport tport, tibrv_u32 count ) noexcept;
   tibrv_status RequestReliability( tibrvTransport tport, tibrv_f64 reliability ) noexcept;
   tibrv_status CreateDispatcher( tibrvDispatcher * disp, tibrvDispatchable able, tibrv_f64 idle_timeout ) noexcept;
+  tibrv_status CreateDispatchPool( tibrvDispatcher * disp, tibrvDispatchable able, tibrv_f64 idle_timeout, tibrv_u32 num_threads, tibrvDispatchPartition part ) noexcept;
+  tibrv_status TimedDispatchPool( api_Dispatcher & disp, tibrv_f64 timeout ) noexcept;
   tibrv_status JoinDispatcher( tibrvDispatcher disp ) noexcept;
   tibrv_status SetDispatcherName( tibrvDispatcher disp, const char * name ) noexcept;
   tibrv_status GetDispatcherName( tibrvDispatcher disp, const char ** name ) noexcept;
@@ -181,6 +312,7 @@ struct Tibrv_API {
   tibrv_status GetFtMemberGroupName( tibrvftMember memb, const char ** name ) noexcept;
   tibrv_status GetFtMemberWeight( tibrvftMember memb, tibrv_u16 * weight ) noexcept;
   tibrv_status SetFtMemberWeight( tibrvftMember memb, tibrv_u16 weight ) noexcept;
+  tibrv_status SetFtMemberFastMode( tibrvftMember memb, tibrv_f64 hb_ival, tibrv_u32 miss_count, tibrv_u32 recover_count ) noexcept;
   tibrv_status CreateFtMonitor( tibrvftMonitor * m, tibrvQueue q, tibrvftMonitorCallback cb, tibrvTransport tport, const char * name, tibrv_f64 lost_ival, const void * closure ) noexcept;
   tibrv_status DestroyFtMonitor( tibrvftMonitor m ) noexcept;
   tibrv_status DestroyExFtMonitor( tibrvftMonitor m, tibrvftMonitorOnComplete cb ) noexcept;
@@ -189,6 +321,23 @@ struct Tibrv_API {
   tibrv_status GetFtMonitorGroupName( tibrvftMonitor m, const char ** name ) noexcept;
 };
 
+/* Pins objects found with get<> against retire() for the guard's scope */
+struct api_EpochGuard {
+  api_EpochRec & rec;
+  api_EpochGuard( Tibrv_API &api ) : rec( api.epoch_rec() ) {
+    if ( this->rec.depth++ == 0 ) {
+      __atomic_store_n( &this->rec.active,
+                        __atomic_load_n( &api.epoch, __ATOMIC_ACQUIRE ),
+                        __ATOMIC_RELAXED );
+      __atomic_thread_fence( __ATOMIC_SEQ_CST );
+    }
+  }
+  ~api_EpochGuard() {
+    if ( --this->rec.depth == 0 )
+      __atomic_store_n( &this->rec.active, 0, __ATOMIC_RELEASE );
+  }
+};
+
 struct api_Msg;
 struct TibrvQueueEvent {
   Tibrv_API              & api;
@@ -199,19 +348,46 @@ struct TibrvQueueEvent {
   const void             * cl;
   tibrvEvent               id;
   tibrv_u32                cnt;
+  uint64_t                 stamp; /* enqueue time, ns */
 
   void * operator new( size_t, void *ptr ) { return ptr; }
   TibrvQueueEvent( Tibrv_API &a,  tibrvId i,  tibrvEventCallback e,
                    tibrvEventVectorCallback v, const void *c,  api_Msg *m )
     : api( a ), next( 0 ), back( 0 ), msg( m ), vec( 0 ), cb( e ), vcb( v ),
-      cl( c ), id( i ), cnt( 1 ) {}
+      cl( c ), id( i ), cnt( 1 ), stamp( 0 ) {}
   void dispatch( void ) noexcept;
-  void release( api_Msg *m ) noexcept;
-  void release( api_Msg **vec,  tibrv_u32 count ) noexcept;
+  static void release( api_Msg *m ) noexcept;
+  static void release( api_Msg **vec,  tibrv_u32 count ) noexcept;
 };
 
 typedef DLinkList< TibrvQueueEvent > TibrvQueueEventList;
 
+/* Log2 bucket of a stats histogram */
+static inline uint32_t api_hist_bucket( uint64_t v ) {
+  uint32_t i = ( v == 0 ? 0 : 64 - __builtin_clzll( v ) );
+  return ( i < TIBRV_STATS_HIST_SIZE ? i : TIBRV_STATS_HIST_SIZE - 1 );
+}
+
+/* Dispatch side stats of one batch, a dispatcher folds them into the queue
+ * once per batch instead of per event */
+struct api_DispatchStats {
+  uint64_t msgs, events, delay, delay_max,
+           hist[ TIBRV_STATS_HIST_SIZE ];
+  api_DispatchStats() : msgs( 0 ), events( 0 ), delay( 0 ), delay_max( 0 ) {
+    ::memset( this->hist, 0, sizeof( this->hist ) );
+  }
+  void add( const TibrvQueueEvent &e,  uint64_t now ) {
+    uint64_t d = ( now > e.stamp ? now - e.stamp : 0 );
+    this->msgs  += e.cnt;
+    this->events++;
+    this->delay += d;
+    if ( d > this->delay_max )
+      this->delay_max = d;
+    this->hist[ api_hist_bucket( d / 1000 ) ]++;
+  }
+  void fold( tibrvQueueStats &st ) const noexcept;
+};
+
 struct MsgTether : public DLinkList< api_Msg > {
   pthread_mutex_t mutex;
   uint64_t serial;
@@ -220,6 +396,35 @@ struct MsgTether : public DLinkList< api_Msg > {
   }
 };
 
+/* The waiting msg of each listener and subject in a conflating queue, open
+ * addressed by the subject hash, emptied when the dispatcher takes the list */
+struct api_ConflateEntry {
+  TibrvQueueEvent * e;    /* NULL when empty */
+  uint32_t          hash,
+                    idx;  /* msg is e->vec[ idx ] when e->cnt > 1 */
+  api_Msg *& msg( void ) const {
+    return this->e->cnt == 1 ? this->e->msg : this->e->vec[ this->idx ];
+  }
+};
+
+struct api_ConflateIndex {
+  api_ConflateEntry * tab;
+  uint32_t            mask,
+                      count;
+  api_ConflateIndex() : tab( 0 ), mask( 0 ), count( 0 ) {}
+  ~api_ConflateIndex() { if ( this->tab != NULL ) ::free( this->tab ); }
+  api_ConflateEntry * find( uint32_t h,  const api_Msg *m ) noexcept;
+  void insert( uint32_t h,  TibrvQueueEvent *e,  uint32_t idx ) noexcept;
+  void remove( uint32_t h,  const api_Msg *m ) noexcept;
+  void resize( void ) noexcept;
+  void clear( void ) {
+    if ( this->count != 0 ) {
+      ::memset( this->tab, 0, sizeof( this->tab[ 0 ] ) * ( this->mask + 1 ) );
+      this->count = 0;
+    }
+  }
+};
+
 struct api_QueueGroup;
 struct api_Queue {
   Tibrv_API           & api;
@@ -232,30 +437,43 @@ struct api_Queue {
   char                * name;
   tibrvQueueLimitPolicy policy;
   tibrv_u32             max_ev,
-                        discard;
+                        discard,
+                        spin_us,  /* poll count this long before cond wait */
+                        spinning; /* consumers polling, push skips the wake */
   pthread_mutex_t       mutex;
   pthread_cond_t        cond;
   TibrvQueueEventList   list;
   MsgTether             tether;
   MDMsgMem              mem_x[ 2 ];
   uint8_t               mptr;
-  bool                  done;
+  bool                  done,
+                        inline_dispatch; /* callbacks run on E, not queued */
   tibrvQueueOnComplete  cb;
   const void          * cl;
   api_QueueGroup      * grp;
+  tibrvQueueStats       stats; /* push side under mutex, dispatch side atomic */
+  api_ConflateIndex     cidx;  /* TIBRVQUEUE_CONFLATE_BY_SUBJECT */
 
   void * operator new( size_t, void *ptr ) { return ptr; }
   void operator delete( void *ptr ) { ::free( ptr ); }
   api_Queue( Tibrv_API &a,  tibrvId i ) : api( a ), next( 0 ), back( 0 ),
       id( i ), priority( 0 ), count( 0 ), hook( 0 ), hook_cl( 0 ), name( 0 ),
-      policy( TIBRVQUEUE_DISCARD_NONE ), max_ev( 0 ), discard( 0 ), mptr( 0 ),
-      done( false ), cb( 0 ), cl( 0 ), grp( 0 ) {
+      policy( TIBRVQUEUE_DISCARD_NONE ), max_ev( 0 ), discard( 0 ),
+      spin_us( 0 ), spinning( 0 ), mptr( 0 ), done( false ),
+      inline_dispatch( false ), cb( 0 ), cl( 0 ), grp( 0 ) {
     pthread_mutex_init( &this->mutex, NULL );
     pthread_cond_init( &this->cond, NULL );
+    ::memset( &this->stats, 0, sizeof( this->stats ) );
   }
   bool push( tibrvId id,  tibrvEventCallback cb,  tibrvEventVectorCallback vcb,
              const void *cl,  api_Msg *msg ) noexcept;
+  bool conflate( uint32_t h,  api_Msg *msg ) noexcept;
+  void take_list( TibrvQueueEventList &list ) noexcept;
+  TibrvQueueEvent * take_one( void ) noexcept;
+  void dispatch_list( TibrvQueueEventList &list ) noexcept;
+  void count_inline( uint32_t cnt ) noexcept;
   tibrv_status finish_queue( void ) noexcept;
+  void spin_wait( tibrv_f64 timeout ) noexcept;
 };
 
 typedef DLinkList< api_Queue > TibrvQueueList;
@@ -266,46 +484,150 @@ struct api_QueueGroup {
   tibrvQueueGroup id;
   pthread_mutex_t mutex;
   pthread_cond_t  cond;
-  tibrv_u32       count;
+  tibrv_u32       count,
+                  spin_us,
+                  spinning;
   bool            update,
                   done;
   void * operator new( size_t, void *ptr ) { return ptr; }
   void operator delete( void *ptr ) { ::free( ptr ); }
   api_QueueGroup( Tibrv_API &a, tibrvId i ) : api( a ), id( i ), count( 0 ),
-      update( false ), done( false ) {
+      spin_us( 0 ), spinning( 0 ), update( false ), done( false ) {
     pthread_mutex_init( &this->mutex, NULL );
     pthread_cond_init( &this->cond, NULL );
   }
 };
 
+/* A slice of a pool dispatcher batch: the events that hash to it, dispatched
+ * in order by the first worker that claims it */
+struct api_DispatchPart {
+  TibrvQueueEventList list;
+  uint32_t            claimed;
+};
+
+/* Worker pool for one queue.  The dispatcher thread is the leader: it swaps
+ * the queue list out as TimedDispatchQueue() does, partitions the batch by
+ * subject hash or listener id, and wakes the workers.  Each worker runs its
+ * own partitions first, then steals unclaimed ones from the others.  The
+ * leader waits for the batch to finish before taking the next one, which
+ * keeps the order within a partition across batches and keeps the events
+ * valid until the queue recycles their memory. */
+struct api_DispatchPool {
+  api_Dispatcher       & disp;
+  api_Queue            * queue;      /* of the current batch */
+  api_DispatchPart     * part;
+  pthread_t            * thr;
+  uint32_t               nthreads,
+                         nparts,
+                         running;    /* workers still in the current batch */
+  uint64_t               gen;        /* batch generation, bumped by leader */
+  tibrvDispatchPartition mode;
+  bool                   quit;
+  pthread_mutex_t        mutex;
+  pthread_cond_t         start_cond,
+                         done_cond;
+
+  void * operator new( size_t, void *ptr ) { return ptr; }
+  void operator delete( void *ptr ) { ::free( ptr ); }
+  api_DispatchPool( api_Dispatcher &d,  uint32_t n,
+                    tibrvDispatchPartition m ) : disp( d ), queue( 0 ), part( 0 ),
+      thr( 0 ), nthreads( n ), nparts( n * 8 ), running( 0 ), gen( 0 ),
+      mode( m ), quit( false ) {
+    pthread_mutex_init( &this->mutex, NULL );
+    pthread_cond_init( &this->start_cond, NULL );
+    pthread_cond_init( &this->done_cond, NULL );
+  }
+  uint32_t key( TibrvQueueEvent *e ) const noexcept;
+  void run_batch( uint32_t w ) noexcept;
+  void run_part( uint32_t p ) noexcept;
+};
+
 struct api_Dispatcher {
-  Tibrv_API     & api;
-  tibrvDispatcher id;
-  tibrvQueue      queue;
-  tibrv_f64       idle_timeout;
-  char          * name;
-  bool            quit,
-                  done,
-                  is_queue,
-                  is_queue_group;
-  pthread_mutex_t mutex;
-  pthread_cond_t  cond;
-  pthread_t       thr_id;
+  Tibrv_API        & api;
+  tibrvDispatcher    id;
+  tibrvQueue         queue;
+  tibrv_f64          idle_timeout;
+  char             * name;
+  bool               quit,
+                     done,
+                     is_queue,
+                     is_queue_group;
+  pthread_mutex_t    mutex;
+  pthread_cond_t     cond;
+  pthread_t          thr_id;
+  api_DispatchPool * pool;
 
   void * operator new( size_t, void *ptr ) { return ptr; }
   void operator delete( void *ptr ) { ::free( ptr ); }
   api_Dispatcher( Tibrv_API &a,  tibrvId i ) : api( a ), id( i ),
       queue( 0 ), idle_timeout( 0 ), name( 0 ),
       quit( false ), done( false ), is_queue( false ), is_queue_group( false ),
-      thr_id( 0 ) {
+      thr_id( 0 ), pool( 0 ) {
     pthread_mutex_init( &this->mutex, NULL );
     pthread_cond_init( &this->cond, NULL );
   }
 };
 
+/* Listener content filter, compiled from an expression like
+ * MKT_ST == 1 && REC_TYPE in { 2, 5 } || SYM == "IBM" into terms that
+ * run in order, a term that is false jumps to the next || group */
+enum {
+  FOP_CMP_INT = 0, /* field cmp arg.i */
+  FOP_CMP_F64 = 1, /* field cmp arg.f */
+  FOP_CMP_STR = 2, /* field cmp the string at pool[ arg.off ], cnt bytes */
+  FOP_IN_INT  = 3, /* field in cnt sorted int64 at pool[ arg.off ] */
+  FOP_IN_STR  = 4, /* field in cnt sorted api_FilterStr at pool[ arg.off ] */
+  FOP_ACCEPT  = 5  /* end of an || group, all terms were true */
+};
+enum {
+  FCMP_EQ = 0, FCMP_NE, FCMP_LT, FCMP_LE, FCMP_GT, FCMP_GE
+};
+struct api_FilterOp {
+  uint8_t  op,   /* FOP_xxx */
+           cmp;  /* FCMP_xxx */
+  uint16_t fld,  /* field slot */
+           fail; /* next pc when false, past the end rejects */
+  uint32_t cnt;
+  union {
+    int64_t  i;
+    double   f;
+    uint32_t off;
+  } arg;
+};
+struct api_FilterStr {
+  uint32_t off, len;
+};
+struct api_FilterField {
+  uint32_t off;  /* name at pool[ off ] */
+  uint16_t len;  /* without the nul */
+  uint8_t  c0;   /* first char, checked before the compare */
+};
+
+struct api_Filter {
+  api_FilterOp    * op;
+  api_FilterField * fld;
+  uint8_t         * pool;
+  uint16_t          nops,
+                    nfld;
+  uint32_t          pool_len;
+
+  void * operator new( size_t, void *ptr ) { return ptr; }
+  void operator delete( void *ptr ) { ::free( ptr ); }
+  api_Filter() : op( 0 ), fld( 0 ), pool( 0 ), nops( 0 ), nfld( 0 ),
+                 pool_len( 0 ) {}
+  ~api_Filter() {
+    ::free( this->op );
+    ::free( this->fld );
+    ::free( this->pool );
+  }
+  static tibrv_status compile( const char *expr,  api_Filter *&f ) noexcept;
+  bool match( RvMsg &msg ) const noexcept;
+};
+
 struct api_Listener {
   Tibrv_API              & api;
   api_Listener           * next, * back;
+  api_Listener           * rem_next; /* api_Transport::rem_pend link */
   char                   * subject;
   const void             * cl;
   uint16_t                 len, wild;
@@ -315,12 +637,18 @@ struct api_Listener {
   tibrvEvent               id;
   tibrvQueue               queue;
   tibrvTransport           tport;
+  api_Filter             * filter; /* tested under the transport mutex */
+  uint32_t                 sub_gen; /* holds a api_SubRef of conn sub_gen */
   
   void * operator new( size_t, void *ptr ) { return ptr; }
   void operator delete( void *ptr ) { ::free( ptr ); }
   api_Listener( Tibrv_API &a,  tibrvId i ) : api( a ), next( 0 ), back( 0 ),
-    subject( 0 ), cl( 0 ), len( 0 ), wild( 0 ), hash( 0 ), cb( 0 ), vcb( 0 ),
-    id( i ), queue( 0 ), tport( 0 ) {}
+    rem_next( 0 ), subject( 0 ), cl( 0 ), len( 0 ), wild( 0 ), hash( 0 ), cb( 0 ), vcb( 0 ),
+    id( i ), queue( 0 ), tport( 0 ), filter( 0 ), sub_gen( 0 ) {}
+  ~api_Listener() {
+    if ( this->filter != NULL )
+      delete this->filter;
+  }
 };                
 
 typedef DLinkList< api_Listener > TibrvListenerList;
@@ -373,54 +701,298 @@ struct api_Listener_ht {
 };
 
 struct api_Msg;
+struct api_MsgData;
 struct api_Rpc {
-  api_Rpc    * next,
-             * back;
-  const char * subject;
-  uint32_t     hash;
-  uint16_t     len;
-  api_Msg    * reply;
+  api_Rpc          * next,
+                   * back,
+                   * wnext,       /* api_RpcWheel slot links */
+                   * wback;
+  const char       * subject;
+  uint32_t           hash;
+  uint16_t           len;
+  api_Msg          * reply;
+  tibrvEventCallback cb;          /* async: reply or timeout pushed to queue */
+  const void       * cl;
+  tibrvQueue         queue;
+  uint64_t           expire_tick; /* async: wheel tick to expire, 0 = never */
   
+  void * operator new( size_t, void *ptr ) { return ptr; }
+  void operator delete( void *ptr ) { ::free( ptr ); }
   api_Rpc( const char *s,  uint16_t l,  uint32_t h ) : next( 0 ), back( 0 ),
-    subject( s ), hash( h ), len( l ), reply( 0 ) {}
+    wnext( 0 ), wback( 0 ), subject( s ), hash( h ), len( l ), reply( 0 ),
+    cb( 0 ), cl( 0 ), queue( 0 ), expire_tick( 0 ) {}
 };                
 
 typedef DLinkList< api_Rpc > TibrvRpcList;
 
+/* Outstanding requests keyed by the reply inbox hash, guarded by the
+ * transport mutex */
+struct api_Rpc_ht {
+  TibrvRpcList * ht;
+  size_t         mask,
+                 count;
+  api_Rpc_ht( void ) : ht( 0 ), mask( 0 ), count( 0 ) {}
+  void init( size_t sz ) {
+    this->mask  = sz - 1;
+    this->count = 0;
+    sz *= sizeof( this->ht[ 0 ] );
+    this->ht = (TibrvRpcList *) ::malloc( sz );
+    ::memset( (void *) this->ht, 0, sz );
+  }
+  void resize( void ) {
+    size_t sz  = this->mask + 1,
+           nsz = sz * 2;
+    TibrvRpcList * oht = this->ht;
+    this->init( oht == NULL ? 16 : nsz );
+    if ( oht != NULL ) {
+      for ( size_t i = 0; i < sz; i++ ) {
+        while ( ! oht[ i ].is_empty() ) {
+          api_Rpc * r = oht[ i ].pop_hd();
+          this->push( r );
+        }
+      }
+      ::free( oht );
+    }
+  }
+  void push( api_Rpc *r ) {
+    if ( this->count >= this->mask )
+      this->resize();
+    size_t i = r->hash & this->mask;
+    this->ht[ i ].push_hd( r );
+    this->count++;
+  }
+  void remove( api_Rpc *r ) {
+    size_t i = r->hash & this->mask;
+    this->ht[ i ].pop( r );
+    this->count--;
+  }
+  api_Rpc *find( const char *sub,  size_t len,  uint32_t h ) {
+    if ( this->count == 0 )
+      return NULL;
+    for ( api_Rpc *r = this->ht[ h & this->mask ].hd; r != NULL; r = r->next ) {
+      if ( r->hash == h && r->len == len &&
+           ::memcmp( r->subject, sub, len ) == 0 )
+        return r;
+    }
+    return NULL;
+  }
+};
+
 /* Per-thread, per-transport send accumulator for TIMER_BATCH mode.  The owning
  * thread appends marshaled copies of each Send() here; the batch is shipped in
  * one EvPipe round-trip (amortizing the synchronous send hand-off).  Each ctx
  * is cached in thread-local storage for the owner's fast path AND linked into
  * its transport's writers registry, so a foreign flusher (batch timer, explicit
  * Flush, teardown) can reach it even though TLS is private to the owner. */
-struct SendCtx {
+struct SendCtx : public SendBatch {
   SendCtx       * next, * back;   /* api_Transport::writers registry links */
   SendCtx       * tls_next;       /* this thread's chain of ctxs */
   api_Transport * t;              /* owning transport */
   uint64_t        gen;            /* bumped on recycle (future leak-bound) */
   pthread_mutex_t lock;           /* guards append vs foreign flush */
-  EvPublish     * pubs;           /* contiguous batch (high-water, realloc) */
-  uint32_t        cnt, cap, bytes;/* entries used / allocated / pending bytes */
-  MDMsgMem        byte_mem;       /* stable copies of subject/reply/data */
 
   void * operator new( size_t, void *ptr ) { return ptr; }
   SendCtx( api_Transport * tp ) : next( 0 ), back( 0 ), tls_next( 0 ), t( tp ),
-    gen( 0 ), pubs( 0 ), cnt( 0 ), cap( 0 ), bytes( 0 ) {
+    gen( 0 ) {
     pthread_mutex_init( &this->lock, NULL );
   }
 };
 typedef DLinkList< SendCtx > SendCtxList;
 
-struct api_BatchTimer;
+/* ASYNC_BATCH mode: one ring per (sending thread, transport), with the thread
+ * as the only producer and the transport's I/O thread as the only consumer.
+ * Records are an api_RingRec followed by subject, reply and msg data. */
+static const uint64_t API_SEND_RING_SIZE = 256 * 1024;
+/* api_SendRing::state, the I/O thread moves a ring from LIVE to FREE when the
+ * transport is destroyed, DETACH while a drain is walking the rings */
+static const uint32_t RING_LIVE   = 0,
+                      RING_DETACH = 1,
+                      RING_FREE   = 2;
+
+struct api_RingRec {
+  uint32_t size;          /* whole record, 8 aligned, 0 = wrap to start */
+  uint16_t subject_len,   /* subject and reply are followed by a nul */
+           reply_len;
+  uint32_t data_len,
+           pad;
+
+  void set( uint32_t sz,  const char *subj,  size_t subj_len,
+            const char *reply,  size_t reply_len,  const void *data,
+            size_t datalen ) noexcept;
+  void publish( api_Transport &tp ) noexcept;
+};
+
+struct api_SendRing {
+  api_SendRing  * next,           /* EvPipe::rings, drained by the I/O thread */
+                * tls_next;       /* the sending thread's chain of rings */
+  api_Transport * t;              /* set by the owner while unlinked */
+  EvPipe        * pipe;
+  tibrvTransport  tport;
+  uint8_t       * buf;            /* owner frees or reuses after RING_FREE */
+  uint32_t        state;          /* RING_LIVE, RING_DETACH, RING_FREE */
+  uint64_t        pad1[ 8 ];      /* keep head and tail on separate lines */
+  uint64_t        head;           /* bytes written by the sending thread */
+  uint64_t        pad2[ 7 ];
+  uint64_t        tail;           /* bytes published by the I/O thread */
+
+  void * operator new( size_t, void *ptr ) { return ptr; }
+  api_SendRing() : next( 0 ), tls_next( 0 ), t( 0 ), pipe( 0 ), tport( 0 ),
+                   buf( 0 ), state( 0 ), head( 0 ), tail( 0 ) {}
+  void drain( void ) noexcept;
+};
+
+struct api_RpcWheel;
+
+/* Daemon interest of a connection by subject, shared by the listeners of
+ * every transport on it: the listen goes out with the first ref and the
+ * cancel with the last.  Only used on the connection's pipe thread */
+struct api_SubRef {
+  api_SubRef * next,
+             * back;
+  uint32_t     hash,
+               refs;
+  uint16_t     len;
+  char         subject[ 2 ];
+
+  void * operator new( size_t, void *ptr ) { return ptr; }
+  void operator delete( void *ptr ) { ::free( ptr ); }
+  api_SubRef( const char *s,  uint16_t l,  uint32_t h ) : next( 0 ),
+      back( 0 ), hash( h ), refs( 0 ), len( l ) {
+    ::memcpy( this->subject, s, l );
+    this->subject[ l ] = '\0';
+  }
+};
+
+typedef DLinkList< api_SubRef > TibrvSubRefList;
+
+struct api_SubRef_ht {
+  TibrvSubRefList * ht;
+  size_t            mask,
+                    count;
+  api_SubRef_ht( void ) : ht( 0 ), mask( 0 ), count( 0 ) {}
+  void init( size_t sz ) {
+    this->mask  = sz - 1;
+    this->count = 0;
+    sz *= sizeof( this->ht[ 0 ] );
+    this->ht = (TibrvSubRefList *) ::malloc( sz );
+    ::memset( (void *) this->ht, 0, sz );
+  }
+  void resize( void ) {
+    size_t sz  = this->mask + 1,
+           nsz = sz * 2;
+    TibrvSubRefList * oht = this->ht;
+    this->init( oht == NULL ? 16 : nsz );
+    if ( oht != NULL ) {
+      for ( size_t i = 0; i < sz; i++ ) {
+        while ( ! oht[ i ].is_empty() ) {
+          api_SubRef * r = oht[ i ].pop_hd();
+          this->ht[ r->hash & this->mask ].push_hd( r );
+          this->count++;
+        }
+      }
+      ::free( oht );
+    }
+  }
+  api_SubRef *find( const char *sub,  size_t len,  uint32_t h ) {
+    if ( this->count == 0 )
+      return NULL;
+    for ( api_SubRef *r = this->ht[ h & this->mask ].hd; r != NULL;
+          r = r->next ) {
+      if ( r->hash == h && r->len == len &&
+           ::memcmp( r->subject, sub, len ) == 0 )
+        return r;
+    }
+    return NULL;
+  }
+  /* true when sub had no refs, the listen is needed */
+  bool ref( const char *sub,  uint16_t len ) {
+    uint32_t     h = kv_crc_c( sub, len, 0 );
+    api_SubRef * r = this->find( sub, len, h );
+    if ( r == NULL ) {
+      if ( this->count >= this->mask )
+        this->resize();
+      r = new ( ::malloc( sizeof( api_SubRef ) + len ) )
+        api_SubRef( sub, len, h );
+      this->ht[ h & this->mask ].push_hd( r );
+      this->count++;
+    }
+    return r->refs++ == 0;
+  }
+  /* true when the last ref of sub is gone, the cancel is needed */
+  bool deref( const char *sub,  uint16_t len ) {
+    uint32_t     h = kv_crc_c( sub, len, 0 );
+    api_SubRef * r = this->find( sub, len, h );
+    if ( r == NULL || --r->refs != 0 )
+      return false;
+    this->ht[ h & this->mask ].pop( r );
+    this->count--;
+    delete r;
+    return true;
+  }
+  /* the connection was reset, the daemon has no interest now */
+  void clear( void ) {
+    for ( size_t i = 0; this->count > 0 && i <= this->mask; i++ ) {
+      while ( ! this->ht[ i ].is_empty() ) {
+        delete this->ht[ i ].pop_hd();
+        this->count--;
+      }
+    }
+  }
+};
+
+/* Reconnect state machine of a connection, runs on its I/O thread.  A
+ * disconnect arms the timer with the backoff delay, expiry connects to the
+ * next daemon and arms the connect timeout, on_connect() replays the
+ * listeners and then the publishes buffered while down */
+static const tibrv_f64 RECONNECT_MIN_IVAL   = 1.0,
+                       RECONNECT_MAX_IVAL   = 30.0,
+                       RECONNECT_TIMEOUT    = 10.0;
+static const uint32_t  RECONNECT_BUF_DEFAULT = 1024 * 1024;
+
+struct api_Reconnect : public EvTimerCallback {
+  enum State { IDLE, WAIT, CONNECTING };
+  api_Transport * t;
+  char         ** daemons;    /* alternates, tried in order after x.daemon */
+  uint32_t        ndaemons,
+                  attempt,    /* failed attempts since the disconnect */
+                  buf_limit;  /* bytes of publishes kept while down */
+  uint64_t        timer_gen,  /* event_id of the armed timer, others stale */
+                  rand_state;
+  tibrv_f64       min_ival,
+                  max_ival;
+  uint8_t       * buf;        /* api_SavedPub records */
+  size_t          buf_len,
+                  buf_size;
+  State           state;
+
+  api_Reconnect( api_Transport * tp ) : t( tp ), daemons( 0 ), ndaemons( 0 ),
+    attempt( 0 ), buf_limit( RECONNECT_BUF_DEFAULT ), timer_gen( 0 ),
+    rand_state( 0 ), min_ival( RECONNECT_MIN_IVAL ),
+    max_ival( RECONNECT_MAX_IVAL ), buf( 0 ), buf_len( 0 ), buf_size( 0 ),
+    state( IDLE ) {}
+  void schedule( void ) noexcept;
+  bool connect( void ) noexcept;
+  bool save( EvPublish &pub ) noexcept;
+  void flush( void ) noexcept;
+  void reset( void ) noexcept;
+  virtual bool timer_cb( uint64_t timer_id,  uint64_t event_id ) noexcept;
+  virtual ~api_Reconnect() {}
+};
 
 struct api_Transport : public EvConnectionNotify, public RvClientCB,
                        public kv::EvSocket {
   Tibrv_API     & api;
-  EvRvClient      client;
+  EvRvClient      client;          /* connected when conn == this */
+  api_Transport * conn,            /* transport that owns the connection */
+                * share_next,      /* list of conn's other transports */
+                * lane_of,         /* on an aux conn: the transport it serves */
+               ** lanes;           /* receive conns, [ 0 ] is this */
   const PeerId  * me;
   api_Listener_ht ht;
-  TibrvRpcList    rpc_list;
+  api_Rpc_ht      rpc_ht;
   UIntHashTab   * wild_ht;
+  api_Listener  * add_pend,        /* created while ht is walked, on next */
+                * rem_pend;        /* destroyed while walked, on rem_next */
   tibrvTransport  id;
   tibrv_u32       inbox_count,
                   wait_limit,
@@ -439,10 +1011,24 @@ struct api_Transport : public EvConnectionNotify, public RvClientCB,
   SendCtx       * sb_fill, * sb_spare;
   pthread_mutex_t sb_lock;          /* guards owner append vs E-thread swap */
   tibrv_f64       batch_ival;       /* batch-timer period in seconds (0=off) */
-  api_BatchTimer* sb_timer;         /* EvTimerCallback fired on E */
+  SendBatchTimer* sb_timer;         /* EvTimerCallback fired on E */
+  api_RpcWheel  * rpc_wheel;        /* async request timeouts, ticks on E */
+  EvPipe        * pipe;             /* ops for this transport run here */
+  api_MsgData   * send_data;        /* process tport send by ref, pipe thread */
+  tibrvTransportStats stats;        /* pipe_* atomic, the rest on pipe thread */
+  uint32_t        io_idx,           /* which I/O thread owns it */
+                  share_idx,        /* sharer's session suffix, 0 for conn */
+                  conn_refs,        /* on conn: transports using it */
+                  sub_gen,          /* on conn: bumped when sub_refs reset */
+                  lane_count,       /* lanes, 0 when only this conn */
+                  busy,             /* dispatch_rv() walks, under mutex */
+                  rv_depth,         /* on_rv_msg() nesting, on pipe thread */
+                  share_count;      /* on conn: last share_idx given out */
+  api_SubRef_ht   sub_refs;         /* on conn: daemon interest */
+  api_Reconnect   reconn;           /* on conn: reconnect after disconnect */
   bool            sb_pending,       /* an OP_TPORT_DRAIN is already in flight */
                   sb_timer_active,
-                  reconnect_active,
+                  aux_close,        /* closed aux conn, freed at on_shutdown */
                   is_destroyed;
 
   struct TportReconnectArgs { /* saved state for reconnecting */
@@ -457,24 +1043,76 @@ struct api_Transport : public EvConnectionNotify, public RvClientCB,
   void * operator new( size_t, void *ptr ) { return ptr; }
   void operator delete( void *ptr ) { aligned_free( ptr ); }
   api_Transport( Tibrv_API &a, tibrvId i ) :
-    kv::EvSocket( a.poll, a.poll.register_type( "api_Transport" ) ),
-    api( a ), client( a.poll ), me( &this->client ), wild_ht( 0 ), id( i ),
-    inbox_count( 1 ), wait_limit( 0 ), batch_size( 0 ),
+    api_Transport( a, i, a.io_assign( i ) ) {}
+  api_Transport( Tibrv_API &a, tibrvId i, uint32_t k ) :
+    kv::EvSocket( a.io_poll( k ),
+                  a.io_poll( k ).register_type( "api_Transport" ) ),
+    api( a ), client( a.io_poll( k ) ), conn( this ), share_next( 0 ),
+    lane_of( 0 ), lanes( 0 ), me( &this->client ), wild_ht( 0 ),
+    add_pend( 0 ), rem_pend( 0 ), id( i ), inbox_count( 1 ), wait_limit( 0 ), batch_size( 0 ),
     batch_mode( TIBRV_TRANSPORT_DEFAULT_BATCH ), descr( 0 ),
-    sb_fill( 0 ), sb_spare( 0 ), batch_ival( 0 ),
-    sb_timer( 0 ), sb_pending( false ), sb_timer_active( false ),
-    reconnect_active( false ), is_destroyed( false ) {
-    pthread_mutex_init( &this->mutex, NULL );
+    sb_fill( 0 ), sb_spare( 0 ), batch_ival( 0 ), sb_timer( 0 ),
+    rpc_wheel( 0 ), pipe( a.io_pipe( k ) ), send_data( 0 ), io_idx( k ),
+    share_idx( 0 ), conn_refs( 0 ), sub_gen( 1 ),
+    lane_count( 0 ), busy( 0 ), rv_depth( 0 ), share_count( 0 ), reconn( this ),
+    sb_pending( false ), sb_timer_active( false ), aux_close( false ),
+    is_destroyed( false ) {
+    /* recursive: an op exec'd under it runs at once when on its own I/O
+     * thread and may take it again; inline callbacks run without it */
+    pthread_mutexattr_t attr;
+    pthread_mutexattr_init( &attr );
+    pthread_mutexattr_settype( &attr, PTHREAD_MUTEX_RECURSIVE );
+    pthread_mutex_init( &this->mutex, &attr );
+    pthread_mutexattr_destroy( &attr );
     pthread_cond_init( &this->cond, NULL );
     pthread_mutex_init( &this->writers_mutex, NULL );
     pthread_mutex_init( &this->sb_lock, NULL );
+    ::memset( &this->stats, 0, sizeof( this->stats ) );
   }
+  /* a publish loop of msgs finished, on the pipe thread */
+  void sent( uint64_t msgs,  uint64_t bytes ) {
+    this->stats.msgs_out  += msgs;
+    this->stats.bytes_out += bytes;
+    this->stats.batches++;
+    this->stats.batch_hist[ api_hist_bucket( msgs ) ]++;
+  }
+  void pipe_rtt( uint64_t ns ) noexcept;
   virtual void on_connect( EvSocket &conn ) noexcept;
   virtual void on_shutdown( EvSocket &conn,  const char *err,
                             size_t err_len ) noexcept;
   virtual bool on_rv_msg( EvPublish &pub ) noexcept;
   void add_wildcard( uint16_t pref ) noexcept;
   void remove_wildcard( uint16_t pref ) noexcept;
+  void add_listener( api_Listener *l ) noexcept;
+  bool remove_listener( api_Listener *l ) noexcept;
+  void settle_listeners( void ) noexcept;
+  void push_rpc( api_Rpc *r,  EvPublish *pub,  RvMsg *rvmsg,
+                 api_MsgData *data ) noexcept;
+  bool deliver( api_Listener *l,  EvPublish &pub,  RvMsg *rvmsg,
+                api_MsgData *data ) noexcept;
+  void deliver_inline( api_Listener *l,  EvPublish &pub,  RvMsg *rvmsg,
+                       api_MsgData *data ) noexcept;
+  bool filter( api_Listener *l,  RvMsg *&fmsg,  MDMsgMem &fmem,
+               api_MsgData *data ) noexcept;
+  void dispatch_rv( EvPublish &pub,  RvMsg *rvmsg,
+                    api_MsgData *data ) noexcept;
+  void send_pub( EvPublish &pub ) noexcept;
+  void replay_subs( void ) noexcept;
+  bool set_session( void ) noexcept;
+  bool in_session( const char *sub,  size_t sublen ) const noexcept;
+  size_t make_inbox( char *inbox,  uint32_t num ) const noexcept;
+  /* the conn a listener receives on, by subject hash when there are lanes;
+   * inboxes belong to the session of this conn */
+  /* lanes is retired after lane_count is 0, it stays valid under a guard */
+  api_Transport *lane( api_Listener *l ) {
+    uint32_t n = __atomic_load_n( &this->lane_count, __ATOMIC_ACQUIRE );
+    if ( n <= 1 || this->conn->in_session( l->subject, l->len ) )
+      return this;
+    return this->lanes[ kv_crc_c( l->subject, l->len, 0 ) % n ];
+  }
+  uint32_t next_inbox( void ) {
+    return this->inbox_count++;
+  }
 
   virtual bool on_msg( kv::EvPublish &pub ) noexcept;
   virtual void write( void ) noexcept;
@@ -483,21 +1121,53 @@ struct api_Transport : public EvConnectionNotify, public RvClientCB,
   virtual void release( void ) noexcept;
 };
 
-/* Periodic flush timer for SINGLE_BATCH mode.  Lives on (and fires on) the E
- * thread, so its callback drains the shared buffer with a direct inline
- * t->client.publish() loop -- no EvPipe hand-off.  This is the latency backstop
- * (tx-usecs analog) for low-rate publishers that never reach batch_size. */
-struct api_BatchTimer : public EvTimerCallback {
+/* Timing wheel for SendRequestAsync() timeouts.  One EvTimerCallback per
+ * transport ticks every RPC_WHEEL_TICK_MS on E while requests are pending and
+ * expires the slots passed since the last tick.  Requests further out than one
+ * revolution stay in their slot until expire_tick comes around.  All members
+ * are guarded by the transport mutex. */
+static const uint32_t RPC_WHEEL_SIZE    = 256; /* power of 2 */
+static const uint64_t RPC_WHEEL_TICK_MS = 10;
+
+struct api_RpcWheel : public EvTimerCallback {
   api_Transport * t;
+  api_Rpc       * slot[ RPC_WHEEL_SIZE ];
+  uint64_t        last_tick;
+  uint32_t        count;
+  bool            active;
 
   void * operator new( size_t, void *ptr ) { return ptr; }
   void operator delete( void *ptr ) { ::free( ptr ); }
-  api_BatchTimer( api_Transport * tp ) : t( tp ) {}
+  api_RpcWheel( api_Transport * tp ) : t( tp ), last_tick( 0 ), count( 0 ),
+      active( false ) {
+    ::memset( this->slot, 0, sizeof( this->slot ) );
+  }
+  static uint64_t current_tick( void ) {
+    return current_monotonic_time_ns() / ( RPC_WHEEL_TICK_MS * 1000000 );
+  }
+  void add( api_Rpc *r ) {
+    api_Rpc *& hd = this->slot[ r->expire_tick & ( RPC_WHEEL_SIZE - 1 ) ];
+    r->wback = NULL;
+    if ( (r->wnext = hd) != NULL )
+      hd->wback = r;
+    hd = r;
+    this->count++;
+  }
+  void remove( api_Rpc *r ) {
+    if ( r->wback != NULL )
+      r->wback->wnext = r->wnext;
+    else
+      this->slot[ r->expire_tick & ( RPC_WHEEL_SIZE - 1 ) ] = r->wnext;
+    if ( r->wnext != NULL )
+      r->wnext->wback = r->wback;
+    r->wnext = r->wback = NULL;
+    this->count--;
+  }
   virtual bool timer_cb( uint64_t timer_id,  uint64_t event_id ) noexcept;
-  virtual ~api_BatchTimer() {}
+  virtual ~api_RpcWheel() {}
 };
 
-struct api_Timer : public EvTimerCallback {
+struct api_Timer : public WheelTimer {
   Tibrv_API        & api;
   tibrvEvent         id;
   tibrvQueue         queue;
@@ -510,7 +1180,8 @@ struct api_Timer : public EvTimerCallback {
   void operator delete( void *ptr ) { ::free( ptr ); }
   api_Timer( Tibrv_API &a,  tibrvId i ) : api( a ), id( i ), queue( 0 ),
       cb( 0 ), cl( 0 ), ival( 0 ), in_queue( false ) {}
-  virtual bool timer_cb( uint64_t timer_id,  uint64_t event_id ) noexcept;
+  virtual bool wheel_fire( void ) noexcept;
+  virtual void wheel_done( void ) noexcept;
   virtual ~api_Timer() {}
 };
 
@@ -529,6 +1200,25 @@ struct TibrvMsgRef {
 
 typedef DLinkList< TibrvMsgRef > TibrvMsgRefList;
 
+struct api_FieldIndex;
+/* Message data delivered by reference on the process transport, either the
+ * sender's pool_buf or a copy following this header.  Every holder reads it,
+ * none write it, api_Msg::unshare() copies before a write */
+struct api_MsgData {
+  uint32_t  refs,
+            len;
+  uint8_t * buf;
+
+  static api_MsgData * copy( const void *data,  uint32_t len ) noexcept;
+  void incref( void ) {
+    __atomic_fetch_add( &this->refs, 1, __ATOMIC_RELAXED );
+  }
+  bool only_ref( void ) const {
+    return __atomic_load_n( &this->refs, __ATOMIC_ACQUIRE ) == 1;
+  }
+  void release( void ) noexcept;
+};
+
 struct api_Msg {
   api_Msg       * next,
                 * back;
@@ -540,40 +1230,64 @@ struct api_Msg {
   tibrvEvent      event;
   RvMsg         * rvmsg;
   MDFieldReader * rd;
+  api_FieldIndex* fidx;   /* lazy field lookup index, lives with rd in mem */
   MDMsgMem        mem;
   RvMsgWriter     wr;
   const void    * cl;
   uint32_t        wr_refs,
                   rd_refs;
   bool            in_queue;
+  uint32_t        conflated; /* msgs replaced by this one while queued */
   MsgTether       tether;
   uint64_t        serial,
                   id_used;
   TibrvMsgRefList refs;
+  uint8_t       * pool_buf;  /* size class buffer, kept while pooled */
+  uint32_t        pool_size;
+  api_MsgData   * share;     /* data is shared with process tport receivers */
+  bool            base_out;  /* GetSlotBase() pointer given, can't lend buf */
 
   void * operator new( size_t, void *ptr ) { return ptr; }
   void operator delete( void *ptr ) { ::free( ptr ); }
   api_Msg( tibrvEvent ev ) :
     next( 0 ), back( 0 ), owner( 0 ), subject( 0 ), reply( 0 ),
     subject_len( 0 ), reply_len( 0 ), event( ev ),
-    rvmsg( 0 ), rd( 0 ), wr( this->mem, NULL, 0 ), cl( 0 ), wr_refs( 0 ),
-    rd_refs( 0 ), in_queue( false ), serial( 0 ), id_used( 0 ) {}
+    rvmsg( 0 ), rd( 0 ), fidx( 0 ), wr( this->mem, NULL, 0 ), cl( 0 ),
+    wr_refs( 0 ),
+    rd_refs( 0 ), in_queue( false ), conflated( 0 ), serial( 0 ),
+    id_used( 0 ),
+    pool_buf( 0 ), pool_size( 0 ), share( 0 ), base_out( false ) {}
   ~api_Msg() noexcept;
   void release( void ) noexcept;
 
-  static api_Msg * make( EvPublish &pub, RvMsg *rvmsg, MsgTether *tether,
-                         tibrvEvent ev, const void *cl ) noexcept;
+  /* thread local free lists, binned by pool_buf size class */
+  static uint32_t pool_max;
+  static api_Msg * alloc( size_t initial ) noexcept;
+  static void recycle( api_Msg *m ) noexcept;
+  static void pool_stats( uint64_t &hits,  uint64_t &misses,
+                          uint64_t &allocs ) noexcept;
+  bool reserve( size_t add ) noexcept;
+
+  static api_Msg * make( EvPublish &pub, RvMsg *rvmsg, api_MsgData *data,
+                         MsgTether *tether, tibrvEvent ev,
+                         const void *cl ) noexcept;
   api_Msg * make_submsg( void ) noexcept;
+  api_MsgData * share_data( void ) noexcept;
+  void unshare( bool copy ) noexcept;
 
   void reset( void ) {
+    if ( this->share != NULL )
+      this->unshare( false );
+    this->base_out    = false;
     this->subject     = NULL;
     this->reply       = NULL;
     this->subject_len = 0;
     this->reply_len   = 0;
     this->rvmsg       = NULL;
     this->rd          = NULL;
-    this->wr.buf      = NULL;
-    this->wr.buflen   = 0;
+    this->fidx        = NULL;
+    this->wr.buf      = this->pool_buf;
+    this->wr.buflen   = this->pool_size;
     this->id_used     = 0;
     this->release();
     this->wr.reset();
@@ -583,43 +1297,72 @@ struct api_Msg {
 };
 struct EvPipeRec;
 struct EvPipe : public EvConnection {
-  int write_fd;
+  int             write_fd;
+  api_SendRing  * rings;          /* ASYNC_BATCH rings of this thread's tports */
+  pthread_mutex_t ring_mutex;     /* ring list, held while draining */
+  uint32_t        ring_signaled;  /* an OP_RING_DRAIN is posted */
+  uint32_t        ring_depth;     /* I/O thread is inside drain_rings() */
+  bool            ring_again,     /* drain re-entered, run once more */
+                  ring_sweep;     /* rings in RING_DETACH to unlink */
 
   void * operator new( size_t, void *ptr ) { return ptr; }
   EvPipe( EvPoll &poll,  int wfd ) :
-    EvConnection( poll, poll.register_type( "tibrv_api" ) ), write_fd( wfd ) {}
+    EvConnection( poll, poll.register_type( "tibrv_api" ) ), write_fd( wfd ),
+    rings( 0 ), ring_signaled( 0 ), ring_depth( 0 ), ring_again( false ),
+    ring_sweep( false ) {
+    pthread_mutex_init( &this->ring_mutex, NULL );
+  }
   bool start( int rfd,  const char *name ) noexcept;
   virtual void process( void ) noexcept final;
   virtual void release( void ) noexcept final {}
 
   void subscribe( EvPipeRec &rec ) noexcept;
   void unsubscribe( EvPipeRec &rec ) noexcept;
-  void create_timer( EvPipeRec &rec ) noexcept;
-  void destroy_timer( EvPipeRec &rec ) noexcept;
-  void reset_timer( EvPipeRec &rec ) noexcept;
+  void start_timers( EvPipeRec &rec ) noexcept;
   void create_tport( EvPipeRec &rec ) noexcept;
   void close_tport( EvPipeRec &rec ) noexcept;
+  void close_aux( EvPipeRec &rec ) noexcept;
+  void free_aux( EvPipeRec &rec ) noexcept;
   void tport_send( EvPipeRec &rec ) noexcept;
   void tport_sendv( EvPipeRec &rec ) noexcept;
   void tport_drain( EvPipeRec &rec ) noexcept;
+  void tport_post( EvPipeRec &rec ) noexcept;
   void start_batch_timer( EvPipeRec &rec ) noexcept;
   void stop_batch_timer( EvPipeRec &rec ) noexcept;
+  void start_rpc_timer( EvPipeRec &rec ) noexcept;
+  void stop_rpc_timer( EvPipeRec &rec ) noexcept;
+  void ring_drain( EvPipeRec &rec ) noexcept;
+  void ring_detach( EvPipeRec &rec ) noexcept;
+  void fast_start( EvPipeRec &rec ) noexcept; /* in rv7_ft.cpp */
+  void fast_stop( EvPipeRec &rec ) noexcept;
+  void drain_rings( void ) noexcept;
+  void sweep_rings( void ) noexcept;
+  void wake_rings( void ) noexcept;
 
   void exec( EvPipeRec &rec ) noexcept;
+  void post( EvPipeRec &rec ) noexcept; /* exec without waiting */
+  bool post_nowait( EvPipeRec &rec ) noexcept;
 };
 
 #define OP_SUBSCRIBE        &EvPipe::subscribe
 #define OP_UNSUBSCRIBE      &EvPipe::unsubscribe
-#define OP_CREATE_TIMER     &EvPipe::create_timer
-#define OP_DESTROY_TIMER    &EvPipe::destroy_timer
-#define OP_RESET_TIMER      &EvPipe::reset_timer
+#define OP_START_TIMERS     &EvPipe::start_timers
 #define OP_CREATE_TPORT     &EvPipe::create_tport
 #define OP_CLOSE_TPORT      &EvPipe::close_tport
+#define OP_CLOSE_AUX        &EvPipe::close_aux
+#define OP_FREE_AUX         &EvPipe::free_aux
 #define OP_TPORT_SEND       &EvPipe::tport_send
 #define OP_TPORT_SENDV      &EvPipe::tport_sendv
 #define OP_TPORT_DRAIN      &EvPipe::tport_drain
+#define OP_TPORT_POST       &EvPipe::tport_post
 #define OP_START_BATCH_TMR  &EvPipe::start_batch_timer
 #define OP_STOP_BATCH_TMR   &EvPipe::stop_batch_timer
+#define OP_START_RPC_TMR    &EvPipe::start_rpc_timer
+#define OP_STOP_RPC_TMR     &EvPipe::stop_rpc_timer
+#define OP_RING_DRAIN       &EvPipe::ring_drain
+#define OP_RING_DETACH      &EvPipe::ring_detach
+#define OP_FAST_START       &EvPipe::fast_start
+#define OP_FAST_STOP        &EvPipe::fast_stop
 
 struct EvPipeRec {
   void ( EvPipe::*func )( EvPipeRec &rec ) noexcept;
@@ -629,6 +1372,9 @@ struct EvPipeRec {
   pthread_mutex_t * mutex;
   pthread_cond_t  * cond;
   EvPublish       * pub;
+  api_MsgData    ** data;   /* pub[ i ] by reference when data[ i ] != 0 */
+  api_RingRec     * copy;   /* OP_TPORT_POST, malloced, freed by the op */
+  api_FtFast      * fast;   /* OP_FAST_START, OP_FAST_STOP */
   tibrv_u32         cnt;
   EvRvClientParameters
                   * parm;
@@ -640,7 +1386,8 @@ struct EvPipeRec {
              pthread_mutex_t * m,
              pthread_cond_t  * c )
     : func( f ), t( transport ), l( 0 ), timer( 0 ),
-      mutex( m ), cond( c ), pub( 0 ), cnt( 0 ), parm( p ), complete( 0 ) {}
+      mutex( m ), cond( c ), pub( 0 ), data( 0 ), copy( 0 ), fast( 0 ), cnt( 0 ),
+      parm( p ), complete( 0 ) {}
 
   EvPipeRec( void ( EvPipe::*f )( EvPipeRec &rec ),
              api_Transport   * transport,
@@ -648,14 +1395,16 @@ struct EvPipeRec {
              pthread_mutex_t * m,
              pthread_cond_t  * c )
     : func( f ), t( transport ), l( listener ), timer( 0 ),
-      mutex( m ), cond( c ), pub( 0 ), cnt( 0 ), parm( 0 ), complete( 0 ) {}
+      mutex( m ), cond( c ), pub( 0 ), data( 0 ), copy( 0 ), fast( 0 ), cnt( 0 ),
+      parm( 0 ), complete( 0 ) {}
 
   EvPipeRec( void ( EvPipe::*f )( EvPipeRec &rec ),
              api_Timer       * tmr,
              pthread_mutex_t * m,
              pthread_cond_t  * c )
     : func( f ), t( 0 ), l( 0 ), timer( tmr ),
-      mutex( m ), cond( c ), pub( 0 ), cnt( 0 ), parm( 0 ), complete( 0 ) {}
+      mutex( m ), cond( c ), pub( 0 ), data( 0 ), copy( 0 ), fast( 0 ), cnt( 0 ),
+      parm( 0 ), complete( 0 ) {}
 
   EvPipeRec( void ( EvPipe::*f )( EvPipeRec &rec ),
              api_Transport   * transport,
@@ -664,10 +1413,27 @@ struct EvPipeRec {
              pthread_mutex_t * m,
              pthread_cond_t  * c )
     : func( f ), t( transport ), l( 0 ), timer( 0 ),
-      mutex( m ), cond( c ), pub( p ), cnt( count ), parm( 0 ), complete( 0 ) {}
+      mutex( m ), cond( c ), pub( p ), data( 0 ), copy( 0 ), fast( 0 ), cnt( count ),
+      parm( 0 ), complete( 0 ) {}
+
+  EvPipeRec( void ( EvPipe::*f )( EvPipeRec &rec ),
+             api_Transport   * transport,
+             api_RingRec     * r )
+    : func( f ), t( transport ), l( 0 ), timer( 0 ),
+      mutex( 0 ), cond( 0 ), pub( 0 ), data( 0 ), copy( r ), fast( 0 ), cnt( 1 ),
+      parm( 0 ), complete( 0 ) {}
+
+  EvPipeRec( void ( EvPipe::*f )( EvPipeRec &rec ),
+             api_FtFast      * ff,
+             pthread_mutex_t * m,
+             pthread_cond_t  * c )
+    : func( f ), t( 0 ), l( 0 ), timer( 0 ),
+      mutex( m ), cond( c ), pub( 0 ), data( 0 ), copy( 0 ), fast( ff ),
+      cnt( 0 ), parm( 0 ), complete( 0 ) {}
 
   EvPipeRec() : func( NULL ), t( 0 ), l( 0 ), timer( 0 ),
-                mutex( 0 ), cond( 0 ), pub( 0 ), cnt( 0 ), parm( 0 ),
+                mutex( 0 ), cond( 0 ), pub( 0 ), data( 0 ), copy( 0 ),
+                fast( 0 ), cnt( 0 ), parm( 0 ),
                 complete( 0 ) {}
 };
 
@@ -31,7 +31,8 @@ struct TibrvFtPeer {
   uint8_t         pub_err;
   bool            is_running,
                   is_stopped,
-                  is_unresponsive;
+                  is_unresponsive,
+                  is_lost;        /* fast mode: missed heartbeats */
 
   void * operator new( size_t, void *ptr ) { return ptr; }
   void operator delete( void *ptr ) { ::free( ptr ); }
@@ -42,7 +43,7 @@ struct TibrvFtPeer {
       weight( 0 ), active_goal( 0 ), rank( 0 ),
       host_stop_id( 0 ), session_stop_id( 0 ), unreachable_id( 0 ),
       pub_err( 0 ), is_running( false ), is_stopped( false ),
-      is_unresponsive( false ) {}
+      is_unresponsive( false ), is_lost( false ) {}
 
   void unreachable_cb( tibrvMsg m ) noexcept;
   void session_stop_cb( tibrvMsg m ) noexcept;
@@ -72,6 +73,64 @@ enum FtState {
   RVFT_ACTIVE_STOP = 7
 };
 
+/* Fast mode: an active member heartbeats every few ms on a private daemon
+ * connection, so they never queue behind data sent on the member transport.
+ * A thread ticks on a timerfd at the heartbeat interval, it sends when active
+ * and counts the ticks each active peer was not heard; miss_count in a row
+ * loses the peer, recover_count heard in a row brings it back */
+static const uint32_t FT_FAST_PEERS = 8;
+struct api_FtFastPeer {
+  uint32_t hash,        /* of the peer inbox, 0 when free */
+           miss,        /* ticks in a row not heard, by tick() */
+           seen;        /* ticks in a row heard, by tick() */
+  uint64_t hb_count,    /* bumped by the receive on the conn thread */
+           last_count;  /* hb_count at the last tick */
+  bool     is_lost,     /* hash is lost, read by the queue */
+           drop;        /* peer sent ACTIVE_STOP, free the slot */
+};
+
+struct api_FtFast;
+/* The timerfd of a fast member in the poll of the API_FT_IO thread, which
+ * also runs the hb conn, so a tick sends without a hand-off */
+struct api_FtFastTimer : public EvConnection {
+  api_FtFast * fast;            /* NULL after OP_FAST_STOP */
+
+  void * operator new( size_t, void *ptr ) { return ptr; }
+  api_FtFastTimer( EvPoll &p,  uint8_t st ) : EvConnection( p, st ),
+    fast( 0 ) {}
+  virtual void process( void ) noexcept final;
+  virtual void release( void ) noexcept final;
+};
+
+struct api_FtFast {
+  api_FtMember  & ft;
+  api_Transport * hb;           /* private conn, sends and receives FAST_HB */
+  api_FtFastTimer * timer;      /* ticks on the hb conn thread */
+  tibrvQueue      hb_queue;     /* inline, FAST_HB runs on the conn thread */
+  tibrvEvent      hb_id;        /* listener of _RVFT.FAST_HB.<name> */
+  tibrv_u64       ival_ns,      /* tick and heartbeat interval */
+                  drop_ns;      /* a lost peer not heard this long is freed */
+  uint32_t        miss_count,   /* ticks not heard to lose a peer */
+                  recover_count,/* ticks heard to restore a lost peer */
+                  my_hash,      /* of my inbox, my heartbeats are skipped */
+                  posted;       /* fast_cb is in the queue */
+  int             tfd;          /* timerfd, owned by timer once started */
+  api_FtFastPeer  peer[ FT_FAST_PEERS ];
+
+  void * operator new( size_t, void *ptr ) { return ptr; }
+  void operator delete( void *ptr ) { ::free( ptr ); }
+  api_FtFast( api_FtMember &m ) : ft( m ), hb( 0 ), timer( 0 ), hb_queue( 0 ),
+      hb_id( 0 ), ival_ns( 0 ), drop_ns( 0 ), miss_count( 0 ),
+      recover_count( 0 ), my_hash( 0 ), posted( 0 ), tfd( -1 ) {
+    ::memset( this->peer, 0, sizeof( this->peer ) );
+  }
+  void tick( void ) noexcept;
+  void heard( uint32_t h ) noexcept;
+  void forget( uint32_t h ) noexcept;
+  bool is_lost( uint32_t h ) const noexcept;
+  void post( void ) noexcept;
+};
+
 struct api_FtMember {
   Tibrv_API           & api;
   tibrvftMember         id;
@@ -90,6 +149,7 @@ struct api_FtMember {
   tibrv_u64             start_time,
                         prepare_time,
                         fterr_time;
+  api_FtFast          * fast;     /* fast mode, or NULL */
   bool                  is_destroyed;
 
   void * operator new( size_t, void *ptr ) { return ptr; }
@@ -97,7 +157,7 @@ struct api_FtMember {
   api_FtMember( Tibrv_API &a,  tibrvId i ) : api( a ), id( i ), queue( 0 ),
       cb( 0 ), cl( 0 ), tport( 0 ), name( 0 ), me( this ), activate_id( 0 ),
       prepare_id( 0 ), hb_id( 0 ), start_time( 0 ), prepare_time( 0 ),
-      fterr_time( 0 ), is_destroyed( false ) {
+      fterr_time( 0 ), fast( 0 ), is_destroyed( false ) {
     for ( int i = 0; i < 8; i++ ) this->cb_id[ i ] = 0;
     pthread_mutex_init( &this->mutex, NULL );
   }
@@ -106,6 +166,7 @@ struct api_FtMember {
   bool publish_rvftsub( const char *cl,  const char *nm,
                         const char *de = NULL ) noexcept;
   void update_peer( TibrvFtPeer *p,  tibrvMsg msg,  FtState state ) noexcept;
+  void rank_peers( TibrvFtPeer *p,  FtState state,  tibrv_u64 now ) noexcept;
   tibrv_u64 update_time( void ) noexcept;
   void stop_timers( void ) noexcept;
   tibrv_status prepare( void ) noexcept;
@@ -123,6 +184,11 @@ struct api_FtMember {
   bool activate_now( void ) noexcept;
   bool do_callback( tibrvftAction action ) noexcept;
   void hb_timer_cb( void ) noexcept;
+  tibrv_status start_fast( tibrv_f64 hb_ival,  tibrv_u32 miss_count,
+                           tibrv_u32 recover_count ) noexcept;
+  void stop_fast( api_FtFast *f ) noexcept;
+  void fast_hb_cb( tibrvMsg m ) noexcept;
+  void fast_cb( void ) noexcept;
 };
 
 struct api_FtMonitor {
@@ -0,0 +1,83 @@
+#ifndef __rai_sassrv__send_batch_h__
+#define __rai_sassrv__send_batch_h__
+
+#include <string.h>
+#include <raikv/ev_net.h>
+#include <raikv/ev_publish.h>
+#include <raimd/md_msg.h>
+
+namespace rai {
+namespace sassrv {
+
+/* Publishes copied into byte_mem until the owner of the connection sends
+ * them in one pass, the RV7 SendCtx buffers and the RV5 session batch */
+struct SendBatch {
+  kv::EvPublish * pubs;       /* contiguous batch (high-water, realloc) */
+  uint32_t        cnt, cap;   /* entries used / allocated */
+  size_t          bytes;      /* pending data bytes */
+  md::MDMsgMem    byte_mem;   /* stable copies of subject/reply/data */
+
+  void * operator new( size_t, void *ptr ) { return ptr; }
+  void operator delete( void *ptr ) { ::free( ptr ); }
+  SendBatch() : pubs( 0 ), cnt( 0 ), cap( 0 ), bytes( 0 ) {}
+  ~SendBatch() {
+    if ( this->pubs != NULL )
+      ::free( this->pubs );
+  }
+  char *copy_str( const char *s,  size_t len ) {
+    char * p = (char *) this->byte_mem.make( len + 1 );
+    ::memcpy( p, s, len );
+    p[ len ] = 0;
+    return p;
+  }
+  void append( const char *sub,  size_t sublen,  const char *rep,
+               size_t replen,  const void *data,  size_t datalen,
+               kv::RoutePublish &sub_route,  const kv::PeerId &src,
+               uint32_t msg_enc ) {
+    char * s = this->copy_str( sub, sublen ),
+         * r = ( replen > 0 ? this->copy_str( rep, replen ) : NULL );
+    void * d = this->byte_mem.make( datalen );
+    ::memcpy( d, data, datalen );
+    if ( this->cnt == this->cap ) {
+      uint32_t        ncap = this->cap ? this->cap * 2 : 64;
+      kv::EvPublish * np   =
+        (kv::EvPublish *) ::malloc( ncap * sizeof( kv::EvPublish ) );
+      if ( this->cnt > 0 )
+        ::memcpy( (void *) np, (void *) this->pubs,
+                  this->cnt * sizeof( kv::EvPublish ) );
+      if ( this->pubs != NULL )
+        ::free( this->pubs );
+      this->pubs = np;
+      this->cap  = ncap;
+    }
+    new ( &this->pubs[ this->cnt++ ] )
+      kv::EvPublish( s, sublen, r, replen, d, datalen, sub_route, src, 0,
+                     msg_enc );
+    this->bytes += datalen;
+  }
+  void reset( void ) {
+    this->cnt   = 0;
+    this->bytes = 0;
+    this->byte_mem.reuse();
+  }
+};
+
+/* Periodic flush of a batch on the poll of the connection, the latency
+ * backstop for a batch that doesn't reach its size, rearms while cb returns
+ * true */
+struct SendBatchTimer : public kv::EvTimerCallback {
+  bool ( *cb )( void *closure );
+  void * closure;
+
+  void * operator new( size_t, void *ptr ) { return ptr; }
+  void operator delete( void *ptr ) { ::free( ptr ); }
+  SendBatchTimer( bool ( *f )( void * ),  void *cl ) : cb( f ), closure( cl ) {}
+  virtual bool timer_cb( uint64_t,  uint64_t ) noexcept {
+    return this->cb( this->closure );
+  }
+  virtual ~SendBatchTimer() {}
+};
+
+}
+}
+#endif
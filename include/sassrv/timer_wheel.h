@@ -0,0 +1,104 @@
+#ifndef __rai_sassrv__timer_wheel_h__
+#define __rai_sassrv__timer_wheel_h__
+
+#include <string.h>
+#include <raikv/ev_net.h>
+
+namespace rai {
+namespace sassrv {
+
+/* Hierarchical timing wheel for API timers.  Four levels of 256 slots at the
+ * tick resolution (1ms) reach ~49 days, longer deadlines wait in the top level
+ * and are slotted again when it comes around.  A single EvPoll timer is armed
+ * for the next tick with work, a linked level 0 slot or a cascade of a higher
+ * level, so a long timer costs a wakeup per level and not one per tick.
+ *
+ * Slots are only touched by the poll (owner) thread.  Any thread can arm,
+ * reset or cancel: a deadline that moves later is just stored and the timer
+ * is re-slotted when its old slot expires, otherwise the timer is pushed onto
+ * a lock free pending stack that the owner takes when it wakes; a push due
+ * before the armed poll timer claims an early wakeup. */
+static const uint32_t WHEEL_LEVELS   = 4,
+                      WHEEL_BITS     = 8,
+                      WHEEL_SLOTS    = 1 << WHEEL_BITS,
+                      WHEEL_MASK     = WHEEL_SLOTS - 1,
+                      WHEEL_UNLINKED = WHEEL_LEVELS * WHEEL_SLOTS,
+                      WHEEL_MAX_SLEEP_MS = 3600 * 1000; /* poll timer max */
+
+struct WheelTimer {
+  WheelTimer * wnext,        /* slot list, owner thread */
+             * wback,
+             * wpend;        /* pending stack link */
+  uint64_t     expire_tick,  /* deadline, stored by any thread */
+               period,       /* ticks between expires */
+               wtick;        /* deadline of the slot it is linked in */
+  uint32_t     wslot,        /* level * WHEEL_SLOTS + index, or UNLINKED */
+               wstate;       /* WHEEL_PENDING | WHEEL_CANCEL */
+
+  WheelTimer() : wnext( 0 ), wback( 0 ), wpend( 0 ), expire_tick( 0 ),
+                 period( 0 ), wtick( 0 ), wslot( WHEEL_UNLINKED ),
+                 wstate( 0 ) {}
+  virtual ~WheelTimer() {}
+  /* expired on the owner thread, true to expire again after period */
+  virtual bool wheel_fire( void ) noexcept = 0;
+  /* cancel completed, the timer is unlinked and can be freed */
+  virtual void wheel_done( void ) noexcept = 0;
+};
+
+struct TimerWheel : public kv::EvTimerCallback {
+  enum { WHEEL_PENDING = 1, WHEEL_CANCEL = 2 };
+
+  kv::EvPoll & poll;
+  WheelTimer * slot[ WHEEL_LEVELS * WHEEL_SLOTS ];
+  WheelTimer * pending;  /* pushed by any thread, taken by the owner */
+  uint64_t     cur,      /* next tick to expire */
+               wake_tick,/* poll timer armed for, 0 when a wakeup is claimed */
+               tick_ns,
+               count,    /* timers linked */
+               fired;    /* timers expired */
+  uint32_t     tick_ms,
+               idle;     /* poll timer stopped and no wakeup claimed */
+  bool         running;  /* poll timer armed, owner only */
+
+  TimerWheel( kv::EvPoll &p,  uint32_t ms = 1 ) : poll( p ), pending( 0 ),
+      cur( 0 ), wake_tick( 0 ), tick_ns( (uint64_t) ms * 1000000 ),
+      count( 0 ), fired( 0 ),
+      tick_ms( ms ), idle( 1 ), running( false ) {
+    ::memset( this->slot, 0, sizeof( this->slot ) );
+  }
+  uint64_t now_tick( void ) const {
+    return kv::current_monotonic_time_ns() / this->tick_ns;
+  }
+  /* ticks for ms, rounded up, at least one */
+  uint64_t ms_ticks( double ms ) const {
+    double   t = ms / (double) this->tick_ms;
+    uint64_t n = ( t > 0 ? (uint64_t) t : 0 );
+    if ( (double) n < t )
+      n++;
+    return ( n == 0 ? 1 : n );
+  }
+  /* Any thread.  Expire after ticks, then every period.  These return true
+   * when the caller must have the owner thread call start() */
+  bool arm( WheelTimer *t,  uint64_t ticks,  uint64_t period ) noexcept;
+  bool cancel( WheelTimer *t ) noexcept;
+
+  /* Owner thread */
+  void start( void ) noexcept;
+  virtual bool timer_cb( uint64_t timer_id,  uint64_t event_id ) noexcept;
+
+  bool mark( WheelTimer *t ) noexcept;
+  void push( WheelTimer *t ) noexcept;
+  bool wake_needed( uint64_t e ) noexcept;
+  void take_pending( void ) noexcept;
+  void insert( WheelTimer *t ) noexcept;
+  void unlink( WheelTimer *t ) noexcept;
+  void cascade( uint32_t level ) noexcept;
+  uint64_t next_tick( void ) const noexcept;
+  void run( uint64_t now ) noexcept;
+  bool settle( void ) noexcept;
+  void arm_poll( void ) noexcept;
+};
+
+}
+}
+#endif
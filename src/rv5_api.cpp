@@ -4,6 +4,10 @@
 #include <stdint.h>
 #include <signal.h>
 #include <unistd.h>
+#include <sched.h>
+#if ! defined( _MSC_VER ) && ! defined( __MINGW32__ )
+#include <sys/eventfd.h>
+#endif
 
 #include <sassrv/ev_rv_client.h>
 #include <raimd/md_msg.h>
@@ -11,6 +15,8 @@
 #include <raikv/ev_publish.h>
 #include <sassrv/rv5api.h>
 #include <sassrv/mc.h>
+#include <sassrv/timer_wheel.h>
+#include <sassrv/send_batch.h>
 
 #pragma GCC diagnostic ignored "-Wunused-parameter"
 
@@ -23,6 +29,7 @@ namespace {
 
 struct rv_Listener_ht;
 struct rv_Session_api;
+struct rv_TrieNode;
 
 struct rv_Listener_api {
   rv_Listener_api  * next,
@@ -32,12 +39,26 @@ struct rv_Listener_api {
   uint16_t           len, wild;
   uint32_t           hash;
   rv_MessageCallback cb;
+  rv_VectorCallback  vcb;
   void             * cl;
+  rv_TrieNode      * node;      /* wildcard, where it is in the trie */
+  rv_Listener_api  * vec_next;  /* session vec_list, msgs this poll */
+  rv_Listener_api  * close_next;/* session close_list, closed while busy */
+  rv_Message       * vec;
+  uint32_t           vec_cnt,
+                     vec_cap;
+  bool               in_vec;
   void * operator new( size_t, void *ptr ) { return ptr; }
   void operator delete( void *ptr ) { ::free( ptr ); }
   rv_Listener_api( rv_Session_api &s )
     : next( 0 ), back( 0 ), session( s ), subject( 0 ), len( 0 ), wild( 0 ),
-      hash( 0 ), cb( 0 ), cl( 0 ) {}
+      hash( 0 ), cb( 0 ), vcb( 0 ), cl( 0 ), node( 0 ), vec_next( 0 ),
+      close_next( 0 ), vec( 0 ),
+      vec_cnt( 0 ), vec_cap( 0 ), in_vec( false ) {}
+  ~rv_Listener_api() {
+    if ( this->vec != NULL )
+      ::free( this->vec );
+  }
 };
 
 typedef DLinkList< rv_Listener_api > rv_Listener_list;
@@ -89,7 +110,87 @@ struct rv_Listener_ht {
   }
 };
 
-struct rv_Timer_api : public EvTimerCallback { 
+/* Segment trie of the wildcard listeners, a node for each segment of a
+ * pattern.  Literal children are in one hash table of all the nodes, keyed by
+ * the parent id and the segment, a '*' child is linked from its parent and a
+ * pattern ending in '>' is listed on the node before the '>'.  A subject is
+ * matched by one walk down its segments, which branches where a '*' is */
+struct rv_TrieNode {
+  rv_TrieNode    * next,
+                 * back;      /* rv_Trie bucket */
+  rv_TrieNode    * parent,
+                 * star;      /* '*' child */
+  rv_Listener_list end,       /* patterns ending at this node */
+                   tail;      /* patterns ending with a '>' after it */
+  uint32_t         hash,
+                   id,
+                   refs;      /* children and listeners */
+  uint16_t         len;
+  char             seg[ 2 ];
+
+  void * operator new( size_t, void *ptr ) { return ptr; }
+  void operator delete( void *ptr ) { ::free( ptr ); }
+  rv_TrieNode( rv_TrieNode *p,  uint32_t i,  const char *s,  size_t l,
+               uint32_t h ) : next( 0 ), back( 0 ), parent( p ), star( 0 ),
+      hash( h ), id( i ), refs( 0 ), len( (uint16_t) l ) {
+    ::memcpy( this->seg, s, l );
+    this->seg[ l ] = '\0';
+  }
+  bool equals( rv_TrieNode *p,  const char *s,  size_t l ) const {
+    return this->parent == p && this->len == l &&
+           ::memcmp( this->seg, s, l ) == 0;
+  }
+};
+
+typedef DLinkList< rv_TrieNode > rv_TrieNode_list;
+
+struct rv_Trie {
+  rv_TrieNode_list * ht;
+  size_t             mask,
+                     count;
+  uint32_t           next_id;
+  rv_TrieNode        root;
+
+  rv_Trie() : ht( 0 ), mask( 0 ), count( 0 ), next_id( 1 ),
+              root( NULL, 0, "", 0, 0 ) {}
+  void resize( void ) {
+    size_t             sz  = ( this->ht == NULL ? 0 : this->mask + 1 ),
+                       nsz = ( sz == 0 ? 16 : sz * 2 );
+    rv_TrieNode_list * oht = this->ht;
+    this->ht   = (rv_TrieNode_list *) ::malloc( sizeof( this->ht[ 0 ] ) * nsz );
+    this->mask = nsz - 1;
+    ::memset( (void *) this->ht, 0, sizeof( this->ht[ 0 ] ) * nsz );
+    for ( size_t i = 0; i < sz; i++ ) {
+      while ( ! oht[ i ].is_empty() ) {
+        rv_TrieNode * n = oht[ i ].pop_hd();
+        this->ht[ n->hash & this->mask ].push_tl( n );
+      }
+    }
+    if ( oht != NULL )
+      ::free( oht );
+  }
+  rv_TrieNode *find( rv_TrieNode *p,  const char *s,  size_t l ) const {
+    if ( this->count == 0 )
+      return NULL;
+    uint32_t h = kv_crc_c( s, l, p->id );
+    for ( rv_TrieNode *n = this->ht[ h & this->mask ].hd; n != NULL;
+          n = n->next ) {
+      if ( n->hash == h && n->equals( p, s, l ) )
+        return n;
+    }
+    return NULL;
+  }
+  rv_TrieNode *make( rv_TrieNode *p,  const char *s,  size_t l,
+                     uint32_t h ) {
+    void * m = ::malloc( sizeof( rv_TrieNode ) + l );
+    p->refs++;
+    return new ( m ) rv_TrieNode( p, this->next_id++, s, l, h );
+  }
+  void add( rv_Listener_api *l ) noexcept;
+  void remove( rv_Listener_api *l ) noexcept;
+};
+
+struct rv_Timer_api : public WheelTimer {
   rv_Session_api  & session;
   rv_TimerCallback  cb;
   void            * cl;
@@ -98,7 +199,8 @@ struct rv_Timer_api : public EvTimerCallback {
   rv_Timer_api( rv_Session_api &s ) : session( s ), cb( 0 ), cl( 0 ) {}
   virtual ~rv_Timer_api() {}
 
-  virtual bool timer_cb( uint64_t timer_id,  uint64_t event_id ) noexcept;
+  virtual bool wheel_fire( void ) noexcept;
+  virtual void wheel_done( void ) noexcept;
 };
 
 struct rv_Signal_api {
@@ -127,6 +229,26 @@ struct rv_Signal_api {
 
 typedef DLinkList< rv_Signal_api > rv_Signal_list;
 
+static const uint32_t RV_VECTOR_MAX = 1024; /* delivered early when full */
+
+/* eventfd in the poll, the signal handler writes it so that a blocked
+ * rv_MainLoop wakes up */
+struct rv_Wakeup : public EvConnection {
+  void * operator new( size_t, void *ptr ) { return ptr; }
+  rv_Wakeup( EvPoll &p ) :
+    EvConnection( p, p.register_type( "rv_wakeup" ) ) {}
+  bool start( int fd ) noexcept {
+    this->PeerData::init_peer( this->poll.get_next_id(), fd, -1, NULL,
+                               "rv_wakeup" );
+    return this->poll.add_sock( this ) == 0;
+  }
+  virtual void process( void ) noexcept final {
+    this->off = this->len; /* counter value, only the wakeup matters */
+    this->pop( EV_PROCESS );
+  }
+  virtual void release( void ) noexcept final {}
+};
+
 struct rv_Session_api : public EvConnectionNotify, public RvClientCB {
   void * operator new( size_t, void *ptr ) { return ptr; }
 
@@ -134,36 +256,43 @@ struct rv_Session_api : public EvConnectionNotify, public RvClientCB {
                  * back;
   EvPoll           poll;
   EvRvClient       client;
+  TimerWheel       timers;
   rv_Listener_ht   ht;
-  UIntHashTab    * wild_ht;
+  rv_Trie          trie;        /* wildcard listeners */
   uint32_t         busy, inbox_count;
   rv_Signal_list   signal_list;
-  bool             signaled;
-
-  rv_Session_api() : next( 0 ), back( 0 ), client( this->poll ), wild_ht( 0 ),
-                     busy( 0 ), inbox_count( 2 ), signaled( false ) {}
-  void add_wildcard( uint16_t pref ) {
-    uint32_t val;
-    size_t   pos;
-    if ( this->wild_ht == NULL )
-      this->wild_ht = UIntHashTab::resize( NULL );
-    if ( this->wild_ht->find( pref, pos, val ) )
-      this->wild_ht->set( pref, pos, val + 1 );
-    else
-      this->wild_ht->upsert_rsz( this->wild_ht, pref, 1 );
-  }
-  void remove_wildcard( uint16_t pref ) {
-    uint32_t val;
-    size_t   pos;
-    if ( this->wild_ht != NULL ) {
-      if ( this->wild_ht->find( pref, pos, val ) ) {
-        if ( val == 1 )
-          this->wild_ht->remove( pos );
-        else
-          this->wild_ht->set( pref, pos, val - 1 );
-      }
-    }
-  }
+  SendBatch      * sb;          /* send batch, NULL when not batching */
+  SendBatchTimer * sb_timer;
+  size_t           batch_size;  /* flush at bytes, 0 = only timer or rv_Flush */
+  double           batch_ival;  /* timer period in seconds, 0 = off */
+  rv_Listener_api* vec_list;    /* vector listeners with msgs this poll */
+  rv_Listener_api* close_list;  /* rv_Close() while busy or in vec_list */
+  MDMsgMem         vec_mem;     /* copies of their msgs */
+  rv_Wakeup      * wakeup;      /* RV_IDLE_BLOCK: signals write wake_fd */
+  int              wake_fd;
+  rv_IdleStrategy  idle_strategy;
+  uint32_t         spin_count;  /* idle polls before idle_strategy */
+  bool             signaled,
+                   sb_timer_active;
+
+  rv_Session_api() : next( 0 ), back( 0 ), client( this->poll ),
+                     timers( this->poll ),
+                     busy( 0 ), inbox_count( 2 ), sb( 0 ), sb_timer( 0 ),
+                     batch_size( 0 ), batch_ival( 0 ), vec_list( 0 ),
+                     close_list( 0 ),
+                     wakeup( 0 ), wake_fd( -1 ), idle_strategy( RV_IDLE_SLEEP ),
+                     spin_count( 255 ), signaled( false ),
+                     sb_timer_active( false ) {}
+  void batch_send( const char *sub,  const char *rep,  rvmsg_Type type,
+                   size_t data_len,  const void *data ) noexcept;
+  void flush_sends( void ) noexcept;
+  void free_send_batch( bool free_timer ) noexcept;
+  void deliver( rv_Listener_api *l,  EvPublish &pub ) noexcept;
+  void match_wild( rv_TrieNode *n,  EvPublish &pub,  const char *p ) noexcept;
+  void deliver_vec( rv_Listener_api *l ) noexcept;
+  void deliver_vectors( void ) noexcept;
+  void sweep_closed( void ) noexcept;
+  void idle_wait( uint32_t idle_count ) noexcept;
   virtual void on_connect( EvSocket &conn ) noexcept;
   virtual void on_shutdown( EvSocket &conn,  const char *err,
                             size_t err_len ) noexcept;
@@ -193,17 +322,21 @@ rv_Session_api::on_shutdown( EvSocket &conn,  const char *err,
 }
 
 bool
-rv_Timer_api::timer_cb( uint64_t timer_id,  uint64_t event_id ) noexcept
+rv_Timer_api::wheel_fire( void ) noexcept
 {
   this->session.busy |= 2;
   if ( this->cb != NULL )
     this->cb( this, this->cl );
   this->session.busy &= ~2;
-  if ( this->cb == NULL ) {
-    delete this;
-    return false;
-  }
-  return true;
+  if ( this->session.busy == 0 && this->session.close_list != NULL )
+    this->session.sweep_closed();
+  return this->cb != NULL; /* destroyed, the wheel calls wheel_done() */
+}
+
+void
+rv_Timer_api::wheel_done( void ) noexcept
+{
+  delete this;
 }
 
 bool
@@ -213,36 +346,273 @@ rv_Session_api::on_rv_msg( EvPublish &pub ) noexcept
   this->busy |= 1;
   size_t i = pub.subj_hash & this->ht.mask;
   for ( l = this->ht.ht[ i ].hd; l != NULL; l = l->next ) {
-    if ( l->hash != pub.subj_hash || l->cb == NULL || l->wild != 0 ||
-         l->len != pub.subject_len ||
+    if ( l->hash != pub.subj_hash || ( l->cb == NULL && l->vcb == NULL ) ||
+         l->wild != 0 || l->len != pub.subject_len ||
          ::memcmp( l->subject, pub.subject, l->len ) != 0 )
       continue;
-    l->cb( l, pub.subject, (char *) pub.reply, pub.msg_enc, pub.msg_len,
-           (void *) pub.msg, l->cl );
+    this->deliver( l, pub );
   }
-  if ( this->wild_ht != NULL ) {
-    uint32_t val, pref;
-    size_t   pos;
-    for ( bool b = this->wild_ht->first( pos ); b;
-          b = this->wild_ht->next( pos ) ) {
-      this->wild_ht->get( pos, pref, val );
-      if ( pref - 1 >= pub.subject_len )
-        continue;
-      uint32_t h = kv_crc_c( pub.subject, pref - 1, pref );
-      i = h & this->ht.mask;
-      for ( l = this->ht.ht[ i ].hd; l != NULL; l = l->next ) {
-        if ( l->hash != h || l->cb == NULL || l->wild != pref ||
-             ! match_rv_wildcard( l->subject, l->len, pub.subject,
-                                  pub.subject_len ) )
-          continue;
-        l->cb( l, pub.subject, (char *) pub.reply, pub.msg_enc, pub.msg_len,
-               (void *) pub.msg, l->cl );
+  if ( this->trie.root.refs != 0 && pub.subject_len > 0 )
+    this->match_wild( &this->trie.root, pub, pub.subject );
+  this->busy &= ~1;
+  if ( this->busy == 0 && this->close_list != NULL )
+    this->sweep_closed();
+
+  return true;
+}
+
+/* Walk down the segments from p, NULL when all are matched */
+void
+rv_Session_api::match_wild( rv_TrieNode *n,  EvPublish &pub,
+                            const char *p ) noexcept
+{
+  const char      * end = &pub.subject[ pub.subject_len ];
+  rv_Listener_api * l;
+  for (;;) {
+    if ( p == NULL ) {
+      for ( l = n->end.hd; l != NULL; l = l->next )
+        if ( l->cb != NULL || l->vcb != NULL )
+          this->deliver( l, pub );
+      return;
+    }
+    const char * e   = (const char *) ::memchr( p, '.', end - p );
+    size_t       len = ( e == NULL ? end - p : e - p );
+    const char * nx  = ( e == NULL ? NULL : &e[ 1 ] );
+    /* '>' and '*' match any segment except an empty last one, as in
+     * match_rv_wildcard() */
+    if ( p < end ) {
+      for ( l = n->tail.hd; l != NULL; l = l->next )
+        if ( l->cb != NULL || l->vcb != NULL )
+          this->deliver( l, pub );
+      if ( n->star != NULL )
+        this->match_wild( n->star, pub, nx );
+    }
+    if ( (n = this->trie.find( n, p, len )) == NULL )
+      return;
+    p = nx;
+  }
+}
+
+/* Link l at the node of its last segment, making the path */
+void
+rv_Trie::add( rv_Listener_api *l ) noexcept
+{
+  const char  * p   = l->subject,
+              * end = &p[ l->len ];
+  rv_TrieNode * n   = &this->root;
+  for (;;) {
+    const char * e   = (const char *) ::memchr( p, '.', end - p );
+    size_t       len = ( e == NULL ? end - p : e - p );
+    if ( e == NULL && len == 1 && p[ 0 ] == '>' ) {
+      n->tail.push_tl( l );
+      break;
+    }
+    if ( len == 1 && p[ 0 ] == '*' ) {
+      if ( n->star == NULL )
+        n->star = this->make( n, p, 1, 0 );
+      n = n->star;
+    }
+    else {
+      rv_TrieNode * c = this->find( n, p, len );
+      if ( c == NULL ) {
+        if ( this->count >= this->mask )
+          this->resize();
+        c = this->make( n, p, len, kv_crc_c( p, len, n->id ) );
+        this->ht[ c->hash & this->mask ].push_tl( c );
+        this->count++;
       }
+      n = c;
+    }
+    if ( e == NULL ) {
+      n->end.push_tl( l );
+      break;
     }
+    p = &e[ 1 ];
+  }
+  n->refs++;
+  l->node = n;
+}
+
+/* Unlink l, then the nodes left without children or listeners */
+void
+rv_Trie::remove( rv_Listener_api *l ) noexcept
+{
+  rv_TrieNode * n = l->node;
+  if ( l->len > 0 && l->subject[ l->len - 1 ] == '>' &&
+       ( l->len == 1 || l->subject[ l->len - 2 ] == '.' ) )
+    n->tail.pop( l );
+  else
+    n->end.pop( l );
+  l->node = NULL;
+  while ( --n->refs == 0 && n != &this->root ) {
+    rv_TrieNode * p = n->parent;
+    if ( p->star == n )
+      p->star = NULL;
+    else {
+      this->ht[ n->hash & this->mask ].pop( n );
+      this->count--;
+    }
+    delete n;
+    n = p;
+  }
+}
+
+void
+rv_Session_api::deliver( rv_Listener_api *l,  EvPublish &pub ) noexcept
+{
+  if ( l->vcb == NULL ) {
+    l->cb( l, pub.subject, (char *) pub.reply, pub.msg_enc, pub.msg_len,
+           (void *) pub.msg, l->cl );
+    return;
+  }
+  /* copy, the read buffer is reused before the end of the poll */
+  if ( l->vec_cnt == l->vec_cap ) {
+    uint32_t n = ( l->vec_cap == 0 ? 16 : l->vec_cap * 2 );
+    l->vec     = (rv_Message *) ::realloc( l->vec, sizeof( l->vec[ 0 ] ) * n );
+    l->vec_cap = n;
+  }
+  rv_Message & m = l->vec[ l->vec_cnt++ ];
+  m.subject  = this->vec_mem.stralloc( pub.subject_len, pub.subject );
+  m.reply    = ( pub.reply_len == 0 ? NULL :
+               this->vec_mem.stralloc( pub.reply_len,
+                                       (const char *) pub.reply ) );
+  m.type     = pub.msg_enc;
+  m.data_len = pub.msg_len;
+  m.data     = this->vec_mem.make( pub.msg_len );
+  ::memcpy( m.data, pub.msg, pub.msg_len );
+  if ( ! l->in_vec ) {
+    l->in_vec   = true;
+    l->vec_next = this->vec_list;
+    this->vec_list = l;
+  }
+  if ( l->vec_cnt >= RV_VECTOR_MAX )
+    this->deliver_vec( l );
+}
+
+void
+rv_Session_api::deliver_vec( rv_Listener_api *l ) noexcept
+{
+  uint32_t cnt = l->vec_cnt;
+  l->vec_cnt = 0;
+  if ( cnt > 0 && l->vcb != NULL )
+    l->vcb( l, l->vec, cnt, l->cl );
+}
+
+/* End of a poll, each vector listener gets its msgs as one array */
+void
+rv_Session_api::deliver_vectors( void ) noexcept
+{
+  this->busy |= 1;
+  while ( this->vec_list != NULL ) {
+    rv_Listener_api * l = this->vec_list;
+    this->vec_list = l->vec_next;
+    l->vec_next    = NULL;
+    l->in_vec      = false;
+    this->deliver_vec( l );
   }
   this->busy &= ~1;
+  this->vec_mem.reuse();
+  if ( this->busy == 0 && this->close_list != NULL )
+    this->sweep_closed();
+}
 
-  return true;
+/* Free the listeners closed while the session was busy, except those still
+ * holding vector msgs, deliver_vectors() sweeps again after them */
+void
+rv_Session_api::sweep_closed( void ) noexcept
+{
+  rv_Listener_api ** pl = &this->close_list, * l;
+  while ( (l = *pl) != NULL ) {
+    if ( l->in_vec ) {
+      pl = &l->close_next;
+      continue;
+    }
+    *pl = l->close_next;
+    if ( l->wild != 0 )
+      this->trie.remove( l );
+    else
+      this->ht.remove( l );
+    delete l;
+  }
+}
+
+void
+rv_Session_api::batch_send( const char *sub,  const char *rep,
+                            rvmsg_Type type,  size_t data_len,
+                            const void *data ) noexcept
+{
+  SendBatch & b = *this->sb;
+  b.append( sub, ::strlen( sub ), rep, rep == NULL ? 0 : ::strlen( rep ),
+            data, data_len, this->client.sub_route, this->client,
+            type == RVMSG_RVMSG ? RVMSG_TYPE_ID : 0 );
+  if ( this->batch_size != 0 && b.bytes >= this->batch_size )
+    this->flush_sends();
+}
+
+/* Publish the batch, the client appends them all to one send buffer */
+void
+rv_Session_api::flush_sends( void ) noexcept
+{
+  SendBatch * b = this->sb;
+  if ( b == NULL || b->cnt == 0 )
+    return;
+  for ( uint32_t i = 0; i < b->cnt; i++ )
+    this->client.publish( b->pubs[ i ] );
+  b->reset();
+}
+
+/* Stop the flush timer and free the batch, at rv_Term or when batching is
+ * turned off */
+void
+rv_Session_api::free_send_batch( bool free_timer ) noexcept
+{
+  this->flush_sends();
+  if ( this->sb_timer_active ) {
+    this->poll.timer.remove_timer_cb( *this->sb_timer, 0, 0 );
+    this->sb_timer_active = false;
+  }
+  if ( free_timer && this->sb_timer != NULL ) {
+    delete this->sb_timer;
+    this->sb_timer = NULL;
+  }
+  if ( this->sb != NULL ) {
+    delete this->sb;
+    this->sb = NULL;
+  }
+}
+
+/* Periodic flush, the latency backstop for a batch under batch_size */
+static bool
+rv_batch_timer_cb( void *closure ) noexcept
+{
+  rv_Session_api * sess = (rv_Session_api *) closure;
+  sess->flush_sends();
+  return sess->sb_timer_active;
+}
+
+/* Wait after a poll, idle_count is the polls in a row that found no work */
+void
+rv_Session_api::idle_wait( uint32_t idle_count ) noexcept
+{
+  if ( idle_count <= this->spin_count || this->poll.quit != 0 ) {
+    this->poll.wait( 0 );
+    return;
+  }
+  switch ( this->idle_strategy ) {
+    case RV_IDLE_SPIN:
+      this->poll.wait( 0 );
+      break;
+    case RV_IDLE_YIELD:
+      ::sched_yield();
+      this->poll.wait( 0 );
+      break;
+    case RV_IDLE_BLOCK: /* timers are in the poll, signals write wake_fd */
+      this->poll.wait( this->wakeup != NULL ? -1 : 100 );
+      break;
+    default:
+      this->poll.wait( 100 );
+      break;
+  }
 }
 
 static rv_Session_list session_list;
@@ -254,7 +624,7 @@ rv_MainLoop( rv_Session session )
 {
   rv_Session_api & sess = *(rv_Session_api *) session;
   EvPoll &poll = sess.poll;
-  int idle_count = 0;
+  uint32_t idle_count = 0;
   for (;;) {
     /* loop 5 times before quiting, time to flush writes */
     if ( sess.signaled ) {
@@ -272,12 +642,14 @@ rv_MainLoop( rv_Session session )
       break;
     /* dispatch network events */
     int idle = poll.dispatch();
+    if ( sess.vec_list != NULL )
+      sess.deliver_vectors();
     if ( idle == EvPoll::DISPATCH_IDLE )
       idle_count++;
     else
       idle_count = 0; 
     /* wait for network events */
-    poll.wait( idle_count > 255 ? 100 : 0 );
+    sess.idle_wait( idle_count );
   }   
   return RV_OK;
 }
@@ -307,6 +679,11 @@ rv_signal_handler( int signum )
       if ( s->signo == signum )
         sess->signaled = s->signaled = true;
     }
+    if ( sess->signaled && sess->wake_fd >= 0 ) {
+      uint64_t one = 1;
+      ssize_t  n   = ::write( sess->wake_fd, &one, sizeof( one ) );
+      (void) n;
+    }
   }
 }
 #endif
@@ -373,8 +750,10 @@ rv_Status
 rv_Term( rv_Session session )
 {
   rv_Session_api *sess = (rv_Session_api *) session;
-  if ( sess != NULL )
+  if ( sess != NULL ) {
+    sess->free_send_batch( true );
     sess->client.idle_push( EV_SHUTDOWN );
+  }
   return RV_OK;
 }
 
@@ -391,21 +770,20 @@ rv_ListenSubject( rv_Session session, rv_Listener * listener,
   const char      * wild = is_rv_wildcard( subject, len );
   rv_Listener_api * l    = new ( ::malloc( sizeof( rv_Listener_api ) + len + 1 ) )
     rv_Listener_api( sess );
+  l->subject = (char *) &l[ 1 ];
+  l->len     = len;
+  l->cb      = callback;
+  l->cl      = closure;
+  ::memcpy( l->subject, subject, len + 1 );
   if ( wild != NULL ) {
     l->wild = &wild[ 1 ] - subject;
-    l->hash = kv_crc_c( subject, l->wild - 1, l->wild );
-    sess.add_wildcard( l->wild );
+    sess.trie.add( l );
   }
   else {
     l->wild = 0;
     l->hash = kv_crc_c( subject, len, 0 );
+    sess.ht.push( l );
   }
-  l->subject = (char *) &l[ 1 ];
-  l->len     = len;
-  l->cb      = callback;
-  l->cl      = closure;
-  ::memcpy( l->subject, subject, len + 1 );
-  sess.ht.push( l );
   if ( listener != NULL )
     *listener = l;
   sess.client.subscribe( subject, len, reply,
@@ -413,6 +791,24 @@ rv_ListenSubject( rv_Session session, rv_Listener * listener,
   return RV_OK;
 }
 
+rv_Status
+rv_ListenSubjectVector( rv_Session session, rv_Listener * listener,
+                        rv_Name subject, rv_VectorCallback callback,
+                        rv_Name reply,  void * closure )
+{
+  rv_Listener l;
+  rv_Status   status;
+  if ( callback == NULL )
+    return RV_NOT_PERMITTED;
+  status = rv_ListenSubject( session, &l, subject, NULL, reply, closure );
+  if ( status == RV_OK ) {
+    ((rv_Listener_api *) l)->vcb = callback;
+    if ( listener != NULL )
+      *listener = l;
+  }
+  return status;
+}
+
 rv_Status
 rv_ListenInbox( rv_Session session, rv_Listener * listener,
                 char *inbox_str,  size_t inbox_len,
@@ -443,20 +839,26 @@ rv_Status
 rv_Close( rv_Listener listener )
 {
   rv_Listener_api * l = (rv_Listener_api *) listener;
-  if ( l->cb != NULL ) {
+  if ( l->cb != NULL || l->vcb != NULL ) {
     rv_Session_api & sess = l->session;
-    l->cb = NULL;
+    l->cb  = NULL;
+    l->vcb = NULL;
 
     if ( l->len <= sizeof( "_INBOX." ) ||
          ::memcmp( l->subject, "_INBOX.", 7 ) != 0 )
       sess.client.unsubscribe( l->subject, l->len );
 
-    if ( sess.busy == 0 ) {
+    if ( sess.busy == 0 && ! l->in_vec ) {
       if ( l->wild != 0 )
-        sess.remove_wildcard( l->wild );
-      sess.ht.remove( l );
+        sess.trie.remove( l );
+      else
+        sess.ht.remove( l );
       delete l;
     }
+    else { /* freed by sweep_closed() */
+      l->close_next   = sess.close_list;
+      sess.close_list = l;
+    }
   }
   return RV_OK;
 }
@@ -473,6 +875,10 @@ rv_Send( rv_Session session, rv_Name subject,  rvmsg_Type type,
          size_t data_len, void * data )
 {
   rv_Session_api & sess = *(rv_Session_api *) session;
+  if ( sess.sb != NULL ) {
+    sess.batch_send( subject, NULL, type, data_len, data );
+    return RV_OK;
+  }
   EvPublish pub( subject, ::strlen( subject ), NULL, 0, data, data_len,
                  sess.client.sub_route, sess.client, 0,
                  type == RVMSG_RVMSG ? RVMSG_TYPE_ID : 0 );
@@ -485,6 +891,10 @@ rv_SendWithReply( rv_Session session, rv_Name subject, rv_Name reply,
                   rvmsg_Type type, size_t data_len, void * data )
 {
   rv_Session_api & sess = *(rv_Session_api *) session;
+  if ( sess.sb != NULL ) {
+    sess.batch_send( subject, reply, type, data_len, data );
+    return RV_OK;
+  }
   EvPublish pub( subject, ::strlen( subject ), reply, ::strlen( reply ), data,
                  data_len, sess.client.sub_route, sess.client, 0,
                  type == RVMSG_RVMSG ? RVMSG_TYPE_ID : 0 );
@@ -492,6 +902,70 @@ rv_SendWithReply( rv_Session session, rv_Name subject, rv_Name reply,
   return RV_OK;
 }
 
+rv_Status
+rv_SetSendBatch( rv_Session session, size_t batch_bytes, float ival_ms )
+{
+  rv_Session_api & sess = *(rv_Session_api *) session;
+  sess.batch_size = batch_bytes;
+  sess.batch_ival = ( ival_ms > 0 ? ival_ms / 1000.0 : 0 );
+  if ( batch_bytes == 0 && sess.batch_ival == 0 ) {
+    sess.free_send_batch( false );
+    return RV_OK;
+  }
+  sess.flush_sends();
+  if ( sess.sb_timer_active ) {
+    sess.poll.timer.remove_timer_cb( *sess.sb_timer, 0, 0 );
+    sess.sb_timer_active = false;
+  }
+  if ( sess.sb == NULL )
+    sess.sb = new ( ::malloc( sizeof( SendBatch ) ) ) SendBatch();
+  if ( sess.batch_ival > 0 ) {
+    if ( sess.sb_timer == NULL )
+      sess.sb_timer = new ( ::malloc( sizeof( SendBatchTimer ) ) )
+                      SendBatchTimer( rv_batch_timer_cb, &sess );
+    sess.sb_timer_active = true;
+    sess.poll.timer.add_timer_double( *sess.sb_timer, sess.batch_ival, 0, 0 );
+  }
+  return RV_OK;
+}
+
+rv_Status
+rv_SetIdleStrategy( rv_Session session, rv_IdleStrategy strategy,
+                    unsigned int spin_count )
+{
+  rv_Session_api & sess = *(rv_Session_api *) session;
+  if ( strategy < RV_IDLE_SLEEP || strategy > RV_IDLE_BLOCK )
+    return RV_NOT_PERMITTED;
+#if ! defined( _MSC_VER ) && ! defined( __MINGW32__ )
+  if ( strategy == RV_IDLE_BLOCK && sess.wakeup == NULL ) {
+    int fd = ::eventfd( 0, EFD_NONBLOCK | EFD_CLOEXEC );
+    if ( fd >= 0 ) {
+      rv_Wakeup * w = new ( aligned_malloc( sizeof( rv_Wakeup ) ) )
+                      rv_Wakeup( sess.poll );
+      if ( w->start( fd ) ) {
+        sess.wakeup  = w;
+        sess.wake_fd = fd;
+      }
+      else {
+        ::close( fd );
+        aligned_free( w );
+      }
+    }
+  }
+#endif
+  sess.idle_strategy = strategy;
+  sess.spin_count    = spin_count;
+  return RV_OK;
+}
+
+rv_Status
+rv_Flush( rv_Session session )
+{
+  rv_Session_api & sess = *(rv_Session_api *) session;
+  sess.flush_sends();
+  return RV_OK;
+}
+
 rv_Status
 rv_CreateTimer( rv_Session session, rv_Timer * timer, float ms,
                 rv_TimerCallback cb, void * closure )
@@ -502,8 +976,9 @@ rv_CreateTimer( rv_Session session, rv_Timer * timer, float ms,
 
   t->cb = cb;
   t->cl = closure;
-  TimerQueue & timer_q  = sess.client.poll.timer;
-  timer_q.add_timer_millis( *t, (uint64_t) ms, (size_t) (void *) t, 0 );
+  uint64_t ticks = sess.timers.ms_ticks( ms );
+  if ( sess.timers.arm( t, ticks, ticks ) )
+    sess.timers.start();
   if ( timer != NULL )
     *timer = t;
   return RV_OK;
@@ -515,10 +990,9 @@ rv_DestroyTimer( rv_Timer timer )
   rv_Timer_api * t = (rv_Timer_api *) timer;
   if ( t->cb != NULL ) {
     rv_Session_api & sess = t->session;
-    sess.client.poll.timer.remove_timer_cb( *t, (size_t) (void *) t, 0 );
-    t->cb = NULL;
-    if ( sess.busy == 0 )
-      delete t;
+    t->cb = NULL; /* freed by the wheel once unlinked */
+    if ( sess.timers.cancel( t ) )
+      sess.timers.start();
   }
   return RV_OK;
 }
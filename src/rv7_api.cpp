@@ -7,11 +7,15 @@
 #include <errno.h>
 #include <fcntl.h>
 #include <poll.h>
+#include <sched.h>
+#include <sys/prctl.h>
 
 #include <sassrv/ev_rv_client.h>
 #include <raikv/ev_publish.h>
 #include <sassrv/rv7api.h>
 #include <sassrv/mc.h>
+#include <sassrv/timer_wheel.h>
+#include <sassrv/send_batch.h>
 #include <sassrv/rv7cpp.h>
 
 namespace rv7 {
@@ -19,6 +23,15 @@ namespace rv7 {
 Tibrv_API * tibrv_api;
 int debug_api;
 
+static inline void
+spin_pause( void ) {
+#if defined( __x86_64__ ) || defined( __i386__ )
+  __builtin_ia32_pause();
+#elif defined( __aarch64__ )
+  __asm__ __volatile__( "yield" );
+#endif
+}
+
 static inline timespec
 ts_timeout( double timeout, double default_timeout = 0 ) {
   struct timespec ts;
@@ -50,75 +63,26 @@ api_Transport::on_connect( EvSocket &conn ) noexcept
     printf( "Connected: %.*s\n", len, conn.peer_address.buf );
   }
   pthread_mutex_lock( &this->mutex );
-  pthread_cond_broadcast( &this->cond );
-  pthread_mutex_unlock( &this->mutex );
-}
-
-void *
-tibrv_reconnect_thread( void *arg ) noexcept
-{
-  api_Transport & t = *(api_Transport *) arg;
-  pthread_cond_t wait_cond;
-  pthread_cond_init( &wait_cond, NULL );
-
-  for (;;) {
-    EvRvClientParameters parm( t.x.daemon, t.x.network, t.x.service );
-    parm.opts |= kv::OPT_CONNECT_NB;
-
-    EvPipeRec rec( OP_CREATE_TPORT, &t, &parm, &t.mutex, &t.cond );
-    struct timespec wait = ts_timeout( 1.0 ); /* pause 1 sec for reconnect */
-
-    pthread_mutex_lock( &t.mutex );
-    if ( pthread_cond_timedwait( &wait_cond, &t.mutex, &wait ) == ETIMEDOUT ) {
-      if ( ! t.is_destroyed )
-        t.api.ev_read->exec( rec );
-
-      if ( debug_api )
-        printf( "Reconnecting...\n" );
-      struct timespec ts = ts_timeout( 10.0 );
-      while ( ! t.is_destroyed  &&
-              t.client.rv_state > EvRvClient::ERR_CLOSE &&
-              t.client.rv_state < EvRvClient::DATA_RECV ) {
-        if ( pthread_cond_timedwait( &t.cond, &t.mutex, &ts ) == ETIMEDOUT ) {
-          EvPipeRec rec2( OP_CLOSE_TPORT, &t, &parm, &t.mutex, &t.cond );
-          t.api.ev_read->exec( rec2 );
-        }
-      }
-    }
-    if ( t.is_destroyed || t.client.rv_state == EvRvClient::DATA_RECV ) {
-      if ( debug_api )
-        printf( "Succussful reconnect...\n" );
-      break;
-    }
-    pthread_mutex_unlock( &t.mutex );
-  }
-  if ( t.client.rv_state == EvRvClient::DATA_RECV ) {
-    if ( t.x.session_len != t.client.session_len ||
-         ::memcmp( t.x.session, t.client.session, t.x.session_len ) != 0 ) {
+  if ( this->reconn.state != api_Reconnect::IDLE ) {
+    if ( debug_api )
+      printf( "Succussful reconnect...\n" );
+    if ( this->x.session_len != this->client.session_len ||
+         ::memcmp( this->x.session, this->client.session,
+                   this->x.session_len ) != 0 ) {
       fprintf( stderr, "Session different: %.*s (old) != %.*s (new)\n",
-              (int) t.x.session_len, t.x.session,
-              (int) t.client.session_len, t.client.session );
-      ::memcpy( t.x.session, t.client.session, t.client.session_len );
-      t.x.session_len = t.client.session_len;
-    }
-  }
-
-  if ( ! t.is_destroyed ) {
-    tibrvId max_id = t.api.next_id;
-    for ( tibrvId id = 0; ! t.is_destroyed && id < max_id; id++ ) {
-      api_Listener *l;
-      if ( (l = t.api.get<api_Listener>( id, TIBRV_LISTENER )) != NULL ) {
-        if ( l->tport == t.id &&
-             t.client.is_inbox( l->subject, l->len ) == 0 ) {
-          EvPipeRec rec( OP_SUBSCRIBE, &t, l, &t.mutex, &t.cond );
-          t.api.ev_read->exec( rec );
-        }
-      }
+              (int) this->x.session_len, this->x.session,
+              (int) this->client.session_len, this->client.session );
+      /* the sharers' sessions are under conn's, they move with it */
+      this->set_session();
+      for ( api_Transport * s = this->share_next; s != NULL; s = s->share_next )
+        s->set_session();
     }
-    t.reconnect_active = false;
+    this->stats.reconnects++;
+    this->replay_subs();
+    this->reconn.flush(); /* after the subs, replies to requests get here */
   }
-  pthread_mutex_unlock( &t.mutex );
-  return NULL;
+  pthread_cond_broadcast( &this->cond );
+  pthread_mutex_unlock( &this->mutex );
 }
 
 void
@@ -135,17 +99,251 @@ api_Transport::on_shutdown( EvSocket &conn,  const char *err,
   pthread_mutex_lock( &this->mutex );
   pthread_cond_broadcast( &this->cond );
 
-  if ( ! this->reconnect_active && this->x.session_len > 0 ) {
-    this->reconnect_active = true;
-    pthread_t id;
-    pthread_attr_t attr;
-    pthread_attr_init( &attr );
-    pthread_attr_setdetachstate( &attr, 1 );
-    pthread_create( &id, &attr, tibrv_reconnect_thread, this );
+  if ( this->conn_refs == 0 ) { /* destroyed, or never connected */
+    this->reconn.reset();
+    if ( this->aux_close ) { /* free it after the release of the socket */
+      this->aux_close = false;
+      EvPipeRec rec( OP_FREE_AUX, this, (EvRvClientParameters *) NULL,
+                     NULL, NULL );
+      this->pipe->post( rec );
+    }
   }
+  else if ( this->x.session_len > 0 )
+    this->reconn.schedule();
   pthread_mutex_unlock( &this->mutex );
 }
 
+/* After a reconnect, subscribe the listeners of every transport on the
+ * connection in one pass, each is appended to the send buffer and the daemon
+ * gets them as one stream; a lane has the listeners hashed to it */
+void
+api_Transport::replay_subs( void ) noexcept
+{
+  api_EpochGuard guard( this->api );
+  tibrvId max_slot = this->api.next_id;
+  for ( tibrvId slot = 0; slot < max_slot; slot++ ) {
+    api_Listener  * l;
+    api_Transport * lt;
+    tibrvId id = this->api.slot_id( slot );
+    if ( id != 0 &&
+         (l = this->api.get<api_Listener>( id, TIBRV_LISTENER )) != NULL &&
+         (lt = this->api.get<api_Transport>( l->tport,
+                                             TIBRV_TRANSPORT )) != NULL &&
+         ! lt->is_destroyed && (lt = lt->lane( l ))->conn == this &&
+         ! this->in_session( l->subject, l->len ) ) {
+      EvPipeRec rec( OP_SUBSCRIBE, lt, l, &this->mutex, &this->cond );
+      this->pipe->subscribe( rec ); /* already on the pipe thread */
+    }
+  }
+}
+
+/* The session of the connection, or a sharer's <conn session>.S<share_idx> */
+bool
+api_Transport::set_session( void ) noexcept
+{
+  EvRvClient & c = this->conn->client;
+  CatPtr p( this->x.session );
+  p.b( c.session, c.session_len );
+  if ( this != this->conn )
+    p.s( ".S" ).u( this->share_idx );
+  this->x.session_len = p.end();
+  return this->x.session_len > 0;
+}
+
+/* An inbox of this session: _INBOX.<session>.<...>; on conn it is true for
+ * the sharers' inboxes too, the daemon routes those without a subscription */
+bool
+api_Transport::in_session( const char *sub,  size_t sublen ) const noexcept
+{
+  size_t n = this->x.session_len;
+  return n > 0 && sublen > 7 + n + 1 &&
+         ::memcmp( sub, "_INBOX.", 7 ) == 0 &&
+         ::memcmp( &sub[ 7 ], this->x.session, n ) == 0 && sub[ 7 + n ] == '.';
+}
+
+/* _INBOX.<session>.<num>, returns the length */
+size_t
+api_Transport::make_inbox( char *inbox,  uint32_t num ) const noexcept
+{
+  CatPtr p( inbox );
+  p.s( "_INBOX." );
+  if ( this->x.session_len > 0 )
+    p.b( this->x.session, this->x.session_len ).c( '.' );
+  return p.u( num ).end();
+}
+
+/* Publish on the connection, while it is reconnecting the msg is kept */
+void
+api_Transport::send_pub( EvPublish &pub ) noexcept
+{
+  api_Transport * c = this->conn;
+  if ( c->reconn.state == api_Reconnect::IDLE )
+    c->client.publish( pub );
+  else if ( c->reconn.save( pub ) )
+    this->stats.msgs_buffered++;
+  else
+    this->stats.msgs_dropped++;
+}
+
+/* Arm the next attempt, the delay doubles up to max_ival and a random part of
+ * up to half spreads out the clients that lost the same daemon */
+void
+api_Reconnect::schedule( void ) noexcept
+{
+  tibrv_f64 ival = this->min_ival;
+  for ( uint32_t i = 0; i < this->attempt && ival < this->max_ival; i++ )
+    ival *= 2.0;
+  if ( ival > this->max_ival )
+    ival = this->max_ival;
+  if ( this->rand_state == 0 )
+    this->rand_state = ( current_monotonic_time_ns() ^
+                         ( (uint64_t) ::getpid() << 32 ) ^
+                         (uint64_t) (uintptr_t) this ) | 1;
+  uint64_t x = this->rand_state; /* xorshift64 */
+  x ^= x << 13;
+  x ^= x >> 7;
+  x ^= x << 17;
+  this->rand_state = x;
+  ival -= ival * 0.5 * ( (double) ( x >> 11 ) / 9007199254740992.0 );
+
+  if ( debug_api )
+    printf( "Reconnect in %.3f secs\n", ival );
+  this->attempt++;
+  this->state = WAIT;
+  this->t->poll.timer.add_timer_double( *this, ival, (uint64_t) this->t->id,
+                                        ++this->timer_gen );
+}
+
+/* Connect to the next daemon, the transport's own and then the alternates */
+bool
+api_Reconnect::connect( void ) noexcept
+{
+  api_Transport & tp  = *this->t;
+  api_Reconnect & cfg = ( tp.lane_of != NULL ? tp.lane_of->reconn : *this );
+  uint32_t        i   = ( this->attempt - 1 ) % ( cfg.ndaemons + 1 );
+  EvRvClientParameters parm( i == 0 ? tp.x.daemon : cfg.daemons[ i - 1 ],
+                             tp.x.network, tp.x.service );
+  parm.opts |= kv::OPT_CONNECT_NB;
+
+  if ( debug_api )
+    printf( "Reconnecting %s...\n",
+            parm.daemon != NULL ? parm.daemon : "(default)" );
+  tp.sub_refs.clear(); /* new session, listeners subscribe again */
+  tp.sub_gen++;
+  this->state = CONNECTING;
+  if ( ! tp.client.rv_connect( parm, &tp, &tp ) )
+    return false;
+  tp.poll.timer.add_timer_double( *this, RECONNECT_TIMEOUT, (uint64_t) tp.id,
+                                  ++this->timer_gen );
+  return true;
+}
+
+/* Backoff expired or connect timed out, a later reset() or schedule() makes
+ * an armed timer stale by moving timer_gen */
+bool
+api_Reconnect::timer_cb( uint64_t,  uint64_t event_id ) noexcept
+{
+  api_Transport & tp = *this->t;
+  pthread_mutex_lock( &tp.mutex );
+  if ( event_id == this->timer_gen ) {
+    if ( tp.conn_refs == 0 )
+      this->reset();
+    else if ( this->state == WAIT ) {
+      if ( ! this->connect() )
+        this->schedule();
+    }
+    else if ( this->state == CONNECTING ) {
+      if ( tp.client.in_list( IN_ACTIVE_LIST ) )
+        tp.client.idle_push( EV_CLOSE ); /* on_shutdown() schedules next */
+      else
+        this->schedule();
+    }
+  }
+  pthread_mutex_unlock( &tp.mutex );
+  return false;
+}
+
+struct api_SavedPub {
+  uint32_t msg_len,
+           msg_enc;
+  uint16_t sub_len,
+           rep_len;
+  size_t size( void ) const {
+    return ( sizeof( api_SavedPub ) + this->sub_len + this->rep_len +
+             this->msg_len + 7 ) & ~(size_t) 7;
+  }
+};
+
+/* Keep a publish made while down, false when over buf_limit */
+bool
+api_Reconnect::save( EvPublish &pub ) noexcept
+{
+  api_SavedPub h;
+  h.msg_len = pub.msg_len;
+  h.msg_enc = pub.msg_enc;
+  h.sub_len = pub.subject_len;
+  h.rep_len = pub.reply_len;
+  size_t sz = h.size();
+  if ( this->buf_len + sz > this->buf_limit )
+    return false;
+  if ( this->buf_len + sz > this->buf_size ) {
+    size_t n = this->buf_size * 2;
+    if ( n < this->buf_len + sz )
+      n = this->buf_len + sz;
+    if ( n < 4096 )
+      n = 4096;
+    if ( n > this->buf_limit )
+      n = this->buf_limit;
+    void * p = ::realloc( this->buf, n );
+    if ( p == NULL )
+      return false;
+    this->buf      = (uint8_t *) p;
+    this->buf_size = n;
+  }
+  uint8_t * p = &this->buf[ this->buf_len ];
+  ::memcpy( p, &h, sizeof( h ) );
+  p = &p[ sizeof( h ) ];
+  ::memcpy( p, pub.subject, h.sub_len );
+  p = &p[ h.sub_len ];
+  if ( h.rep_len > 0 )
+    ::memcpy( p, pub.reply, h.rep_len );
+  p = &p[ h.rep_len ];
+  ::memcpy( p, pub.msg, h.msg_len );
+  this->buf_len += sz;
+  return true;
+}
+
+/* Connected again, send the publishes kept while down */
+void
+api_Reconnect::flush( void ) noexcept
+{
+  api_Transport & tp = *this->t;
+  for ( size_t off = 0; off < this->buf_len; ) {
+    api_SavedPub h;
+    ::memcpy( &h, &this->buf[ off ], sizeof( h ) );
+    const char * sub = (const char *) &this->buf[ off + sizeof( h ) ],
+               * rep = &sub[ h.sub_len ];
+    EvPublish pub( sub, h.sub_len, rep, h.rep_len, &rep[ h.rep_len ],
+                   h.msg_len, tp.client.sub_route, *tp.me, 0, h.msg_enc );
+    tp.client.publish( pub );
+    off += h.size();
+  }
+  this->reset();
+}
+
+void
+api_Reconnect::reset( void ) noexcept
+{
+  if ( this->buf != NULL )
+    ::free( this->buf );
+  this->buf      = NULL;
+  this->buf_len  = 0;
+  this->buf_size = 0;
+  this->attempt  = 0;
+  this->state    = IDLE;
+  this->timer_gen++; /* an armed timer is stale */
+}
+
 void
 api_Transport::add_wildcard( uint16_t pref ) noexcept
 {
@@ -174,9 +372,56 @@ api_Transport::remove_wildcard( uint16_t pref ) noexcept
   }
 }
 
+/* Link l into ht, while dispatch_rv() walks ht and wild_ht it waits on
+ * add_pend, either may be resized (caller holds the mutex) */
+void
+api_Transport::add_listener( api_Listener *l ) noexcept
+{
+  if ( this->busy != 0 ) {
+    l->next = this->add_pend;
+    this->add_pend = l;
+    return;
+  }
+  if ( l->wild != 0 )
+    this->add_wildcard( l->wild );
+  this->ht.push( l );
+}
+
+/* Unlink l, false when a walk is busy, then it stays in ht with no callback
+ * until settle_listeners() unlinks and retires it */
+bool
+api_Transport::remove_listener( api_Listener *l ) noexcept
+{
+  if ( this->busy != 0 ) {
+    l->rem_next = this->rem_pend;
+    this->rem_pend = l;
+    return false;
+  }
+  if ( l->wild != 0 )
+    this->remove_wildcard( l->wild );
+  this->ht.remove( l );
+  return true;
+}
+
+/* The last walk ended, apply what inline callbacks changed during it */
+void
+api_Transport::settle_listeners( void ) noexcept
+{
+  api_Listener * l;
+  while ( (l = this->add_pend) != NULL ) {
+    this->add_pend = l->next;
+    this->add_listener( l );
+  }
+  while ( (l = this->rem_pend) != NULL ) {
+    this->rem_pend = l->rem_next;
+    this->remove_listener( l );
+    this->api.retire( l );
+  }
+}
+
 api_Msg *
-api_Msg::make( EvPublish &pub,  RvMsg *rvmsg,  MsgTether *tether,
-               tibrvEvent ev,  const void *cl ) noexcept
+api_Msg::make( EvPublish &pub,  RvMsg *rvmsg,  api_MsgData *data,
+               MsgTether *tether,  tibrvEvent ev,  const void *cl ) noexcept
 {
   void * p = NULL;
 
@@ -190,12 +435,30 @@ api_Msg::make( EvPublish &pub,  RvMsg *rvmsg,  MsgTether *tether,
       }
     }
   }
+  uint8_t * pool_buf  = NULL;
+  uint32_t  pool_size = 0;
   if ( p == NULL )
     p = ::malloc( sizeof( api_Msg ) );
+  else {
+    pool_buf  = ((api_Msg *) p)->pool_buf;
+    pool_size = ((api_Msg *) p)->pool_size;
+  }
   api_Msg * m   = new ( p ) api_Msg( ev );
-  size_t    len = rvmsg->msg_end - rvmsg->msg_off;
-  uint8_t * ptr = &((uint8_t *) rvmsg->msg_buf)[ rvmsg->msg_off ];
-  void    * buf = m->mem.memalloc( len, ptr );
+  m->pool_buf  = pool_buf;
+  m->pool_size = pool_size;
+  size_t    len;
+  void    * buf;
+  if ( data != NULL ) { /* sent by reference, no copy */
+    data->incref();
+    m->share = data;
+    len = data->len;
+    buf = data->buf;
+  }
+  else {
+    uint8_t * ptr = &((uint8_t *) rvmsg->msg_buf)[ rvmsg->msg_off ];
+    len = rvmsg->msg_end - rvmsg->msg_off;
+    buf = m->mem.memalloc( len, ptr );
+  }
   m->rvmsg       = RvMsg::unpack_rv( buf, 0, len, 0, NULL, m->mem );
   m->subject_len = pub.subject_len;
   m->subject     = m->mem.stralloc( pub.subject_len, pub.subject );
@@ -216,6 +479,11 @@ api_Msg::make( EvPublish &pub,  RvMsg *rvmsg,  MsgTether *tether,
 void *
 api_Msg::get_as_bytes( tibrv_u32 *size ) noexcept
 {
+  if ( this->share != NULL ) { /* not written since it was shared */
+    if ( size != NULL )
+      *size = this->share->len;
+    return this->share->buf;
+  }
   if ( this->wr_refs == this->rd_refs && this->rd != NULL ) {
     MDMsg &iter_msg = this->rd->iter->iter_msg();
     uint8_t * buf = (uint8_t *) iter_msg.msg_buf;
@@ -246,7 +514,7 @@ api_Msg::release( void ) noexcept
   while ( ! this->tether.is_empty() ) {
     api_Msg *m = this->tether.pop_tl();
     m->owner = NULL;
-    delete m;
+    api_Msg::recycle( m );
   }
   while ( ! this->refs.is_empty() ) {
     TibrvMsgRef * ref = this->refs.pop_hd();
@@ -258,7 +526,7 @@ api_Msg::release( void ) noexcept
 api_Msg *
 api_Msg::make_submsg( void ) noexcept
 {
-  api_Msg *m = new ( ::malloc( sizeof( api_Msg ) ) ) api_Msg( 0 );
+  api_Msg *m = api_Msg::alloc( 0 );
   pthread_mutex_lock( &this->tether.mutex );
   m->owner = &this->tether;
   this->tether.push_tl( m );
@@ -270,54 +538,348 @@ api_Msg::make_submsg( void ) noexcept
 api_Msg::~api_Msg() noexcept
 {
   this->release();
+  if ( this->share != NULL ) {
+    if ( this->share->buf == this->pool_buf )
+      this->pool_buf = NULL; /* freed with the last ref */
+    this->share->release();
+  }
+  if ( this->pool_buf != NULL )
+    ::free( this->pool_buf );
+}
+
+static const uint32_t API_MSG_CLASSES = 5;
+static const uint32_t api_msg_class_size[ API_MSG_CLASSES ] =
+  { 512, 2 * 1024, 8 * 1024, 32 * 1024, 128 * 1024 };
+uint32_t api_Msg::pool_max = 64; /* per class per thread, 0 = no pooling */
+
+static inline uint32_t
+msg_size_class( size_t sz )
+{
+  uint32_t cls = 0;
+  while ( cls < API_MSG_CLASSES && api_msg_class_size[ cls ] < sz )
+    cls++;
+  return cls;
+}
+
+namespace {
+struct api_MsgPool {
+  api_Msg * hd[ API_MSG_CLASSES ];
+  uint32_t  cnt[ API_MSG_CLASSES ];
+  uint64_t  hits,
+            misses,
+            allocs;
+  api_MsgPool() : hits( 0 ), misses( 0 ), allocs( 0 ) {
+    for ( uint32_t i = 0; i < API_MSG_CLASSES; i++ ) {
+      this->hd[ i ]  = NULL;
+      this->cnt[ i ] = 0;
+    }
+  }
+  ~api_MsgPool() {
+    for ( uint32_t i = 0; i < API_MSG_CLASSES; i++ ) {
+      while ( this->hd[ i ] != NULL ) {
+        api_Msg * m = this->hd[ i ];
+        this->hd[ i ] = m->next;
+        delete m;
+      }
+      this->cnt[ i ] = 0;
+    }
+  }
+};
+static thread_local api_MsgPool tls_msg_pool;
+}
+
+api_Msg *
+api_Msg::alloc( size_t initial ) noexcept
+{
+  api_MsgPool & pool = tls_msg_pool;
+  uint32_t cls = msg_size_class( initial + 8 ), i;
+  api_Msg * m;
+  /* any pooled msg with a buffer at least as large as needed */
+  for ( i = cls; i < API_MSG_CLASSES; i++ ) {
+    if ( (m = pool.hd[ i ]) != NULL ) {
+      pool.hd[ i ] = m->next;
+      pool.cnt[ i ]--;
+      pool.hits++;
+      uint8_t * pool_buf  = m->pool_buf;
+      uint32_t  pool_size = m->pool_size;
+      m = new ( m ) api_Msg( 0 );
+      m->pool_buf   = pool_buf;
+      m->pool_size  = pool_size;
+      m->wr.buf     = pool_buf;
+      m->wr.buflen  = pool_size;
+      return m;
+    }
+  }
+  pool.misses++;
+  pool.allocs += 2;
+  m = new ( ::malloc( sizeof( api_Msg ) ) ) api_Msg( 0 );
+  m->pool_size = ( cls < API_MSG_CLASSES ? api_msg_class_size[ cls ] :
+                   (uint32_t) ( initial + 8 ) );
+  m->pool_buf  = (uint8_t *) ::malloc( m->pool_size );
+  m->wr.buf    = m->pool_buf;
+  m->wr.buflen = m->pool_size;
+  return m;
 }
 
+void
+api_Msg::recycle( api_Msg *m ) noexcept
+{
+  api_MsgPool & pool = tls_msg_pool;
+  if ( m->share != NULL )
+    m->unshare( false );
+  uint32_t cls = msg_size_class( m->pool_size );
+  /* grew out of its buffer, the next user of this shell likely will too */
+  if ( m->wr.buf != m->pool_buf && m->wr.off > m->pool_size ) {
+    uint32_t cls2 = msg_size_class( m->wr.off );
+    if ( cls2 < API_MSG_CLASSES && ( cls >= API_MSG_CLASSES || cls2 > cls ) ) {
+      if ( m->pool_buf != NULL )
+        ::free( m->pool_buf );
+      m->pool_size = api_msg_class_size[ cls2 ];
+      m->pool_buf  = (uint8_t *) ::malloc( m->pool_size );
+      pool.allocs++;
+      cls = cls2;
+    }
+  }
+  if ( cls >= API_MSG_CLASSES || api_msg_class_size[ cls ] != m->pool_size ||
+       pool.cnt[ cls ] >= api_Msg::pool_max ) {
+    delete m;
+    return;
+  }
+  m->reset();
+  m->next = pool.hd[ cls ];
+  pool.hd[ cls ] = m;
+  pool.cnt[ cls ]++;
+}
+
+void
+api_Msg::pool_stats( uint64_t &hits,  uint64_t &misses,
+                     uint64_t &allocs ) noexcept
+{
+  api_MsgPool & pool = tls_msg_pool;
+  hits   = pool.hits;
+  misses = pool.misses;
+  allocs = pool.allocs;
+}
+
+/* make room for add more bytes without the writer growing in mem */
 bool
-api_Transport::on_rv_msg( EvPublish &pub ) noexcept
+api_Msg::reserve( size_t add ) noexcept
 {
-  if ( this == this->api.process_tport )
-    this->client.msg_in.mem.reuse();
-  RvMsg * rvmsg = this->client.make_rv_msg( (void *) pub.msg, pub.msg_len,
-                                            pub.msg_enc );
-  if ( rvmsg == NULL )
+  if ( this->share != NULL )
+    this->unshare( true );
+  size_t used = ( this->wr.buf == NULL ? 0 : this->wr.off );
+  if ( this->wr.buf != NULL && this->wr.buflen - used >= add )
     return true;
+  size_t   need = ( used < 8 ? 8 : used ) + add;
+  uint32_t cls  = msg_size_class( need );
+  uint32_t sz   = ( cls < API_MSG_CLASSES ? api_msg_class_size[ cls ] :
+                    (uint32_t) need );
+  uint8_t * buf = (uint8_t *) ::malloc( sz );
+  if ( buf == NULL )
+    return false;
+  tls_msg_pool.allocs++;
+  if ( used > 0 )
+    ::memcpy( buf, this->wr.buf, used );
+  if ( this->pool_buf != NULL )
+    ::free( this->pool_buf );
+  this->pool_buf   = buf;
+  this->pool_size  = sz;
+  this->wr.buf     = buf;
+  this->wr.buflen  = sz;
+  this->rd         = NULL; /* may point at the old buffer */
+  this->fidx       = NULL;
+  return true;
+}
+
+api_MsgData *
+api_MsgData::copy( const void *data,  uint32_t len ) noexcept
+{
+  api_MsgData * d = (api_MsgData *) ::malloc( sizeof( api_MsgData ) + len );
+  d->refs = 1;
+  d->len  = len;
+  d->buf  = (uint8_t *) &d[ 1 ];
+  ::memcpy( d->buf, data, len );
+  return d;
+}
+
+void
+api_MsgData::release( void ) noexcept
+{
+  if ( __atomic_sub_fetch( &this->refs, 1, __ATOMIC_ACQ_REL ) == 0 ) {
+    if ( this->buf != (uint8_t *) &this[ 1 ] ) /* lent pool_buf */
+      ::free( this->buf );
+    ::free( this );
+  }
+}
+
+/* Data of the message for a send by reference, the caller holds a ref.  When
+ * the data is all in pool_buf, the buffer is lent to the receivers and the
+ * next write copies it (unshare), otherwise the data is copied once */
+api_MsgData *
+api_Msg::share_data( void ) noexcept
+{
+  api_MsgData * d = this->share;
+  if ( d == NULL ) {
+    tibrv_u32 len;
+    void    * data = this->get_as_bytes( &len );
+    if ( data != this->pool_buf || this->pool_buf == NULL || this->base_out )
+      return api_MsgData::copy( data, len );
+    d = (api_MsgData *) ::malloc( sizeof( api_MsgData ) );
+    d->refs = 1;
+    d->len  = len;
+    d->buf  = this->pool_buf;
+    this->share = d;
+  }
+  d->incref();
+  return d;
+}
+
+/* Drop the shared data before a write (copy) or a reset.  A sender that is
+ * still lending pool_buf moves to a new one, a receiver copies into mem */
+void
+api_Msg::unshare( bool copy ) noexcept
+{
+  api_MsgData * d = this->share;
+  this->share = NULL;
+  if ( d->buf == this->pool_buf ) {
+    if ( d->only_ref() ) { /* receivers are done, keep the buffer */
+      ::free( d );
+      return;
+    }
+    uint8_t * buf = (uint8_t *) ::malloc( this->pool_size );
+    tls_msg_pool.allocs++;
+    if ( copy && this->wr.buf == this->pool_buf )
+      ::memcpy( buf, this->pool_buf, this->wr.off );
+    if ( this->wr.buf == this->pool_buf )
+      this->wr.buf = buf;
+    this->pool_buf = buf;
+  }
+  else if ( copy && this->rvmsg != NULL ) {
+    void * buf = this->mem.memalloc( d->len, d->buf );
+    this->rvmsg = RvMsg::unpack_rv( buf, 0, d->len, 0, NULL, this->mem );
+  }
+  this->rd   = NULL; /* may point at the shared data */
+  this->fidx = NULL;
+  d->release();
+}
+
+bool
+api_Transport::on_rv_msg( EvPublish &pub ) noexcept
+{
+  api_EpochGuard guard( this->api ); /* inline callbacks may retire objects */
+  api_MsgData * data  = NULL;
+  RvMsg       * rvmsg = NULL;
+  if ( this->send_data != NULL && pub.msg == this->send_data->buf )
+    data = this->send_data; /* process tport send by reference, no decode */
+  else {
+    /* a send from an inline callback nests here, the outer msg is live */
+    if ( this == this->api.process_tport && this->rv_depth == 0 )
+      this->client.msg_in.mem.reuse();
+    rvmsg = this->client.make_rv_msg( (void *) pub.msg, pub.msg_len,
+                                      pub.msg_enc );
+    if ( rvmsg == NULL )
+      return true;
+  }
+  this->rv_depth++;
+  pthread_mutex_lock( &this->mutex );
+  api_Transport * to = NULL, /* an inbox goes to the session it is in */
+                * s  = this->share_next;
+  if ( s != NULL && this->in_session( pub.subject, pub.subject_len ) ) {
+    to = this;
+    for ( ; s != NULL; s = s->share_next ) {
+      if ( s->in_session( pub.subject, pub.subject_len ) ) {
+        to = s;
+        break;
+      }
+    }
+    s = this->share_next;
+  }
+  pthread_mutex_unlock( &this->mutex );
+  /* not under the mutex, inline callbacks run in dispatch_rv(); the shares
+   * are stepped locked, transports are not freed and an unlinked one still
+   * links to the rest */
+  if ( to == NULL || to == this )
+    this->dispatch_rv( pub, rvmsg, data );
+  while ( s != NULL ) {
+    if ( to == NULL || to == s )
+      s->dispatch_rv( pub, rvmsg, data );
+    pthread_mutex_lock( &this->mutex );
+    s = s->share_next;
+    pthread_mutex_unlock( &this->mutex );
+  }
+  this->rv_depth--;
+  return true;
+}
+
+/* Append l to the inline listeners of a walk, grown in mem */
+static inline void
+add_inline( api_Listener **&inl,  size_t &n,  size_t &max,  MDMsgMem &mem,
+            api_Listener *l )
+{
+  if ( n == max ) {
+    api_Listener ** p = (api_Listener **) mem.make( sizeof( p[ 0 ] ) * max * 2 );
+    ::memcpy( p, inl, sizeof( p[ 0 ] ) * n );
+    inl  = p;
+    max *= 2;
+  }
+  inl[ n++ ] = l;
+}
+
+/* Match the message to the requests and listeners of this transport, the
+ * connection owner calls it for each transport sharing it.  Listeners of
+ * inline queues are collected in the walk and run after the mutex is
+ * released, so a callback may call any API function, including a
+ * SendRequest() answered on another I/O thread */
+void
+api_Transport::dispatch_rv( EvPublish &pub,  RvMsg *rvmsg,
+                            api_MsgData *data ) noexcept
+{
   api_Listener * l;
   pthread_mutex_lock( &this->mutex );
-  for ( api_Rpc *r = this->rpc_list.hd; r != NULL; r = r->next ) {
-    if ( r->hash == pub.subj_hash &&
-         r->len == pub.subject_len &&
-         ::memcmp( r->subject, pub.subject, r->len ) == 0 ) {
+  if ( this->is_destroyed ) {
+    pthread_mutex_unlock( &this->mutex );
+    return;
+  }
+  this->stats.msgs_in++;
+  this->stats.bytes_in += pub.msg_len;
+  api_Rpc * r = this->rpc_ht.find( pub.subject, pub.subject_len,
+                                   pub.subj_hash );
+  if ( r != NULL ) {
+    if ( r->cb == NULL ) { /* SendRequest() waiting on cond */
       if ( r->reply == NULL ) /* multiple replies ? */
-        r->reply = api_Msg::make( pub, rvmsg, NULL, this->id, NULL );
+        r->reply = api_Msg::make( pub, rvmsg, data, NULL, this->id, NULL );
       pthread_cond_broadcast( &this->cond );
-      pthread_mutex_unlock( &this->mutex );
-      return true;
     }
+    else { /* SendRequestAsync(), first reply completes it */
+      this->rpc_ht.remove( r );
+      if ( r->expire_tick != 0 )
+        this->rpc_wheel->remove( r );
+      this->push_rpc( r, &pub, rvmsg, data );
+      delete r;
+    }
+    pthread_mutex_unlock( &this->mutex );
+    return;
   }
-  size_t i;
+  api_Listener * next,
+               * inl_buf[ 8 ],  /* listeners of inline queues */
+              ** inl  = inl_buf;
+  RvMsg        * fmsg = rvmsg; /* decoded for filters when by reference */
+  MDMsgMem       fmem;         /* a nested send reuses client.msg_in.mem */
+  size_t i, n_inl = 0, max_inl = 8;
+  this->busy++;
   if ( this->ht.ht != NULL ) {
     i = pub.subj_hash & this->ht.mask;
-    for ( l = this->ht.ht[ i ].hd; l != NULL; l = l->next ) {
+    for ( l = this->ht.ht[ i ].hd; l != NULL; l = next ) {
+      next = l->next;
       if ( l->hash != pub.subj_hash || l->wild != 0 ||
+           ( l->cb == NULL && l->vcb == NULL ) ||
            l->len != pub.subject_len ||
            ::memcmp( l->subject, pub.subject, l->len ) != 0 )
         continue;
-      api_Queue * q = this->api.get<api_Queue>( l->queue, TIBRV_QUEUE );
-      if ( q != NULL ) {
-        api_QueueGroup * g = NULL;
-        pthread_mutex_lock( &q->mutex );
-        if ( q->push( l->id, l->cb, l->vcb, l->cl,
-                      api_Msg::make( pub, rvmsg, &q->tether, l->id, l->cl ) ) ) {
-          if ( (g = q->grp) == NULL )
-            pthread_cond_broadcast( &q->cond );
-        }
-        pthread_mutex_unlock( &q->mutex );
-        if ( g != NULL ) {
-          pthread_mutex_lock( &g->mutex );
-          pthread_cond_broadcast( &g->cond );
-          pthread_mutex_unlock( &g->mutex );
-        }
-      }
+      if ( l->filter != NULL && ! this->filter( l, fmsg, fmem, data ) )
+        continue;
+      if ( this->deliver( l, pub, rvmsg, data ) )
+        add_inline( inl, n_inl, max_inl, fmem, l );
     }
   }
   if ( this->wild_ht != NULL ) {
@@ -330,43 +892,162 @@ api_Transport::on_rv_msg( EvPublish &pub ) noexcept
         continue;
       uint32_t h = kv_crc_c( pub.subject, pref - 1, pref );
       i = h & this->ht.mask;
-      for ( l = this->ht.ht[ i ].hd; l != NULL; l = l->next ) {
+      for ( l = this->ht.ht[ i ].hd; l != NULL; l = next ) {
+        next = l->next;
         if ( l->hash != h || l->wild != pref ||
+             ( l->cb == NULL && l->vcb == NULL ) ||
              ! match_rv_wildcard( l->subject, l->len, pub.subject,
                                   pub.subject_len ) )
           continue;
-        api_Queue * q = this->api.get<api_Queue>( l->queue, TIBRV_QUEUE );
-        if ( q != NULL ) {
-          api_QueueGroup * g = NULL;
-          pthread_mutex_lock( &q->mutex );
-          if ( q->push( l->id, l->cb, l->vcb, l->cl,
-                   api_Msg::make( pub, rvmsg, &q->tether, l->id, l->cl ) ) ) {
-            if ( (g = q->grp) == NULL )
-              pthread_cond_broadcast( &q->cond );
-          }
-          pthread_mutex_unlock( &q->mutex );
-          if ( g != NULL ) {
-            pthread_mutex_lock( &g->mutex );
-            pthread_cond_broadcast( &g->cond );
-            pthread_mutex_unlock( &g->mutex );
-          }
-        }
+        if ( l->filter != NULL && ! this->filter( l, fmsg, fmem, data ) )
+          continue;
+        if ( this->deliver( l, pub, rvmsg, data ) )
+          add_inline( inl, n_inl, max_inl, fmem, l );
       }
     }
   }
+  if ( --this->busy == 0 &&
+       ( this->add_pend != NULL || this->rem_pend != NULL ) )
+    this->settle_listeners();
   pthread_mutex_unlock( &this->mutex );
+  /* a destroyed l is retired, on_rv_msg() holds the epoch */
+  for ( i = 0; i < n_inl; i++ )
+    this->deliver_inline( inl[ i ], pub, rvmsg, data );
+}
 
-  return true;
+/* Test the content filter of l before anything is made or queued, the
+ * message sent by reference is decoded once into fmem, on the first filter */
+bool
+api_Transport::filter( api_Listener *l,  RvMsg *&fmsg,  MDMsgMem &fmem,
+                       api_MsgData *data ) noexcept
+{
+  if ( fmsg == NULL )
+    fmsg = RvMsg::unpack_rv( data->buf, 0, data->len, 0, NULL, fmem );
+  if ( fmsg != NULL && l->filter->match( *fmsg ) )
+    return true;
+  this->stats.msgs_filtered++;
+  return false;
+}
+
+/* Queue a message for listener l, true when the queue is inline, then the
+ * caller runs it with deliver_inline() (caller holds the transport mutex) */
+bool
+api_Transport::deliver( api_Listener *l,  EvPublish &pub,  RvMsg *rvmsg,
+                        api_MsgData *data ) noexcept
+{
+  api_Queue * q = this->api.get<api_Queue>( l->queue, TIBRV_QUEUE );
+  if ( q == NULL || l->cb == NULL && l->vcb == NULL )
+    return false;
+  if ( q->inline_dispatch )
+    return true;
+  api_QueueGroup * g = NULL;
+  pthread_mutex_lock( &q->mutex );
+  if ( q->push( l->id, l->cb, l->vcb, l->cl,
+                api_Msg::make( pub, rvmsg, data, &q->tether, l->id,
+                               l->cl ) ) ) {
+    if ( (g = q->grp) == NULL )
+      pthread_cond_broadcast( &q->cond );
+  }
+  pthread_mutex_unlock( &q->mutex );
+  if ( g != NULL ) {
+    pthread_mutex_lock( &g->mutex );
+    pthread_cond_broadcast( &g->cond );
+    pthread_mutex_unlock( &g->mutex );
+  }
+  return false;
+}
+
+/* Run the callback of l now, on E without the transport mutex; l is checked
+ * again, a callback before it may have destroyed it */
+void
+api_Transport::deliver_inline( api_Listener *l,  EvPublish &pub,
+                               RvMsg *rvmsg,  api_MsgData *data ) noexcept
+{
+  api_Queue * q = this->api.get<api_Queue>( l->queue, TIBRV_QUEUE );
+  if ( q == NULL || l->cb == NULL && l->vcb == NULL )
+    return;
+  TibrvQueueEvent ev( this->api, l->id, l->cb, l->vcb, l->cl,
+                      api_Msg::make( pub, rvmsg, data, &q->tether, l->id,
+                                     l->cl ) );
+  q->count_inline( 1 );
+  ev.dispatch();
+}
+
+/* Deliver an async request completion to its queue, pub is NULL on timeout
+ * (caller holds the transport mutex) */
+void
+api_Transport::push_rpc( api_Rpc *r,  EvPublish *pub,  RvMsg *rvmsg,
+                         api_MsgData *data ) noexcept
+{
+  api_Queue * q = this->api.get<api_Queue>( r->queue, TIBRV_QUEUE );
+  if ( q == NULL || q->done )
+    return;
+  api_QueueGroup * g = NULL;
+  api_Msg        * m = NULL;
+  pthread_mutex_lock( &q->mutex );
+  if ( pub != NULL )
+    m = api_Msg::make( *pub, rvmsg, data, &q->tether, this->id, r->cl );
+  if ( q->push( this->id, r->cb, NULL, r->cl, m ) ) {
+    if ( (g = q->grp) == NULL )
+      pthread_cond_broadcast( &q->cond );
+  }
+  pthread_mutex_unlock( &q->mutex );
+  if ( g != NULL ) {
+    pthread_mutex_lock( &g->mutex );
+    pthread_cond_broadcast( &g->cond );
+    pthread_mutex_unlock( &g->mutex );
+  }
+}
+
+/* Expire the slots passed since the last tick, stops when nothing pending */
+bool
+api_RpcWheel::timer_cb( uint64_t,  uint64_t ) noexcept
+{
+  api_Transport & tp  = *this->t;
+  uint64_t        now = current_tick();
+  pthread_mutex_lock( &tp.mutex );
+  uint64_t tick = this->last_tick;
+  if ( now - tick > RPC_WHEEL_SIZE )
+    tick = now - RPC_WHEEL_SIZE;
+  while ( tick < now && this->count > 0 ) {
+    api_Rpc * next;
+    tick++;
+    for ( api_Rpc * r = this->slot[ tick & ( RPC_WHEEL_SIZE - 1 ) ]; r != NULL;
+          r = next ) {
+      next = r->wnext;
+      if ( r->expire_tick > now )
+        continue;
+      this->remove( r );
+      tp.rpc_ht.remove( r );
+      tp.push_rpc( r, NULL, NULL, NULL );
+      delete r;
+    }
+  }
+  this->last_tick = now;
+  if ( this->count == 0 )
+    this->active = false;
+  bool b = this->active;
+  pthread_mutex_unlock( &tp.mutex );
+  return b;
 }
 
+/* Expired on the wheel, a destroy cancels it through the wheel, which calls
+ * wheel_done() after it is unlinked */
 bool
-api_Timer::timer_cb( uint64_t /*timer_id*/,  uint64_t /*event_id*/ ) noexcept
+api_Timer::wheel_fire( void ) noexcept
 {
   if ( this->cb == NULL )
     return false;
   if ( this->in_queue )
     return true;
   api_Queue * q = this->api.get<api_Queue>( this->queue, TIBRV_QUEUE );
+  if ( q != NULL && q->inline_dispatch ) {
+    this->in_queue = true;
+    q->count_inline( 1 );
+    this->cb( this->id, NULL, (void *) this->cl );
+    this->in_queue = false;
+    return this->cb != NULL;
+  }
   if ( q != NULL ) {
     api_QueueGroup * g = NULL;
     pthread_mutex_lock( &q->mutex );
@@ -386,20 +1067,74 @@ api_Timer::timer_cb( uint64_t /*timer_id*/,  uint64_t /*event_id*/ ) noexcept
   return false;
 }
 
-void *
-tibrv_epoll_thread( void *arg ) noexcept
+void
+api_Timer::wheel_done( void ) noexcept
+{
+  this->api.retire( this );
+}
+
+/* The pipe of the I/O thread this is, EvPipe ops requested from it (inline
+ * callbacks) run directly instead of through the pipe */
+static thread_local EvPipe * tls_io_pipe = NULL;
+
+/* Idle polls in a row an I/O thread spins, then yields, before it blocks in
+ * epoll; other threads reach it only through its pipe, a write wakes it and
+ * the poll timers are in epoll too */
+static const int IO_SPIN_POLLS  = 64,
+                 IO_YIELD_POLLS = 128;
+
+static void
+tibrv_io_loop( EvPoll &poll,  EvPipe *pipe,  int cpu ) noexcept
 {
-  Tibrv_API & api = *(Tibrv_API *) arg;
-  EvPoll &poll = api.poll;
   int idle_count = 0;
+  tls_io_pipe = pipe;
+  if ( cpu >= 0 ) {
+    cpu_set_t set;
+    CPU_ZERO( &set );
+    CPU_SET( cpu, &set );
+    pthread_setaffinity_np( pthread_self(), sizeof( set ), &set );
+  }
   for (;;) {
     int idle = poll.dispatch();
-    if ( idle == EvPoll::DISPATCH_IDLE )
+    if ( idle != EvPoll::DISPATCH_IDLE )
+      idle_count = 0;
+    else if ( idle_count < IO_YIELD_POLLS )
       idle_count++;
-    else
-      idle_count = 0; 
-    poll.wait( idle_count > 10 ? 100 : 0 );
+    if ( idle_count < IO_SPIN_POLLS )
+      poll.wait( 0 );
+    else if ( idle_count < IO_YIELD_POLLS ) {
+      ::sched_yield();
+      poll.wait( 0 );
+    }
+    else {
+      poll.wait( -1 );
+    }
   }
+}
+
+void *
+tibrv_epoll_thread( void *arg ) noexcept
+{
+  Tibrv_API & api = *(Tibrv_API *) arg;
+  tibrv_io_loop( api.poll, api.ev_read, api.io_cpu[ 0 ] );
+  return NULL;
+}
+
+struct api_IoStart {
+  Tibrv_API & api;
+  uint32_t    k;
+};
+
+void *
+tibrv_io_thread( void *arg ) noexcept
+{
+  api_IoStart  * x   = (api_IoStart *) arg;
+  Tibrv_API    & api = x->api;
+  uint32_t       k   = x->k;
+  ::free( x );
+  if ( k == API_FT_IO ) /* FAST_HB timerfd, default slack is 50us */
+    prctl( PR_SET_TIMERSLACK, 1UL, 0, 0, 0 );
+  tibrv_io_loop( api.io_thr[ k ]->poll, api.io_thr[ k ]->pipe, api.io_cpu[ k ] );
   return NULL;
 }
 
@@ -437,12 +1172,105 @@ tibrv_disp_group_thread( void *arg ) noexcept
   return NULL;
 }
 
+void *
+tibrv_disp_pool_worker( void *arg ) noexcept
+{
+  api_DispatchPool & pool = *(api_DispatchPool *) arg;
+  uint32_t w;
+  uint64_t gen = 0;
+  pthread_mutex_lock( &pool.mutex );
+  for ( w = 1; w < pool.nthreads; w++ ) /* worker number from thread slot */
+    if ( pthread_equal( pool.thr[ w ], pthread_self() ) )
+      break;
+  for (;;) {
+    while ( gen == pool.gen && ! pool.quit )
+      pthread_cond_wait( &pool.start_cond, &pool.mutex );
+    if ( pool.quit )
+      break;
+    gen = pool.gen;
+    pthread_mutex_unlock( &pool.mutex );
+
+    pool.run_batch( w );
+
+    pthread_mutex_lock( &pool.mutex );
+    if ( --pool.running == 0 )
+      pthread_cond_broadcast( &pool.done_cond );
+  }
+  pthread_mutex_unlock( &pool.mutex );
+  return NULL;
+}
+
+void *
+tibrv_disp_pool_thread( void *arg ) noexcept
+{
+  api_Dispatcher   & disp = *(api_Dispatcher *) arg;
+  api_DispatchPool & pool = *disp.pool;
+  tibrv_f64 t =
+    ( disp.idle_timeout == TIBRV_WAIT_FOREVER ? 10.0 : disp.idle_timeout );
+  while ( ! disp.quit ) {
+    if ( disp.api.TimedDispatchPool( disp, t ) == TIBRV_INVALID_QUEUE )
+      break;
+  }
+  pthread_mutex_lock( &pool.mutex );
+  pool.quit = true;
+  pthread_cond_broadcast( &pool.start_cond );
+  pthread_mutex_unlock( &pool.mutex );
+  for ( uint32_t w = 1; w < pool.nthreads; w++ )
+    pthread_join( pool.thr[ w ], NULL );
+
+  pthread_mutex_lock( &disp.mutex );
+  disp.done = true;
+  pthread_cond_broadcast( &disp.cond );
+  pthread_mutex_unlock( &disp.mutex );
+  return NULL;
+}
+
+/* Partition key, vector events carry several subjects so they go by listener */
+uint32_t
+api_DispatchPool::key( TibrvQueueEvent *e ) const noexcept
+{
+  if ( this->mode == TIBRV_DISPATCH_BY_SUBJECT && e->msg != NULL &&
+       e->cnt == 1 ) {
+    api_Msg * m = e->msg;
+    return kv_crc_c( m->subject, m->subject_len, 0 );
+  }
+  return kv_crc_c( &e->id, sizeof( e->id ), 0 );
+}
+
+void
+api_DispatchPool::run_part( uint32_t p ) noexcept
+{
+  api_DispatchPart & x = this->part[ p ];
+  if ( x.list.is_empty() ||
+       ! __sync_bool_compare_and_swap( &x.claimed, 0, 1 ) )
+    return;
+  this->queue->dispatch_list( x.list );
+}
+
+/* Own partitions first, then steal the ones not yet claimed */
+void
+api_DispatchPool::run_batch( uint32_t w ) noexcept
+{
+  uint32_t p;
+  for ( p = w; p < this->nparts; p += this->nthreads )
+    this->run_part( p );
+  for ( p = 0; p < this->nparts; p++ )
+    this->run_part( ( p + w ) % this->nparts );
+}
+
 void
 EvPipe::exec( EvPipeRec &rec ) noexcept
 {
+  if ( tls_io_pipe == this ) { /* already on the owner thread, no hand-off */
+    (this->*rec.func)( rec );
+    return;
+  }
+  if ( tls_io_pipe != NULL && this->post_nowait( rec ) )
+    return;
   uint8_t * p = (uint8_t *) &rec,
           * e = &p[ sizeof( EvPipeRec ) ];
   bool      complete = false;
+  uint64_t  start    = current_monotonic_time_ns();
   rec.complete = &complete;
   for (;;) {
     int n = ::write( this->write_fd, p, e - p );
@@ -457,6 +1285,51 @@ EvPipe::exec( EvPipeRec &rec ) noexcept
   while ( ! *rec.complete )
     pthread_cond_wait( rec.cond, rec.mutex );
   rec.complete = NULL;
+  if ( rec.t != NULL )
+    rec.t->pipe_rtt( current_monotonic_time_ns() - start );
+}
+
+void
+EvPipe::post( EvPipeRec &rec ) noexcept
+{
+  uint8_t * p = (uint8_t *) &rec,
+          * e = &p[ sizeof( EvPipeRec ) ];
+  rec.complete = NULL;
+  for (;;) {
+    int n = ::write( this->write_fd, p, e - p );
+    if ( n > 0 ) {
+      p += n;
+      if ( p == e )
+        break;
+    }
+    struct pollfd fds = { this->write_fd, POLLOUT, POLLOUT };
+    ::poll( &fds, 1, 10 );
+  }
+}
+
+/* An inline callback on another I/O thread must not wait for this one, which
+ * may be waiting for that thread the same way while it holds a transport
+ * mutex.  Sends are copied and posted, drains posted, false for the rest */
+bool
+EvPipe::post_nowait( EvPipeRec &rec ) noexcept
+{
+  if ( rec.func == OP_TPORT_DRAIN || rec.func == OP_RING_DRAIN ) {
+    this->post( rec );
+    return true;
+  }
+  if ( rec.func != OP_TPORT_SEND && rec.func != OP_TPORT_SENDV )
+    return false;
+  for ( tibrv_u32 i = 0; i < rec.cnt; i++ ) {
+    EvPublish & pub  = rec.pub[ i ];
+    size_t      need = sizeof( api_RingRec ) + pub.subject_len + 1 +
+                       pub.reply_len + 1 + pub.msg_len;
+    api_RingRec * r  = (api_RingRec *) ::malloc( need );
+    r->set( (uint32_t) need, pub.subject, pub.subject_len,
+            (const char *) pub.reply, pub.reply_len, pub.msg, pub.msg_len );
+    EvPipeRec op( OP_TPORT_POST, rec.t, r );
+    this->post( op );
+  }
+  return true;
 }
 
 bool
@@ -478,7 +1351,12 @@ EvPipe::process( void ) noexcept
     EvPipeRec rec;
     ::memcpy( &rec, &this->recv[ this->off ], sizeof( EvPipeRec ) );
     this->off += sizeof( EvPipeRec );
+    /* sends queued in rings go out before any op posted after them */
+    if ( this->rings != NULL )
+      this->drain_rings();
     (this->*rec.func)( rec );
+    if ( rec.complete == NULL ) /* posted, no one waiting */
+      continue;
     pthread_mutex_lock( rec.mutex );
     *rec.complete = true;
     pthread_cond_broadcast( rec.cond );
@@ -530,6 +1408,7 @@ TibrvQueueEvent::dispatch( void ) noexcept
     if ( this->msg != NULL )
       this->release( this->msg );
     else {
+      api_EpochGuard guard( this->api );
       api_Timer *t = this->api.get<api_Timer>( this->id, TIBRV_TIMER );
       if ( t != NULL )
         t->in_queue = false;
@@ -552,6 +1431,15 @@ api_Queue::push( tibrvId id,  tibrvEventCallback cb,
                  tibrvEventVectorCallback vcb,
                  const void *cl,  api_Msg *msg ) noexcept
 {
+  uint32_t h     = 0;
+  bool     cflat = false;
+  this->stats.enqueued++;
+  if ( this->policy == TIBRVQUEUE_CONFLATE_BY_SUBJECT && msg != NULL ) {
+    h = kv_crc_c( msg->subject, msg->subject_len, msg->event );
+    if ( this->conflate( h, msg ) )
+      return false;
+    cflat = true;
+  }
   if ( vcb != NULL && ! this->list.is_empty() && id == this->list.tl->id ) {
     TibrvQueueEvent * e = this->list.tl;
     if ( e->cnt == 1 ) {
@@ -569,17 +1457,238 @@ api_Queue::push( tibrvId id,  tibrvEventCallback cb,
       }
       e->vec[ e->cnt++ ] = msg;
     }
+    if ( cflat )
+      this->cidx.insert( h, e, e->cnt - 1 );
   }
   else {
-    this->list.push_tl(
+    TibrvQueueEvent * e =
       new ( this->mem_x[ this->mptr ].make( sizeof( TibrvQueueEvent ) ) )
-        TibrvQueueEvent( this->api, id, cb, vcb, cl, msg ) );
-    if ( this->count++ == 0 )
+        TibrvQueueEvent( this->api, id, cb, vcb, cl, msg );
+    e->stamp = current_monotonic_time_ns();
+    this->list.push_tl( e );
+    if ( cflat )
+      this->cidx.insert( h, e, 0 );
+    if ( this->count >= this->stats.max_depth )
+      this->stats.max_depth = this->count + 1;
+    if ( this->count++ == 0 ) {
+      if ( this->spinning != 0 ) /* consumer polls count, no wake needed */
+        return false;
+      if ( this->grp != NULL ) {
+        /* order count++ before reading the group flag, the group consumer
+         * clears it and then rescans the counts without this mutex */
+        __atomic_thread_fence( __ATOMIC_SEQ_CST );
+        if ( __atomic_load_n( &this->grp->spinning, __ATOMIC_RELAXED ) != 0 )
+          return false;
+      }
       return true;
+    }
   }
   return false;
 }
 
+/* A msg of a listener and subject that is waiting is replaced by msg, which
+ * takes its place in the queue and counts the msgs it replaced */
+bool
+api_Queue::conflate( uint32_t h,  api_Msg *msg ) noexcept
+{
+  api_ConflateEntry * x = this->cidx.find( h, msg );
+  if ( x == NULL )
+    return false;
+  api_Msg *& m = x->msg();
+  msg->conflated = m->conflated + 1;
+  TibrvQueueEvent::release( m );
+  m = msg;
+  this->stats.conflated++;
+  return true;
+}
+
+/* Take every event for dispatch (caller holds the mutex) */
+void
+api_Queue::take_list( TibrvQueueEventList &list ) noexcept
+{
+  list = this->list;
+  this->list.init();
+  this->mptr = ( this->mptr + 1 ) % 2;
+  this->mem_x[ this->mptr ].reuse();
+  this->count = 0;
+  this->cidx.clear();
+}
+
+/* Take the first event for dispatch (caller holds the mutex) */
+TibrvQueueEvent *
+api_Queue::take_one( void ) noexcept
+{
+  TibrvQueueEvent * ev = this->list.pop_hd();
+  this->count--;
+  if ( this->list.is_empty() ) {
+    this->mptr = ( this->mptr + 1 ) % 2;
+    this->mem_x[ this->mptr ].reuse();
+    this->cidx.clear();
+  }
+  else if ( this->cidx.count != 0 && ev->msg != NULL ) {
+    for ( tibrv_u32 i = 0; i < ev->cnt; i++ ) {
+      api_Msg * m = ( ev->cnt == 1 ? ev->msg : ev->vec[ i ] );
+      this->cidx.remove( kv_crc_c( m->subject, m->subject_len, m->event ),
+                         m );
+    }
+  }
+  return ev;
+}
+
+static inline bool
+conflate_match( const api_Msg *x,  const api_Msg *m )
+{
+  return x->event == m->event && x->subject_len == m->subject_len &&
+         ::memcmp( x->subject, m->subject, m->subject_len ) == 0;
+}
+
+api_ConflateEntry *
+api_ConflateIndex::find( uint32_t h,  const api_Msg *m ) noexcept
+{
+  if ( this->count == 0 )
+    return NULL;
+  for ( uint32_t i = h & this->mask; ; i = ( i + 1 ) & this->mask ) {
+    api_ConflateEntry & x = this->tab[ i ];
+    if ( x.e == NULL )
+      return NULL;
+    if ( x.hash == h && conflate_match( x.msg(), m ) )
+      return &x;
+  }
+}
+
+void
+api_ConflateIndex::insert( uint32_t h,  TibrvQueueEvent *e,
+                           uint32_t idx ) noexcept
+{
+  if ( ( this->count + 1 ) * 2 > this->mask + 1 )
+    this->resize();
+  uint32_t i = h & this->mask;
+  while ( this->tab[ i ].e != NULL )
+    i = ( i + 1 ) & this->mask;
+  this->tab[ i ].e    = e;
+  this->tab[ i ].hash = h;
+  this->tab[ i ].idx  = idx;
+  this->count++;
+}
+
+/* Linear probe delete, entries after the hole move back to it when their
+ * home slot is not between the hole and where they are */
+void
+api_ConflateIndex::remove( uint32_t h,  const api_Msg *m ) noexcept
+{
+  api_ConflateEntry * x = this->find( h, m );
+  if ( x == NULL )
+    return;
+  uint32_t i = (uint32_t) ( x - this->tab ),
+           j = i;
+  for (;;) {
+    this->tab[ i ].e = NULL;
+    for (;;) {
+      j = ( j + 1 ) & this->mask;
+      if ( this->tab[ j ].e == NULL ) {
+        this->count--;
+        return;
+      }
+      uint32_t k = this->tab[ j ].hash & this->mask;
+      if ( ( i <= j ) ? ( i < k && k <= j ) : ( i < k || k <= j ) )
+        continue;
+      break;
+    }
+    this->tab[ i ] = this->tab[ j ];
+    i = j;
+  }
+}
+
+void
+api_ConflateIndex::resize( void ) noexcept
+{
+  api_ConflateEntry * old = this->tab;
+  uint32_t            n   = ( old == NULL ? 0 : this->mask + 1 ),
+                      sz  = ( n == 0 ? 64 : n * 2 );
+  this->tab   = (api_ConflateEntry *) ::calloc( sz, sizeof( this->tab[ 0 ] ) );
+  this->mask  = sz - 1;
+  this->count = 0;
+  for ( uint32_t i = 0; i < n; i++ ) {
+    if ( old[ i ].e != NULL )
+      this->insert( old[ i ].hash, old[ i ].e, old[ i ].idx );
+  }
+  if ( old != NULL )
+    ::free( old );
+}
+
+/* Dispatch a batch taken from the queue, the time after each callback is the
+ * dispatch time of the next event */
+void
+api_Queue::dispatch_list( TibrvQueueEventList &list ) noexcept
+{
+  api_DispatchStats st;
+  uint64_t          now = current_monotonic_time_ns();
+  while ( ! list.is_empty() ) {
+    TibrvQueueEvent * e = list.pop_hd();
+    st.add( *e, now );
+    e->dispatch();
+    now = current_monotonic_time_ns();
+  }
+  st.fold( this->stats );
+}
+
+/* Inline dispatch has no queue wait */
+void
+api_Queue::count_inline( uint32_t cnt ) noexcept
+{
+  __atomic_fetch_add( &this->stats.enqueued, cnt, __ATOMIC_RELAXED );
+  __atomic_fetch_add( &this->stats.dispatched, cnt, __ATOMIC_RELAXED );
+  __atomic_fetch_add( &this->stats.delay_events, 1, __ATOMIC_RELAXED );
+  __atomic_fetch_add( &this->stats.delay_hist[ 0 ], 1, __ATOMIC_RELAXED );
+}
+
+static void
+stats_max( tibrv_u64 &max,  uint64_t val ) noexcept
+{
+  uint64_t cur = __atomic_load_n( &max, __ATOMIC_RELAXED );
+  while ( val > cur &&
+          ! __atomic_compare_exchange_n( &max, &cur, val, true,
+                                         __ATOMIC_RELAXED, __ATOMIC_RELAXED ) )
+    ;
+}
+
+void
+api_DispatchStats::fold( tibrvQueueStats &st ) const noexcept
+{
+  if ( this->events == 0 )
+    return;
+  __atomic_fetch_add( &st.dispatched, this->msgs, __ATOMIC_RELAXED );
+  __atomic_fetch_add( &st.delay_events, this->events, __ATOMIC_RELAXED );
+  __atomic_fetch_add( &st.delay_ns, this->delay, __ATOMIC_RELAXED );
+  stats_max( st.delay_max_ns, this->delay_max );
+  for ( uint32_t i = 0; i < TIBRV_STATS_HIST_SIZE; i++ ) {
+    if ( this->hist[ i ] != 0 )
+      __atomic_fetch_add( &st.delay_hist[ i ], this->hist[ i ],
+                          __ATOMIC_RELAXED );
+  }
+}
+
+/* Caller thread of EvPipe::exec(), several at once */
+void
+api_Transport::pipe_rtt( uint64_t ns ) noexcept
+{
+  __atomic_fetch_add( &this->stats.pipe_ops, 1, __ATOMIC_RELAXED );
+  __atomic_fetch_add( &this->stats.pipe_rtt_ns, ns, __ATOMIC_RELAXED );
+  stats_max( this->stats.pipe_rtt_max_ns, ns );
+  __atomic_fetch_add( &this->stats.pipe_rtt_hist[ api_hist_bucket( ns / 1000 ) ],
+                      1, __ATOMIC_RELAXED );
+}
+
+/* Copy counters that other threads are adding to */
+static void
+stats_load( void *dest,  const void *src,  size_t size ) noexcept
+{
+  tibrv_u64       * d = (tibrv_u64 *) dest;
+  const tibrv_u64 * s = (const tibrv_u64 *) src;
+  for ( size_t i = 0; i < size / sizeof( tibrv_u64 ); i++ )
+    d[ i ] = __atomic_load_n( &s[ i ], __ATOMIC_RELAXED );
+}
+
 bool api_Transport::on_msg( kv::EvPublish &pub ) noexcept
 {
   this->on_rv_msg( pub );
@@ -635,8 +1744,90 @@ Tibrv_API::Open( void ) noexcept
   pthread_attr_t attr;
   pthread_attr_init( &attr );
   pthread_attr_setdetachstate( &attr, 1 );
-  pthread_create( &id, &attr, tibrv_epoll_thread, this );
-  return TIBRV_OK;
+  pthread_create( &id, &attr, tibrv_epoll_thread, this );
+  for ( uint32_t k = 1; k < this->io_count; k++ ) {
+    if ( ! this->start_io( k ) ) {
+      this->io_count = k;
+      break;
+    }
+  }
+  return TIBRV_OK;
+}
+
+/* Destroy the transports still open, which closes their lanes; aux conns of
+ * FT members close with the member */
+void
+Tibrv_API::Close( void ) noexcept
+{
+  api_EpochGuard guard( *this );
+  tibrvId max_slot = this->next_id;
+  for ( tibrvId slot = 0; slot < max_slot; slot++ ) {
+    tibrvId         id = this->slot_id( slot );
+    api_Transport * t;
+    if ( id != 0 && id != TIBRV_PROCESS_TRANSPORT &&
+         (t = this->get<api_Transport>( id, TIBRV_TRANSPORT )) != NULL &&
+         t->lane_of == NULL && ! t->is_destroyed )
+      this->DestroyTransport( id );
+  }
+}
+
+/* Start I/O thread k >= 1 with its own poll and pipe */
+bool
+Tibrv_API::start_io( uint32_t k ) noexcept
+{
+  api_IoThread * io = new ( aligned_malloc( sizeof( api_IoThread ) ) )
+                      api_IoThread();
+  if ( pipe2( io->pfd, O_CLOEXEC ) != 0 ) {
+    aligned_free( io );
+    return false;
+  }
+  fcntl( io->pfd[ 0 ], F_SETFL, O_NONBLOCK |
+         fcntl( io->pfd[ 0 ], F_GETFL ) );
+  io->poll.init( 128, false );
+  io->pipe = new ( aligned_malloc( sizeof( EvPipe ) ) )
+             EvPipe( io->poll, io->pfd[ 1 ] );
+  io->pipe->start( io->pfd[ 0 ], "tibrv_io_pipe" );
+  this->io_thr[ k ] = io;
+
+  api_IoStart * x = (api_IoStart *) ::malloc( sizeof( api_IoStart ) );
+  new ( x ) api_IoStart{ *this, k };
+  pthread_t id;
+  pthread_attr_t attr;
+  pthread_attr_init( &attr );
+  pthread_attr_setdetachstate( &attr, 1 );
+  pthread_create( &id, &attr, tibrv_io_thread, x );
+  return true;
+}
+
+/* Start the FT heartbeat thread once, it is not in io_count so io_assign()
+ * only puts the conns opened with open_aux( .., API_FT_IO ) there */
+bool
+Tibrv_API::start_ft_io( void ) noexcept
+{
+  bool ok = true;
+  pthread_mutex_lock( &this->map_mutex );
+  if ( this->io_thr[ API_FT_IO ] == NULL )
+    ok = this->start_io( API_FT_IO );
+  pthread_mutex_unlock( &this->map_mutex );
+  return ok;
+}
+
+/* The I/O thread open_aux() asks for, read by io_assign() in make<> */
+static thread_local uint32_t tls_io_pin = 0;
+
+/* Pick the I/O thread with the fewest transports, called from make<> under
+ * map_mutex; the process transport stays with its listeners on thread 0 */
+uint32_t
+Tibrv_API::io_assign( tibrvId id ) noexcept
+{
+  uint32_t k = tls_io_pin;
+  if ( k == 0 && id != TIBRV_PROCESS_TRANSPORT ) {
+    for ( uint32_t j = 1; j < this->io_count; j++ )
+      if ( this->io_load[ j ] < this->io_load[ k ] )
+        k = j;
+  }
+  __atomic_fetch_add( &this->io_load[ k ], 1, __ATOMIC_RELAXED );
+  return k;
 }
 
 tibrv_status
@@ -645,6 +1836,7 @@ Tibrv_API::CreateListener( tibrvEvent * event,  tibrvQueue queue,
                           tibrvEventVectorCallback vcb,
                           const char * subj,  const void * closure ) noexcept
 {
+  api_EpochGuard guard( *this );
   size_t len  = ( subj == NULL ? 0 : ::strlen( subj ) );
   *event = TIBRV_INVALID_ID;
   if ( len == 0 || ::strstr( subj, ".." ) != NULL ||
@@ -673,15 +1865,14 @@ Tibrv_API::CreateListener( tibrvEvent * event,  tibrvQueue queue,
   l->tport   = tport;
   ::memcpy( l->subject, subj, len + 1 );
 
-  pthread_mutex_lock( &t->mutex );
-  if ( wild != NULL )
-    t->add_wildcard( l->wild );
-  t->ht.push( l );
-  if ( t->client.is_inbox( l->subject, l->len ) == 0 ) {
-    EvPipeRec rec( OP_SUBSCRIBE, t, l, &t->mutex, &t->cond );
-    this->ev_read->exec( rec );
+  api_Transport * lt = t->lane( l ); /* t, or the lane of the subject */
+  pthread_mutex_lock( &lt->mutex );
+  lt->add_listener( l );
+  if ( ! t->conn->in_session( l->subject, l->len ) ) {
+    EvPipeRec rec( OP_SUBSCRIBE, lt, l, &lt->mutex, &lt->cond );
+    lt->pipe->exec( rec );
   }
-  pthread_mutex_unlock( &t->mutex );
+  pthread_mutex_unlock( &lt->mutex );
 
   *event = l->id;
   return TIBRV_OK;
@@ -693,8 +1884,14 @@ EvPipe::subscribe( EvPipeRec &rec ) noexcept
   const char * sub = rec.l->subject;
   size_t       len = rec.l->len;
 
-  if ( rec.t->id != TIBRV_PROCESS_TRANSPORT )
-    rec.t->client.subscribe( sub, len, NULL, 0 );
+  if ( rec.t->id != TIBRV_PROCESS_TRANSPORT ) {
+    api_Transport * c = rec.t->conn; /* listens are counted per connection */
+    if ( rec.l->sub_gen != c->sub_gen ) {
+      rec.l->sub_gen = c->sub_gen;
+      if ( c->sub_refs.ref( sub, (uint16_t) len ) )
+        c->client.subscribe( sub, len, NULL, 0 );
+    }
+  }
   else {
     kv::RoutePublish & sub_route = rec.t->client.sub_route;
     if ( ! is_rv_wildcard( sub, len ) ) {
@@ -720,6 +1917,7 @@ Tibrv_API::CreateTimer( tibrvEvent * event,  tibrvQueue queue,
                         tibrvEventCallback cb,  tibrv_f64 ival,
                         const void * closure ) noexcept
 {
+  api_EpochGuard guard( *this );
   *event = TIBRV_INVALID_ID;
   api_Queue * q = this->get<api_Queue>( queue, TIBRV_QUEUE );
   if ( q == NULL ) return TIBRV_INVALID_QUEUE;
@@ -729,26 +1927,35 @@ Tibrv_API::CreateTimer( tibrvEvent * event,  tibrvQueue queue,
   t->cl    = closure;
   t->ival  = ival;
 
-  EvPipeRec rec( OP_CREATE_TIMER, t, &q->mutex, &q->cond );
-  pthread_mutex_lock( &q->mutex );
-  this->ev_read->exec( rec );
-  pthread_mutex_unlock( &q->mutex );
-
   *event = t->id;
+  uint64_t ticks = this->timers.ms_ticks( ival * 1000.0 );
+  if ( this->timers.arm( t, ticks, ticks ) )
+    this->wake_timers();
   return TIBRV_OK;
 }
 
+/* The wheel stopped ticking when it emptied, restart it on E */
+void
+Tibrv_API::wake_timers( void ) noexcept
+{
+  if ( tls_io_pipe == this->ev_read )
+    this->timers.start();
+  else {
+    EvPipeRec rec( OP_START_TIMERS, (api_Timer *) NULL, NULL, NULL );
+    this->ev_read->post( rec );
+  }
+}
+
 void
-EvPipe::create_timer( EvPipeRec &rec ) noexcept
+EvPipe::start_timers( EvPipeRec & ) noexcept
 {
-  TimerQueue & timer_q = this->poll.timer;
-  api_Timer * t = rec.timer;
-  timer_q.add_timer_double( *t, t->ival, t->id, 0 );
+  tibrv_api->timers.start();
 }
 
 tibrv_status
 Tibrv_API::DestroyEvent( tibrvEvent event,  tibrvEventOnComplete cb ) noexcept
 {
+  api_EpochGuard guard( *this );
   tibrv_u32 type;
   if ( tibrvEvent_GetType( event, &type ) == TIBRV_OK ) {
     bool ok = true;
@@ -757,15 +1964,9 @@ Tibrv_API::DestroyEvent( tibrvEvent event,  tibrvEventOnComplete cb ) noexcept
         api_Timer * t = this->rem<api_Timer>( event, TIBRV_TIMER );
         if ( t == NULL )
           break;
-        api_Queue * q = this->get<api_Queue>( t->queue, TIBRV_QUEUE );
-        t->cb = NULL;
-        if ( q != NULL ) {
-          EvPipeRec rec( OP_DESTROY_TIMER, t, &q->mutex, &q->cond );
-          pthread_mutex_lock( &q->mutex );
-          this->ev_read->exec( rec );
-          pthread_mutex_unlock( &q->mutex );
-        }
-        delete t;
+        t->cb = NULL; /* retired by the wheel once unlinked */
+        if ( this->timers.cancel( t ) )
+          this->wake_timers();
         break;
       }
       case TIBRV_LISTENER: {
@@ -773,18 +1974,21 @@ Tibrv_API::DestroyEvent( tibrvEvent event,  tibrvEventOnComplete cb ) noexcept
         if ( l == NULL )
           break;
         api_Transport * t = this->get<api_Transport>( l->tport, TIBRV_TRANSPORT );
-        l->cb = NULL;
+        bool unlinked = true;
+        l->cb  = NULL;
+        l->vcb = NULL;
         if ( t != NULL ) {
+          bool ibx = t->conn->in_session( l->subject, l->len );
+          t = t->lane( l );
           EvPipeRec rec( OP_UNSUBSCRIBE, t, l, &t->mutex, &t->cond );
           pthread_mutex_lock( &t->mutex );
-          if ( t->client.is_inbox( l->subject, l->len ) == 0 )
-            this->ev_read->exec( rec );
-          if ( l->wild != 0 )
-            t->remove_wildcard( l->wild );
-          t->ht.remove( l );
+          if ( ! ibx )
+            t->pipe->exec( rec );
+          unlinked = t->remove_listener( l ); /* or after the walk */
           pthread_mutex_unlock( &t->mutex );
         }
-        delete l;
+        if ( unlinked )
+          this->retire( l );
         break;
       }
       case TIBRV_QUEUE:
@@ -804,21 +2008,19 @@ Tibrv_API::DestroyEvent( tibrvEvent event,  tibrvEventOnComplete cb ) noexcept
   return TIBRV_INVALID_EVENT;
 }
 
-void
-EvPipe::destroy_timer( EvPipeRec &rec ) noexcept
-{
-  TimerQueue & timer_q = this->poll.timer;
-  api_Timer * t = rec.timer;
-  timer_q.remove_timer_cb( *t, t->id, 0 );
-}
-
 void
 EvPipe::unsubscribe( EvPipeRec &rec ) noexcept
 {
   const char * sub = rec.l->subject;
   size_t       len = rec.l->len;
-  if ( rec.t->id != TIBRV_PROCESS_TRANSPORT )
-    rec.t->client.unsubscribe( rec.l->subject, rec.l->len );
+  if ( rec.t->id != TIBRV_PROCESS_TRANSPORT ) {
+    api_Transport * c = rec.t->conn;
+    if ( rec.l->sub_gen == c->sub_gen ) {
+      rec.l->sub_gen = 0;
+      if ( c->sub_refs.deref( sub, (uint16_t) len ) )
+        c->client.unsubscribe( sub, len );
+    }
+  }
   else {
     kv::RoutePublish & sub_route = rec.t->client.sub_route;
     if ( ! is_rv_wildcard( sub, len ) ) {
@@ -839,16 +2041,89 @@ EvPipe::unsubscribe( EvPipeRec &rec ) noexcept
   }
 }
 
+/* Thread's epoch record, linked into epoch_list on first use and left there
+ * (inactive) when the thread exits */
+api_EpochRec &
+Tibrv_API::epoch_rec( void ) noexcept
+{
+  static thread_local api_EpochRec * tls_rec;
+  if ( tls_rec == NULL ) {
+    api_EpochRec * r = (api_EpochRec *) ::calloc( 1, sizeof( api_EpochRec ) );
+    pthread_mutex_lock( &this->map_mutex );
+    r->next = this->epoch_list;
+    __atomic_store_n( &this->epoch_list, r, __ATOMIC_RELEASE );
+    pthread_mutex_unlock( &this->map_mutex );
+    tls_rec = r;
+  }
+  return *tls_rec;
+}
+
+/* Defer the free of an object removed with rem<> until no guard that could
+ * have found it is still active */
+void
+Tibrv_API::retire_ptr( void *p,  void (*fn)( void * ) ) noexcept
+{
+  api_Retired * r = (api_Retired *) ::malloc( sizeof( api_Retired ) ),
+              * next;
+  pthread_mutex_lock( &this->map_mutex );
+  r->ptr     = p;
+  r->free_fn = fn;
+  r->epoch   = this->epoch;
+  r->next    = this->limbo;
+  this->limbo = r;
+  r = this->reclaim();
+  pthread_mutex_unlock( &this->map_mutex );
+  for ( ; r != NULL; r = next ) {
+    next = r->next;
+    r->free_fn( r->ptr );
+    ::free( r );
+  }
+}
+
+/* Advance the epoch if every active thread has seen it, return the retired
+ * objects two epochs old, called with map_mutex held */
+api_Retired *
+Tibrv_API::reclaim( void ) noexcept
+{
+  __atomic_thread_fence( __ATOMIC_SEQ_CST ); /* unmap before reading active */
+  for ( int i = 0; i < 2; i++ ) {
+    uint64_t e = this->epoch;
+    api_EpochRec * rec;
+    for ( rec = this->epoch_list; rec != NULL; rec = rec->next ) {
+      uint64_t a = __atomic_load_n( &rec->active, __ATOMIC_ACQUIRE );
+      if ( a != 0 && a != e )
+        break;
+    }
+    if ( rec != NULL )
+      break;
+    __atomic_store_n( &this->epoch, e + 1, __ATOMIC_RELEASE );
+  }
+  api_Retired * done = NULL, ** pr = &this->limbo, * r;
+  while ( (r = *pr) != NULL ) {
+    if ( r->epoch + 2 <= this->epoch ) {
+      *pr     = r->next;
+      r->next = done;
+      done    = r;
+    }
+    else {
+      pr = &r->next;
+    }
+  }
+  return done;
+}
+
 tibrv_status
 Tibrv_API::GetEventType( tibrvEvent event,  tibrvEventType * type ) noexcept
 {
+  tibrv_Elem * e = this->elem( event );
   *type = 0;
-  pthread_mutex_lock( &this->map_mutex );
-  if ( event < this->map_size && this->map[ event ].id == event &&
-       this->map[ event ].ptr != NULL ) {
-    *type = this->map[ event ].type;
+  if ( e != NULL && event != 0 &&
+       __atomic_load_n( &e->id, __ATOMIC_ACQUIRE ) == event ) {
+    tibrvEventType t = e->type;
+    __atomic_thread_fence( __ATOMIC_ACQUIRE );
+    if ( __atomic_load_n( &e->id, __ATOMIC_RELAXED ) == event )
+      *type = t;
   }
-  pthread_mutex_unlock( &this->map_mutex );
   if ( *type != 0 )
     return TIBRV_OK;
   return TIBRV_INVALID_EVENT;
@@ -857,24 +2132,16 @@ Tibrv_API::GetEventType( tibrvEvent event,  tibrvEventType * type ) noexcept
 tibrv_status
 Tibrv_API::GetEventQueue( tibrvEvent event,  tibrvQueue * queue ) noexcept
 {
+  api_EpochGuard guard( *this );
+  api_Timer    * t;
+  api_Listener * l;
   *queue = 0;
-  pthread_mutex_lock( &this->map_mutex );
-  if ( event < this->map_size && this->map[ event ].id == event &&
-       this->map[ event ].ptr != NULL ) {
-    switch ( this->map[ event ].type ) {
-      case TIBRV_TIMER:
-        *queue = ((api_Timer *) this->map[ event ].ptr )->queue;
-        break;
-      case TIBRV_LISTENER:
-        *queue = ((api_Listener *) this->map[ event ].ptr )->queue;
-        break;
-      case TIBRV_QUEUE:
-        *queue = event;
-        break;
-      default: break;
-    }
-  }
-  pthread_mutex_unlock( &this->map_mutex );
+  if ( (t = this->get<api_Timer>( event, TIBRV_TIMER )) != NULL )
+    *queue = t->queue;
+  else if ( (l = this->get<api_Listener>( event, TIBRV_LISTENER )) != NULL )
+    *queue = l->queue;
+  else if ( this->get<api_Queue>( event, TIBRV_QUEUE ) != NULL )
+    *queue = event;
   if ( *queue != 0 )
     return TIBRV_OK;
   return TIBRV_INVALID_EVENT;
@@ -883,6 +2150,7 @@ Tibrv_API::GetEventQueue( tibrvEvent event,  tibrvQueue * queue ) noexcept
 tibrv_status
 Tibrv_API::GetListenerSubject( tibrvEvent event,  const char ** subject ) noexcept
 {
+  api_EpochGuard guard( *this );
   api_Listener *l = this->get<api_Listener>( event, TIBRV_LISTENER );
   if ( l != NULL ) {
     *subject = l->subject;
@@ -894,6 +2162,7 @@ Tibrv_API::GetListenerSubject( tibrvEvent event,  const char ** subject ) noexce
 tibrv_status
 Tibrv_API::GetListenerTransport( tibrvEvent event,  tibrvTransport * tport ) noexcept
 {
+  api_EpochGuard guard( *this );
   api_Listener *l = this->get<api_Listener>( event, TIBRV_LISTENER );
   if ( l != NULL ) {
     *tport = l->tport;
@@ -902,9 +2171,39 @@ Tibrv_API::GetListenerTransport( tibrvEvent event,  tibrvTransport * tport ) noe
   return TIBRV_INVALID_EVENT;
 }
 
+tibrv_status
+Tibrv_API::SetListenerFilter( tibrvEvent event,  const char * expr ) noexcept
+{
+  api_EpochGuard guard( *this );
+  api_Listener * l = this->get<api_Listener>( event, TIBRV_LISTENER );
+  if ( l == NULL )
+    return TIBRV_INVALID_EVENT;
+  api_Filter * f = NULL;
+  if ( expr != NULL ) {
+    tibrv_status status = api_Filter::compile( expr, f );
+    if ( status != TIBRV_OK )
+      return status;
+  }
+  api_Transport * t = this->get<api_Transport>( l->tport, TIBRV_TRANSPORT );
+  if ( t == NULL ) {
+    if ( f != NULL )
+      delete f;
+    return TIBRV_INVALID_TRANSPORT;
+  }
+  t = t->lane( l ); /* on_rv_msg() tests it under the mutex of its conn */
+  pthread_mutex_lock( &t->mutex );
+  api_Filter * old = l->filter;
+  l->filter = f;
+  pthread_mutex_unlock( &t->mutex );
+  if ( old != NULL )
+    delete old;
+  return TIBRV_OK;
+}
+
 tibrv_status
 Tibrv_API::GetTimerInterval( tibrvEvent event,  tibrv_f64 * ival ) noexcept
 {
+  api_EpochGuard guard( *this );
   api_Timer *t = this->get<api_Timer>( event, TIBRV_TIMER );
   if ( t != NULL ) {
     *ival = t->ival;
@@ -916,29 +2215,19 @@ Tibrv_API::GetTimerInterval( tibrvEvent event,  tibrv_f64 * ival ) noexcept
 tibrv_status
 Tibrv_API::ResetTimerInterval( tibrvEvent event,  tibrv_f64 ival ) noexcept
 {
+  api_EpochGuard guard( *this );
   api_Timer * t = this->get<api_Timer>( event, TIBRV_TIMER );
   if ( t != NULL ) {
+    /* lock free, restarts the interval from now */
     t->ival = ival;
-    api_Queue * q = this->get<api_Queue>( t->queue, TIBRV_QUEUE );
-    if ( q == NULL ) return TIBRV_INVALID_QUEUE;
-    EvPipeRec rec( OP_RESET_TIMER, t, &q->mutex, &q->cond );
-    pthread_mutex_lock( &q->mutex );
-    this->ev_read->exec( rec );
-    pthread_mutex_unlock( &q->mutex );
+    uint64_t ticks = this->timers.ms_ticks( ival * 1000.0 );
+    if ( this->timers.arm( t, ticks, ticks ) )
+      this->wake_timers();
     return TIBRV_OK;
   }
   return TIBRV_INVALID_EVENT;
 }
 
-void
-EvPipe::reset_timer( EvPipeRec &rec ) noexcept
-{
-  TimerQueue & timer_q = this->poll.timer;
-  api_Timer * t = rec.timer;
-  timer_q.remove_timer_cb( *t, t->id, 0 );
-  timer_q.add_timer_double( *t, t->ival, t->id, 0 );
-}
-
 tibrv_status
 Tibrv_API::CreateQueue( tibrvQueue * q ) noexcept
 {
@@ -954,6 +2243,8 @@ Tibrv_API::TimedDispatchQueue( tibrvQueue q, tibrv_f64 timeout ) noexcept
   if ( queue == NULL || queue->done )
     return TIBRV_INVALID_QUEUE;
   pthread_mutex_lock( &queue->mutex );
+  if ( queue->list.is_empty() && queue->spin_us != 0 )
+    queue->spin_wait( timeout );
   while ( queue->list.is_empty() ) {
     struct timespec ts = ts_timeout( timeout, 1.0 );
     pthread_cond_timedwait( &queue->cond, &queue->mutex, &ts );
@@ -966,22 +2257,44 @@ Tibrv_API::TimedDispatchQueue( tibrvQueue q, tibrv_f64 timeout ) noexcept
       return queue->finish_queue();
     return TIBRV_TIMEOUT;
   }
-  TibrvQueueEventList list2 = queue->list;
-  queue->list.init();
-  queue->mptr = ( queue->mptr + 1 ) % 2;
-  queue->mem_x[ queue->mptr ].reuse();
-  queue->count = 0;
+  TibrvQueueEventList list2;
+  queue->take_list( list2 );
   pthread_mutex_unlock( &queue->mutex );
-
-  do {
-    list2.pop_hd()->dispatch();
-  } while ( ! list2.is_empty() );
+  /* queues are not freed, the guard is not held across the wait above so
+   * that a parked dispatcher does not hold back reclaim */
+  api_EpochGuard guard( *this );
+  queue->dispatch_list( list2 );
 
   if ( queue->done )
     return queue->finish_queue();
   return TIBRV_OK;
 }
 
+/* Poll the count for up to spin_us before the caller parks on the cond.
+ * Called and returns with the mutex held; while spinning is set, push()
+ * does not broadcast, the result is rechecked under the mutex after */
+void
+api_Queue::spin_wait( tibrv_f64 timeout ) noexcept
+{
+  uint64_t spin_ns = (uint64_t) this->spin_us * 1000;
+  if ( timeout == TIBRV_NO_WAIT )
+    return;
+  if ( timeout > 0 && timeout * 1e9 < (double) spin_ns )
+    spin_ns = (uint64_t) ( timeout * 1e9 );
+  uint64_t end = current_monotonic_time_ns() + spin_ns;
+  this->spinning++;
+  pthread_mutex_unlock( &this->mutex );
+  for ( uint32_t i = 1; ; i++ ) {
+    if ( __atomic_load_n( &this->count, __ATOMIC_RELAXED ) != 0 || this->done )
+      break;
+    spin_pause();
+    if ( ( i & 63 ) == 0 && current_monotonic_time_ns() >= end )
+      break;
+  }
+  pthread_mutex_lock( &this->mutex );
+  this->spinning--;
+}
+
 tibrv_status
 api_Queue::finish_queue( void ) noexcept
 {
@@ -1005,6 +2318,8 @@ Tibrv_API::TimedDispatchQueueOneEvent( tibrvQueue q,
   if ( queue == NULL || queue->done )
     return TIBRV_INVALID_QUEUE;
   pthread_mutex_lock( &queue->mutex );
+  if ( queue->list.is_empty() && queue->spin_us != 0 )
+    queue->spin_wait( timeout );
   while ( queue->list.is_empty() ) {
     struct timespec ts = ts_timeout( timeout, 1.0 );
     pthread_cond_timedwait( &queue->cond, &queue->mutex, &ts );
@@ -1017,15 +2332,14 @@ Tibrv_API::TimedDispatchQueueOneEvent( tibrvQueue q,
       return queue->finish_queue();
     return TIBRV_TIMEOUT;
   }
-  ev = queue->list.pop_hd();
-  queue->count--;
-  if ( queue->list.is_empty() ) {
-    queue->mptr = ( queue->mptr + 1 ) % 2;
-    queue->mem_x[ queue->mptr ].reuse();
-  }
+  ev = queue->take_one();
   pthread_mutex_unlock( &queue->mutex );
 
+  api_EpochGuard guard( *this ); /* not across the wait, as above */
+  api_DispatchStats st;
+  st.add( *ev, current_monotonic_time_ns() );
   ev->dispatch();
+  st.fold( queue->stats );
 
   if ( queue->done )
     return queue->finish_queue();
@@ -1036,6 +2350,7 @@ tibrv_status
 Tibrv_API::DestroyQueue( tibrvQueue q, tibrvQueueOnComplete cb,
                         const void * cl ) noexcept
 {
+  api_EpochGuard guard( *this );
   api_Queue * queue = this->get<api_Queue>( q, TIBRV_QUEUE );
   if ( queue == NULL || queue->done )
     return TIBRV_INVALID_QUEUE;
@@ -1055,6 +2370,7 @@ Tibrv_API::DestroyQueue( tibrvQueue q, tibrvQueueOnComplete cb,
 tibrv_status
 Tibrv_API::GetQueueCount( tibrvQueue q, tibrv_u32 * num ) noexcept
 {
+  api_EpochGuard guard( *this );
   api_Queue * queue = this->get<api_Queue>( q, TIBRV_QUEUE );
   *num = 0;
   if ( queue == NULL || queue->done )
@@ -1068,6 +2384,7 @@ Tibrv_API::GetQueueCount( tibrvQueue q, tibrv_u32 * num ) noexcept
 tibrv_status
 Tibrv_API::GetQueuePriority( tibrvQueue q, tibrv_u32 * priority ) noexcept
 {
+  api_EpochGuard guard( *this );
   api_Queue * queue = this->get<api_Queue>( q, TIBRV_QUEUE );
   if ( queue == NULL || queue->done )
     return TIBRV_INVALID_QUEUE;
@@ -1078,6 +2395,7 @@ Tibrv_API::GetQueuePriority( tibrvQueue q, tibrv_u32 * priority ) noexcept
 tibrv_status
 Tibrv_API::SetQueuePriority( tibrvQueue q, tibrv_u32 prio ) noexcept
 {
+  api_EpochGuard guard( *this );
   api_Queue * queue = this->get<api_Queue>( q, TIBRV_QUEUE );
   if ( queue == NULL || queue->done )
     return TIBRV_INVALID_QUEUE;
@@ -1091,6 +2409,7 @@ tibrv_status
 Tibrv_API::GetQueueLimitPolicy( tibrvQueue q, tibrvQueueLimitPolicy * policy,
                                tibrv_u32 * max_ev, tibrv_u32 * discard ) noexcept
 {
+  api_EpochGuard guard( *this );
   api_Queue * queue = this->get<api_Queue>( q, TIBRV_QUEUE );
   if ( queue == NULL || queue->done )
     return TIBRV_INVALID_QUEUE;
@@ -1104,18 +2423,24 @@ tibrv_status
 Tibrv_API::SetQueueLimitPolicy( tibrvQueue q, tibrvQueueLimitPolicy policy,
                                tibrv_u32 max_ev, tibrv_u32 discard ) noexcept
 {
+  api_EpochGuard guard( *this );
   api_Queue * queue = this->get<api_Queue>( q, TIBRV_QUEUE );
   if ( queue == NULL || queue->done )
     return TIBRV_INVALID_QUEUE;
+  pthread_mutex_lock( &queue->mutex );
+  if ( queue->policy != policy ) /* waiting msgs are not indexed */
+    queue->cidx.clear();
   queue->policy  = policy;
   queue->max_ev  = max_ev;
   queue->discard = discard;
+  pthread_mutex_unlock( &queue->mutex );
   return TIBRV_OK;
 }
 
 tibrv_status
 Tibrv_API::SetQueueName( tibrvQueue q, const char * name ) noexcept
 {
+  api_EpochGuard guard( *this );
   api_Queue * queue = this->get<api_Queue>( q, TIBRV_QUEUE );
   if ( queue == NULL || queue->done )
     return TIBRV_INVALID_QUEUE;
@@ -1126,6 +2451,7 @@ Tibrv_API::SetQueueName( tibrvQueue q, const char * name ) noexcept
 tibrv_status
 Tibrv_API::GetQueueName( tibrvQueue q, const char ** name ) noexcept
 {
+  api_EpochGuard guard( *this );
   api_Queue * queue = this->get<api_Queue>( q, TIBRV_QUEUE );
   if ( queue == NULL || queue->done )
     return TIBRV_INVALID_QUEUE;
@@ -1136,6 +2462,7 @@ Tibrv_API::GetQueueName( tibrvQueue q, const char ** name ) noexcept
 tibrv_status
 Tibrv_API::SetQueueHook( tibrvQueue q, tibrvQueueHook hook, void * cl ) noexcept
 {
+  api_EpochGuard guard( *this );
   api_Queue * queue = this->get<api_Queue>( q, TIBRV_QUEUE );
   if ( queue == NULL || queue->done )
     return TIBRV_INVALID_QUEUE;
@@ -1147,6 +2474,7 @@ Tibrv_API::SetQueueHook( tibrvQueue q, tibrvQueueHook hook, void * cl ) noexcept
 tibrv_status
 Tibrv_API::GetQueueHook( tibrvQueue q, tibrvQueueHook * hook ) noexcept
 {
+  api_EpochGuard guard( *this );
   api_Queue * queue = this->get<api_Queue>( q, TIBRV_QUEUE );
   if ( queue == NULL || queue->done )
     return TIBRV_INVALID_QUEUE;
@@ -1154,6 +2482,67 @@ Tibrv_API::GetQueueHook( tibrvQueue q, tibrvQueueHook * hook ) noexcept
   return TIBRV_OK;
 }
 
+tibrv_status
+Tibrv_API::SetQueueInline( tibrvQueue q, tibrv_bool on ) noexcept
+{
+  api_EpochGuard guard( *this );
+  api_Queue * queue = this->get<api_Queue>( q, TIBRV_QUEUE );
+  if ( queue == NULL || queue->done )
+    return TIBRV_INVALID_QUEUE;
+  queue->inline_dispatch = ( on != TIBRV_FALSE );
+  return TIBRV_OK;
+}
+
+tibrv_status
+Tibrv_API::GetQueueInline( tibrvQueue q, tibrv_bool * on ) noexcept
+{
+  api_EpochGuard guard( *this );
+  api_Queue * queue = this->get<api_Queue>( q, TIBRV_QUEUE );
+  if ( queue == NULL || queue->done )
+    return TIBRV_INVALID_QUEUE;
+  *on = ( queue->inline_dispatch ? TIBRV_TRUE : TIBRV_FALSE );
+  return TIBRV_OK;
+}
+
+tibrv_status
+Tibrv_API::SetQueueSpin( tibrvQueue q, tibrv_u32 spin_us ) noexcept
+{
+  api_EpochGuard guard( *this );
+  api_Queue * queue = this->get<api_Queue>( q, TIBRV_QUEUE );
+  if ( queue == NULL || queue->done )
+    return TIBRV_INVALID_QUEUE;
+  queue->spin_us = spin_us;
+  return TIBRV_OK;
+}
+
+tibrv_status
+Tibrv_API::GetQueueSpin( tibrvQueue q, tibrv_u32 * spin_us ) noexcept
+{
+  api_EpochGuard guard( *this );
+  api_Queue * queue = this->get<api_Queue>( q, TIBRV_QUEUE );
+  if ( queue == NULL || queue->done )
+    return TIBRV_INVALID_QUEUE;
+  *spin_us = queue->spin_us;
+  return TIBRV_OK;
+}
+
+tibrv_status
+Tibrv_API::GetQueueStats( tibrvQueue q, tibrvQueueStats * stats ) noexcept
+{
+  api_EpochGuard guard( *this );
+  api_Queue * queue = this->get<api_Queue>( q, TIBRV_QUEUE );
+  if ( queue == NULL || queue->done )
+    return TIBRV_INVALID_QUEUE;
+  pthread_mutex_lock( &queue->mutex );
+  stats_load( stats, &queue->stats, sizeof( *stats ) );
+  stats->depth = queue->count;
+  queue->stats.max_depth = queue->count;
+  stats->delay_max_ns =
+    __atomic_exchange_n( &queue->stats.delay_max_ns, 0, __ATOMIC_RELAXED );
+  pthread_mutex_unlock( &queue->mutex );
+  return TIBRV_OK;
+}
+
 tibrv_status
 Tibrv_API::CreateQueueGroup( tibrvQueueGroup * grp ) noexcept
 {
@@ -1170,6 +2559,9 @@ cmp_queue( const api_Queue &x,  const api_Queue &y )
   return 1;
 }
 
+/* a larger group parks without spinning */
+static const uint32_t GROUP_SPIN_MAX = 64;
+
 tibrv_status
 Tibrv_API::TimedDispatchGroup( tibrvQueueGroup grp, tibrv_f64 timeout ) noexcept
 {
@@ -1184,13 +2576,42 @@ Tibrv_API::TimedDispatchGroup( tibrvQueueGroup grp, tibrv_f64 timeout ) noexcept
     g->update = false;
   }
   bool all_done;
-  for (;;) {
+  for ( bool spun = ( g->spin_us == 0 || timeout == TIBRV_NO_WAIT ); ; ) {
     all_done = true;
     for ( queue = g->list.hd; queue != NULL; queue = queue->next ) {
       if ( queue->count > 0 )
         break;
       all_done &= queue->done;
     }
+    if ( queue == NULL && ! spun && ! all_done &&
+         g->count <= GROUP_SPIN_MAX ) {
+      /* poll the member counts before parking, as api_Queue::spin_wait();
+       * the list is copied under the mutex, queues are not freed */
+      api_Queue * snap[ GROUP_SPIN_MAX ];
+      uint32_t    n = 0;
+      for ( api_Queue * q = g->list.hd; q != NULL && n < GROUP_SPIN_MAX;
+            q = q->next )
+        snap[ n++ ] = q;
+      uint64_t spin_ns = (uint64_t) g->spin_us * 1000;
+      if ( timeout > 0 && timeout * 1e9 < (double) spin_ns )
+        spin_ns = (uint64_t) ( timeout * 1e9 );
+      uint64_t end = current_monotonic_time_ns() + spin_ns;
+      bool     hit = false;
+      __atomic_store_n( &g->spinning, g->spinning + 1, __ATOMIC_SEQ_CST );
+      pthread_mutex_unlock( &g->mutex );
+      for ( uint32_t i = 1; ! hit; i++ ) {
+        for ( uint32_t k = 0; k < n; k++ )
+          if ( __atomic_load_n( &snap[ k ]->count, __ATOMIC_RELAXED ) != 0 )
+            hit = true;
+        spin_pause();
+        if ( ( i & 63 ) == 0 && current_monotonic_time_ns() >= end )
+          break;
+      }
+      pthread_mutex_lock( &g->mutex );
+      __atomic_store_n( &g->spinning, g->spinning - 1, __ATOMIC_SEQ_CST );
+      spun = true;
+      continue; /* rescan under the mutex */
+    }
     if ( queue == NULL ) {
       struct timespec ts = ts_timeout( timeout, 1.0 );
       pthread_cond_timedwait( &g->cond, &g->mutex, &ts );
@@ -1212,23 +2633,30 @@ Tibrv_API::TimedDispatchGroup( tibrvQueueGroup grp, tibrv_f64 timeout ) noexcept
   }
   pthread_mutex_lock( &queue->mutex );
   TibrvQueueEventList list2;
-  if ( queue->grp == g ) {
-    list2 = queue->list;
-    queue->list.init();
-    queue->mptr = ( queue->mptr + 1 ) % 2;
-    queue->mem_x[ queue->mptr ].reuse();
-    queue->count = 0;
-  }
+  if ( queue->grp == g )
+    queue->take_list( list2 );
   pthread_mutex_unlock( &queue->mutex );
 
-  while ( ! list2.is_empty() )
-    list2.pop_hd()->dispatch();
+  api_EpochGuard guard( *this ); /* not across the wait, as above */
+  queue->dispatch_list( list2 );
+  return TIBRV_OK;
+}
+
+tibrv_status
+Tibrv_API::SetQueueGroupSpin( tibrvQueueGroup grp, tibrv_u32 spin_us ) noexcept
+{
+  api_EpochGuard guard( *this );
+  api_QueueGroup * g = this->get<api_QueueGroup>( grp, TIBRV_QUEUE_GROUP );
+  if ( g == NULL || g->done )
+    return TIBRV_INVALID_QUEUE_GROUP;
+  g->spin_us = spin_us;
   return TIBRV_OK;
 }
 
 tibrv_status
 Tibrv_API::DestroyQueueGroup( tibrvQueueGroup grp ) noexcept
 {
+  api_EpochGuard guard( *this );
   api_QueueGroup * g = this->get<api_QueueGroup>( grp, TIBRV_QUEUE_GROUP );
   if ( g == NULL || g->done )
     return TIBRV_INVALID_QUEUE_GROUP;
@@ -1239,6 +2667,7 @@ Tibrv_API::DestroyQueueGroup( tibrvQueueGroup grp ) noexcept
 tibrv_status
 Tibrv_API::AddQueueGroup( tibrvQueueGroup grp, tibrvQueue q ) noexcept
 {
+  api_EpochGuard guard( *this );
   api_QueueGroup * g     = this->get<api_QueueGroup>( grp, TIBRV_QUEUE_GROUP );
   api_Queue      * queue = this->get<api_Queue>( q, TIBRV_QUEUE );
   if ( queue == NULL || queue->done )
@@ -1262,6 +2691,7 @@ Tibrv_API::AddQueueGroup( tibrvQueueGroup grp, tibrvQueue q ) noexcept
 tibrv_status
 Tibrv_API::RemoveQueueGroup( tibrvQueueGroup grp, tibrvQueue q ) noexcept
 {
+  api_EpochGuard guard( *this );
   api_QueueGroup * g     = this->get<api_QueueGroup>( grp, TIBRV_QUEUE_GROUP );
   api_Queue      * queue = this->get<api_Queue>( q, TIBRV_QUEUE );
   if ( queue == NULL || queue->done )
@@ -1302,33 +2732,119 @@ Tibrv_API::CreateTransport( tibrvTransport * tport, const char * service,
     acat( t->x.daemon, daemon );
 #undef acat
 
+  if ( this->share_tports && this->find_conn( t ) != NULL ) /* off by default */
+    return TIBRV_OK;
+
+  tibrv_status ret = this->connect_tport( t, parm );
+  if ( ret != TIBRV_OK )
+    *tport = TIBRV_INVALID_ID;
+  return ret;
+}
+
+/* Connect t on its I/O thread and wait for the session, up to 10 seconds */
+tibrv_status
+Tibrv_API::connect_tport( api_Transport * t,
+                          EvRvClientParameters &parm ) noexcept
+{
   EvPipeRec rec( OP_CREATE_TPORT, t, &parm, &t->mutex, &t->cond );
   tibrv_status ret = TIBRV_OK;
 
   pthread_mutex_lock( &t->mutex );
-  this->ev_read->exec( rec );
+  t->pipe->exec( rec );
 
   struct timespec ts = ts_timeout( 10.0 );
   while ( t->client.rv_state > EvRvClient::ERR_CLOSE &&
           t->client.rv_state < EvRvClient::DATA_RECV ) {
     if ( pthread_cond_timedwait( &t->cond, &t->mutex, &ts ) == ETIMEDOUT ) {
       EvPipeRec rec2( OP_CLOSE_TPORT, t, &parm, &t->mutex, &t->cond );
-      this->ev_read->exec( rec2 );
+      t->pipe->exec( rec2 );
     }
   }
   if ( t->client.rv_state != EvRvClient::DATA_RECV )
     ret = TIBRV_DAEMON_NOT_CONNECTED;
-  ::memcpy( t->x.session, t->client.session, sizeof( t->x.session ) );
-  t->x.session_len = t->client.session_len;
+  else
+    t->conn_refs = 1;
+  t->set_session();
   pthread_mutex_unlock( &t->mutex );
-  if ( ret != TIBRV_OK )
-    *tport = TIBRV_INVALID_ID;
   return ret;
 }
 
+static inline bool
+same_param( const char *a,  const char *b )
+{
+  return a == b || ( a != NULL && b != NULL && ::strcmp( a, b ) == 0 );
+}
+
+/* Attach t to a connected transport with the same service, network and
+ * daemon, t keeps its own listeners, requests and inboxes.  The daemon has one
+ * session for the connection, t gets its own session <conn session>.S<idx>
+ * under it, so the daemon routes t's inboxes on the connection without a
+ * subscription and on_rv_msg() routes them to t by the session */
+api_Transport *
+Tibrv_API::find_conn( api_Transport * t ) noexcept
+{
+  api_EpochGuard guard( *this );
+  tibrvId max_slot = this->next_id;
+  for ( tibrvId slot = 0; slot < max_slot; slot++ ) {
+    tibrvId         id = this->slot_id( slot );
+    api_Transport * c;
+    if ( id == 0 || id == t->id || id == TIBRV_PROCESS_TRANSPORT ||
+         (c = this->get<api_Transport>( id, TIBRV_TRANSPORT )) == NULL ||
+         c->conn != c || c->lane_of != NULL || c->lane_count > 1 ||
+         ! same_param( c->x.service, t->x.service ) ||
+         ! same_param( c->x.network, t->x.network ) ||
+         ! same_param( c->x.daemon, t->x.daemon ) )
+      continue;
+    pthread_mutex_lock( &c->mutex );
+    if ( c->conn_refs == 0 || c->client.rv_state != EvRvClient::DATA_RECV ||
+         c->x.session_len + 12 > sizeof( c->x.session ) ) {
+      pthread_mutex_unlock( &c->mutex );
+      continue;
+    }
+    c->conn_refs++;
+    /* ops run on the connection's thread, which doesn't count t */
+    __atomic_fetch_sub( &this->io_load[ t->io_idx ], 1, __ATOMIC_RELAXED );
+    t->io_idx     = c->io_idx;
+    t->pipe       = c->pipe;
+    t->me         = c->me;
+    t->conn       = c;
+    t->share_idx  = ++c->share_count; /* not reused, stale inboxes miss */
+    t->share_next = c->share_next;
+    c->share_next = t;
+    t->set_session();
+    pthread_mutex_unlock( &c->mutex );
+    return c;
+  }
+  return NULL;
+}
+
+/* Release the daemon interest of t's listeners, the connection stays open
+ * for the other transports on it */
+void
+Tibrv_API::drop_subs( api_Transport * t ) noexcept
+{
+  api_EpochGuard guard( *this );
+  tibrvId max_slot = this->next_id;
+  pthread_mutex_lock( &t->mutex );
+  for ( tibrvId slot = 0; slot < max_slot; slot++ ) {
+    api_Listener * l;
+    tibrvId id = this->slot_id( slot );
+    if ( id != 0 &&
+         (l = this->get<api_Listener>( id, TIBRV_LISTENER )) != NULL &&
+         l->tport == t->id &&
+         ! t->conn->in_session( l->subject, l->len ) ) {
+      EvPipeRec rec( OP_UNSUBSCRIBE, t, l, &t->mutex, &t->cond );
+      t->pipe->exec( rec );
+    }
+  }
+  pthread_mutex_unlock( &t->mutex );
+}
+
 void
 EvPipe::create_tport( EvPipeRec &rec ) noexcept
 {
+  rec.t->sub_refs.clear(); /* new session, listeners subscribe again */
+  rec.t->sub_gen++;
   rec.t->client.rv_connect( *rec.parm, rec.t, rec.t );
 }
 
@@ -1363,34 +2879,9 @@ Tibrv_API::get_send_ctx( api_Transport * t ) noexcept
 static void
 send_ctx_append( SendCtx * c,  api_Transport * t,  api_Msg * m ) noexcept
 {
-  const void * data    = m->wr.buf;
-  size_t       datalen = m->wr.update_hdr();
-  char * subj = (char *) c->byte_mem.make( m->subject_len + 1 );
-  ::memcpy( subj, m->subject, m->subject_len );
-  subj[ m->subject_len ] = 0;
-  const char * rep = NULL;
-  if ( m->reply_len > 0 ) {
-    char * r = (char *) c->byte_mem.make( m->reply_len + 1 );
-    ::memcpy( r, m->reply, m->reply_len );
-    r[ m->reply_len ] = 0;
-    rep = r;
-  }
-  void * d = c->byte_mem.make( datalen );
-  ::memcpy( d, data, datalen );
-  if ( c->cnt == c->cap ) {
-    uint32_t    ncap = c->cap ? c->cap * 2 : 64;
-    EvPublish * np   = (EvPublish *) ::malloc( ncap * sizeof( EvPublish ) );
-    if ( c->cnt > 0 )
-      ::memcpy( (void *) np, (void *) c->pubs, c->cnt * sizeof( EvPublish ) );
-    if ( c->pubs != NULL )
-      ::free( c->pubs );
-    c->pubs = np;
-    c->cap  = ncap;
-  }
-  new ( &c->pubs[ c->cnt++ ] )
-    EvPublish( subj, m->subject_len, rep, m->reply_len, d, datalen,
-               t->client.sub_route, *t->me, 0, RVMSG_TYPE_ID );
-  c->bytes += (uint32_t) datalen;
+  size_t datalen = m->wr.update_hdr();
+  c->append( m->subject, m->subject_len, m->reply, m->reply_len, m->wr.buf,
+             datalen, t->conn->client.sub_route, *t->me, RVMSG_TYPE_ID );
 }
 
 /* Ship the accumulated batch in a single EvPipe round-trip.  Synchronous on
@@ -1403,11 +2894,9 @@ Tibrv_API::flush_send_ctx( SendCtx * c ) noexcept
     EvPipeRec rec( OP_TPORT_SENDV, c->t, c->pubs, c->cnt, &c->t->mutex,
                    &c->t->cond );
     pthread_mutex_lock( &c->t->mutex );
-    this->ev_read->exec( rec );
+    c->t->pipe->exec( rec );
     pthread_mutex_unlock( &c->t->mutex );
-    c->cnt   = 0;
-    c->bytes = 0;
-    c->byte_mem.reuse();
+    c->reset();
   }
   pthread_mutex_unlock( &c->lock );
   return TIBRV_OK;
@@ -1418,6 +2907,7 @@ Tibrv_API::flush_send_ctx( SendCtx * c ) noexcept
 tibrv_status
 Tibrv_API::Flush( tibrvTransport tport ) noexcept
 {
+  api_EpochGuard guard( *this );
   api_Transport * t = this->get<api_Transport>( tport, TIBRV_TRANSPORT );
   if ( t == NULL )
     return TIBRV_INVALID_TRANSPORT;
@@ -1429,7 +2919,14 @@ Tibrv_API::Flush( tibrvTransport tport ) noexcept
     EvPipeRec rec( OP_TPORT_DRAIN, t, (EvRvClientParameters *) NULL,
                    &t->mutex, &t->cond );
     pthread_mutex_lock( &t->mutex );
-    this->ev_read->exec( rec );
+    t->pipe->exec( rec );
+    pthread_mutex_unlock( &t->mutex );
+  }
+  if ( t->pipe->rings != NULL ) { /* ASYNC_BATCH: rings drain before an op */
+    EvPipeRec rec( OP_RING_DRAIN, t, (EvRvClientParameters *) NULL,
+                   &t->mutex, &t->cond );
+    pthread_mutex_lock( &t->mutex );
+    t->pipe->exec( rec );
     pthread_mutex_unlock( &t->mutex );
   }
   return TIBRV_OK;
@@ -1442,12 +2939,271 @@ Tibrv_API::free_transport_writers( api_Transport * t ) noexcept
   while ( ! t->writers.is_empty() ) {
     SendCtx * c = t->writers.pop_hd();
     this->flush_send_ctx( c );
-    if ( c->pubs != NULL )
-      ::free( c->pubs );
     c->~SendCtx();
     ::free( c );
   }
-  pthread_mutex_unlock( &t->writers_mutex );
+  pthread_mutex_unlock( &t->writers_mutex );
+}
+
+/* Head of the calling thread's chain of ASYNC_BATCH rings, like
+ * tls_send_head.  Only this thread touches the buffers of its rings after
+ * the I/O thread frees them, it reuses one and releases the rest */
+static thread_local api_SendRing * tls_ring_head = NULL;
+
+api_SendRing *
+Tibrv_API::get_send_ring( api_Transport * t ) noexcept
+{
+  api_SendRing * r, * dead = NULL;
+  for ( r = tls_ring_head; r != NULL; r = r->tls_next ) {
+    if ( __atomic_load_n( &r->state, __ATOMIC_ACQUIRE ) != RING_FREE ) {
+      if ( r->t == t && r->tport == t->id )
+        return r;
+    }
+    else if ( dead == NULL )
+      dead = r;
+    else if ( r->buf != NULL ) {
+      ::free( r->buf );
+      r->buf = NULL;
+    }
+  }
+  if ( (r = dead) == NULL ) {
+    r = new ( ::malloc( sizeof( api_SendRing ) ) ) api_SendRing();
+    r->tls_next   = tls_ring_head;
+    tls_ring_head = r;
+  }
+  if ( r->buf == NULL )
+    r->buf = (uint8_t *) ::malloc( API_SEND_RING_SIZE );
+  r->head  = 0;
+  r->tail  = 0;
+  r->t     = t;
+  r->tport = t->id;
+  r->pipe  = t->pipe;
+  r->state = RING_LIVE;
+  pthread_mutex_lock( &t->pipe->ring_mutex );
+  r->next = t->pipe->rings;
+  __atomic_store_n( &t->pipe->rings, r, __ATOMIC_RELEASE );
+  pthread_mutex_unlock( &t->pipe->ring_mutex );
+  return r;
+}
+
+/* Copy a send into this thread's ring for t and return without waiting for
+ * the I/O thread, unless the ring is full.  False when the send can't be
+ * queued and must take the synchronous path. */
+bool
+Tibrv_API::ring_send( api_Transport * t,  const char * subj,  size_t subj_len,
+                      const char * reply,  size_t reply_len,
+                      const void * data,  size_t datalen ) noexcept
+{
+  if ( tls_io_pipe != NULL ) /* an I/O thread must not wait for ring space */
+    return false;
+  size_t need = ( sizeof( api_RingRec ) + subj_len + 1 + reply_len + 1 +
+                  datalen + 7 ) & ~(size_t) 7;
+  if ( need > API_SEND_RING_SIZE / 2 )
+    return false;
+
+  api_SendRing * r    = this->get_send_ring( t );
+  if ( __atomic_load_n( &r->state, __ATOMIC_ACQUIRE ) != RING_LIVE )
+    return false; /* transport destroyed, the ring is not drained */
+  uint64_t       head = r->head,
+                 mask = API_SEND_RING_SIZE - 1,
+                 off, contig;
+  for ( uint32_t spins = 0; ; spins++ ) {
+    off    = head & mask;
+    contig = API_SEND_RING_SIZE - off;
+    uint64_t want = need + ( contig < need ? contig : 0 ),
+             tail = __atomic_load_n( &r->tail, __ATOMIC_ACQUIRE );
+    if ( API_SEND_RING_SIZE - ( head - tail ) >= want )
+      break;
+    if ( __atomic_load_n( &r->state, __ATOMIC_ACQUIRE ) != RING_LIVE )
+      return false; /* detached while full, tail won't move again */
+    r->pipe->wake_rings(); /* full: backpressure until E makes room */
+    if ( spins < 64 )
+      spin_pause();
+    else
+      sched_yield();
+  }
+  if ( __atomic_load_n( &r->state, __ATOMIC_ACQUIRE ) != RING_LIVE )
+    return false;
+  if ( contig < need ) { /* no room at the end, wrap */
+    if ( contig >= sizeof( api_RingRec ) )
+      ((api_RingRec *) &r->buf[ off ])->size = 0;
+    head += contig;
+    off   = 0;
+  }
+  ((api_RingRec *) &r->buf[ off ])->set( (uint32_t) need, subj, subj_len,
+                                         reply, reply_len, data, datalen );
+
+  __atomic_store_n( &r->head, head + need, __ATOMIC_RELEASE );
+  __atomic_thread_fence( __ATOMIC_SEQ_CST ); /* head before ring_signaled */
+  r->pipe->wake_rings();
+  return true;
+}
+
+/* Copy a send after the record header, subject and reply nul terminated */
+void
+api_RingRec::set( uint32_t sz,  const char *subj,  size_t subj_len,
+                  const char *reply,  size_t reply_len,  const void *data,
+                  size_t datalen ) noexcept
+{
+  char * p = (char *) &this[ 1 ];
+  this->size        = sz;
+  this->subject_len = (uint16_t) subj_len;
+  this->reply_len   = (uint16_t) reply_len;
+  this->data_len    = (uint32_t) datalen;
+  ::memcpy( p, subj, subj_len );
+  p[ subj_len ] = '\0';
+  p = &p[ subj_len + 1 ];
+  if ( reply_len > 0 )
+    ::memcpy( p, reply, reply_len );
+  p[ reply_len ] = '\0';
+  ::memcpy( &p[ reply_len + 1 ], data, datalen );
+}
+
+/* Publish a copied send in place, on the transport's I/O thread */
+void
+api_RingRec::publish( api_Transport &tp ) noexcept
+{
+  const char * subj  = (const char *) &this[ 1 ],
+             * reply = &subj[ this->subject_len + 1 ];
+  EvPublish pub( subj, this->subject_len,
+                 this->reply_len > 0 ? reply : NULL, this->reply_len,
+                 &reply[ this->reply_len + 1 ], this->data_len,
+                 tp.conn->client.sub_route, *tp.me, 0, RVMSG_TYPE_ID );
+  if ( tp.id != TIBRV_PROCESS_TRANSPORT )
+    tp.send_pub( pub );
+  else {
+    pub.subj_hash = kv_crc_c( subj, this->subject_len, 0 );
+    tp.conn->client.sub_route.forward_msg( pub );
+  }
+}
+
+/* Post one OP_RING_DRAIN until E picks it up, the rest ride along */
+void
+EvPipe::wake_rings( void ) noexcept
+{
+  if ( __atomic_load_n( &this->ring_signaled, __ATOMIC_RELAXED ) == 0 &&
+       __atomic_exchange_n( &this->ring_signaled, 1, __ATOMIC_SEQ_CST ) == 0 ) {
+    EvPipeRec rec( OP_RING_DRAIN, NULL, (EvRvClientParameters *) NULL,
+                   NULL, NULL );
+    this->post( rec );
+  }
+}
+
+void
+EvPipe::ring_drain( EvPipeRec & ) noexcept
+{
+  /* clear first, a send after this either is seen below or posts again */
+  __atomic_exchange_n( &this->ring_signaled, 0, __ATOMIC_SEQ_CST );
+  this->drain_rings();
+}
+
+/* An inline callback run by a drain may send, flush or destroy a transport,
+ * which comes back here on the same thread with ring_mutex held, so the
+ * nested call only asks the outer one to go around again */
+void
+EvPipe::drain_rings( void ) noexcept
+{
+  if ( this->ring_depth != 0 ) {
+    this->ring_again = true;
+    return;
+  }
+  this->ring_depth++;
+  pthread_mutex_lock( &this->ring_mutex );
+  do {
+    this->ring_again = false;
+    for ( api_SendRing * r = this->rings; r != NULL; r = r->next )
+      if ( r->state == RING_LIVE )
+        r->drain();
+  } while ( this->ring_again );
+  if ( this->ring_sweep )
+    this->sweep_rings();
+  pthread_mutex_unlock( &this->ring_mutex );
+  this->ring_depth--;
+}
+
+/* Publish what is left in the rings of rec.t and detach them, inside a
+ * drain they are marked and unlinked when the outer drain_rings() ends */
+void
+EvPipe::ring_detach( EvPipeRec &rec ) noexcept
+{
+  bool nested = ( this->ring_depth != 0 ); /* ring_mutex held by this thread */
+  if ( ! nested ) {
+    this->drain_rings();
+    pthread_mutex_lock( &this->ring_mutex );
+  }
+  for ( api_SendRing * r = this->rings; r != NULL; r = r->next )
+    if ( r->t == rec.t && r->state == RING_LIVE )
+      __atomic_store_n( &r->state, RING_DETACH, __ATOMIC_RELEASE );
+  this->ring_sweep = true;
+  if ( ! nested ) {
+    this->sweep_rings();
+    pthread_mutex_unlock( &this->ring_mutex );
+  }
+}
+
+/* Unlink detached rings, the I/O thread is done with them and the owner
+ * may reuse the buffer, called with ring_mutex held */
+void
+EvPipe::sweep_rings( void ) noexcept
+{
+  this->ring_sweep = false;
+  for ( api_SendRing ** pr = &this->rings; *pr != NULL; ) {
+    api_SendRing * r = *pr;
+    if ( r->state == RING_DETACH ) {
+      *pr     = r->next;
+      r->next = NULL;
+      __atomic_store_n( &r->state, RING_FREE, __ATOMIC_RELEASE );
+    }
+    else {
+      pr = &r->next;
+    }
+  }
+}
+
+/* Runs on the transport's I/O thread, publishes in place from the ring */
+void
+api_SendRing::drain( void ) noexcept
+{
+  uint64_t tail = this->tail,
+           head = __atomic_load_n( &this->head, __ATOMIC_ACQUIRE ),
+           mask = API_SEND_RING_SIZE - 1;
+  if ( tail == head )
+    return;
+  api_Transport & tp = *this->t;
+  uint64_t        n = 0, bytes = 0;
+  while ( tail != head ) {
+    uint64_t      off    = tail & mask,
+                  contig = API_SEND_RING_SIZE - off;
+    api_RingRec * rec    = (api_RingRec *) &this->buf[ off ];
+    if ( contig < sizeof( api_RingRec ) || rec->size == 0 ) {
+      tail += contig;
+      continue;
+    }
+    rec->publish( tp );
+    n++;
+    bytes += rec->data_len;
+    tail += rec->size;
+    if ( this->state != RING_LIVE ) /* destroyed by an inline callback */
+      break;
+  }
+  __atomic_store_n( &this->tail, tail, __ATOMIC_RELEASE );
+  if ( n > 0 )
+    tp.sent( n, bytes );
+}
+
+/* Publish what is left in the rings of t and detach them on the I/O thread,
+ * the sending threads reuse the ring memory for the next transport */
+void
+Tibrv_API::free_send_rings( api_Transport * t ) noexcept
+{
+  EvPipe * p = t->pipe;
+  if ( __atomic_load_n( &p->rings, __ATOMIC_ACQUIRE ) == NULL )
+    return;
+  EvPipeRec rec( OP_RING_DETACH, t, (EvRvClientParameters *) NULL,
+                 &t->mutex, &t->cond );
+  pthread_mutex_lock( &t->mutex );
+  p->exec( rec );
+  pthread_mutex_unlock( &t->mutex );
 }
 
 /* SINGLE_BATCH drain.  Runs ON THE E THREAD (via OP_TPORT_DRAIN or the batch
@@ -1470,20 +3226,19 @@ Tibrv_API::drain_send_buf( api_Transport * t ) noexcept
   t->sb_spare = full;          /* reset below, before the next drain runs */
   pthread_mutex_unlock( &t->sb_lock );
 
+  t->sent( full->cnt, full->bytes );
   if ( t->id != TIBRV_PROCESS_TRANSPORT ) {
     for ( uint32_t i = 0; i < full->cnt; i++ )
-      t->client.publish( full->pubs[ i ] );
+      t->send_pub( full->pubs[ i ] );
   }
   else {
     for ( uint32_t i = 0; i < full->cnt; i++ ) {
       full->pubs[ i ].subj_hash =
         kv_crc_c( full->pubs[ i ].subject, full->pubs[ i ].subject_len, 0 );
-      t->client.sub_route.forward_msg( full->pubs[ i ] );
+      t->conn->client.sub_route.forward_msg( full->pubs[ i ] );
     }
   }
-  full->cnt   = 0;
-  full->bytes = 0;
-  full->byte_mem.reuse();
+  full->reset();
 }
 
 /* Teardown for the shared buffer: stop the timer + final drain (both on E),
@@ -1495,7 +3250,7 @@ Tibrv_API::free_send_buf( api_Transport * t ) noexcept
     EvPipeRec rec( OP_STOP_BATCH_TMR, t, (EvRvClientParameters *) NULL,
                    &t->mutex, &t->cond );
     pthread_mutex_lock( &t->mutex );
-    this->ev_read->exec( rec );
+    t->pipe->exec( rec );
     pthread_mutex_unlock( &t->mutex );
     t->sb_timer_active = false;
   }
@@ -1503,19 +3258,15 @@ Tibrv_API::free_send_buf( api_Transport * t ) noexcept
     EvPipeRec rec( OP_TPORT_DRAIN, t, (EvRvClientParameters *) NULL,
                    &t->mutex, &t->cond );
     pthread_mutex_lock( &t->mutex );
-    this->ev_read->exec( rec );
+    t->pipe->exec( rec );
     pthread_mutex_unlock( &t->mutex );
   }
   if ( t->sb_fill != NULL ) {
-    if ( t->sb_fill->pubs != NULL )
-      ::free( t->sb_fill->pubs );
     t->sb_fill->~SendCtx();
     ::free( t->sb_fill );
     t->sb_fill = NULL;
   }
   if ( t->sb_spare != NULL ) {
-    if ( t->sb_spare->pubs != NULL )
-      ::free( t->sb_spare->pubs );
     t->sb_spare->~SendCtx();
     ::free( t->sb_spare );
     t->sb_spare = NULL;
@@ -1529,6 +3280,7 @@ Tibrv_API::free_send_buf( api_Transport * t ) noexcept
 tibrv_status
 Tibrv_API::Send( tibrvTransport tport, tibrvMsg msg ) noexcept
 {
+  api_EpochGuard guard( *this );
   api_Transport * t = this->get<api_Transport>( tport, TIBRV_TRANSPORT );
   if ( t == NULL )
     return TIBRV_INVALID_TRANSPORT;
@@ -1561,76 +3313,129 @@ Tibrv_API::Send( tibrvTransport tport, tibrvMsg msg ) noexcept
       EvPipeRec rec( OP_TPORT_DRAIN, t, (EvRvClientParameters *) NULL,
                      &t->mutex, &t->cond );
       pthread_mutex_lock( &t->mutex );
-      this->ev_read->exec( rec );
+      t->pipe->exec( rec );
       pthread_mutex_unlock( &t->mutex );
     }
     return TIBRV_OK;
   }
   tibrv_u32    datalen;
   const void * data = m->get_as_bytes( &datalen );
+  if ( t->batch_mode == TIBRV_TRANSPORT_ASYNC_BATCH &&
+       this->ring_send( t, m->subject, m->subject_len, m->reply, m->reply_len,
+                        data, datalen ) )
+    return TIBRV_OK;
+  api_MsgData * share = NULL;
+  if ( t->id == TIBRV_PROCESS_TRANSPORT ) { /* listeners get it by reference */
+    share   = m->share_data();
+    data    = share->buf;
+    datalen = share->len;
+  }
   EvPublish pub( m->subject, m->subject_len, m->reply, m->reply_len,
-                 data, datalen, t->client.sub_route, *t->me, 0, RVMSG_TYPE_ID );
+                 data, datalen, t->conn->client.sub_route, *t->me, 0,
+                 RVMSG_TYPE_ID );
   EvPipeRec rec( OP_TPORT_SEND, t, &pub, 1, &t->mutex, &t->cond );
+  rec.data = ( share != NULL ? &share : NULL );
   pthread_mutex_lock( &t->mutex );
-  this->ev_read->exec( rec );
+  t->pipe->exec( rec );
   pthread_mutex_unlock( &t->mutex );
+  if ( share != NULL )
+    share->release();
   return TIBRV_OK;
 }
 
 void
 EvPipe::tport_send( EvPipeRec &rec ) noexcept
 {
+  rec.t->sent( 1, rec.pub->msg_len );
   if ( rec.t->id != TIBRV_PROCESS_TRANSPORT )
-    rec.t->client.publish( *rec.pub );
+    rec.t->send_pub( *rec.pub );
   else {
+    api_MsgData * prev = rec.t->send_data; /* nested by an inline callback */
     rec.pub->subj_hash =
       kv_crc_c( rec.pub->subject, rec.pub->subject_len, 0 );
-    rec.t->client.sub_route.forward_msg( *rec.pub );
+    rec.t->send_data = ( rec.data != NULL ? rec.data[ 0 ] : NULL );
+    rec.t->conn->client.sub_route.forward_msg( *rec.pub );
+    rec.t->send_data = prev;
   }
 }
 
 tibrv_status
 Tibrv_API::Sendv( tibrvTransport tport, tibrvMsg * vec, tibrv_u32 cnt ) noexcept
 {
+  api_EpochGuard guard( *this );
   if ( cnt == 0 )
     return TIBRV_OK;
 
   api_Transport * t = this->get<api_Transport>( tport, TIBRV_TRANSPORT );
   if ( t == NULL )
     return TIBRV_INVALID_TRANSPORT;
-  MDMsgMem    tmp;
-  void      * pvec = tmp.make( sizeof( EvPublish ) * cnt );
-  EvPublish * pub  = (EvPublish *) pvec;
+  MDMsgMem       tmp;
+  void         * pvec  = tmp.make( sizeof( EvPublish ) * cnt );
+  EvPublish    * pub   = (EvPublish *) pvec;
+  api_MsgData ** share = NULL;
+  if ( t->id == TIBRV_PROCESS_TRANSPORT )
+    share = (api_MsgData **) tmp.make( sizeof( share[ 0 ] ) * cnt );
 
   for ( tibrv_u32 i = 0; i < cnt; i++ ) {
     api_Msg    * m       = (api_Msg *) vec[ i ];
     tibrv_u32    datalen;
-    const void * data    = m->get_as_bytes( &datalen );
+    const void * data;
+    if ( share == NULL )
+      data = m->get_as_bytes( &datalen );
+    else {
+      share[ i ] = m->share_data();
+      data       = share[ i ]->buf;
+      datalen    = share[ i ]->len;
+    }
     new ( &pub[ i ] )
       EvPublish( m->subject, m->subject_len, m->reply, m->reply_len,
-                 data, datalen, t->client.sub_route, *t->me, 0, RVMSG_TYPE_ID );
+                 data, datalen, t->conn->client.sub_route, *t->me, 0,
+                 RVMSG_TYPE_ID );
   }
   EvPipeRec rec( OP_TPORT_SENDV, t, pub, cnt, &t->mutex, &t->cond );
+  rec.data = share;
   pthread_mutex_lock( &t->mutex );
-  this->ev_read->exec( rec );
+  t->pipe->exec( rec );
   pthread_mutex_unlock( &t->mutex );
+  if ( share != NULL ) {
+    for ( tibrv_u32 i = 0; i < cnt; i++ )
+      share[ i ]->release();
+  }
   return TIBRV_OK;
 }
 
 void
 EvPipe::tport_sendv( EvPipeRec &rec ) noexcept
 {
+  uint64_t bytes = 0;
+  for ( tibrv_u32 i = 0; i < rec.cnt; i++ )
+    bytes += rec.pub[ i ].msg_len;
+  rec.t->sent( rec.cnt, bytes );
   if ( rec.t->id != TIBRV_PROCESS_TRANSPORT ) {
     for ( tibrv_u32 i = 0; i < rec.cnt; i++ )
-      rec.t->client.publish( rec.pub[ i ] );
+      rec.t->send_pub( rec.pub[ i ] );
   }
   else {
+    api_MsgData * prev = rec.t->send_data;
     for ( tibrv_u32 i = 0; i < rec.cnt; i++ ) {
       rec.pub[ i ].subj_hash =
         kv_crc_c( rec.pub[ i ].subject, rec.pub[ i ].subject_len, 0 );
-      rec.t->client.sub_route.forward_msg( rec.pub[ i ] );
+      rec.t->send_data = ( rec.data != NULL ? rec.data[ i ] : NULL );
+      rec.t->conn->client.sub_route.forward_msg( rec.pub[ i ] );
     }
+    rec.t->send_data = prev;
+  }
+}
+
+/* A send copied by post_nowait(), dropped when the transport is gone */
+void
+EvPipe::tport_post( EvPipeRec &rec ) noexcept
+{
+  if ( ! rec.t->is_destroyed ) {
+    rec.copy->publish( *rec.t );
+    rec.t->sent( 1, rec.copy->data_len );
   }
+  ::free( rec.copy );
 }
 
 /* SINGLE_BATCH: drain the transport's shared buffer inline on E. */
@@ -1655,38 +3460,55 @@ EvPipe::stop_batch_timer( EvPipeRec &rec ) noexcept
 
 /* Batch-timer expiry, fired on E: latency backstop for sub-batch_size traffic.
  * Rearms while the transport stays in SINGLE_BATCH mode. */
-bool
-api_BatchTimer::timer_cb( uint64_t,  uint64_t ) noexcept
+static bool
+tibrv_batch_timer_cb( void *closure ) noexcept
 {
-  this->t->api.drain_send_buf( this->t );
-  return this->t->sb_timer_active;
+  api_Transport * t = (api_Transport *) closure;
+  t->api.drain_send_buf( t );
+  return t->sb_timer_active;
 }
 
 tibrv_status
 Tibrv_API::SendRequest( tibrvTransport tport, tibrvMsg msg, tibrvMsg * reply,
                         tibrv_f64 idle_timeout ) noexcept
 {
+  api_EpochGuard guard( *this ); /* t is used until the reply or timeout */
   api_Transport * t = this->get<api_Transport>( tport, TIBRV_TRANSPORT );
   if ( t == NULL )
     return TIBRV_INVALID_TRANSPORT;
+  /* an inline callback may wait for a reply read by another I/O thread, not
+   * for one that this thread would read */
+  if ( tls_io_pipe != NULL && tls_io_pipe == t->pipe )
+    return TIBRV_NOT_PERMITTED;
   api_Msg * m = (api_Msg *) msg;
   if ( m->reply_len == 0 ) {
     char inbox[ MAX_RV_INBOX_LEN ];
-    t->client.make_inbox( inbox, t->inbox_count++ );
-    size_t len = ::strlen( inbox );
+    size_t len = t->make_inbox( inbox, t->next_inbox() );
     m->reply = m->mem.stralloc( len, inbox );
     m->reply_len = len;
   }
   tibrv_u32    datalen;
   const void * data    = m->get_as_bytes( &datalen );
   EvPublish pub( m->subject, m->subject_len, m->reply, m->reply_len,
-                 data, datalen, t->client.sub_route, *t->me, 0, RVMSG_TYPE_ID );
+                 data, datalen, t->conn->client.sub_route, *t->me, 0,
+                 RVMSG_TYPE_ID );
   EvPipeRec rec( OP_TPORT_SEND, t, &pub, 1, &t->mutex, &t->cond );
   api_Rpc   rpc( m->reply, m->reply_len,
                  kv_crc_c( m->reply, m->reply_len, 0 ) );
   pthread_mutex_lock( &t->mutex );
-  t->rpc_list.push_hd( &rpc );
-  this->ev_read->exec( rec );
+  t->rpc_ht.push( &rpc );
+  if ( t->batch_mode == TIBRV_TRANSPORT_ASYNC_BATCH ) {
+    /* don't hold the mutex while waiting for ring space, E needs it */
+    pthread_mutex_unlock( &t->mutex );
+    bool queued = this->ring_send( t, m->subject, m->subject_len, m->reply,
+                                   m->reply_len, data, datalen );
+    pthread_mutex_lock( &t->mutex );
+    if ( ! queued )
+      t->pipe->exec( rec );
+  }
+  else {
+    t->pipe->exec( rec );
+  }
   struct timespec ts = ts_timeout( idle_timeout );
   while ( rpc.reply == NULL ) {
     if ( idle_timeout >= 0.0 ) {
@@ -1698,7 +3520,7 @@ Tibrv_API::SendRequest( tibrvTransport tport, tibrvMsg msg, tibrvMsg * reply,
     }
   }
   *reply = rpc.reply;
-  t->rpc_list.pop( &rpc );
+  t->rpc_ht.remove( &rpc );
   if ( rpc.reply != NULL )
     rpc.reply->in_queue = false;
   pthread_mutex_unlock( &t->mutex );
@@ -1708,10 +3530,126 @@ Tibrv_API::SendRequest( tibrvTransport tport, tibrvMsg msg, tibrvMsg * reply,
   return TIBRV_OK;
 }
 
+/* Send a request and return, the reply or a timeout (msg == NULL) is
+ * dispatched from queue q as cb( tport, msg, closure ) */
+tibrv_status
+Tibrv_API::SendRequestAsync( tibrvTransport tport, tibrvMsg msg,
+                             tibrvEventCallback cb, tibrvQueue q,
+                             tibrv_f64 idle_timeout,
+                             const void * closure ) noexcept
+{
+  api_EpochGuard guard( *this );
+  api_Transport * t = this->get<api_Transport>( tport, TIBRV_TRANSPORT );
+  if ( t == NULL )
+    return TIBRV_INVALID_TRANSPORT;
+  if ( cb == NULL )
+    return TIBRV_INVALID_CALLBACK;
+  if ( this->get<api_Queue>( q, TIBRV_QUEUE ) == NULL )
+    return TIBRV_INVALID_QUEUE;
+  api_Msg * m = (api_Msg *) msg;
+  if ( m->reply_len == 0 ) {
+    char inbox[ MAX_RV_INBOX_LEN ];
+    pthread_mutex_lock( &t->mutex );
+    size_t len = t->make_inbox( inbox, t->next_inbox() );
+    pthread_mutex_unlock( &t->mutex );
+    m->reply = m->mem.stralloc( len, inbox );
+    m->reply_len = len;
+  }
+  void    * p   = ::malloc( sizeof( api_Rpc ) + m->reply_len + 1 );
+  char    * sub = (char *) p + sizeof( api_Rpc );
+  ::memcpy( sub, m->reply, m->reply_len );
+  sub[ m->reply_len ] = '\0';
+  api_Rpc * r = new ( p ) api_Rpc( sub, m->reply_len,
+                                   kv_crc_c( sub, m->reply_len, 0 ) );
+  r->cb    = cb;
+  r->cl    = closure;
+  r->queue = q;
+
+  tibrv_u32    datalen;
+  const void * data    = m->get_as_bytes( &datalen );
+  EvPublish pub( m->subject, m->subject_len, m->reply, m->reply_len,
+                 data, datalen, t->conn->client.sub_route, *t->me, 0,
+                 RVMSG_TYPE_ID );
+  EvPipeRec rec( OP_TPORT_SEND, t, &pub, 1, &t->mutex, &t->cond );
+  pthread_mutex_lock( &t->mutex );
+  t->rpc_ht.push( r );
+  if ( idle_timeout >= 0.0 ) {
+    if ( t->rpc_wheel == NULL )
+      t->rpc_wheel = new ( ::malloc( sizeof( api_RpcWheel ) ) )
+                     api_RpcWheel( t );
+    uint64_t ticks = (uint64_t) ( idle_timeout * 1000.0 ) / RPC_WHEEL_TICK_MS;
+    r->expire_tick = api_RpcWheel::current_tick() + ticks + 1;
+    t->rpc_wheel->add( r );
+    if ( ! t->rpc_wheel->active ) {
+      EvPipeRec rec2( OP_START_RPC_TMR, t, (EvRvClientParameters *) NULL,
+                      &t->mutex, &t->cond );
+      t->rpc_wheel->active    = true;
+      t->rpc_wheel->last_tick = api_RpcWheel::current_tick();
+      t->pipe->exec( rec2 );
+    }
+  }
+  if ( t->batch_mode == TIBRV_TRANSPORT_ASYNC_BATCH ) {
+    pthread_mutex_unlock( &t->mutex );
+    if ( this->ring_send( t, m->subject, m->subject_len, m->reply,
+                          m->reply_len, data, datalen ) )
+      return TIBRV_OK;
+    pthread_mutex_lock( &t->mutex );
+  }
+  t->pipe->exec( rec );
+  pthread_mutex_unlock( &t->mutex );
+  return TIBRV_OK;
+}
+
+/* Stop the timeout wheel and drop the async requests still pending */
+void
+Tibrv_API::free_rpc_wheel( api_Transport * t ) noexcept
+{
+  pthread_mutex_lock( &t->mutex );
+  if ( t->rpc_wheel != NULL && t->rpc_wheel->active ) {
+    EvPipeRec rec( OP_STOP_RPC_TMR, t, (EvRvClientParameters *) NULL,
+                   &t->mutex, &t->cond );
+    t->pipe->exec( rec );
+    t->rpc_wheel->active = false;
+  }
+  if ( t->rpc_ht.ht != NULL ) {
+    for ( size_t i = 0; i <= t->rpc_ht.mask; i++ ) {
+      api_Rpc * next;
+      for ( api_Rpc * r = t->rpc_ht.ht[ i ].hd; r != NULL; r = next ) {
+        next = r->next;
+        if ( r->cb != NULL ) {
+          t->rpc_ht.remove( r );
+          if ( r->expire_tick != 0 )
+            t->rpc_wheel->remove( r );
+          delete r;
+        }
+      }
+    }
+  }
+  if ( t->rpc_wheel != NULL ) {
+    delete t->rpc_wheel;
+    t->rpc_wheel = NULL;
+  }
+  pthread_mutex_unlock( &t->mutex );
+}
+
+void
+EvPipe::start_rpc_timer( EvPipeRec &rec ) noexcept
+{
+  this->poll.timer.add_timer_millis( *rec.t->rpc_wheel, RPC_WHEEL_TICK_MS,
+                                     (uint64_t) rec.t->id, 0 );
+}
+
+void
+EvPipe::stop_rpc_timer( EvPipeRec &rec ) noexcept
+{
+  this->poll.timer.remove_timer_cb( *rec.t->rpc_wheel, (uint64_t) rec.t->id, 0 );
+}
+
 tibrv_status
 Tibrv_API::SendReply( tibrvTransport tport, tibrvMsg msg,
                       tibrvMsg request_msg ) noexcept
 {
+  api_EpochGuard guard( *this );
   api_Transport * t = this->get<api_Transport>( tport, TIBRV_TRANSPORT );
   if ( t == NULL )
     return TIBRV_INVALID_TRANSPORT;
@@ -1719,30 +3657,134 @@ Tibrv_API::SendReply( tibrvTransport tport, tibrvMsg msg,
              * r       = (api_Msg *) request_msg;
   tibrv_u32    datalen;
   const void * data    = m->get_as_bytes( &datalen );
+  if ( t->batch_mode == TIBRV_TRANSPORT_ASYNC_BATCH &&
+       this->ring_send( t, r->reply, r->reply_len, m->reply, m->reply_len,
+                        data, datalen ) )
+    return TIBRV_OK;
   EvPublish pub( r->reply, r->reply_len, m->reply, m->reply_len,
-                 data, datalen, t->client.sub_route, *t->me, 0, RVMSG_TYPE_ID );
+                 data, datalen, t->conn->client.sub_route, *t->me, 0,
+                 RVMSG_TYPE_ID );
   EvPipeRec rec( OP_TPORT_SEND, t, &pub, 1, &t->mutex, &t->cond );
   pthread_mutex_lock( &t->mutex );
-  this->ev_read->exec( rec );
+  t->pipe->exec( rec );
   pthread_mutex_unlock( &t->mutex );
   return TIBRV_OK;
 }
 
+/* Open a private daemon connection for t on I/O thread k, or the least
+ * loaded when k is 0, a receive lane or the heartbeat conn of an FT member;
+ * it is not shared and reconnects with the alternate daemons of t */
+tibrv_status
+Tibrv_API::open_aux( api_Transport * t,  api_Transport *& c,
+                     uint32_t k ) noexcept
+{
+  EvRvClientParameters parm( t->x.daemon, t->x.network, t->x.service );
+  parm.opts |= kv::OPT_CONNECT_NB;
+  tls_io_pin = k;
+  c = this->make<api_Transport>( TIBRV_TRANSPORT );
+  tls_io_pin = 0;
+  c->lane_of         = t;
+  c->x.service       = t->x.service; /* t is never freed */
+  c->x.network       = t->x.network;
+  c->x.daemon        = t->x.daemon;
+  c->reconn.min_ival = t->reconn.min_ival;
+  c->reconn.max_ival = t->reconn.max_ival;
+  return this->connect_tport( c, parm );
+}
+
+/* Close an aux conn and unmap it, the object is retired on its I/O thread
+ * once the socket is released; callers hold an api_EpochGuard */
+void
+Tibrv_API::close_aux( api_Transport * c ) noexcept
+{
+  pthread_mutex_lock( &c->mutex );
+  c->is_destroyed = true;
+  c->conn_refs    = 0;
+  EvPipeRec rec( OP_CLOSE_AUX, c, (EvRvClientParameters *) NULL,
+                 &c->mutex, &c->cond );
+  c->pipe->exec( rec );
+  __atomic_fetch_sub( &this->io_load[ c->io_idx ], 1, __ATOMIC_RELAXED );
+  this->rem<api_Transport>( c->id, TIBRV_TRANSPORT ); /* slot is reused */
+  pthread_mutex_unlock( &c->mutex );
+}
+
+/* Stop reconnecting and close, on_shutdown() frees it after the release, or
+ * now when not connected */
+void
+EvPipe::close_aux( EvPipeRec &rec ) noexcept
+{
+  api_Transport * c = rec.t;
+  this->poll.timer.remove_timer_cb( c->reconn, (uint64_t) c->id,
+                                    c->reconn.timer_gen );
+  c->reconn.reset();
+  if ( c->client.in_list( IN_ACTIVE_LIST ) ) {
+    c->aux_close = true;
+    c->client.idle_push( EV_CLOSE );
+  }
+  else {
+    EvPipeRec op( OP_FREE_AUX, c, (EvRvClientParameters *) NULL, NULL, NULL );
+    this->post( op );
+  }
+}
+
+void
+EvPipe::free_aux( EvPipeRec &rec ) noexcept
+{
+  rec.t->api.retire( rec.t );
+}
+
 tibrv_status
 Tibrv_API::DestroyTransport( tibrvTransport tport ) noexcept
 {
+  api_EpochGuard guard( *this );
   api_Transport * t = this->get<api_Transport>( tport, TIBRV_TRANSPORT );
   if ( t == NULL )
     return TIBRV_INVALID_TRANSPORT;
 
   this->free_transport_writers( t );
   this->free_send_buf( t );
-  pthread_mutex_lock( &t->mutex );
-  EvPipeRec rec2( OP_CLOSE_TPORT, t, (EvRvClientParameters *) NULL,
-                  &t->mutex, &t->cond );
-  t->api.ev_read->exec( rec2 );
+  this->free_send_rings( t );
+  this->free_rpc_wheel( t );
+
+  api_Transport * c = t->conn;
+  pthread_mutex_lock( &c->mutex ); /* on_rv_msg() walks the shares locked */
+  if ( t->is_destroyed ) {
+    pthread_mutex_unlock( &c->mutex );
+    return TIBRV_OK;
+  }
   t->is_destroyed = true;
-  pthread_mutex_unlock( &t->mutex );
+  if ( t != c ) {
+    api_Transport ** p = &c->share_next;
+    while ( *p != t )
+      p = &(*p)->share_next;
+    *p = t->share_next;
+  }
+  if ( c->conn_refs > 1 ) { /* the others keep the connection */
+    c->conn_refs--;
+    pthread_mutex_unlock( &c->mutex );
+    this->drop_subs( t );
+    return TIBRV_OK;
+  }
+  c->conn_refs = 0;
+  EvPipeRec rec2( OP_CLOSE_TPORT, c, (EvRvClientParameters *) NULL,
+                  &c->mutex, &c->cond );
+  c->pipe->exec( rec2 );
+  __atomic_fetch_sub( &this->io_load[ c->io_idx ], 1, __ATOMIC_RELAXED );
+  pthread_mutex_unlock( &c->mutex );
+  uint32_t n = t->lane_count;
+  __atomic_store_n( &t->lane_count, 0, __ATOMIC_RELEASE );
+  for ( uint32_t k = 1; k < n; k++ )
+    this->close_aux( t->lanes[ k ] );
+  if ( t->lanes != NULL ) /* lane() may still read it under a guard */
+    this->retire_ptr( t->lanes, ::free );
+  /* conn_refs is 0 on the conn and its lanes, none reconnects again */
+  pthread_mutex_lock( &c->mutex );
+  char ** d = c->reconn.daemons;
+  c->reconn.daemons  = NULL;
+  c->reconn.ndaemons = 0;
+  pthread_mutex_unlock( &c->mutex );
+  if ( d != NULL )
+    ::free( d );
   return TIBRV_OK;
 }
 
@@ -1750,6 +3792,7 @@ tibrv_status
 Tibrv_API::CreateInbox( tibrvTransport tport, char * inbox_str,
                         tibrv_u32 inbox_len ) noexcept
 {
+  api_EpochGuard guard( *this );
   api_Transport * t = this->get<api_Transport>( tport, TIBRV_TRANSPORT );
   if ( t == NULL ) {
     if ( inbox_len > 0 )
@@ -1758,17 +3801,11 @@ Tibrv_API::CreateInbox( tibrvTransport tport, char * inbox_str,
   }
 
   pthread_mutex_lock( &t->mutex );
-  uint32_t num = t->inbox_count++;
+  uint32_t num = t->next_inbox();
   pthread_mutex_unlock( &t->mutex );
 
   char inbox[ MAX_RV_INBOX_LEN ];
-  CatPtr p( inbox );
-  p.s( "_INBOX." );
-  if ( t->x.session_len > 0 ) {
-    p.b( t->x.session, t->x.session_len )
-     .c( '.' );
-  }
-  size_t len = p.u( num ).end();
+  size_t len = t->make_inbox( inbox, num );
   if ( inbox_len > 0 )
     ::memcpy( inbox_str, inbox, len + 1 <= inbox_len ? len + 1 : inbox_len );
   return TIBRV_OK;
@@ -1777,36 +3814,40 @@ Tibrv_API::CreateInbox( tibrvTransport tport, char * inbox_str,
 tibrv_status
 Tibrv_API::GetService( tibrvTransport tport, const char ** service_string ) noexcept
 {
+  api_EpochGuard guard( *this );
   api_Transport * t = this->get<api_Transport>( tport, TIBRV_TRANSPORT );
   if ( t == NULL )
     return TIBRV_INVALID_TRANSPORT;
-  *service_string = t->client.service;
+  *service_string = t->conn->client.service;
   return TIBRV_OK;
 }
 
 tibrv_status
 Tibrv_API::GetNetwork( tibrvTransport tport, const char ** network_string ) noexcept
 {
+  api_EpochGuard guard( *this );
   api_Transport * t = this->get<api_Transport>( tport, TIBRV_TRANSPORT );
   if ( t == NULL )
     return TIBRV_INVALID_TRANSPORT;
-  *network_string = t->client.network;
+  *network_string = t->conn->client.network;
   return TIBRV_OK;
 }
 
 tibrv_status
 Tibrv_API::GetDaemon( tibrvTransport tport, const char ** daemon_string ) noexcept
 {
+  api_EpochGuard guard( *this );
   api_Transport * t = this->get<api_Transport>( tport, TIBRV_TRANSPORT );
   if ( t == NULL )
     return TIBRV_INVALID_TRANSPORT;
-  *daemon_string = t->client.daemon;
+  *daemon_string = t->conn->client.daemon;
   return TIBRV_OK;
 }
 
 tibrv_status
 Tibrv_API::SetDescription( tibrvTransport tport, const char * descr ) noexcept
 {
+  api_EpochGuard guard( *this );
   api_Transport * t = this->get<api_Transport>( tport, TIBRV_TRANSPORT );
   if ( t == NULL )
     return TIBRV_INVALID_TRANSPORT;
@@ -1817,6 +3858,7 @@ Tibrv_API::SetDescription( tibrvTransport tport, const char * descr ) noexcept
 tibrv_status
 Tibrv_API::GetDescription( tibrvTransport tport, const char ** descr ) noexcept
 {
+  api_EpochGuard guard( *this );
   api_Transport * t = this->get<api_Transport>( tport, TIBRV_TRANSPORT );
   if ( t == NULL )
     return TIBRV_INVALID_TRANSPORT;
@@ -1827,6 +3869,7 @@ Tibrv_API::GetDescription( tibrvTransport tport, const char ** descr ) noexcept
 tibrv_status
 Tibrv_API::SetSendingWaitLimit( tibrvTransport tport, tibrv_u32 num_bytes ) noexcept
 {
+  api_EpochGuard guard( *this );
   api_Transport * t = this->get<api_Transport>( tport, TIBRV_TRANSPORT );
   if ( t == NULL )
     return TIBRV_INVALID_TRANSPORT;
@@ -1837,6 +3880,7 @@ Tibrv_API::SetSendingWaitLimit( tibrvTransport tport, tibrv_u32 num_bytes ) noex
 tibrv_status
 Tibrv_API::GetSendingWaitLimit( tibrvTransport tport, tibrv_u32 * num_bytes ) noexcept
 {
+  api_EpochGuard guard( *this );
   api_Transport * t = this->get<api_Transport>( tport, TIBRV_TRANSPORT );
   if ( t == NULL )
     return TIBRV_INVALID_TRANSPORT;
@@ -1847,6 +3891,7 @@ Tibrv_API::GetSendingWaitLimit( tibrvTransport tport, tibrv_u32 * num_bytes ) no
 tibrv_status
 Tibrv_API::SetBatchMode( tibrvTransport tport, tibrvTransportBatchMode mode ) noexcept
 {
+  api_EpochGuard guard( *this );
   api_Transport * t = this->get<api_Transport>( tport, TIBRV_TRANSPORT );
   if ( t == NULL )
     return TIBRV_INVALID_TRANSPORT;
@@ -1855,8 +3900,8 @@ Tibrv_API::SetBatchMode( tibrvTransport tport, tibrvTransportBatchMode mode ) no
     /* one shared, double-buffered accumulator + an E-thread flush timer */
     t->sb_fill  = new ( ::malloc( sizeof( SendCtx ) ) ) SendCtx( t );
     t->sb_spare = new ( ::malloc( sizeof( SendCtx ) ) ) SendCtx( t );
-    t->sb_timer = new ( ::malloc( sizeof( api_BatchTimer ) ) )
-                  api_BatchTimer( t );
+    t->sb_timer = new ( ::malloc( sizeof( SendBatchTimer ) ) )
+                  SendBatchTimer( tibrv_batch_timer_cb, t );
   }
   return TIBRV_OK;
 }
@@ -1864,6 +3909,7 @@ Tibrv_API::SetBatchMode( tibrvTransport tport, tibrvTransportBatchMode mode ) no
 tibrv_status
 Tibrv_API::SetBatchInterval( tibrvTransport tport, tibrv_f64 secs ) noexcept
 {
+  api_EpochGuard guard( *this );
   api_Transport * t = this->get<api_Transport>( tport, TIBRV_TRANSPORT );
   if ( t == NULL )
     return TIBRV_INVALID_TRANSPORT;
@@ -1874,15 +3920,149 @@ Tibrv_API::SetBatchInterval( tibrvTransport tport, tibrv_f64 secs ) noexcept
     EvPipeRec rec( OP_START_BATCH_TMR, t, (EvRvClientParameters *) NULL,
                    &t->mutex, &t->cond );
     pthread_mutex_lock( &t->mutex );
-    this->ev_read->exec( rec );
+    t->pipe->exec( rec );
     pthread_mutex_unlock( &t->mutex );
   }
   return TIBRV_OK;
 }
 
+tibrv_status
+Tibrv_API::GetTransportStats( tibrvTransport tport,
+                              tibrvTransportStats * stats ) noexcept
+{
+  api_EpochGuard guard( *this );
+  api_Transport * t = this->get<api_Transport>( tport, TIBRV_TRANSPORT );
+  if ( t == NULL )
+    return TIBRV_INVALID_TRANSPORT;
+  stats_load( stats, &t->stats, sizeof( *stats ) );
+  stats->pipe_rtt_max_ns =
+    __atomic_exchange_n( &t->stats.pipe_rtt_max_ns, 0, __ATOMIC_RELAXED );
+  for ( uint32_t k = 1; k < t->lane_count; k++ ) { /* receive counts */
+    tibrvTransportStats & ls = t->lanes[ k ]->stats;
+    stats->msgs_in       += __atomic_load_n( &ls.msgs_in, __ATOMIC_RELAXED );
+    stats->bytes_in      += __atomic_load_n( &ls.bytes_in, __ATOMIC_RELAXED );
+    stats->msgs_filtered += __atomic_load_n( &ls.msgs_filtered,
+                                             __ATOMIC_RELAXED );
+    stats->reconnects    += __atomic_load_n( &ls.reconnects,
+                                             __ATOMIC_RELAXED );
+  }
+  return TIBRV_OK;
+}
+
+tibrv_status
+Tibrv_API::SetReconnect( tibrvTransport tport, tibrv_f64 min_ival,
+                         tibrv_f64 max_ival, tibrv_u32 buffer_bytes ) noexcept
+{
+  api_EpochGuard guard( *this );
+  api_Transport * t = this->get<api_Transport>( tport, TIBRV_TRANSPORT );
+  if ( t == NULL || t->id == TIBRV_PROCESS_TRANSPORT )
+    return TIBRV_INVALID_TRANSPORT;
+  if ( min_ival < 0.0 || max_ival < min_ival )
+    return TIBRV_INVALID_ARG;
+  api_Transport * c = t->conn; /* shared by the transports on it */
+  pthread_mutex_lock( &c->mutex );
+  c->reconn.min_ival  = min_ival;
+  c->reconn.max_ival  = max_ival;
+  c->reconn.buf_limit = buffer_bytes;
+  pthread_mutex_unlock( &c->mutex );
+  for ( uint32_t k = 1; k < t->lane_count; k++ ) { /* lanes only receive */
+    api_Transport * lt = t->lanes[ k ];
+    pthread_mutex_lock( &lt->mutex );
+    lt->reconn.min_ival = min_ival;
+    lt->reconn.max_ival = max_ival;
+    pthread_mutex_unlock( &lt->mutex );
+  }
+  return TIBRV_OK;
+}
+
+tibrv_status
+Tibrv_API::SetAlternateDaemons( tibrvTransport tport, const char ** daemons,
+                                tibrv_u32 count ) noexcept
+{
+  api_EpochGuard guard( *this );
+  api_Transport * t = this->get<api_Transport>( tport, TIBRV_TRANSPORT );
+  if ( t == NULL || t->id == TIBRV_PROCESS_TRANSPORT )
+    return TIBRV_INVALID_TRANSPORT;
+  size_t sz = sizeof( char * ) * count;
+  for ( tibrv_u32 i = 0; i < count; i++ ) {
+    if ( daemons[ i ] == NULL )
+      return TIBRV_INVALID_ARG;
+    sz += ::strlen( daemons[ i ] ) + 1;
+  }
+  char ** d = NULL;
+  if ( count > 0 ) { /* one block, the pointers then the strings */
+    if ( (d = (char **) ::malloc( sz )) == NULL )
+      return TIBRV_NO_MEMORY;
+    char * p = (char *) (void *) &d[ count ];
+    for ( tibrv_u32 i = 0; i < count; i++ ) {
+      size_t len = ::strlen( daemons[ i ] ) + 1;
+      ::memcpy( p, daemons[ i ], len );
+      d[ i ] = p;
+      p = &p[ len ];
+    }
+  }
+  api_Transport * c = t->conn;
+  pthread_mutex_lock( &c->mutex );
+  char ** old = c->reconn.daemons;
+  c->reconn.daemons  = d;
+  c->reconn.ndaemons = count;
+  pthread_mutex_unlock( &c->mutex );
+  /* lanes connect with these under their own mutex, wait for any using old */
+  for ( uint32_t k = 1; k < t->lane_count; k++ ) {
+    pthread_mutex_lock( &t->lanes[ k ]->mutex );
+    pthread_mutex_unlock( &t->lanes[ k ]->mutex );
+  }
+  if ( old != NULL )
+    ::free( old );
+  return TIBRV_OK;
+}
+
+/* Open count - 1 more daemon connections to receive for t, each is a
+ * transport on the least loaded I/O thread; a listener subscribes on one of
+ * them by the hash of its subject, so a subject arrives on one connection, in
+ * order, and every connection delivers into the listener queues */
+tibrv_status
+Tibrv_API::SetReceiveLanes( tibrvTransport tport, tibrv_u32 count ) noexcept
+{
+  api_EpochGuard guard( *this );
+  api_Transport * t = this->get<api_Transport>( tport, TIBRV_TRANSPORT );
+  if ( t == NULL || t->id == TIBRV_PROCESS_TRANSPORT || t->lane_of != NULL )
+    return TIBRV_INVALID_TRANSPORT;
+  if ( count == 0 || count > API_MAX_LANES )
+    return TIBRV_INVALID_ARG;
+  pthread_mutex_lock( &t->mutex );
+  bool ok = ( t->lane_count == 0 && t->conn == t && t->share_next == NULL &&
+              t->conn_refs != 0 && t->ht.count == 0 );
+  pthread_mutex_unlock( &t->mutex );
+  if ( ! ok ) /* shared, or listeners already placed */
+    return TIBRV_NOT_PERMITTED;
+  if ( count == 1 )
+    return TIBRV_OK;
+
+  api_Transport ** lanes = (api_Transport **)
+    ::malloc( sizeof( lanes[ 0 ] ) * count );
+  tibrv_status ret = TIBRV_OK;
+  uint32_t     k;
+  lanes[ 0 ] = t;
+  for ( k = 1; k < count && ret == TIBRV_OK; k++ )
+    ret = this->open_aux( t, lanes[ k ] );
+  if ( ret != TIBRV_OK ) {
+    while ( k > 1 )
+      this->close_aux( lanes[ --k ] );
+    ::free( lanes );
+    return ret;
+  }
+  pthread_mutex_lock( &t->mutex );
+  t->lanes = lanes;
+  __atomic_store_n( &t->lane_count, count, __ATOMIC_RELEASE );
+  pthread_mutex_unlock( &t->mutex );
+  return TIBRV_OK;
+}
+
 tibrv_status
 Tibrv_API::SetBatchSize( tibrvTransport tport, tibrv_u32 num_bytes ) noexcept
 {
+  api_EpochGuard guard( *this );
   api_Transport * t = this->get<api_Transport>( tport, TIBRV_TRANSPORT );
   if ( t == NULL )
     return TIBRV_INVALID_TRANSPORT;
@@ -1894,6 +4074,7 @@ tibrv_status
 Tibrv_API::RequestReliability( tibrvTransport tport,
                                tibrv_f64 /*reliability*/ ) noexcept
 {
+  api_EpochGuard guard( *this );
   api_Transport * t = this->get<api_Transport>( tport, TIBRV_TRANSPORT );
   if ( t == NULL )
     return TIBRV_INVALID_TRANSPORT;
@@ -1904,6 +4085,7 @@ tibrv_status
 Tibrv_API::CreateDispatcher( tibrvDispatcher * disp, tibrvDispatchable able,
                              tibrv_f64 idle_timeout ) noexcept
 {
+  api_EpochGuard guard( *this );
   api_Dispatcher * d = this->make<api_Dispatcher>( TIBRV_DISPATCHER );
   *disp = d->id;
   d->queue = able;
@@ -1924,6 +4106,102 @@ Tibrv_API::CreateDispatcher( tibrvDispatcher * disp, tibrvDispatchable able,
   return TIBRV_OK;
 }
 
+tibrv_status
+Tibrv_API::CreateDispatchPool( tibrvDispatcher * disp, tibrvDispatchable able,
+                               tibrv_f64 idle_timeout, tibrv_u32 num_threads,
+                               tibrvDispatchPartition part ) noexcept
+{
+  api_EpochGuard guard( *this );
+  if ( num_threads <= 1 )
+    return this->CreateDispatcher( disp, able, idle_timeout );
+  *disp = TIBRV_INVALID_ID;
+  if ( this->get<api_Queue>( able, TIBRV_QUEUE ) == NULL )
+    return TIBRV_INVALID_DISPATCHABLE;
+
+  api_Dispatcher * d = this->make<api_Dispatcher>( TIBRV_DISPATCHER );
+  *disp = d->id;
+  d->queue = able;
+  d->idle_timeout = idle_timeout;
+  d->is_queue = true;
+
+  size_t sz = sizeof( api_DispatchPool ) +
+              sizeof( api_DispatchPart ) * num_threads * 8 +
+              sizeof( pthread_t ) * num_threads;
+  void * p = ::malloc( sz );
+  ::memset( p, 0, sz );
+  api_DispatchPool * pool = new ( p ) api_DispatchPool( *d, num_threads, part );
+  pool->part = (api_DispatchPart *) (void *) &pool[ 1 ];
+  pool->thr  = (pthread_t *) (void *) &pool->part[ pool->nparts ];
+  d->pool    = pool;
+
+  pthread_mutex_lock( &pool->mutex ); /* workers find their slot in thr[] */
+  for ( uint32_t w = 1; w < num_threads; w++ )
+    pthread_create( &pool->thr[ w ], NULL, tibrv_disp_pool_worker, pool );
+  pthread_mutex_unlock( &pool->mutex );
+
+  pthread_attr_t attr;
+  pthread_attr_init( &attr );
+  pthread_attr_setdetachstate( &attr, 1 );
+  pthread_create( &d->thr_id, &attr, tibrv_disp_pool_thread, d );
+  pool->thr[ 0 ] = d->thr_id;
+  return TIBRV_OK;
+}
+
+/* Leader side of a pool dispatcher: take a batch, fan it out, join it */
+tibrv_status
+Tibrv_API::TimedDispatchPool( api_Dispatcher & disp, tibrv_f64 timeout ) noexcept
+{
+  api_DispatchPool & pool  = *disp.pool;
+  api_Queue        * queue = this->get<api_Queue>( disp.queue, TIBRV_QUEUE );
+  if ( queue == NULL || queue->done )
+    return TIBRV_INVALID_QUEUE;
+  pthread_mutex_lock( &queue->mutex );
+  if ( queue->list.is_empty() && queue->spin_us != 0 )
+    queue->spin_wait( timeout );
+  while ( queue->list.is_empty() ) {
+    struct timespec ts = ts_timeout( timeout, 1.0 );
+    pthread_cond_timedwait( &queue->cond, &queue->mutex, &ts );
+    if ( timeout != TIBRV_WAIT_FOREVER || queue->done || disp.quit )
+      break;
+  }
+  if ( queue->list.is_empty() ) {
+    pthread_mutex_unlock( &queue->mutex );
+    if ( queue->done )
+      return queue->finish_queue();
+    return TIBRV_TIMEOUT;
+  }
+  TibrvQueueEventList list2;
+  queue->take_list( list2 );
+  pthread_mutex_unlock( &queue->mutex );
+
+  pool.queue = queue;
+  do {
+    TibrvQueueEvent * e = list2.pop_hd();
+    pool.part[ pool.key( e ) % pool.nparts ].list.push_tl( e );
+  } while ( ! list2.is_empty() );
+  for ( uint32_t p = 0; p < pool.nparts; p++ )
+    pool.part[ p ].claimed = 0;
+
+  pthread_mutex_lock( &pool.mutex );
+  pool.running = pool.nthreads;
+  pool.gen++;
+  pthread_cond_broadcast( &pool.start_cond );
+  pthread_mutex_unlock( &pool.mutex );
+
+  pool.run_batch( 0 );
+
+  pthread_mutex_lock( &pool.mutex );
+  if ( --pool.running > 0 ) {
+    while ( pool.running > 0 )
+      pthread_cond_wait( &pool.done_cond, &pool.mutex );
+  }
+  pthread_mutex_unlock( &pool.mutex );
+
+  if ( queue->done )
+    return queue->finish_queue();
+  return TIBRV_OK;
+}
+
 tibrv_status
 Tibrv_API::JoinDispatcher( tibrvDispatcher disp ) noexcept
 {
@@ -1967,6 +4245,7 @@ Tibrv_API::JoinDispatcher( tibrvDispatcher disp ) noexcept
 tibrv_status
 Tibrv_API::SetDispatcherName( tibrvDispatcher disp, const char * name ) noexcept
 {
+  api_EpochGuard guard( *this );
   api_Dispatcher * d = this->get<api_Dispatcher>( disp, TIBRV_DISPATCHER );
   if ( d == NULL )
     return TIBRV_INVALID_DISPATCHABLE;
@@ -1977,6 +4256,7 @@ Tibrv_API::SetDispatcherName( tibrvDispatcher disp, const char * name ) noexcept
 tibrv_status
 Tibrv_API::GetDispatcherName( tibrvDispatcher disp, const char ** name ) noexcept
 {
+  api_EpochGuard guard( *this );
   api_Dispatcher * d = this->get<api_Dispatcher>( disp, TIBRV_DISPATCHER );
   if ( d == NULL )
     return TIBRV_INVALID_DISPATCHABLE;
@@ -1996,11 +4276,23 @@ tibrv_Version( void )
   return "sassrv-" kv_stringify( SASSRV_VER );
 }
 
+/* set by tibrv_SetIoThreads() before open */
+static bool      io_cfg_set     = false;
+static tibrv_u32 io_threads_cfg = 1;
+static tibrv_i32 io_cpus_cfg[ API_MAX_IO_THREADS ];
+static bool      share_cfg      = false;
+
 tibrv_status
 tibrv_Open( void )
 {
   if ( tibrv_api == NULL ) {
     tibrv_api = new ( aligned_malloc( sizeof( Tibrv_API ) ) ) Tibrv_API();
+    if ( io_cfg_set ) {
+      tibrv_api->io_count = io_threads_cfg;
+      for ( tibrv_u32 k = 0; k < io_threads_cfg; k++ )
+        tibrv_api->io_cpu[ k ] = io_cpus_cfg[ k ];
+    }
+    tibrv_api->share_tports = share_cfg;
     return tibrv_api->Open();
   }
   return TIBRV_OK;
@@ -2009,6 +4301,31 @@ tibrv_Open( void )
 tibrv_status
 tibrv_Close( void )
 {
+  if ( tibrv_api != NULL )
+    tibrv_api->Close();
+  return TIBRV_OK;
+}
+
+tibrv_status
+tibrv_SetIoThreads( tibrv_u32 num_threads,  const tibrv_i32 * cpus )
+{
+  if ( tibrv_api != NULL )
+    return TIBRV_NOT_PERMITTED;
+  if ( num_threads == 0 || num_threads > API_MAX_IO_THREADS )
+    return TIBRV_INVALID_ARG;
+  io_cfg_set     = true;
+  io_threads_cfg = num_threads;
+  for ( tibrv_u32 k = 0; k < API_MAX_IO_THREADS; k++ )
+    io_cpus_cfg[ k ] = ( cpus != NULL && k < num_threads ? cpus[ k ] : -1 );
+  return TIBRV_OK;
+}
+
+tibrv_status
+tibrv_SetTransportSharing( tibrv_bool on )
+{
+  share_cfg = ( on != TIBRV_FALSE );
+  if ( tibrv_api != NULL ) /* applies to transports created after */
+    tibrv_api->share_tports = share_cfg;
   return TIBRV_OK;
 }
 
@@ -2091,6 +4408,12 @@ tibrvEvent_GetListenerTransport( tibrvEvent event,  tibrvTransport * tport )
   return tibrv_api->GetListenerTransport( event, tport );
 }
 
+tibrv_status
+tibrvEvent_SetListenerFilter( tibrvEvent event,  const char * expr )
+{
+  return tibrv_api->SetListenerFilter( event, expr );
+}
+
 tibrv_status
 tibrvEvent_GetTimerInterval( tibrvEvent event,  tibrv_f64 * ival )
 {
@@ -2183,6 +4506,36 @@ tibrvQueue_GetHook( tibrvQueue q, tibrvQueueHook * hook )
   return tibrv_api->GetQueueHook( q, hook );
 }
 
+tibrv_status
+tibrvQueue_SetInlineDispatch( tibrvQueue q, tibrv_bool on )
+{
+  return tibrv_api->SetQueueInline( q, on );
+}
+
+tibrv_status
+tibrvQueue_GetInlineDispatch( tibrvQueue q, tibrv_bool * on )
+{
+  return tibrv_api->GetQueueInline( q, on );
+}
+
+tibrv_status
+tibrvQueue_SetSpinTime( tibrvQueue q, tibrv_u32 spin_us )
+{
+  return tibrv_api->SetQueueSpin( q, spin_us );
+}
+
+tibrv_status
+tibrvQueue_GetSpinTime( tibrvQueue q, tibrv_u32 * spin_us )
+{
+  return tibrv_api->GetQueueSpin( q, spin_us );
+}
+
+tibrv_status
+tibrvQueue_GetStats( tibrvQueue q, tibrvQueueStats * stats )
+{
+  return tibrv_api->GetQueueStats( q, stats );
+}
+
 tibrv_status
 tibrvQueueGroup_Create( tibrvQueueGroup * grp )
 {
@@ -2213,6 +4566,12 @@ tibrvQueueGroup_Remove( tibrvQueueGroup grp, tibrvQueue q )
   return tibrv_api->RemoveQueueGroup( grp, q );
 }
 
+tibrv_status
+tibrvQueueGroup_SetSpinTime( tibrvQueueGroup grp, tibrv_u32 spin_us )
+{
+  return tibrv_api->SetQueueGroupSpin( grp, spin_us );
+}
+
 tibrv_status
 tibrvTransport_Create( tibrvTransport * tport, const char * service,
                        const char * network, const char * daemon )
@@ -2245,6 +4604,14 @@ tibrvTransport_SendRequest( tibrvTransport tport, tibrvMsg msg,
   return tibrv_api->SendRequest( tport, msg, reply, idle_timeout );
 }
 
+tibrv_status
+tibrvTransport_SendRequestAsync( tibrvTransport tport, tibrvMsg msg,
+                                 tibrvEventCallback cb, tibrvQueue q,
+                                 tibrv_f64 idle_timeout, const void * closure )
+{
+  return tibrv_api->SendRequestAsync( tport, msg, cb, q, idle_timeout, closure );
+}
+
 tibrv_status
 tibrvTransport_SendReply( tibrvTransport tport, tibrvMsg msg,
                           tibrvMsg request_msg )
@@ -2327,6 +4694,32 @@ tibrvTransport_SetBatchInterval( tibrvTransport tport, tibrv_f64 secs )
   return tibrv_api->SetBatchInterval( tport, secs );
 }
 
+tibrv_status
+tibrvTransport_GetStats( tibrvTransport tport, tibrvTransportStats * stats )
+{
+  return tibrv_api->GetTransportStats( tport, stats );
+}
+
+tibrv_status
+tibrvTransport_SetReconnect( tibrvTransport tport, tibrv_f64 min_ival,
+                             tibrv_f64 max_ival, tibrv_u32 buffer_bytes )
+{
+  return tibrv_api->SetReconnect( tport, min_ival, max_ival, buffer_bytes );
+}
+
+tibrv_status
+tibrvTransport_SetAlternateDaemons( tibrvTransport tport,
+                                    const char ** daemons, tibrv_u32 count )
+{
+  return tibrv_api->SetAlternateDaemons( tport, daemons, count );
+}
+
+tibrv_status
+tibrvTransport_SetReceiveLanes( tibrvTransport tport, tibrv_u32 count )
+{
+  return tibrv_api->SetReceiveLanes( tport, count );
+}
+
 tibrv_status
 tibrvTransport_CreateLicensed( tibrvTransport * tport, const char * service,
                                const char * network, const char * daemon,
@@ -2348,6 +4741,15 @@ tibrvDispatcher_CreateEx( tibrvDispatcher * disp,
   return tibrv_api->CreateDispatcher( disp, able, idle_timeout );
 }
 
+tibrv_status
+tibrvDispatcher_CreatePool( tibrvDispatcher * disp, tibrvDispatchable able,
+                            tibrv_f64 idle_timeout, tibrv_u32 num_threads,
+                            tibrvDispatchPartition part )
+{
+  return tibrv_api->CreateDispatchPool( disp, able, idle_timeout, num_threads,
+                                        part );
+}
+
 tibrv_status
 tibrvDispatcher_Join( tibrvDispatcher disp )
 {
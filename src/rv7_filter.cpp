@@ -0,0 +1,468 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <pthread.h>
+
+#include <raimd/md_msg.h>
+#include <sassrv/ev_rv_client.h>
+#include <sassrv/rv7api.h>
+#include <sassrv/timer_wheel.h>
+#include <sassrv/send_batch.h>
+#include <sassrv/rv7cpp.h>
+
+using namespace rv7;
+
+/* fields resolved per message, one bit each */
+static const uint32_t FILTER_MAX_FIELDS = 64;
+
+namespace {
+/* the compiler state, arrays grow as the expression is parsed */
+struct FilterParse {
+  const char      * p;
+  api_FilterOp    * op;
+  api_FilterField * fld;
+  uint8_t         * pool;
+  uint32_t          nops, op_cap,
+                    nfld, fld_cap,
+                    pool_len, pool_cap;
+  bool              oom;
+
+  FilterParse( const char *expr ) : p( expr ), op( 0 ), fld( 0 ), pool( 0 ),
+    nops( 0 ), op_cap( 0 ), nfld( 0 ), fld_cap( 0 ), pool_len( 0 ),
+    pool_cap( 0 ), oom( false ) {}
+  ~FilterParse() {
+    ::free( this->op );
+    ::free( this->fld );
+    ::free( this->pool );
+  }
+  bool grow( void *&ar,  uint32_t &cap,  uint32_t need,  size_t sz ) {
+    if ( need <= cap )
+      return true;
+    uint32_t ncap = ( cap == 0 ? 8 : cap );
+    while ( ncap < need )
+      ncap *= 2;
+    void * p = ::realloc( ar, ncap * sz );
+    if ( p == NULL ) {
+      this->oom = true;
+      return false;
+    }
+    ar  = p;
+    cap = ncap;
+    return true;
+  }
+  api_FilterOp * add_op( void ) {
+    if ( this->nops >= 0xffffU ||
+         ! this->grow( (void *&) this->op, this->op_cap, this->nops + 1,
+                       sizeof( api_FilterOp ) ) )
+      return NULL;
+    api_FilterOp * o = &this->op[ this->nops++ ];
+    ::memset( (void *) o, 0, sizeof( *o ) );
+    return o;
+  }
+  /* append to the pool, aligned for int64 sets, returns the offset */
+  bool add_pool( const void *data,  uint32_t len,  uint32_t &off ) {
+    uint32_t start = ( this->pool_len + 7 ) & ~(uint32_t) 7;
+    if ( ! this->grow( (void *&) this->pool, this->pool_cap, start + len + 1,
+                       1 ) ) /* + 1, an empty string still has a pointer */
+      return false;
+    if ( len > 0 )
+      ::memcpy( &this->pool[ start ], data, len );
+    this->pool_len = start + len;
+    off = start;
+    return true;
+  }
+  void skip_ws( void ) {
+    while ( *this->p == ' ' || *this->p == '\t' || *this->p == '\n' ||
+            *this->p == '\r' )
+      this->p++;
+  }
+  bool eat( const char *tok ) {
+    size_t len = ::strlen( tok );
+    this->skip_ws();
+    if ( ::strncmp( this->p, tok, len ) != 0 )
+      return false;
+    this->p += len;
+    return true;
+  }
+  int  field( void );
+  bool value( bool &is_str,  bool &is_f,  int64_t &i,  double &f,
+              api_FilterStr &s );
+  bool term( void );
+  bool compile( void );
+};
+}
+
+static inline bool
+is_name_char( char c )
+{
+  return c > ' ' && ::strchr( "=!<>{},&|\"()", c ) == NULL;
+}
+
+/* find or add the field slot of the name at p */
+int
+FilterParse::field( void )
+{
+  const char * nm = this->p;
+  while ( is_name_char( *this->p ) )
+    this->p++;
+  uint32_t len = (uint32_t) ( this->p - nm ), off;
+  if ( len == 0 || len > 0xffffU )
+    return -1;
+  for ( uint32_t i = 0; i < this->nfld; i++ ) {
+    if ( this->fld[ i ].len == len &&
+         ::memcmp( &this->pool[ this->fld[ i ].off ], nm, len ) == 0 )
+      return (int) i;
+  }
+  if ( this->nfld >= FILTER_MAX_FIELDS ||
+       ! this->grow( (void *&) this->fld, this->fld_cap, this->nfld + 1,
+                     sizeof( api_FilterField ) ) ||
+       ! this->add_pool( nm, len, off ) )
+    return -1;
+  api_FilterField & f = this->fld[ this->nfld ];
+  f.off = off;
+  f.len = (uint16_t) len;
+  f.c0  = (uint8_t) nm[ 0 ];
+  return (int) this->nfld++;
+}
+
+/* a number, true/false or a "string", strings are copied into the pool */
+bool
+FilterParse::value( bool &is_str,  bool &is_f,  int64_t &i,  double &f,
+                    api_FilterStr &s )
+{
+  this->skip_ws();
+  is_str = is_f = false;
+  if ( *this->p == '"' ) {
+    char   buf[ 256 ];
+    size_t len = 0;
+    for ( this->p++; *this->p != '"'; this->p++ ) {
+      if ( *this->p == '\\' && this->p[ 1 ] != '\0' )
+        this->p++;
+      if ( *this->p == '\0' || len == sizeof( buf ) )
+        return false;
+      buf[ len++ ] = *this->p;
+    }
+    this->p++;
+    is_str = true;
+    s.len  = (uint32_t) len;
+    return this->add_pool( buf, s.len, s.off );
+  }
+  if ( ::strncmp( this->p, "true", 4 ) == 0 &&
+       ! is_name_char( this->p[ 4 ] ) ) {
+    this->p += 4;
+    i = 1;
+    return true;
+  }
+  if ( ::strncmp( this->p, "false", 5 ) == 0 &&
+       ! is_name_char( this->p[ 5 ] ) ) {
+    this->p += 5;
+    i = 0;
+    return true;
+  }
+  char * end;
+  i = ::strtoll( this->p, &end, 10 );
+  if ( end == this->p )
+    return false;
+  if ( *end == '.' || *end == 'e' || *end == 'E' ) {
+    f = ::strtod( this->p, &end );
+    is_f = true;
+  }
+  this->p = end;
+  return true;
+}
+
+static int
+str_order( const uint8_t *pool,  const api_FilterStr &a,
+           const api_FilterStr &b )
+{
+  uint32_t n = ( a.len < b.len ? a.len : b.len );
+  int      c = ::memcmp( &pool[ a.off ], &pool[ b.off ], n );
+  if ( c == 0 )
+    c = ( a.len < b.len ? -1 : a.len > b.len ? 1 : 0 );
+  return c;
+}
+
+/* FIELD op value | FIELD in { value, ... } */
+bool
+FilterParse::term( void )
+{
+  this->skip_ws();
+  int fl = this->field();
+  if ( fl < 0 )
+    return false;
+  api_FilterOp * o = this->add_op(); /* only the pool grows below */
+  if ( o == NULL )
+    return false;
+  bool          is_str, is_f;
+  int64_t       i = 0;
+  double        f = 0;
+  api_FilterStr s = { 0, 0 };
+  o->fld = (uint16_t) fl;
+  this->skip_ws();
+  if ( this->p[ 0 ] == 'i' && this->p[ 1 ] == 'n' &&
+       ! is_name_char( this->p[ 2 ] ) ) {
+    /* collect the set in the pool, then sort it for the binary search */
+    int64_t       ibuf[ 256 ];
+    api_FilterStr sbuf[ 256 ];
+    uint32_t      cnt = 0, j;
+    bool          strs = false, ok;
+    this->p += 2;
+    if ( ! this->eat( "{" ) )
+      return false;
+    do {
+      if ( cnt == 256 || ! this->value( is_str, is_f, i, f, s ) || is_f ||
+           ( cnt > 0 && is_str != strs ) )
+        return false;
+      strs = is_str;
+      if ( strs ) {
+        for ( j = cnt; j > 0 && str_order( this->pool, s, sbuf[ j - 1 ] ) < 0;
+              j-- )
+          sbuf[ j ] = sbuf[ j - 1 ];
+        sbuf[ j ] = s;
+      }
+      else {
+        for ( j = cnt; j > 0 && i < ibuf[ j - 1 ]; j-- )
+          ibuf[ j ] = ibuf[ j - 1 ];
+        ibuf[ j ] = i;
+      }
+      cnt++;
+    } while ( this->eat( "," ) );
+    if ( ! this->eat( "}" ) )
+      return false;
+    if ( strs )
+      ok = this->add_pool( sbuf, cnt * sizeof( sbuf[ 0 ] ), o->arg.off );
+    else
+      ok = this->add_pool( ibuf, cnt * sizeof( ibuf[ 0 ] ), o->arg.off );
+    o->op  = ( strs ? FOP_IN_STR : FOP_IN_INT );
+    o->cnt = cnt;
+    return ok;
+  }
+  static const struct {
+    const char * tok;
+    uint8_t      cmp;
+  } cmp_tok[] = { /* two char tokens first */
+    { "==", FCMP_EQ }, { "!=", FCMP_NE }, { "<=", FCMP_LE }, { ">=", FCMP_GE },
+    { "<", FCMP_LT }, { ">", FCMP_GT }, { "=", FCMP_EQ }
+  };
+  size_t t;
+  for ( t = 0; t < sizeof( cmp_tok ) / sizeof( cmp_tok[ 0 ] ); t++ )
+    if ( this->eat( cmp_tok[ t ].tok ) )
+      break;
+  if ( t == sizeof( cmp_tok ) / sizeof( cmp_tok[ 0 ] ) ||
+       ! this->value( is_str, is_f, i, f, s ) )
+    return false;
+  o->cmp = cmp_tok[ t ].cmp;
+  if ( is_str ) {
+    o->op      = FOP_CMP_STR;
+    o->arg.off = s.off;
+    o->cnt     = s.len;
+  }
+  else if ( is_f ) {
+    o->op    = FOP_CMP_F64;
+    o->arg.f = f;
+  }
+  else {
+    o->op    = FOP_CMP_INT;
+    o->arg.i = i;
+  }
+  return true;
+}
+
+/* term ( && term )* ( || term ( && term )* )*, each group ends with accept
+ * and a false term jumps to the start of the next group */
+bool
+FilterParse::compile( void )
+{
+  uint32_t grp = 0;
+  for (;;) {
+    if ( ! this->term() )
+      return false;
+    if ( this->eat( "&&" ) )
+      continue;
+    api_FilterOp * o = this->add_op();
+    if ( o == NULL )
+      return false;
+    o->op = FOP_ACCEPT;
+    for ( uint32_t j = grp; j < this->nops - 1; j++ )
+      this->op[ j ].fail = (uint16_t) this->nops;
+    grp = this->nops;
+    if ( ! this->eat( "||" ) )
+      break;
+  }
+  this->skip_ws();
+  return *this->p == '\0';
+}
+
+tibrv_status
+api_Filter::compile( const char *expr,  api_Filter *&f ) noexcept
+{
+  FilterParse x( expr );
+  f = NULL;
+  if ( ! x.compile() )
+    return x.oom ? TIBRV_NO_MEMORY : TIBRV_INVALID_ARG;
+  void * p = ::malloc( sizeof( api_Filter ) );
+  if ( p == NULL )
+    return TIBRV_NO_MEMORY;
+  f = new ( p ) api_Filter();
+  f->op       = x.op;   x.op   = NULL;
+  f->fld      = x.fld;  x.fld  = NULL;
+  f->pool     = x.pool; x.pool = NULL;
+  f->nops     = (uint16_t) x.nops;
+  f->nfld     = (uint16_t) x.nfld;
+  f->pool_len = x.pool_len;
+  return TIBRV_OK;
+}
+
+template<class T>
+static inline bool
+cmp_value( uint8_t cmp,  T a,  T b )
+{
+  switch ( cmp ) {
+    case FCMP_EQ: return a == b;
+    case FCMP_NE: return a != b;
+    case FCMP_LT: return a < b;
+    case FCMP_LE: return a <= b;
+    case FCMP_GT: return a > b;
+    default:      return a >= b;
+  }
+}
+
+/* number fields as int64 unless they are real or don't fit */
+static bool
+num_value( const MDReference &mref,  int64_t &i,  double &f,  bool &is_f )
+{
+  switch ( mref.ftype ) {
+    case MD_INT:
+      i = get_int<int64_t>( mref );
+      is_f = false;
+      return true;
+    case MD_UINT:
+    case MD_BOOLEAN: {
+      uint64_t u = get_uint<uint64_t>( mref );
+      is_f = ( u > (uint64_t) INT64_MAX );
+      if ( is_f )
+        f = (double) u;
+      else
+        i = (int64_t) u;
+      return true;
+    }
+    case MD_REAL:
+      f = get_float<double>( mref );
+      is_f = true;
+      return true;
+    default:
+      return false;
+  }
+}
+
+static bool
+test_op( const api_FilterOp &o,  const uint8_t *pool,
+         const MDReference &mref )
+{
+  int64_t i = 0;
+  double  f = 0;
+  bool    is_f;
+
+  if ( o.op == FOP_CMP_STR || o.op == FOP_IN_STR ) {
+    if ( mref.ftype != MD_STRING )
+      return false;
+    api_FilterStr s = { 0, (uint32_t) mref.fsize };
+    const uint8_t * v = mref.fptr;
+    while ( s.len > 0 && v[ s.len - 1 ] == '\0' )
+      s.len--;
+    if ( o.op == FOP_CMP_STR ) {
+      uint32_t n = ( s.len < o.cnt ? s.len : o.cnt );
+      int      c = ::memcmp( v, &pool[ o.arg.off ], n );
+      if ( c == 0 )
+        c = ( s.len < o.cnt ? -1 : s.len > o.cnt ? 1 : 0 );
+      return cmp_value<int>( o.cmp, c, 0 );
+    }
+    const api_FilterStr * set = (const api_FilterStr *) &pool[ o.arg.off ];
+    uint32_t lo = 0, hi = o.cnt;
+    while ( lo < hi ) {
+      uint32_t m = ( lo + hi ) / 2,
+               n = ( s.len < set[ m ].len ? s.len : set[ m ].len );
+      int      c = ::memcmp( v, &pool[ set[ m ].off ], n );
+      if ( c == 0 )
+        c = ( s.len < set[ m ].len ? -1 : s.len > set[ m ].len ? 1 : 0 );
+      if ( c == 0 )
+        return true;
+      if ( c < 0 )
+        hi = m;
+      else
+        lo = m + 1;
+    }
+    return false;
+  }
+  if ( ! num_value( mref, i, f, is_f ) )
+    return false;
+  switch ( o.op ) {
+    case FOP_CMP_INT:
+      if ( is_f )
+        return cmp_value<double>( o.cmp, f, (double) o.arg.i );
+      return cmp_value<int64_t>( o.cmp, i, o.arg.i );
+    case FOP_CMP_F64:
+      return cmp_value<double>( o.cmp, is_f ? f : (double) i, o.arg.f );
+    case FOP_IN_INT: {
+      if ( is_f ) { /* a real that is a whole number may be in the set */
+        if ( ! ( f >= -9.2e18 && f <= 9.2e18 ) || f != (double) (int64_t) f )
+          return false;
+        i = (int64_t) f;
+      }
+      const int64_t * set = (const int64_t *) &pool[ o.arg.off ];
+      uint32_t lo = 0, hi = o.cnt;
+      while ( lo < hi ) {
+        uint32_t m = ( lo + hi ) / 2;
+        if ( set[ m ] == i )
+          return true;
+        if ( i < set[ m ] )
+          hi = m;
+        else
+          lo = m + 1;
+      }
+      return false;
+    }
+    default:
+      return false;
+  }
+}
+
+/* One walk over the fields resolves the first instance of each name the
+ * filter uses, stopping when all are found, then the terms run */
+bool
+api_Filter::match( RvMsg &msg ) const noexcept
+{
+  MDReference val[ FILTER_MAX_FIELDS ];
+  uint64_t    found = 0,
+              want  = ( this->nfld >= 64 ? ~(uint64_t) 0 :
+                        ( (uint64_t) 1 << this->nfld ) - 1 );
+  MDFieldReader rd( msg );
+  for ( bool b = rd.first(); b && found != want; b = rd.next() ) {
+    MDName nm;
+    if ( rd.iter->get_name( nm ) != 0 || nm.fnamelen == 0 )
+      continue;
+    size_t len = nm.fnamelen;
+    while ( len > 0 && nm.fname[ len - 1 ] == '\0' )
+      len--;
+    for ( uint32_t j = 0; j < this->nfld; j++ ) {
+      const api_FilterField & fl = this->fld[ j ];
+      if ( ( found & ( (uint64_t) 1 << j ) ) != 0 || fl.len != len ||
+           fl.c0 != (uint8_t) nm.fname[ 0 ] ||
+           ::memcmp( &this->pool[ fl.off ], nm.fname, len ) != 0 )
+        continue;
+      rd.iter->get_reference( val[ j ] );
+      found |= (uint64_t) 1 << j;
+      break;
+    }
+  }
+  for ( uint32_t pc = 0; pc < this->nops; ) {
+    const api_FilterOp & o = this->op[ pc ];
+    if ( o.op == FOP_ACCEPT )
+      return true;
+    bool t = ( found & ( (uint64_t) 1 << o.fld ) ) != 0 &&
+             test_op( o, this->pool, val[ o.fld ] );
+    pc = ( t ? pc + 1 : o.fail );
+  }
+  return false;
+}
@@ -3,11 +3,16 @@
 #include <string.h>
 #include <stdint.h>
 #include <stdarg.h>
+#include <unistd.h>
+#include <errno.h>
 #include <pthread.h>
+#include <sys/timerfd.h>
 
 #include <sassrv/ev_rv_client.h>
 #include <raikv/ev_publish.h>
 #include <sassrv/rv7api.h>
+#include <sassrv/timer_wheel.h>
+#include <sassrv/send_batch.h>
 #include <sassrv/rv7cpp.h>
 #include <sassrv/rv7ftcpp.h>
 
@@ -36,6 +41,8 @@ void tibrv_ft_active_stop_cb   ( tibrvEvent ,  tibrvMsg m,  void *cl ) noexcept
 void tibrv_ft_activate_timer_cb( tibrvEvent ,  tibrvMsg  ,  void *cl ) noexcept { ((api_FtMember *) cl)->activate_timer_cb(); }
 void tibrv_ft_prepare_timer_cb ( tibrvEvent ,  tibrvMsg  ,  void *cl ) noexcept { ((api_FtMember *) cl)->prepare_timer_cb(); }
 void tibrv_ft_hb_timer_cb      ( tibrvEvent ,  tibrvMsg  ,  void *cl ) noexcept { ((api_FtMember *) cl)->hb_timer_cb(); }
+void tibrv_ft_fast_hb_cb       ( tibrvEvent ,  tibrvMsg m,  void *cl ) noexcept { ((api_FtMember *) cl)->fast_hb_cb( m ); }
+void tibrv_ft_fast_cb          ( tibrvEvent ,  tibrvMsg  ,  void *cl ) noexcept { ((api_FtMember *) cl)->fast_cb(); }
 void tibrv_ft_unreachable_cb   ( tibrvEvent ,  tibrvMsg m,  void *cl ) noexcept { ((TibrvFtPeer *) cl)->unreachable_cb( m ); }
 void tibrv_ft_session_stop_cb  ( tibrvEvent ,  tibrvMsg m,  void *cl ) noexcept { ((TibrvFtPeer *) cl)->session_stop_cb( m ); }
 void tibrv_ft_host_stop_cb     ( tibrvEvent ,  tibrvMsg m,  void *cl ) noexcept { ((TibrvFtPeer *) cl)->host_stop_cb( m ); }
@@ -52,6 +59,7 @@ Tibrv_API::CreateFtMember( tibrvftMember * memb, tibrvQueue queue,
                            tibrv_f64 prepare_ival, tibrv_f64 activate_ival,
                            const void * closure ) noexcept
 {
+  api_EpochGuard guard( *this );
 #define mod1000( d ) (tibrv_f64) ( (uint32_t) ( d * 1000.0 ) ) / 1000.0
 #define FT_SUBJECT_EXTRA "_RVFT.ACTIVE_START."
   *memb = TIBRV_INVALID_ID;
@@ -93,7 +101,7 @@ Tibrv_API::CreateFtMember( tibrvftMember * memb, tibrvQueue queue,
   ::memcpy( group_name, name, len );
 
   pthread_mutex_lock( &t->mutex );
-  inbox_num = t->inbox_count++;
+  inbox_num = t->next_inbox();
   p.s( "_INBOX." )
    .b( t->x.session, t->x.session_len )
    .c( '.' )
@@ -154,6 +162,7 @@ static const char _RVFT_ACT_INTERVAL[]  = "ACT_INTERVAL";
 void
 api_FtMember::publish( api_Transport *t,  const char *sub,  uint8_t flds ) noexcept
 {
+  api_EpochGuard guard( this->api );
   char subject[ MAX_FT_SUBJECT_LEN ];
   
   if ( sub[ 0 ] != '_' ) {
@@ -183,11 +192,11 @@ api_FtMember::publish( api_Transport *t,  const char *sub,  uint8_t flds ) noexc
   }
   EvPublish pub( sub, ::strlen( sub ),
                  this->me.inbox, ::strlen( this->me.inbox ),
-                 msg.buf, msg.update_hdr(), t->client.sub_route, *t->me,
-                 0, RVMSG_TYPE_ID );
+                 msg.buf, msg.update_hdr(), t->conn->client.sub_route,
+                 *t->me, 0, RVMSG_TYPE_ID );
   EvPipeRec rec( OP_TPORT_SEND, t, &pub, 1, &t->mutex, &t->cond );
   pthread_mutex_lock( &t->mutex );
-  this->api.ev_read->exec( rec );
+  t->pipe->exec( rec );
   pthread_mutex_unlock( &t->mutex );
 }
 
@@ -195,6 +204,7 @@ bool
 api_FtMember::publish_rvftsub( const char *cl,  const char *nm,
                                const char *de ) noexcept
 {
+  api_EpochGuard guard( this->api );
   tibrv_u64 now = current_monotonic_time_ns();
   if ( this->fterr_time + this->me.hb_ns > now )
     return false;
@@ -223,7 +233,7 @@ api_FtMember::publish_rvftsub( const char *cl,  const char *nm,
 
   uint32_t h = kv_crc_c( subject, p.len(), 0 );
   EvPublish pub( subject, p.len(), NULL, 0,
-                 msg.buf, msg.update_hdr(), t->client.sub_route, *t->me,
+                 msg.buf, msg.update_hdr(), t->conn->client.sub_route, *t->me,
                  h, RVMSG_TYPE_ID );
   t->on_rv_msg( pub );
   return true;
@@ -286,6 +296,14 @@ api_FtMember::prepare( void ) noexcept
   return status;
 }
 
+/* fast mode peer slot key, 0 is a free slot */
+static inline uint32_t
+fast_hash( const char *inbox,  size_t len ) noexcept
+{
+  uint32_t h = kv_crc_c( inbox, len, 0 );
+  return ( h == 0 ? 1 : h );
+}
+
 static int
 compare_peer( const TibrvFtPeer &p1, const TibrvFtPeer &p2 ) noexcept
 {
@@ -299,6 +317,11 @@ compare_peer( const TibrvFtPeer &p1, const TibrvFtPeer &p2 ) noexcept
       return 1;
     return -1;
   }
+  if ( p1.is_lost != p2.is_lost ) {
+    if ( p1.is_lost )
+      return 1;
+    return -1;
+  }
   if ( p1.weight > p2.weight )
     return -1;
   if ( p1.weight < p2.weight )
@@ -477,11 +500,26 @@ api_FtMember::update_peer( TibrvFtPeer * p,  tibrvMsg msg,
     p->is_running = true;
   else if ( state == RVFT_ACTIVE_STOP || state == RVFT_STOP || state == RVFT_START )
     p->is_running = false;
+  if ( state == RVFT_ACTIVE_STOP && this->fast != NULL ) {
+    /* stopped heartbeating on purpose, not lost */
+    this->fast->forget( fast_hash( p->inbox, ::strlen( p->inbox ) ) );
+    p->is_lost = false;
+  }
 
   for ( x = this->peers.hd; x != NULL; x = x->next ) {
     if ( now > x->last_seen && now - x->last_seen > p->activate_ns )
       x->is_running = false;
   }
+  this->rank_peers( p, state, now );
+}
+
+/* Rank the peers and activate or deactivate me by my rank, p is the peer
+ * updated, if any */
+void
+api_FtMember::rank_peers( TibrvFtPeer * p,  FtState state,
+                          tibrv_u64 now ) noexcept
+{
+  TibrvFtPeer * x;
   this->peers.sort<compare_peer>();
 
   uint16_t i = 0;
@@ -501,7 +539,8 @@ api_FtMember::update_peer( TibrvFtPeer * p,  tibrvMsg msg,
         return;
     }
     if ( this->me.rank < this->me.active_goal && this->me.is_running ) {
-      if ( state == RVFT_ACTIVE && p->rank >= this->me.active_goal ) {
+      if ( state == RVFT_ACTIVE && p != NULL &&
+           p->rank >= this->me.active_goal ) {
         this->publish_rvftsub( _WARN, "TOO_MANY_ACTIVE" );
       }
       return;
@@ -745,14 +784,323 @@ api_FtMember::hb_timer_cb( void ) noexcept
   pthread_mutex_unlock( &this->mutex );
 }
 
+/* API_FT_IO thread: add the timerfd to the poll and arm it */
+void
+EvPipe::fast_start( EvPipeRec &rec ) noexcept
+{
+  api_FtFast      * f = rec.fast;
+  api_FtFastTimer * x =
+    this->poll.get_free_list<api_FtFastTimer>(
+      this->poll.register_type( "ft_fast_timer" ) );
+  struct itimerspec its;
+  its.it_interval.tv_sec  = (time_t) ( f->ival_ns / 1000000000ULL );
+  its.it_interval.tv_nsec = (long) ( f->ival_ns % 1000000000ULL );
+  its.it_value            = its.it_interval;
+  if ( x != NULL ) {
+    x->PeerData::init_peer( this->poll.get_next_id(), f->tfd, -1, NULL,
+                            "ft_fast_timer" );
+    if ( this->poll.add_sock( x ) == 0 ) {
+      x->fast  = f;
+      f->timer = x;
+      f->tfd   = -1; /* closed with x */
+      timerfd_settime( x->fd, 0, &its, NULL );
+      return;
+    }
+  }
+  ::close( f->tfd );
+  f->tfd = -1;
+}
+
+/* API_FT_IO thread: the timer is detached, no tick runs after this, so f is
+ * freed here where no tick can be using it */
+void
+EvPipe::fast_stop( EvPipeRec &rec ) noexcept
+{
+  api_FtFast      * f = rec.fast;
+  api_FtFastTimer * x = f->timer;
+  if ( x != NULL ) {
+    struct itimerspec its;
+    ::memset( &its, 0, sizeof( its ) );
+    timerfd_settime( x->fd, 0, &its, NULL );
+    x->fast = NULL;
+    x->idle_push( EV_CLOSE );
+  }
+  if ( f->tfd >= 0 )
+    ::close( f->tfd );
+  delete f;
+}
+
+/* A read returns the number of intervals expired, a late tick counts once
+ * so a stall does not lose every peer */
+void
+api_FtFastTimer::process( void ) noexcept
+{
+  this->off = this->len;
+  if ( this->fast != NULL )
+    this->fast->tick();
+  this->pop( EV_PROCESS );
+}
+
+void
+api_FtFastTimer::release( void ) noexcept
+{
+  this->fast = NULL;
+  this->EvConnection::release_buffers();
+}
+
+/* Send my heartbeat when active, then count the peers heard since the last
+ * tick; slots are only changed here, the receive only claims and counts */
+void
+api_FtFast::tick( void ) noexcept
+{
+  bool changed = false;
+  if ( __atomic_load_n( &this->ft.me.is_running, __ATOMIC_RELAXED ) )
+    this->ft.publish( this->hb, "FAST_HB", 0 );
+  for ( uint32_t i = 0; i < FT_FAST_PEERS; i++ ) {
+    api_FtFastPeer & x = this->peer[ i ];
+    if ( __atomic_load_n( &x.hash, __ATOMIC_ACQUIRE ) == 0 )
+      continue;
+    uint64_t cnt = __atomic_load_n( &x.hb_count, __ATOMIC_RELAXED );
+    bool     drop = __atomic_load_n( &x.drop, __ATOMIC_RELAXED );
+    if ( ! drop && cnt != x.last_count ) {
+      x.last_count = cnt;
+      x.miss = 0;
+      if ( x.seen < this->recover_count )
+        x.seen++;
+      if ( x.is_lost && x.seen >= this->recover_count ) {
+        __atomic_store_n( &x.is_lost, false, __ATOMIC_RELAXED );
+        changed = true;
+      }
+      continue;
+    }
+    x.seen = 0;
+    x.miss++;
+    if ( ! drop && ! x.is_lost && x.miss >= this->miss_count ) {
+      __atomic_store_n( &x.is_lost, true, __ATOMIC_RELAXED );
+      changed = true;
+    }
+    else if ( drop || (uint64_t) x.miss * this->ival_ns > this->drop_ns ) {
+      x.miss  = 0;
+      x.drop  = false;
+      x.last_count = cnt;
+      __atomic_store_n( &x.is_lost, false, __ATOMIC_RELAXED );
+      __atomic_store_n( &x.hash, 0, __ATOMIC_RELEASE );
+    }
+  }
+  if ( changed )
+    this->post();
+}
+
+/* Conn thread: count a heartbeat of h, claim a free slot for a new peer,
+ * more than FT_FAST_PEERS actives are not tracked */
+void
+api_FtFast::heard( uint32_t h ) noexcept
+{
+  uint32_t i;
+  for ( i = 0; i < FT_FAST_PEERS; i++ ) {
+    if ( __atomic_load_n( &this->peer[ i ].hash, __ATOMIC_ACQUIRE ) == h ) {
+      __atomic_fetch_add( &this->peer[ i ].hb_count, 1, __ATOMIC_RELAXED );
+      return;
+    }
+  }
+  for ( i = 0; i < FT_FAST_PEERS; i++ ) {
+    uint32_t z = 0;
+    if ( __atomic_compare_exchange_n( &this->peer[ i ].hash, &z, h, false,
+                                      __ATOMIC_ACQ_REL, __ATOMIC_RELAXED ) ) {
+      __atomic_fetch_add( &this->peer[ i ].hb_count, 1, __ATOMIC_RELAXED );
+      return;
+    }
+  }
+}
+
+void
+api_FtFast::forget( uint32_t h ) noexcept
+{
+  for ( uint32_t i = 0; i < FT_FAST_PEERS; i++ )
+    if ( __atomic_load_n( &this->peer[ i ].hash, __ATOMIC_ACQUIRE ) == h )
+      __atomic_store_n( &this->peer[ i ].drop, true, __ATOMIC_RELAXED );
+}
+
+bool
+api_FtFast::is_lost( uint32_t h ) const noexcept
+{
+  for ( uint32_t i = 0; i < FT_FAST_PEERS; i++ )
+    if ( __atomic_load_n( &this->peer[ i ].hash, __ATOMIC_ACQUIRE ) == h )
+      return __atomic_load_n( &this->peer[ i ].is_lost, __ATOMIC_RELAXED );
+  return false;
+}
+
+/* Queue fast_cb once, like a timer expiring on the member queue */
+void
+api_FtFast::post( void ) noexcept
+{
+  if ( __atomic_exchange_n( &this->posted, 1, __ATOMIC_ACQ_REL ) != 0 )
+    return;
+  api_FtMember & m = this->ft;
+  api_EpochGuard guard( m.api );
+  api_Queue * q = m.api.get<api_Queue>( m.queue, TIBRV_QUEUE );
+  if ( q == NULL )
+    return;
+  if ( q->inline_dispatch ) {
+    q->count_inline( 1 );
+    tibrv_ft_fast_cb( m.id, NULL, &m );
+    return;
+  }
+  api_QueueGroup * g = NULL;
+  pthread_mutex_lock( &q->mutex );
+  if ( q->push( m.id, tibrv_ft_fast_cb, NULL, &m, NULL ) ) {
+    if ( ( g = q->grp ) == NULL )
+      pthread_cond_broadcast( &q->cond );
+  }
+  pthread_mutex_unlock( &q->mutex );
+  if ( g != NULL ) {
+    pthread_mutex_lock( &g->mutex );
+    pthread_cond_broadcast( &g->cond );
+    pthread_mutex_unlock( &g->mutex );
+  }
+}
+
+/* Conn thread, inline: a FAST_HB from an active peer */
+void
+api_FtMember::fast_hb_cb( tibrvMsg msg ) noexcept
+{
+  api_Msg    * m = (api_Msg *) msg;
+  api_FtFast * f = this->fast;
+  if ( f == NULL || m->reply_len == 0 )
+    return;
+  uint32_t h = fast_hash( m->reply, m->reply_len );
+  if ( h != f->my_hash )
+    f->heard( h );
+}
+
+/* Member queue: a tick lost or restored a peer, rank again */
+void
+api_FtMember::fast_cb( void ) noexcept
+{
+  if ( this->is_destroyed )
+    return;
+  pthread_mutex_lock( &this->mutex );
+  api_FtFast * f = this->fast;
+  if ( f != NULL && ! this->is_destroyed ) {
+    __atomic_store_n( &f->posted, 0, __ATOMIC_RELEASE );
+    bool changed = false;
+    for ( TibrvFtPeer *x = this->peers.hd; x != NULL; x = x->next ) {
+      if ( x == &this->me )
+        continue;
+      bool lost = f->is_lost( fast_hash( x->inbox, ::strlen( x->inbox ) ) );
+      if ( lost != x->is_lost ) {
+        x->is_lost = lost;
+        if ( lost )
+          x->is_running = false;
+        changed = true;
+      }
+    }
+    if ( debug_rvft ) {
+      pt( "fast_cb" );
+      printf( " changed=%s\n", changed ? "yes" : "no" );
+    }
+    if ( changed )
+      this->rank_peers( NULL, RVFT_STATUS, current_monotonic_time_ns() );
+  }
+  pthread_mutex_unlock( &this->mutex );
+}
+
+/* Open the heartbeat conn on the API_FT_IO thread, listen to FAST_HB inline
+ * on it and add the timerfd to the same poll, a tick sends FAST_HB from the
+ * thread that owns the conn */
+tibrv_status
+api_FtMember::start_fast( tibrv_f64 hb_ival,  tibrv_u32 miss_count,
+                          tibrv_u32 recover_count ) noexcept
+{
+  api_EpochGuard guard( this->api );
+  api_Transport * t = this->api.get<api_Transport>( this->tport,
+                                                    TIBRV_TRANSPORT );
+  if ( t == NULL )
+    return TIBRV_INVALID_TRANSPORT;
+  void       * mem = ::malloc( sizeof( api_FtFast ) );
+  api_FtFast * f   = new ( mem ) api_FtFast( *this );
+  char         subject[ MAX_FT_SUBJECT_LEN ];
+  CatPtr       p( subject );
+  tibrv_status status;
+
+  f->ival_ns       = (tibrv_u64) ( hb_ival * NS_DBL );
+  f->drop_ns       = this->me.activate_ns * 2;
+  f->miss_count    = miss_count;
+  f->recover_count = recover_count;
+  f->my_hash       = fast_hash( this->me.inbox, ::strlen( this->me.inbox ) );
+
+  if ( ! this->api.start_ft_io() ) {
+    delete f;
+    return TIBRV_NO_MEMORY;
+  }
+  status = this->api.open_aux( t->conn, f->hb, API_FT_IO );
+  if ( status == TIBRV_OK )
+    status = this->api.CreateQueue( &f->hb_queue );
+  if ( status == TIBRV_OK )
+    status = this->api.SetQueueInline( f->hb_queue, TIBRV_TRUE );
+  if ( status == TIBRV_OK ) {
+    p.s( "_RVFT.FAST_HB." ).s( this->name ).end();
+    this->fast = f; /* fast_hb_cb may run before CreateListener returns */
+    status = this->api.CreateListener( &f->hb_id, f->hb_queue, f->hb->id,
+                                       tibrv_ft_fast_hb_cb, NULL, subject,
+                                       this );
+  }
+  if ( status == TIBRV_OK ) {
+    f->tfd = timerfd_create( CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC );
+    if ( f->tfd < 0 )
+      status = TIBRV_NO_MEMORY;
+    else {
+      EvPipeRec rec( OP_FAST_START, f, &f->hb->mutex, &f->hb->cond );
+      pthread_mutex_lock( &f->hb->mutex );
+      f->hb->pipe->exec( rec );
+      pthread_mutex_unlock( &f->hb->mutex );
+    }
+  }
+  if ( status != TIBRV_OK ) {
+    this->fast = NULL;
+    this->stop_fast( f );
+  }
+  return status;
+}
+
+/* Stop the ticks and close the conn, f is no longer this->fast; f is freed
+ * by OP_FAST_STOP on the API_FT_IO thread, the pipe runs the close after */
+void
+api_FtMember::stop_fast( api_FtFast * f ) noexcept
+{
+  api_Transport * hb       = f->hb;
+  tibrvQueue      hb_queue = f->hb_queue;
+  if ( f->hb_id != 0 )
+    this->api.DestroyEvent( f->hb_id, NULL ); /* after any inline callback */
+  if ( hb == NULL ) {
+    delete f;
+  }
+  else {
+    EvPipeRec rec( OP_FAST_STOP, f, &hb->mutex, &hb->cond );
+    pthread_mutex_lock( &hb->mutex );
+    hb->pipe->exec( rec );
+    pthread_mutex_unlock( &hb->mutex );
+    this->api.close_aux( hb );
+  }
+  if ( hb_queue != 0 )
+    this->api.DestroyQueue( hb_queue, NULL, NULL );
+}
+
 tibrv_status
 Tibrv_API::DestroyFtMember( tibrvftMember memb ) noexcept
 {
+  api_EpochGuard guard( *this );
   api_FtMember *ft = this->get<api_FtMember>( memb, TIBRV_FTMEMBER );
   if ( ft == NULL )
     return TIBRV_INVALID_DISPATCHABLE;
   pthread_mutex_lock( &ft->mutex );
   ft->is_destroyed = true;
+  api_FtFast * fast = ft->fast;
+  ft->fast = NULL;
+  pthread_mutex_unlock( &ft->mutex );
+  if ( fast != NULL ) /* a tick may run fast_cb inline, not locked */
+    ft->stop_fast( fast );
+  pthread_mutex_lock( &ft->mutex );
   ft->stop_timers();
   ft->publish( NULL, "STOP", 0 );
   for ( size_t i = 0; i < sizeof( ft->cb_id ) / sizeof( ft->cb_id[ 0 ] ); i++ ) {
@@ -766,6 +1114,7 @@ Tibrv_API::DestroyFtMember( tibrvftMember memb ) noexcept
 tibrv_status
 Tibrv_API::DestroyExFtMember( tibrvftMember memb, tibrvftMemberOnComplete cb ) noexcept
 {
+  api_EpochGuard guard( *this );
   api_FtMember *ft = this->get<api_FtMember>( memb, TIBRV_FTMEMBER );
   if ( ft == NULL )
     return TIBRV_INVALID_DISPATCHABLE;
@@ -778,6 +1127,7 @@ Tibrv_API::DestroyExFtMember( tibrvftMember memb, tibrvftMemberOnComplete cb ) n
 tibrv_status
 Tibrv_API::GetFtMemberQueue( tibrvftMember memb, tibrvQueue * q ) noexcept
 {
+  api_EpochGuard guard( *this );
   api_FtMember *ft = this->get<api_FtMember>( memb, TIBRV_FTMEMBER );
   if ( ft == NULL )
     return TIBRV_INVALID_DISPATCHABLE;
@@ -788,6 +1138,7 @@ Tibrv_API::GetFtMemberQueue( tibrvftMember memb, tibrvQueue * q ) noexcept
 tibrv_status
 Tibrv_API::GetFtMemberTransport( tibrvftMember memb, tibrvTransport * tport ) noexcept
 {
+  api_EpochGuard guard( *this );
   api_FtMember *ft = this->get<api_FtMember>( memb, TIBRV_FTMEMBER );
   if ( ft == NULL )
     return TIBRV_INVALID_DISPATCHABLE;
@@ -798,6 +1149,7 @@ Tibrv_API::GetFtMemberTransport( tibrvftMember memb, tibrvTransport * tport ) no
 tibrv_status
 Tibrv_API::GetFtMemberGroupName( tibrvftMember memb, const char ** name ) noexcept
 {
+  api_EpochGuard guard( *this );
   api_FtMember *ft = this->get<api_FtMember>( memb, TIBRV_FTMEMBER );
   if ( ft == NULL )
     return TIBRV_INVALID_DISPATCHABLE;
@@ -808,6 +1160,7 @@ Tibrv_API::GetFtMemberGroupName( tibrvftMember memb, const char ** name ) noexce
 tibrv_status
 Tibrv_API::GetFtMemberWeight( tibrvftMember memb, tibrv_u16 * weight ) noexcept
 {
+  api_EpochGuard guard( *this );
   api_FtMember *ft = this->get<api_FtMember>( memb, TIBRV_FTMEMBER );
   if ( ft == NULL )
     return TIBRV_INVALID_DISPATCHABLE;
@@ -818,6 +1171,7 @@ Tibrv_API::GetFtMemberWeight( tibrvftMember memb, tibrv_u16 * weight ) noexcept
 tibrv_status
 Tibrv_API::SetFtMemberWeight( tibrvftMember memb, tibrv_u16 weight ) noexcept
 {
+  api_EpochGuard guard( *this );
   api_FtMember *ft = this->get<api_FtMember>( memb, TIBRV_FTMEMBER );
   if ( ft == NULL )
     return TIBRV_INVALID_DISPATCHABLE;
@@ -828,6 +1182,29 @@ Tibrv_API::SetFtMemberWeight( tibrvftMember memb, tibrv_u16 weight ) noexcept
   return TIBRV_OK;
 }
 
+tibrv_status
+Tibrv_API::SetFtMemberFastMode( tibrvftMember memb, tibrv_f64 hb_ival,
+                                tibrv_u32 miss_count,
+                                tibrv_u32 recover_count ) noexcept
+{
+  api_EpochGuard guard( *this );
+  api_FtMember *ft = this->get<api_FtMember>( memb, TIBRV_FTMEMBER );
+  if ( ft == NULL )
+    return TIBRV_INVALID_DISPATCHABLE;
+  if ( hb_ival < 0.001 || hb_ival > 0.1 || miss_count < 2 ||
+       recover_count < 1 )
+    return TIBRV_INVALID_ARG;
+  /* losing a peer should be faster than the activate interval */
+  if ( hb_ival * (tibrv_f64) miss_count >= ft->me.activate_ival )
+    return TIBRV_INVALID_ARG;
+  tibrv_status status = TIBRV_NOT_PERMITTED;
+  pthread_mutex_lock( &ft->mutex );
+  if ( ft->fast == NULL && ! ft->is_destroyed )
+    status = ft->start_fast( hb_ival, miss_count, recover_count );
+  pthread_mutex_unlock( &ft->mutex );
+  return status;
+}
+
 void tibrv_ftmon_stop_cb          ( tibrvEvent ,  tibrvMsg m,  void *cl ) noexcept { ((api_FtMonitor *) cl)->stop_cb( m ); }
 void tibrv_ftmon_active_hb_cb     ( tibrvEvent ,  tibrvMsg m,  void *cl ) noexcept { ((api_FtMonitor *) cl)->active_hb_cb( m ); }
 void tibrv_ftmon_active_start_cb  ( tibrvEvent ,  tibrvMsg m,  void *cl ) noexcept { ((api_FtMonitor *) cl)->active_start_cb( m ); }
@@ -841,6 +1218,7 @@ Tibrv_API::CreateFtMonitor( tibrvftMonitor * m, tibrvQueue queue, tibrvftMonitor
                             tibrvTransport tport, const char * name, tibrv_f64 lost_ival,
                             const void * closure ) noexcept
 {
+  api_EpochGuard guard( *this );
   *m = TIBRV_INVALID_ID;
   api_Queue     * q   = this->get<api_Queue>( queue, TIBRV_QUEUE );
   api_Transport * t   = this->get<api_Transport>( tport, TIBRV_TRANSPORT );
@@ -1080,6 +1458,7 @@ api_FtMonitor::active_stop_cb( tibrvMsg m ) noexcept
 tibrv_status
 Tibrv_API::DestroyFtMonitor( tibrvftMonitor m ) noexcept
 {
+  api_EpochGuard guard( *this );
   api_FtMonitor *mon = this->get<api_FtMonitor>( m, TIBRV_FTMONITOR );
   if ( mon == NULL )
     return TIBRV_INVALID_DISPATCHABLE;
@@ -1100,6 +1479,7 @@ Tibrv_API::DestroyFtMonitor( tibrvftMonitor m ) noexcept
 tibrv_status
 Tibrv_API::DestroyExFtMonitor( tibrvftMonitor m, tibrvftMonitorOnComplete cb ) noexcept
 {
+  api_EpochGuard guard( *this );
   api_FtMonitor *mon = this->get<api_FtMonitor>( m, TIBRV_FTMONITOR );
   if ( mon == NULL )
     return TIBRV_INVALID_DISPATCHABLE;
@@ -1112,6 +1492,7 @@ Tibrv_API::DestroyExFtMonitor( tibrvftMonitor m, tibrvftMonitorOnComplete cb ) n
 tibrv_status
 Tibrv_API::GetFtMonitorQueue( tibrvftMonitor m, tibrvQueue * q ) noexcept
 {
+  api_EpochGuard guard( *this );
   api_FtMonitor *mon = this->get<api_FtMonitor>( m, TIBRV_FTMONITOR );
   if ( mon == NULL )
     return TIBRV_INVALID_DISPATCHABLE;
@@ -1122,6 +1503,7 @@ Tibrv_API::GetFtMonitorQueue( tibrvftMonitor m, tibrvQueue * q ) noexcept
 tibrv_status
 Tibrv_API::GetFtMonitorTransport( tibrvftMonitor m, tibrvTransport * tport ) noexcept
 {
+  api_EpochGuard guard( *this );
   api_FtMonitor *mon = this->get<api_FtMonitor>( m, TIBRV_FTMONITOR );
   if ( mon == NULL )
     return TIBRV_INVALID_DISPATCHABLE;
@@ -1132,6 +1514,7 @@ Tibrv_API::GetFtMonitorTransport( tibrvftMonitor m, tibrvTransport * tport ) noe
 tibrv_status
 Tibrv_API::GetFtMonitorGroupName( tibrvftMonitor m, const char ** name ) noexcept
 {
+  api_EpochGuard guard( *this );
   api_FtMonitor *mon = this->get<api_FtMonitor>( m, TIBRV_FTMONITOR );
   if ( mon == NULL )
     return TIBRV_INVALID_DISPATCHABLE;
@@ -1207,6 +1590,14 @@ tibrvftMember_SetWeight( tibrvftMember memb, tibrv_u16 weight )
   return tibrv_api->SetFtMemberWeight( memb, weight );
 }
 
+tibrv_status
+tibrvftMember_SetFastMode( tibrvftMember memb, tibrv_f64 hb_ival,
+                           tibrv_u32 miss_count, tibrv_u32 recover_count )
+{
+  return tibrv_api->SetFtMemberFastMode( memb, hb_ival, miss_count,
+                                         recover_count );
+}
+
 tibrv_status
 tibrvftMonitor_Create( tibrvftMonitor *mon, tibrvQueue q,
                        tibrvftMonitorCallback cb, tibrvTransport tport,
@@ -9,6 +9,8 @@
 #include <raimd/md_dict.h>
 #include <sassrv/ev_rv_client.h>
 #include <sassrv/rv7api.h>
+#include <sassrv/timer_wheel.h>
+#include <sassrv/send_batch.h>
 #include <sassrv/rv7cpp.h>
 
 using namespace rv7;
@@ -41,16 +43,31 @@ StrOutput::printf( const char *fmt,  ... ) noexcept
   return n;
 }
 
+/* copy the fields of a received message into the writer as one segment,
+ * they are already rv encoded, so there is no need to walk them */
+static inline void
+splice_rvmsg( RvMsgWriter &wr,  RvMsg &rvmsg )
+{
+  static const size_t hdr_len = 8; /* size + magic */
+  size_t len = rvmsg.msg_end - rvmsg.msg_off;
+  if ( len > hdr_len )
+    wr.append_buffer( &((uint8_t *) rvmsg.msg_buf)[ rvmsg.msg_off + hdr_len ],
+                      len - hdr_len );
+}
+
 static inline RvMsgWriter &
 get_writer( tibrvMsg msg ) {
   api_Msg *m = ((api_Msg *) msg);
   if ( m->rd_refs == m->wr_refs ) {
     if ( m->rvmsg != NULL ) {
       m->wr.reset();
-      m->wr.append_rvmsg( *m->rvmsg );
+      splice_rvmsg( m->wr, *m->rvmsg );
+      m->rvmsg   = NULL; /* writer owns the fields now, don't reset again */
       m->id_used = ~(uint64_t) 0;
     }
   }
+  if ( m->share != NULL ) /* sent or received by reference, copy on write */
+    m->unshare( true );
   m->wr_refs++;
   return m->wr;
 }
@@ -69,6 +86,7 @@ get_reader( tibrvMsg msg )
     }
     m->rd = new ( m->mem.make( sizeof( MDFieldReader ) ) )
             MDFieldReader( *rvmsg );
+    m->fidx    = NULL; /* offsets refer to the old buffer */
     m->rd_refs = m->wr_refs;
   }
   return *m->rd;
@@ -95,6 +113,100 @@ check_id( tibrvMsg msg,  tibrv_u16 id )
   return used;
 }
 
+/* field index built on the first lookup by name or by ordinal, allocated in
+ * the message mem with the reader, dropped when get_reader() rebuilds */
+struct rv7::api_FieldIndex {
+  uint32_t * off,   /* field_start of each field, by ordinal */
+           * hash,  /* crc of each field name, by ordinal */
+           * ht;    /* ordinal + 1 of the field hashed to a slot, 0 = empty */
+  uint32_t   count, /* number of fields */
+             mask;  /* ht size - 1 */
+};
+
+static inline uint32_t
+field_name_hash( const char *name,  size_t len )
+{
+  while ( len > 0 && name[ len - 1 ] == '\0' )
+    len--;
+  return kv_crc_c( name, len, 0 );
+}
+
+static api_FieldIndex *
+get_index( tibrvMsg msg,  MDFieldReader &rd )
+{
+  api_Msg        * m = (api_Msg *) msg;
+  api_FieldIndex * x = m->fidx;
+  if ( x != NULL )
+    return x;
+
+  uint32_t n = 0, cap = 16, i, j;
+  void   * p = m->mem.make( sizeof( uint32_t ) * cap * 2 );
+  uint32_t * pr = (uint32_t *) p;
+  for ( bool b = rd.first(); b; b = rd.next() ) {
+    MDName nm;
+    if ( n == cap ) {
+      m->mem.extend( sizeof( uint32_t ) * cap * 2,
+                     sizeof( uint32_t ) * cap * 4, &p );
+      pr   = (uint32_t *) p;
+      cap *= 2;
+    }
+    pr[ n * 2 ]     = (uint32_t) rd.iter->field_start;
+    pr[ n * 2 + 1 ] = ( rd.iter->get_name( nm ) == 0 ) ?
+                      field_name_hash( nm.fname, nm.fnamelen ) : 0;
+    n++;
+  }
+  uint32_t sz = 8;
+  while ( sz < n * 2 )
+    sz *= 2;
+  x = (api_FieldIndex *) m->mem.make( sizeof( api_FieldIndex ) );
+  x->off   = (uint32_t *) m->mem.make( sizeof( uint32_t ) * ( n * 2 + sz ) );
+  x->hash  = &x->off[ n ];
+  x->ht    = &x->hash[ n ];
+  x->count = n;
+  x->mask  = sz - 1;
+  ::memset( x->ht, 0, sizeof( uint32_t ) * sz );
+  for ( i = 0; i < n; i++ ) {
+    x->off[ i ]  = pr[ i * 2 ];
+    x->hash[ i ] = pr[ i * 2 + 1 ];
+    /* probe in ordinal order, so instances are found in message order */
+    for ( j = x->hash[ i ] & x->mask; x->ht[ j ] != 0; j = ( j + 1 ) & x->mask )
+      ;
+    x->ht[ j ] = i + 1;
+  }
+  m->fidx = x;
+  return x;
+}
+
+/* position the reader at field ordinal i without walking from the start */
+static inline void
+seek_field( MDFieldReader &rd,  api_FieldIndex *x,  uint32_t i )
+{
+  RvFieldIter * it = (RvFieldIter *) rd.iter;
+  it->field_start = x->off[ i ];
+  it->unpack();
+  it->field_index = i;
+  it->get_reference( rd.mref );
+}
+
+/* find the inst'th field named name (inst >= 1) through the index */
+static bool
+find_field( tibrvMsg msg,  MDFieldReader &rd,  const char *name,
+            size_t name_len,  uint32_t inst )
+{
+  api_FieldIndex * x = get_index( msg, rd );
+  uint32_t h = field_name_hash( name, name_len ), j, i;
+  for ( j = h & x->mask; ( i = x->ht[ j ] ) != 0; j = ( j + 1 ) & x->mask ) {
+    if ( x->hash[ --i ] != h )
+      continue;
+    seek_field( rd, x, i );
+    if ( ((RvFieldIter *) rd.iter)->is_named( name, name_len ) ) {
+      if ( --inst == 0 )
+        return true;
+    }
+  }
+  return false;
+}
+
 struct FNameArg {
   size_t        nm_len;
   const char  * nm;
@@ -142,10 +254,57 @@ struct FNameUpdateArg : public FNameArg {
 
 struct FNameGetArg : public FNameArg {
   MDFieldReader & rd;
-  FNameGetArg( tibrvMsg msg,  const char *name,  tibrv_u16 id )
-      : FNameArg( name, id ), rd( get_reader( msg ) ) {}
+  tibrvMsg        msg;
+  tibrv_u16       id;
+  FNameGetArg( tibrvMsg m,  const char *name,  tibrv_u16 i )
+      : FNameArg( name, i ), rd( get_reader( m ) ), msg( m ), id( i ) {}
+  /* names qualified by an id are matched by the reader, which decodes them */
+  bool find( void ) {
+    if ( this->id != 0 || this->nm == NULL )
+      return this->rd.find( this->nm, this->nm_len );
+    return find_field( this->msg, this->rd, this->nm, this->nm_len, 1 );
+  }
 };
 
+/* update a field by overwriting its data where it is, used when the type and
+ * size are unchanged; the reader, the field index and the message buffer all
+ * stay valid, so the message is not converted to a writer.  Only with a
+ * current reader, rebuilding one to patch costs more than the writer path */
+static bool
+patch_field( tibrvMsg msg,  const char *name,  tibrv_u16 id,
+             const void *value,  size_t size,  MDType type,  bool swap )
+{
+  api_Msg * m = (api_Msg *) msg;
+  if ( name == NULL )
+    return false;
+  if ( m->share != NULL )
+    m->unshare( true );
+  if ( m->rd == NULL || m->rd_refs != m->wr_refs )
+    return false;
+  FNameGetArg arg( msg, name, id );
+  if ( ! arg.find() )
+    return false;
+  MDReference & mref = arg.rd.mref;
+  if ( mref.ftype != type || mref.fsize != size || mref.fptr == NULL )
+    return false;
+  const uint8_t * v = (const uint8_t *) value;
+  if ( ! swap || mref.fendian == md_endian || size == 1 )
+    ::memcpy( mref.fptr, v, size );
+  else {
+    for ( size_t i = 0; i < size; i++ )
+      mref.fptr[ i ] = v[ size - 1 - i ];
+  }
+  return true;
+}
+
+template<class T>
+static inline bool
+patch_value( tibrvMsg msg,  const char *name,  tibrv_u16 id,  T value,
+             MDType type )
+{
+  return patch_field( msg, name, id, &value, sizeof( T ), type, true );
+}
+
 template<class T>
 static inline tibrv_status
 get_value( MDFieldReader &rd, T * value, MDType type )
@@ -163,7 +322,7 @@ get_value( tibrvMsg msg, const char *name, T * value, tibrv_u16 id,
            MDType type )
 {
   FNameGetArg arg( msg, name, id );
-  if ( arg.rd.find( arg.nm, arg.nm_len ) )
+  if ( arg.find() )
     return get_value( arg.rd, value, type );
   return TIBRV_NOT_FOUND;
 }
@@ -184,7 +343,7 @@ get_string( tibrvMsg msg, const char *name, char ** value, tibrv_u16 id )
 {
   FNameGetArg arg( msg, name, id );
   tibrv_u32 len;
-  if ( arg.rd.find( arg.nm, arg.nm_len ) )
+  if ( arg.find() )
     return get_string( arg.rd, value, &len );
   return TIBRV_NOT_FOUND;
 }
@@ -205,7 +364,7 @@ get_opaque( tibrvMsg msg, const char *name, void ** value, tibrv_u32 *len,
             tibrv_u16 id )
 {
   FNameGetArg arg( msg, name, id );
-  if ( arg.rd.find( arg.nm, arg.nm_len ) )
+  if ( arg.find() )
     return get_opaque( arg.rd, value, len );
   return TIBRV_NOT_FOUND;
 }
@@ -236,7 +395,7 @@ get_array_value( tibrvMsg msg, const char *name, T ** value, tibrv_u16 id,
                  MDType type,  tibrv_u32 *count )
 {
   FNameGetArg arg( msg, name, id );
-  if ( arg.rd.find( arg.nm, arg.nm_len ) )
+  if ( arg.find() )
     return get_array_value( arg.rd, value, type, count );
   return TIBRV_NOT_FOUND;
 }
@@ -436,21 +595,51 @@ extern "C" {
 tibrv_status
 tibrvMsg_Create( tibrvMsg * msg )
 {
-  *msg = new ( ::malloc( sizeof( api_Msg ) ) ) api_Msg( 0 );
+  *msg = api_Msg::alloc( 0 );
   return TIBRV_OK;
 }
 
 tibrv_status
-tibrvMsg_CreateEx( tibrvMsg * msg,  tibrv_u32 /*initial*/ )
+tibrvMsg_CreateEx( tibrvMsg * msg,  tibrv_u32 initial )
 {
-  return tibrvMsg_Create( msg );
+  *msg = api_Msg::alloc( initial );
+  return TIBRV_OK;
 }
 
 tibrv_status
 tibrvMsg_Destroy( tibrvMsg msg )
 {
   if ( msg != NULL && ((api_Msg *) msg)->owner == NULL )
-    delete (api_Msg *) msg;
+    api_Msg::recycle( (api_Msg *) msg );
+  return TIBRV_OK;
+}
+
+tibrv_status
+tibrvMsg_SetPoolSize( tibrv_u32 max_free )
+{
+  api_Msg::pool_max = max_free;
+  return TIBRV_OK;
+}
+
+tibrv_status
+tibrvMsg_GetPoolStats( tibrv_u64 * hits,  tibrv_u64 * misses,
+                       tibrv_u64 * allocs )
+{
+  uint64_t h, m, a;
+  api_Msg::pool_stats( h, m, a );
+  if ( hits != NULL )
+    *hits = h;
+  if ( misses != NULL )
+    *misses = m;
+  if ( allocs != NULL )
+    *allocs = a;
+  return TIBRV_OK;
+}
+
+tibrv_status
+tibrvMsg_GetConflateCount( tibrvMsg msg,  tibrv_u32 * count )
+{
+  *count = ((api_Msg *) msg)->conflated;
   return TIBRV_OK;
 }
 
@@ -477,8 +666,10 @@ tibrvMsg_Reset( tibrvMsg msg )
 }
 
 tibrv_status
-tibrvMsg_Expand( tibrvMsg /*msg*/,  tibrv_i32 /*add*/ )
+tibrvMsg_Expand( tibrvMsg msg,  tibrv_i32 add )
 {
+  if ( add > 0 && ! ((api_Msg *) msg)->reserve( (size_t) add ) )
+    return TIBRV_NO_MEMORY;
   return TIBRV_OK;
 }
 
@@ -535,15 +726,8 @@ tibrvMsg_GetClosure( tibrvMsg msg,  void ** closure )
 tibrv_status
 tibrvMsg_GetNumFields( tibrvMsg msg,  tibrv_u32 * num_flds )
 {
-  RvMsg & rvmsg = get_as_rvmsg( msg );
-  MDFieldIter * iter;
-  tibrv_u32     i = 0;
-  if ( rvmsg.get_field_iter( iter ) == 0 ) {
-    if ( iter->first() == 0 )
-      for ( i = 1; iter->next() == 0; i++ )
-        ;
-  }
-  *num_flds = i;
+  MDFieldReader & rd = get_reader( msg );
+  *num_flds = ( rd.iter == NULL ? 0 : get_index( msg, rd )->count );
   return TIBRV_OK;
 }
 
@@ -713,11 +897,108 @@ tibrvMsg_GetAsBytesCopy( tibrvMsg msg, void * ptr, tibrv_u32 size )
   return TIBRV_OK;
 }
 
+tibrv_status
+tibrvMsg_GetSlot( tibrvMsg msg,  const char * name,  tibrv_u16 id,
+                  tibrvMsgSlot * slot )
+{
+  if ( name == NULL )
+    return TIBRV_INVALID_ARG;
+  RvMsgWriter & wr = get_writer( msg ); /* slots are offsets into wr.buf */
+  FNameGetArg arg( msg, name, id );
+  if ( ! arg.find() )
+    return TIBRV_NOT_FOUND;
+  MDReference & mref = arg.rd.mref;
+  if ( mref.fptr < wr.buf || mref.fptr + mref.fsize > &wr.buf[ wr.off ] )
+    return TIBRV_NOT_PERMITTED;
+  tibrv_u8 type = TIBRVMSG_NONE;
+  switch ( mref.ftype ) {
+    case MD_INT:
+      switch ( mref.fsize ) {
+        case 1: type = TIBRVMSG_I8; break;
+        case 2: type = TIBRVMSG_I16; break;
+        case 4: type = TIBRVMSG_I32; break;
+        case 8: type = TIBRVMSG_I64; break;
+      }
+      break;
+    case MD_UINT:
+      switch ( mref.fsize ) {
+        case 1: type = TIBRVMSG_U8; break;
+        case 2: type = TIBRVMSG_U16; break;
+        case 4: type = TIBRVMSG_U32; break;
+        case 8: type = TIBRVMSG_U64; break;
+      }
+      break;
+    case MD_REAL:
+      switch ( mref.fsize ) {
+        case 4: type = TIBRVMSG_F32; break;
+        case 8: type = TIBRVMSG_F64; break;
+      }
+      break;
+    case MD_BOOLEAN: if ( mref.fsize == 1 ) type = TIBRVMSG_BOOL; break;
+    case MD_STRING:  type = TIBRVMSG_STRING; break;
+    case MD_OPAQUE:  type = TIBRVMSG_OPAQUE; break;
+    default: break;
+  }
+  if ( type == TIBRVMSG_NONE )
+    return TIBRV_NOT_PERMITTED;
+  slot->off  = (tibrv_u32) ( mref.fptr - wr.buf );
+  slot->size = (tibrv_u32) mref.fsize;
+  slot->type = type;
+  slot->swap = ( mref.fsize > 1 && mref.fendian != md_endian &&
+                 type != TIBRVMSG_STRING && type != TIBRVMSG_OPAQUE );
+  return TIBRV_OK;
+}
+
+tibrv_status
+tibrvMsg_GetSlotBase( tibrvMsg msg,  void ** base )
+{
+  api_Msg * m = (api_Msg *) msg;
+  if ( m->rvmsg != NULL ) /* received, slots not taken yet */
+    return TIBRV_NOT_PERMITTED;
+  if ( m->share != NULL )
+    m->unshare( true );
+  m->base_out = true; /* written through base from now on, never lent */
+  *base = m->wr.buf;
+  return TIBRV_OK;
+}
+
+tibrv_status
+tibrvMsg_SetSlot( tibrvMsg msg,  const tibrvMsgSlot * slot,
+                  const void * value,  tibrv_u32 size )
+{
+  api_Msg * m = (api_Msg *) msg;
+  if ( m->rvmsg != NULL || slot->off + slot->size > m->wr.off )
+    return TIBRV_NOT_PERMITTED;
+  if ( m->share != NULL )
+    m->unshare( true );
+  uint8_t       * p = &m->wr.buf[ slot->off ];
+  const uint8_t * v = (const uint8_t *) value;
+  if ( slot->type == TIBRVMSG_STRING || slot->type == TIBRVMSG_OPAQUE ) {
+    /* fixed capacity, the unused tail is zero filled, a string keeps a nul */
+    if ( size > slot->size ||
+         ( slot->type == TIBRVMSG_STRING && size == slot->size ) )
+      return TIBRV_ARG_CONFLICT;
+    ::memcpy( p, v, size );
+    ::memset( &p[ size ], 0, slot->size - size );
+  }
+  else {
+    if ( size != slot->size )
+      return TIBRV_ARG_CONFLICT;
+    if ( ! slot->swap )
+      ::memcpy( p, v, size );
+    else {
+      for ( tibrv_u32 i = 0; i < size; i++ )
+        p[ i ] = v[ size - 1 - i ];
+    }
+  }
+  return TIBRV_OK;
+}
+
 tibrv_status
 tibrvMsg_CreateCopy( const tibrvMsg msg,  tibrvMsg * copy )
 {
   api_Msg * m  = (api_Msg *) msg,
-          * cp = new ( ::malloc( sizeof( api_Msg ) ) ) api_Msg( 0 );
+          * cp = api_Msg::alloc( 0 );
   if ( m->subject_len > 0 ) {
     cp->subject_len = m->subject_len;
     cp->subject     = cp->mem.stralloc( m->subject_len, m->subject );
@@ -1132,7 +1413,7 @@ tibrv_status
 tibrvMsg_GetFieldEx( tibrvMsg msg, const char * name, tibrvMsgField * field, tibrv_u16 id )
 {
   FNameGetArg arg( msg, name, id );
-  if ( arg.rd.find( arg.nm, arg.nm_len ) )
+  if ( arg.find() )
     return get_field( msg, arg.rd, field );
   return TIBRV_NOT_FOUND;
 }
@@ -1142,14 +1423,10 @@ tibrvMsg_GetFieldInstance( tibrvMsg msg,  const char * name,
                            tibrvMsgField * field,  tibrv_u32 inst )
 {
   MDFieldReader & rd = get_reader( msg );
-  if ( inst > 0 ) {
+  if ( inst > 0 && rd.iter != NULL ) {
     size_t name_len = ( name == NULL ? 0 : ::strlen( name ) + 1 );
-    for ( bool b = rd.first(); b; b = rd.next() ) {
-      if ( ((RvFieldIter *) rd.iter)->is_named( name, name_len ) ) {
-        if ( --inst == 0 )
-          return get_field( msg, rd, field );
-      }
-    }
+    if ( find_field( msg, rd, name, name_len, inst ) )
+      return get_field( msg, rd, field );
   }
   return TIBRV_NOT_FOUND;
 }
@@ -1158,14 +1435,10 @@ tibrv_status
 tibrvMsg_GetFieldByIndex( tibrvMsg msg,  tibrvMsgField * field,  tibrv_u32 idx )
 {
   MDFieldReader & rd = get_reader( msg );
-  bool b = true;
-  if ( idx == 0 || rd.iter->field_index > idx )
-    b = rd.first();
-  while ( b && rd.iter->field_index < idx )
-    b = rd.next();
-  if ( b ) {
-    if ( rd.iter->field_index == idx ) {
-      rd.iter->get_reference( rd.mref );
+  if ( rd.iter != NULL ) {
+    api_FieldIndex * x = get_index( msg, rd );
+    if ( idx < x->count ) {
+      seek_field( rd, x, idx );
       return get_field( msg, rd, field );
     }
   }
@@ -1197,7 +1470,7 @@ tibrvMsg_GetMsgEx( tibrvMsg msg, const char * name, tibrvMsg * sub, tibrv_u16 id
 {
   FNameGetArg arg( msg, name, id );
   *sub = NULL;
-  if ( arg.rd.find( arg.nm, arg.nm_len ) )
+  if ( arg.find() )
     return get_msg( msg, arg.rd, sub );
   return TIBRV_NOT_FOUND;
 }
@@ -1365,7 +1638,7 @@ tibrvMsg_GetMsgArrayEx( tibrvMsg msg, const char * name, const tibrvMsg ** array
   FNameGetArg arg( msg, name, id );
   *array = NULL;
   *count = 0;
-  if ( arg.rd.find( arg.nm, arg.nm_len ) )
+  if ( arg.find() )
     return get_msg_array( msg, arg.rd, (tibrvMsg **) array, count );
   return TIBRV_NOT_FOUND;
 }
@@ -1386,7 +1659,7 @@ tibrv_status
 tibrvMsg_GetXmlEx( tibrvMsg msg, const char * name, const void ** value, tibrv_u32*size, tibrv_u16 id)
 {
   FNameGetArg arg( msg, name, id );
-  if ( arg.rd.find( arg.nm, arg.nm_len ) )
+  if ( arg.find() )
     return get_string( arg.rd, (char **) value, size );
   return TIBRV_NOT_FOUND;
 }
@@ -1449,9 +1722,11 @@ tibrvMsg_UpdateDateTimeEx( tibrvMsg msg, const char * name, const tibrvMsgDateTi
 tibrv_status
 tibrvMsg_UpdateBoolEx( tibrvMsg msg, const char * name, tibrv_bool value, tibrv_u16 id )
 {
+  uint8_t v = ( value ? 1 : 0 );
+  if ( patch_value( msg, name, id, v, MD_BOOLEAN ) )
+    return TIBRV_OK;
   FNameUpdateArg arg( msg, name, id );
   UpdGeom g( arg.wr, arg.nm, arg.nm_len );
-  uint8_t v = ( value ? 1 : 0 );
   g.wr.append_type( arg.nm, arg.nm_len, v, MD_BOOLEAN );
   g.fin();
   return TIBRV_OK;
@@ -1460,6 +1735,8 @@ tibrvMsg_UpdateBoolEx( tibrvMsg msg, const char * name, tibrv_bool value, tibrv_
 tibrv_status
 tibrvMsg_UpdateI8Ex( tibrvMsg msg, const char * name, tibrv_i8 value, tibrv_u16 id )
 {
+  if ( patch_value( msg, name, id, value, MD_INT ) )
+    return TIBRV_OK;
   FNameUpdateArg arg( msg, name, id );
   UpdGeom g( arg.wr, arg.nm, arg.nm_len );
   g.wr.append_type( arg.nm, arg.nm_len, value, MD_INT );
@@ -1480,6 +1757,8 @@ tibrvMsg_UpdateI8ArrayEx( tibrvMsg msg, const char * name, const tibrv_i8 * arra
 tibrv_status
 tibrvMsg_UpdateU8Ex( tibrvMsg msg, const char * name, tibrv_u8 value, tibrv_u16 id )
 {
+  if ( patch_value( msg, name, id, value, MD_UINT ) )
+    return TIBRV_OK;
   FNameUpdateArg arg( msg, name, id );
   UpdGeom g( arg.wr, arg.nm, arg.nm_len );
   g.wr.append_type( arg.nm, arg.nm_len, value, MD_UINT );
@@ -1500,6 +1779,8 @@ tibrvMsg_UpdateU8ArrayEx( tibrvMsg msg, const char * name, const tibrv_u8 * arra
 tibrv_status
 tibrvMsg_UpdateI16Ex( tibrvMsg msg, const char * name, tibrv_i16 value, tibrv_u16 id )
 {
+  if ( patch_value( msg, name, id, value, MD_INT ) )
+    return TIBRV_OK;
   FNameUpdateArg arg( msg, name, id );
   UpdGeom g( arg.wr, arg.nm, arg.nm_len );
   g.wr.append_type( arg.nm, arg.nm_len, value, MD_INT );
@@ -1520,6 +1801,8 @@ tibrvMsg_UpdateI16ArrayEx( tibrvMsg msg, const char * name, const tibrv_i16 * ar
 tibrv_status
 tibrvMsg_UpdateU16Ex( tibrvMsg msg, const char * name, tibrv_u16 value, tibrv_u16 id )
 {
+  if ( patch_value( msg, name, id, value, MD_UINT ) )
+    return TIBRV_OK;
   FNameUpdateArg arg( msg, name, id );
   UpdGeom g( arg.wr, arg.nm, arg.nm_len );
   g.wr.append_type( arg.nm, arg.nm_len, value, MD_UINT );
@@ -1540,6 +1823,8 @@ tibrvMsg_UpdateU16ArrayEx( tibrvMsg msg, const char * name, const tibrv_u16 * ar
 tibrv_status
 tibrvMsg_UpdateI32Ex( tibrvMsg msg, const char * name, tibrv_i32 value, tibrv_u16 id )
 {
+  if ( patch_value( msg, name, id, value, MD_INT ) )
+    return TIBRV_OK;
   FNameUpdateArg arg( msg, name, id );
   UpdGeom g( arg.wr, arg.nm, arg.nm_len );
   g.wr.append_type( arg.nm, arg.nm_len, value, MD_INT );
@@ -1560,6 +1845,8 @@ tibrvMsg_UpdateI32ArrayEx( tibrvMsg msg, const char * name, const tibrv_i32 * ar
 tibrv_status
 tibrvMsg_UpdateU32Ex( tibrvMsg msg, const char * name, tibrv_u32 value, tibrv_u16 id )
 {
+  if ( patch_value( msg, name, id, value, MD_UINT ) )
+    return TIBRV_OK;
   FNameUpdateArg arg( msg, name, id );
   UpdGeom g( arg.wr, arg.nm, arg.nm_len );
   g.wr.append_type( arg.nm, arg.nm_len, value, MD_UINT );
@@ -1580,6 +1867,8 @@ tibrvMsg_UpdateU32ArrayEx( tibrvMsg msg, const char * name, const tibrv_u32 * ar
 tibrv_status
 tibrvMsg_UpdateI64Ex( tibrvMsg msg, const char * name, tibrv_i64 value, tibrv_u16 id )
 {
+  if ( patch_value( msg, name, id, value, MD_INT ) )
+    return TIBRV_OK;
   FNameUpdateArg arg( msg, name, id );
   UpdGeom g( arg.wr, arg.nm, arg.nm_len );
   g.wr.append_type( arg.nm, arg.nm_len, value, MD_INT );
@@ -1600,6 +1889,8 @@ tibrvMsg_UpdateI64ArrayEx( tibrvMsg msg, const char * name, const tibrv_i64 * ar
 tibrv_status
 tibrvMsg_UpdateU64Ex( tibrvMsg msg, const char * name, tibrv_u64 value, tibrv_u16 id )
 {
+  if ( patch_value( msg, name, id, value, MD_UINT ) )
+    return TIBRV_OK;
   FNameUpdateArg arg( msg, name, id );
   UpdGeom g( arg.wr, arg.nm, arg.nm_len );
   g.wr.append_type( arg.nm, arg.nm_len, value, MD_UINT );
@@ -1620,6 +1911,8 @@ tibrvMsg_UpdateU64ArrayEx( tibrvMsg msg, const char * name, const tibrv_u64 * ar
 tibrv_status
 tibrvMsg_UpdateF32Ex( tibrvMsg msg, const char * name, tibrv_f32 value, tibrv_u16 id )
 {
+  if ( patch_value( msg, name, id, value, MD_REAL ) )
+    return TIBRV_OK;
   FNameUpdateArg arg( msg, name, id );
   UpdGeom g( arg.wr, arg.nm, arg.nm_len );
   g.wr.append_type( arg.nm, arg.nm_len, value, MD_REAL );
@@ -1640,6 +1933,8 @@ tibrvMsg_UpdateF32ArrayEx( tibrvMsg msg, const char * name, const tibrv_f32 * ar
 tibrv_status
 tibrvMsg_UpdateF64Ex( tibrvMsg msg, const char * name, tibrv_f64 value, tibrv_u16 id )
 {
+  if ( patch_value( msg, name, id, value, MD_REAL ) )
+    return TIBRV_OK;
   FNameUpdateArg arg( msg, name, id );
   UpdGeom g( arg.wr, arg.nm, arg.nm_len );
   g.wr.append_type( arg.nm, arg.nm_len, value, MD_REAL );
@@ -1689,9 +1984,11 @@ tibrvMsg_UpdateMsgArrayEx( tibrvMsg msg, const char * name, const tibrvMsg * val
 tibrv_status
 tibrvMsg_UpdateStringEx( tibrvMsg msg, const char * name, const char * value, tibrv_u16 id )
 {
+  size_t len = ( value == NULL ? 0 : ::strlen( value ) + 1 );
+  if ( len > 0 && patch_field( msg, name, id, value, len, MD_STRING, false ) )
+    return TIBRV_OK;
   FNameUpdateArg arg( msg, name, id );
   UpdGeom g( arg.wr, arg.nm, arg.nm_len );
-  size_t len = ( value == NULL ? 0 : ::strlen( value ) + 1 );
   g.wr.append_string( arg.nm, arg.nm_len, value, len );
   g.fin();
   return TIBRV_OK;
@@ -1700,6 +1997,8 @@ tibrvMsg_UpdateStringEx( tibrvMsg msg, const char * name, const char * value, ti
 tibrv_status
 tibrvMsg_UpdateOpaqueEx( tibrvMsg msg, const char * name, const void * value, tibrv_u32 size, tibrv_u16 id )
 {
+  if ( size > 0 && patch_field( msg, name, id, value, size, MD_OPAQUE, false ) )
+    return TIBRV_OK;
   FNameUpdateArg arg( msg, name, id );
   UpdGeom g( arg.wr, arg.nm, arg.nm_len );
   g.wr.append_opaque( arg.nm, arg.nm_len, value, size );
@@ -0,0 +1,286 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <sassrv/timer_wheel.h>
+
+using namespace rai;
+using namespace kv;
+using namespace sassrv;
+
+bool
+TimerWheel::arm( WheelTimer *t,  uint64_t ticks,  uint64_t period ) noexcept
+{
+  uint64_t e = this->now_tick() + ( ticks == 0 ? 1 : ticks );
+  __atomic_store_n( &t->period, period == 0 ? 1 : period, __ATOMIC_RELAXED );
+  __atomic_store_n( &t->expire_tick, e, __ATOMIC_RELEASE );
+  /* linked in a slot at or before e, the owner moves it when it gets there */
+  if ( __atomic_load_n( &t->wslot, __ATOMIC_ACQUIRE ) != WHEEL_UNLINKED &&
+       __atomic_load_n( &t->wtick, __ATOMIC_RELAXED ) <= e )
+    return false;
+  return this->mark( t );
+}
+
+bool
+TimerWheel::cancel( WheelTimer *t ) noexcept
+{
+  uint32_t s = __atomic_fetch_or( &t->wstate, WHEEL_PENDING | WHEEL_CANCEL,
+                                  __ATOMIC_ACQ_REL );
+  if ( ( s & ( WHEEL_PENDING | WHEEL_CANCEL ) ) != 0 )
+    return false; /* already on the stack, the owner sees the cancel */
+  this->push( t );
+  return this->wake_needed( this->now_tick() + 1 ); /* for wheel_done() */
+}
+
+/* Push t once, until the owner takes it */
+bool
+TimerWheel::mark( WheelTimer *t ) noexcept
+{
+  uint32_t s = __atomic_load_n( &t->wstate, __ATOMIC_RELAXED );
+  for (;;) {
+    if ( ( s & ( WHEEL_PENDING | WHEEL_CANCEL ) ) != 0 )
+      return false;
+    if ( __atomic_compare_exchange_n( &t->wstate, &s, s | WHEEL_PENDING, false,
+                                      __ATOMIC_ACQ_REL, __ATOMIC_RELAXED ) )
+      break;
+  }
+  this->push( t );
+  return this->wake_needed( __atomic_load_n( &t->expire_tick,
+                                             __ATOMIC_ACQUIRE ) );
+}
+
+void
+TimerWheel::push( WheelTimer *t ) noexcept
+{
+  WheelTimer * hd = __atomic_load_n( &this->pending, __ATOMIC_RELAXED );
+  do {
+    t->wpend = hd;
+  } while ( ! __atomic_compare_exchange_n( &this->pending, &hd, t, true,
+                                           __ATOMIC_SEQ_CST,
+                                           __ATOMIC_RELAXED ) );
+}
+
+/* After a push of a timer due at e: if the poll timer is stopped, or armed
+ * for a tick after e, claim the wakeup */
+bool
+TimerWheel::wake_needed( uint64_t e ) noexcept
+{
+  if ( __atomic_load_n( &this->idle, __ATOMIC_SEQ_CST ) != 0 &&
+       __atomic_exchange_n( &this->idle, 0, __ATOMIC_SEQ_CST ) != 0 )
+    return true;
+  uint64_t w = __atomic_load_n( &this->wake_tick, __ATOMIC_SEQ_CST );
+  while ( e < w ) {
+    if ( __atomic_compare_exchange_n( &this->wake_tick, &w, 0, false,
+                                      __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST ) )
+      return true;
+  }
+  return false;
+}
+
+void
+TimerWheel::take_pending( void ) noexcept
+{
+  WheelTimer * t, * next;
+  t = __atomic_exchange_n( &this->pending, (WheelTimer *) NULL,
+                           __ATOMIC_ACQUIRE );
+  for ( ; t != NULL; t = next ) {
+    next = t->wpend; /* before clearing pending, it may be pushed again */
+    uint32_t s = __atomic_fetch_and( &t->wstate, ~(uint32_t) WHEEL_PENDING,
+                                     __ATOMIC_ACQ_REL );
+    if ( t->wslot != WHEEL_UNLINKED )
+      this->unlink( t );
+    if ( ( s & WHEEL_CANCEL ) != 0 )
+      t->wheel_done();
+    else
+      this->insert( t );
+  }
+}
+
+void
+TimerWheel::insert( WheelTimer *t ) noexcept
+{
+  uint64_t e = __atomic_load_n( &t->expire_tick, __ATOMIC_ACQUIRE ),
+           d;
+  uint32_t lvl = 0;
+  if ( e < this->cur )
+    e = this->cur;
+  d = e - this->cur;
+  while ( lvl < WHEEL_LEVELS - 1 &&
+          d >= ( (uint64_t) 1 << ( ( lvl + 1 ) * WHEEL_BITS ) ) )
+    lvl++;
+  if ( d >= ( (uint64_t) 1 << ( WHEEL_LEVELS * WHEEL_BITS ) ) ) /* park */
+    e = this->cur + ( (uint64_t) 1 << ( WHEEL_LEVELS * WHEEL_BITS ) ) - 1;
+
+  uint32_t      s  = lvl * WHEEL_SLOTS +
+                     (uint32_t) ( ( e >> ( lvl * WHEEL_BITS ) ) & WHEEL_MASK );
+  WheelTimer *& hd = this->slot[ s ];
+  t->wback = NULL;
+  if ( (t->wnext = hd) != NULL )
+    hd->wback = t;
+  hd = t;
+  __atomic_store_n( &t->wtick, e, __ATOMIC_RELAXED );
+  __atomic_store_n( &t->wslot, s, __ATOMIC_RELEASE );
+  this->count++;
+}
+
+void
+TimerWheel::unlink( WheelTimer *t ) noexcept
+{
+  if ( t->wback != NULL )
+    t->wback->wnext = t->wnext;
+  else
+    this->slot[ t->wslot ] = t->wnext;
+  if ( t->wnext != NULL )
+    t->wnext->wback = t->wback;
+  t->wnext = t->wback = NULL;
+  __atomic_store_n( &t->wslot, WHEEL_UNLINKED, __ATOMIC_RELAXED );
+  this->count--;
+}
+
+/* Move the slot of level that cur has reached down to the lower levels */
+void
+TimerWheel::cascade( uint32_t level ) noexcept
+{
+  uint32_t     s = level * WHEEL_SLOTS +
+                   (uint32_t) ( ( this->cur >> ( level * WHEEL_BITS ) ) &
+                                WHEEL_MASK );
+  WheelTimer * t;
+  while ( (t = this->slot[ s ]) != NULL ) {
+    this->unlink( t );
+    this->insert( t );
+  }
+}
+
+/* The next tick run() has work at: the first linked level 0 slot, or the
+ * first cascade of a linked slot of a higher level, ~0 when none */
+uint64_t
+TimerWheel::next_tick( void ) const noexcept
+{
+  uint64_t n = ~(uint64_t) 0;
+  for ( uint32_t k = 0; k < WHEEL_SLOTS; k++ ) {
+    if ( this->slot[ ( this->cur + k ) & WHEEL_MASK ] != NULL ) {
+      n = this->cur + k;
+      break;
+    }
+  }
+  for ( uint32_t lvl = 1; lvl < WHEEL_LEVELS; lvl++ ) {
+    uint32_t shift = lvl * WHEEL_BITS;
+    uint64_t idx   = this->cur >> shift;
+    /* k = 0 is a cascade at cur when run() has not reached it yet */
+    for ( uint32_t k = 0; k < WHEEL_SLOTS; k++ ) {
+      uint64_t b = ( idx + k ) << shift;
+      if ( b >= n )
+        break;
+      if ( b >= this->cur &&
+           this->slot[ lvl * WHEEL_SLOTS + ( ( idx + k ) & WHEEL_MASK ) ] ) {
+        n = b;
+        break;
+      }
+    }
+  }
+  return n;
+}
+
+/* Expire ticks up to and including now, skipping the ticks without work */
+void
+TimerWheel::run( uint64_t now ) noexcept
+{
+  while ( this->cur <= now ) {
+    if ( ( this->cur & WHEEL_MASK ) == 0 ) {
+      for ( uint32_t lvl = 1; lvl < WHEEL_LEVELS; lvl++ ) {
+        this->cascade( lvl );
+        if ( ( ( this->cur >> ( lvl * WHEEL_BITS ) ) & WHEEL_MASK ) != 0 )
+          break;
+      }
+    }
+    WheelTimer * t;
+    while ( (t = this->slot[ this->cur & WHEEL_MASK ]) != NULL ) {
+      this->unlink( t );
+      uint64_t e = __atomic_load_n( &t->expire_tick, __ATOMIC_ACQUIRE );
+      if ( e > this->cur ) { /* reset to later, lands in another slot */
+        this->insert( t );
+        continue;
+      }
+      this->fired++;
+      if ( t->wheel_fire() ) {
+        uint64_t next = e + __atomic_load_n( &t->period, __ATOMIC_RELAXED );
+        if ( next <= this->cur ) /* fell behind, don't expire in a burst */
+          next = this->cur + 1;
+        /* a reset during the callback wins */
+        __atomic_compare_exchange_n( &t->expire_tick, &e, next, false,
+                                     __ATOMIC_ACQ_REL, __ATOMIC_RELAXED );
+        this->insert( t );
+      }
+    }
+    this->cur++;
+    uint64_t n = this->next_tick();
+    if ( n > this->cur )
+      this->cur = ( n <= now ? n : now + 1 );
+  }
+}
+
+/* Keep ticking while linked, otherwise go idle unless a push raced in */
+bool
+TimerWheel::settle( void ) noexcept
+{
+  for (;;) {
+    if ( this->count != 0 )
+      return true;
+    __atomic_store_n( &this->idle, 1, __ATOMIC_SEQ_CST );
+    if ( __atomic_load_n( &this->pending, __ATOMIC_SEQ_CST ) == NULL )
+      return false;
+    if ( __atomic_exchange_n( &this->idle, 0, __ATOMIC_SEQ_CST ) == 0 )
+      return false; /* the pusher claimed it and will call start() */
+    this->take_pending();
+  }
+}
+
+/* Arm the poll timer for the next tick with work, replacing an armed one.
+ * A push that loaded the old wake_tick is seen by the pending recheck */
+void
+TimerWheel::arm_poll( void ) noexcept
+{
+  uint64_t now, n, ms;
+  for (;;) {
+    now = this->now_tick();
+    n   = this->next_tick();
+    if ( n <= now )
+      n = now + 1;
+    ms = ( n - now ) * this->tick_ms;
+    if ( ms > WHEEL_MAX_SLEEP_MS ) {
+      ms = WHEEL_MAX_SLEEP_MS;
+      n  = now + ms / this->tick_ms;
+    }
+    __atomic_store_n( &this->wake_tick, n, __ATOMIC_SEQ_CST );
+    if ( __atomic_load_n( &this->pending, __ATOMIC_SEQ_CST ) == NULL )
+      break;
+    this->take_pending();
+  }
+  if ( this->running )
+    this->poll.timer.remove_timer_cb( *this, (uint64_t) (size_t) this, 0 );
+  this->running = true;
+  this->poll.timer.add_timer_millis( *this, (uint32_t) ms,
+                                     (uint64_t) (size_t) this, 0 );
+}
+
+void
+TimerWheel::start( void ) noexcept
+{
+  if ( ! this->running ) /* nothing linked, slot from now */
+    this->cur = this->now_tick();
+  this->take_pending();
+  if ( ! this->settle() )
+    return; /* an armed poll timer stops when it fires */
+  this->arm_poll(); /* earlier, when a push claimed the wakeup */
+}
+
+bool
+TimerWheel::timer_cb( uint64_t,  uint64_t ) noexcept
+{
+  this->take_pending();
+  this->run( this->now_tick() );
+  this->running = false; /* one shot, armed again for the next work */
+  if ( this->settle() )
+    this->arm_poll();
+  return false;
+}
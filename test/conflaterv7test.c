@@ -0,0 +1,162 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+
+#include <sassrv/rv7api.h>
+
+/*
+ * conflaterv7test -- conflating queue test.
+ *
+ * Publishes a numbered stream round-robin over N subjects on the process
+ * transport to a TIBRVQUEUE_CONFLATE_BY_SUBJECT queue, whose dispatcher
+ * burns W microseconds per callback so it falls behind.  Each callback adds
+ * the conflate count of its message, checks that sequence numbers only move
+ * forward, and at the end every subject must have seen its last sequence and
+ * received + conflated must equal the count sent.
+ *
+ * Field layout:
+ *   SUBJ  u32  subject index (0..subjects-1)
+ *   SEQ   u64  per-subject sequence number
+ */
+
+#define MAX_SUBJECTS 4096
+
+static tibrv_u64          g_last[ MAX_SUBJECTS ];
+static volatile tibrv_u64 g_recv = 0,
+                          g_conflated = 0,
+                          g_backward = 0;
+static tibrv_u64          g_work_ns = 0;
+
+static tibrv_u64
+mono_ns( void )
+{
+  struct timespec ts;
+  clock_gettime( CLOCK_MONOTONIC, &ts );
+  return (tibrv_u64) ts.tv_sec * 1000000000ULL + (tibrv_u64) ts.tv_nsec;
+}
+
+static void
+on_msg( tibrvEvent event, tibrvMsg msg, void * closure )
+{
+  tibrv_u32 idx = 0, n = 0;
+  tibrv_u64 seq = 0, start;
+  (void) event; (void) closure;
+
+  if ( tibrvMsg_GetU32( msg, "SUBJ", &idx ) != TIBRV_OK ||
+       tibrvMsg_GetU64( msg, "SEQ", &seq ) != TIBRV_OK ||
+       idx >= MAX_SUBJECTS )
+    return;
+  tibrvMsg_GetConflateCount( msg, &n );
+  if ( seq + 1 <= g_last[ idx ] )
+    g_backward++;
+  g_last[ idx ] = seq + 1;
+
+  start = mono_ns(); /* slow consumer */
+  while ( mono_ns() - start < g_work_ns )
+    ;
+  g_conflated += n;
+  __sync_fetch_and_add( &g_recv, 1 );
+}
+
+static void
+usage( void )
+{
+  fprintf( stderr,
+    "conflaterv7test [-subjects N] [-count C] [-work-us W]\n"
+    "\n"
+    "  -subjects N  subjects to publish round-robin (default 64)\n"
+    "  -count C     messages to publish (default 100000)\n"
+    "  -work-us W   microseconds of CPU per callback (default 20)\n" );
+  exit( 1 );
+}
+
+int
+main( int argc, char ** argv )
+{
+  tibrvQueue      queue;
+  tibrvEvent      listener;
+  tibrvDispatcher disp;
+  tibrvQueueStats st;
+  unsigned long   subjects = 64, count = 100000, work_us = 20, i;
+  tibrv_u64       start, end, stale = 0;
+  tibrv_status    err;
+  char            subj[ 64 ];
+  int             j = 1;
+
+  while ( j < argc && *argv[ j ] == '-' ) {
+    if ( strcmp( argv[ j ], "-subjects" ) == 0 && j + 1 < argc ) {
+      subjects = strtoul( argv[ ++j ], NULL, 10 );
+    } else if ( strcmp( argv[ j ], "-count" ) == 0 && j + 1 < argc ) {
+      count = strtoul( argv[ ++j ], NULL, 10 );
+    } else if ( strcmp( argv[ j ], "-work-us" ) == 0 && j + 1 < argc ) {
+      work_us = strtoul( argv[ ++j ], NULL, 10 );
+    } else {
+      usage();
+    }
+    j++;
+  }
+  if ( j < argc || subjects == 0 || subjects > MAX_SUBJECTS ||
+       count < subjects )
+    usage();
+  g_work_ns = (tibrv_u64) work_us * 1000;
+
+  tibrv_Open();
+  tibrvQueue_Create( &queue );
+  err = tibrvQueue_SetLimitPolicy( queue, TIBRVQUEUE_CONFLATE_BY_SUBJECT,
+                                   0, 0 );
+  if ( err == TIBRV_OK )
+    err = tibrvEvent_CreateListener( &listener, queue, on_msg,
+                                     TIBRV_PROCESS_TRANSPORT, "CONF.>", NULL );
+  if ( err == TIBRV_OK )
+    err = tibrvDispatcher_Create( &disp, queue );
+  if ( err != TIBRV_OK ) {
+    fprintf( stderr, "conflaterv7test: %s\n", tibrvStatus_GetText( err ) );
+    return 1;
+  }
+  printf( "conflaterv7test: subjects=%lu count=%lu work=%luus\n",
+          subjects, count, work_us );
+  fflush( stdout );
+
+  start = mono_ns();
+  for ( i = 0; i < count; i++ ) {
+    tibrvMsg  msg;
+    tibrv_u32 idx = (tibrv_u32) ( i % subjects );
+    snprintf( subj, sizeof( subj ), "CONF.%u", idx );
+    tibrvMsg_Create( &msg );
+    tibrvMsg_SetSendSubject( msg, subj );
+    tibrvMsg_AddU32( msg, "SUBJ", idx );
+    tibrvMsg_AddU64( msg, "SEQ", (tibrv_u64) ( i / subjects ) );
+    tibrvTransport_Send( TIBRV_PROCESS_TRANSPORT, msg );
+    tibrvMsg_Destroy( msg );
+  }
+  end = mono_ns();
+  while ( g_recv + g_conflated < count ) {
+    struct timespec r = { 0, 1000000 };
+    nanosleep( &r, NULL );
+  }
+
+  for ( i = 0; i < subjects; i++ ) {
+    tibrv_u64 last = ( count - 1 - i ) / subjects + 1; /* seq + 1 */
+    if ( g_last[ i ] != last )
+      stale++;
+  }
+  tibrvQueue_GetStats( queue, &st );
+  printf( "sent %lu in %.3fs, received %llu, conflated %llu (queue %llu),"
+          " max depth %llu, backward=%llu stale=%llu\n",
+          count, (double) ( end - start ) / 1e9,
+          (unsigned long long) g_recv, (unsigned long long) g_conflated,
+          (unsigned long long) st.conflated,
+          (unsigned long long) st.max_depth,
+          (unsigned long long) g_backward, (unsigned long long) stale );
+
+  tibrvDispatcher_Destroy( disp );
+  tibrvEvent_Destroy( listener );
+  tibrvQueue_Destroy( queue );
+  tibrv_Close();
+  return ( g_backward == 0 && stale == 0 &&
+           g_recv + g_conflated == count ) ? 0 : 1;
+}
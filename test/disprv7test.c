@@ -0,0 +1,182 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+
+#include <sassrv/rv7api.h>
+
+/*
+ * disprv7test -- dispatcher pool scaling test.
+ *
+ * Publishes a numbered stream round-robin over N subjects on the process
+ * transport, and dispatches one queue with tibrvDispatcher_CreatePool() using
+ * T worker threads.  Each callback burns W microseconds of CPU to model a
+ * heavy handler, and checks that the sequence numbers of its subject arrive
+ * in order.  Run with -threads 1, 2, 4, ... to see how callback throughput
+ * scales on one hot queue.
+ *
+ * Field layout:
+ *   SUBJ  u32  subject index (0..subjects-1)
+ *   SEQ   u64  per-subject sequence number
+ */
+
+#define MAX_SUBJECTS 4096
+
+typedef struct {
+  tibrv_u64 next_seq;   /* only touched by the worker owning the subject */
+  tibrv_u64 misorder;
+  char      pad[ 48 ];  /* keep subjects on separate cache lines */
+} subj_state_t;
+
+static subj_state_t       g_subj[ MAX_SUBJECTS ];
+static volatile tibrv_u64 g_recv = 0;
+static tibrv_u64          g_work_ns = 0;
+
+static tibrv_u64
+mono_ns( void )
+{
+  struct timespec ts;
+  clock_gettime( CLOCK_MONOTONIC, &ts );
+  return (tibrv_u64) ts.tv_sec * 1000000000ULL + (tibrv_u64) ts.tv_nsec;
+}
+
+static void
+on_msg( tibrvEvent event, tibrvMsg msg, void * closure )
+{
+  tibrv_u32 idx = 0;
+  tibrv_u64 seq = 0, start;
+  (void) event; (void) closure;
+
+  if ( tibrvMsg_GetU32( msg, "SUBJ", &idx ) != TIBRV_OK ||
+       tibrvMsg_GetU64( msg, "SEQ", &seq ) != TIBRV_OK ||
+       idx >= MAX_SUBJECTS )
+    return;
+  if ( seq != g_subj[ idx ].next_seq )
+    g_subj[ idx ].misorder++;
+  g_subj[ idx ].next_seq = seq + 1;
+
+  start = mono_ns(); /* cpu heavy callback */
+  while ( mono_ns() - start < g_work_ns )
+    ;
+  __sync_fetch_and_add( &g_recv, 1 );
+}
+
+static void
+usage( void )
+{
+  fprintf( stderr,
+    "disprv7test [-threads T] [-subjects N] [-count C] [-work-us W]\n"
+    "            [-by-listener]\n"
+    "\n"
+    "  -threads T      dispatcher pool threads (default 4, 1 = plain)\n"
+    "  -subjects N     subjects to spread the stream over (default 64)\n"
+    "  -count C        messages to publish (default 100000)\n"
+    "  -work-us W      cpu microseconds burned per callback (default 10)\n"
+    "  -by-listener    partition by listener instead of by subject\n" );
+  exit( 1 );
+}
+
+int
+main( int argc, char ** argv )
+{
+  tibrvQueue             queue;
+  tibrvEvent             listener;
+  tibrvDispatcher        disp;
+  tibrvDispatchPartition part    = TIBRV_DISPATCH_BY_SUBJECT;
+  unsigned long          threads = 4, subjects = 64, count = 100000,
+                         work_us = 10, i;
+  tibrv_u64              start, end, misorder = 0;
+  tibrvQueueStats        st;
+  tibrv_status           err;
+  char                   subj[ 64 ];
+  int                    j = 1;
+
+  while ( j < argc && *argv[ j ] == '-' ) {
+    if ( strcmp( argv[ j ], "-threads" ) == 0 && j + 1 < argc ) {
+      threads = strtoul( argv[ ++j ], NULL, 10 );
+    } else if ( strcmp( argv[ j ], "-subjects" ) == 0 && j + 1 < argc ) {
+      subjects = strtoul( argv[ ++j ], NULL, 10 );
+    } else if ( strcmp( argv[ j ], "-count" ) == 0 && j + 1 < argc ) {
+      count = strtoul( argv[ ++j ], NULL, 10 );
+    } else if ( strcmp( argv[ j ], "-work-us" ) == 0 && j + 1 < argc ) {
+      work_us = strtoul( argv[ ++j ], NULL, 10 );
+    } else if ( strcmp( argv[ j ], "-by-listener" ) == 0 ) {
+      part = TIBRV_DISPATCH_BY_LISTENER;
+    } else {
+      usage();
+    }
+    j++;
+  }
+  if ( j < argc || subjects == 0 || subjects > MAX_SUBJECTS || threads == 0 )
+    usage();
+  g_work_ns = (tibrv_u64) work_us * 1000;
+
+  tibrv_Open();
+  tibrvQueue_Create( &queue );
+  err = tibrvEvent_CreateListener( &listener, queue, on_msg,
+                                   TIBRV_PROCESS_TRANSPORT, "DISP.>", NULL );
+  if ( err == TIBRV_OK )
+    err = tibrvDispatcher_CreatePool( &disp, queue, TIBRV_WAIT_FOREVER,
+                                      (tibrv_u32) threads, part );
+  if ( err != TIBRV_OK ) {
+    fprintf( stderr, "disprv7test: %s\n", tibrvStatus_GetText( err ) );
+    return 1;
+  }
+  printf( "disprv7test: threads=%lu subjects=%lu count=%lu work=%luus by=%s\n",
+          threads, subjects, count, work_us,
+          part == TIBRV_DISPATCH_BY_SUBJECT ? "subject" : "listener" );
+  fflush( stdout );
+
+  start = mono_ns();
+  for ( i = 0; i < count; i++ ) {
+    tibrvMsg  msg;
+    tibrv_u32 idx = (tibrv_u32) ( i % subjects );
+    snprintf( subj, sizeof( subj ), "DISP.%u", idx );
+    tibrvMsg_Create( &msg );
+    tibrvMsg_SetSendSubject( msg, subj );
+    tibrvMsg_AddU32( msg, "SUBJ", idx );
+    tibrvMsg_AddU64( msg, "SEQ", (tibrv_u64) ( i / subjects ) );
+    tibrvTransport_Send( TIBRV_PROCESS_TRANSPORT, msg );
+    tibrvMsg_Destroy( msg );
+  }
+  while ( g_recv < count ) {
+    struct timespec r = { 0, 1000000 };
+    nanosleep( &r, NULL );
+  }
+  end = mono_ns();
+
+  for ( i = 0; i < subjects; i++ )
+    misorder += g_subj[ i ].misorder;
+  printf( "dispatched %lu in %.3fs: %.0f msg/s, %.2fx of one thread at %luus,"
+          " misordered=%llu\n",
+          count, (double) ( end - start ) / 1e9,
+          (double) count * 1e9 / (double) ( end - start ),
+          work_us ? (double) count * (double) g_work_ns /
+                    (double) ( end - start ) : 0.0,
+          work_us, (unsigned long long) misorder );
+
+  if ( tibrvQueue_GetStats( queue, &st ) == TIBRV_OK ) {
+    printf( "queue: enqueued=%llu dispatched=%llu max_depth=%llu"
+            " delay avg %.1fus max %.1fus\n  delay us:",
+            (unsigned long long) st.enqueued,
+            (unsigned long long) st.dispatched,
+            (unsigned long long) st.max_depth,
+            st.delay_events ? (double) st.delay_ns /
+                              (double) st.delay_events / 1e3 : 0.0,
+            (double) st.delay_max_ns / 1e3 );
+    for ( j = 0; j < TIBRV_STATS_HIST_SIZE; j++ )
+      if ( st.delay_hist[ j ] != 0 )
+        printf( " <%llu:%llu", j == 0 ? 1ULL : 1ULL << j,
+                (unsigned long long) st.delay_hist[ j ] );
+    printf( "\n" );
+  }
+
+  tibrvDispatcher_Destroy( disp );
+  tibrvEvent_Destroy( listener );
+  tibrvQueue_Destroy( queue );
+  tibrv_Close();
+  return 0;
+}
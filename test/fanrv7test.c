@@ -6,6 +6,7 @@
 #include <string.h>
 #include <stdint.h>
 #include <time.h>
+#include <sys/resource.h>
 
 #include <sassrv/rv7api.h>
 
@@ -32,6 +33,11 @@
  * across receivers (does subscriber #1 get each message far ahead of #8?), and
  * how latency degrades as you add subscribers.
  *
+ * SPIN: -spin-us N makes the subscriber queue poll for N microseconds before
+ * parking in the condvar wait.  Run the same -pub -rate against -spin-us 0,
+ * 10, 50, 200 and compare p50/p99 with the cpu line of each summary: the
+ * spin trades a core for skipping the futex wakeup after each idle gap.
+ *
  * Clocks: the publish timestamp is CLOCK_REALTIME nanoseconds, so one-way
  * latency is meaningful across hosts only to the accuracy of clock sync
  * (PTP/NTP).  On a single host both processes read the same clock, so it is
@@ -56,6 +62,7 @@ typedef struct {
   tibrv_u64      warmup;        /* sub: discard first N samples */
   tibrv_u64      bucket_ns;     /* histogram bucket width, ns */
   int            quiet;         /* suppress per-interval lines */
+  tibrv_u32      spin_us;       /* sub: queue spin budget before parking */
 
   /* subscriber running state */
   tibrv_u64 *    hist;
@@ -102,6 +109,15 @@ mono_ns( void )
   return (tibrv_u64) ts.tv_sec * 1000000000ULL + (tibrv_u64) ts.tv_nsec;
 }
 
+static double
+cpu_secs( void )
+{
+  struct rusage ru;
+  getrusage( RUSAGE_SELF, &ru );
+  return (double) ru.ru_utime.tv_sec + (double) ru.ru_utime.tv_usec / 1e6 +
+         (double) ru.ru_stime.tv_sec + (double) ru.ru_stime.tv_usec / 1e6;
+}
+
 /* integer sqrt-ish for stddev without -lm dependency assumptions */
 static double
 dsqrt( double x )
@@ -259,7 +275,7 @@ sub_report_timer( tibrvEvent event, tibrvMsg message, void * closure )
 }
 
 static void
-sub_summary( fan_state_t * st )
+sub_summary( fan_state_t * st, double wall_s, double cpu_s )
 {
   double avg, var, sd, span_s;
   tibrv_u64 expected;
@@ -278,6 +294,9 @@ sub_summary( fan_state_t * st )
     printf( "throughput: %.0f msg/s, %.2f MB/s over %.3fs\n",
             (double) st->raw_recv / span_s,
             ( (double) st->bytes / span_s ) / ( 1024.0 * 1024.0 ), span_s );
+  if ( wall_s > 0 )
+    printf( "cpu: %.3fs over %.3fs wall (%.1f%% of a core), spin=%uus\n",
+            cpu_s, wall_s, 100.0 * cpu_s / wall_s, st->spin_us );
   if ( st->n == 0 ) {
     printf( "no latency samples (clock not synced? all warmup?)\n" );
     return;
@@ -423,6 +442,7 @@ usage( void )
     "  -warmup N        discard first N samples from latency stats (default 0)\n"
     "  -idle S          exit after S seconds with no messages (0 = never, def 5)\n"
     "  -hist-ns N       latency histogram bucket width in ns (default 1000)\n"
+    "  -spin-us N       poll the queue N us before sleeping (default 0)\n"
     "\n"
     " common:\n"
     "  -interval S      report interval seconds (default 1.0)\n"
@@ -472,6 +492,8 @@ main( int argc, char ** argv )
     } else if ( strcmp( argv[ i ], "-hist-ns" ) == 0 && i + 1 < argc ) {
       hist_ns = strtoul( argv[ ++i ], NULL, 10 );
       if ( hist_ns == 0 ) hist_ns = 1;
+    } else if ( strcmp( argv[ i ], "-spin-us" ) == 0 && i + 1 < argc ) {
+      st.spin_us = (tibrv_u32) strtoul( argv[ ++i ], NULL, 10 );
     } else if ( strcmp( argv[ i ], "-interval" ) == 0 && i + 1 < argc ) {
       interval = strtod( argv[ ++i ], NULL );
     } else if ( strcmp( argv[ i ], "-quiet" ) == 0 ) {
@@ -514,8 +536,11 @@ main( int argc, char ** argv )
     publisher_run( &st, rate, count, size );
   }
   else {
+    double wall0, cpu0;
     st.hist = (tibrv_u64 *) calloc( HIST_BUCKETS, sizeof( tibrv_u64 ) );
     if ( st.hist == NULL ) { fprintf( stderr, "out of memory\n" ); exit( 1 ); }
+    if ( st.spin_us != 0 )
+      tibrvQueue_SetSpinTime( TIBRV_DEFAULT_QUEUE, st.spin_us );
 
     err = tibrvEvent_CreateListener( &listenId, TIBRV_DEFAULT_QUEUE,
                                      sub_callback, st.transport,
@@ -536,12 +561,14 @@ main( int argc, char ** argv )
     printf( "fanrv7test: subscribing to %s\n", st.subject );
     fflush( stdout );
 
+    wall0 = (double) mono_ns() / 1e9;
+    cpu0  = cpu_secs();
     while ( ! g_stop ) {
       err = tibrvQueue_TimedDispatch( TIBRV_DEFAULT_QUEUE, 0.25 );
       if ( err != TIBRV_OK && err != TIBRV_TIMEOUT )
         break;
     }
-    sub_summary( &st );
+    sub_summary( &st, (double) mono_ns() / 1e9 - wall0, cpu_secs() - cpu0 );
     free( st.hist );
   }
 
@@ -0,0 +1,165 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+
+#include <sassrv/rv7api.h>
+
+/*
+ * fidxrv7test -- lookups through the lazy field index of a message.
+ *
+ * No daemon is needed.  A message has N fields F.<i> = i with the names
+ * "dup" and "one" mixed in, "dup" three times.  The checks:
+ *   ordinal  : tibrvMsg_GetFieldByIndex() returns each field in order.
+ *   name     : every F.<i> is found by name with its value.
+ *   dup      : instances of "dup" are found in message order, the first
+ *              by tibrvMsg_GetU32(), one past the last is not found.
+ *   update   : after an update, an add and a remove the index built by the
+ *              lookups before is not used, the lookups see the new fields.
+ *   copy     : a copy of the updated message has the same instances.
+ * The exit status is 0 when all pass.
+ */
+
+static int g_fail;
+
+#define CHECK( cond, ... ) do { \
+    if ( ! ( cond ) ) { \
+      printf( "FAIL line %d: ", __LINE__ ); \
+      printf( __VA_ARGS__ ); \
+      printf( "\n" ); \
+      g_fail++; \
+    } \
+  } while ( 0 )
+
+static tibrv_u32
+get_u32( tibrvMsg msg,  const char *name,  tibrv_u32 inst )
+{
+  tibrvMsgField f;
+  if ( tibrvMsg_GetFieldInstance( msg, name, &f, inst ) != TIBRV_OK )
+    return ~(tibrv_u32) 0;
+  return f.data.u32;
+}
+
+static void
+check_dup( tibrvMsg msg,  const tibrv_u32 *val,  tibrv_u32 n )
+{
+  tibrvMsgField f;
+  tibrv_u32     i, v = 0;
+  for ( i = 0; i < n; i++ )
+    CHECK( get_u32( msg, "dup", i + 1 ) == val[ i ], "dup inst %u != %u",
+           i + 1, val[ i ] );
+  CHECK( tibrvMsg_GetFieldInstance( msg, "dup", &f, n + 1 ) == TIBRV_NOT_FOUND,
+         "dup inst %u found", n + 1 );
+  CHECK( tibrvMsg_GetFieldInstance( msg, "dup", &f, 0 ) == TIBRV_NOT_FOUND,
+         "dup inst 0 found" );
+  CHECK( tibrvMsg_GetU32( msg, "dup", &v ) == TIBRV_OK && v == val[ 0 ],
+         "dup first %u != %u", v, val[ 0 ] );
+}
+
+static void
+run( tibrv_u32 nflds )
+{
+  tibrvMsg      msg, copy;
+  tibrvMsgField f;
+  tibrv_u32     i, n = 0, v = 0;
+  char          name[ 32 ];
+  tibrv_u32     dup[ 3 ] = { 100, 200, 300 },
+                dup2[ 3 ] = { 200, 300, 400 };
+
+  tibrvMsg_Create( &msg );
+  for ( i = 0; i < nflds; i++ ) {
+    snprintf( name, sizeof( name ), "F.%u", i );
+    tibrvMsg_AddU32( msg, name, i );
+    if ( i == 0 || i == nflds / 2 || i == nflds - 1 )
+      tibrvMsg_AddU32( msg, "dup", dup[ i == 0 ? 0 : i == nflds - 1 ? 2 : 1 ] );
+    if ( i == nflds / 3 )
+      tibrvMsg_AddU32( msg, "one", 1 );
+  }
+  /* ordinal, the first lookup builds the index */
+  tibrvMsg_GetNumFields( msg, &n );
+  CHECK( n == nflds + 4, "num fields %u != %u", n, nflds + 4 );
+  CHECK( tibrvMsg_GetFieldByIndex( msg, &f, 0 ) == TIBRV_OK &&
+         strcmp( f.name, "F.0" ) == 0, "index 0 not F.0" );
+  CHECK( tibrvMsg_GetFieldByIndex( msg, &f, 1 ) == TIBRV_OK &&
+         strcmp( f.name, "dup" ) == 0 && f.data.u32 == dup[ 0 ],
+         "index 1 not dup" );
+  CHECK( tibrvMsg_GetFieldByIndex( msg, &f, n ) == TIBRV_NOT_FOUND,
+         "index %u found", n );
+  /* by name, through the index, last to first */
+  for ( i = nflds; i > 0; i-- ) {
+    snprintf( name, sizeof( name ), "F.%u", i - 1 );
+    CHECK( tibrvMsg_GetU32( msg, name, &v ) == TIBRV_OK && v == i - 1,
+           "%s = %u", name, v );
+  }
+  CHECK( get_u32( msg, "one", 1 ) == 1, "one not found" );
+  CHECK( tibrvMsg_GetFieldInstance( msg, "none", &f, 1 ) == TIBRV_NOT_FOUND,
+         "none found" );
+  check_dup( msg, dup, 3 );
+
+  /* update: the index is rebuilt, not reused */
+  tibrvMsg_UpdateU32( msg, "F.0", 1000 );
+  CHECK( tibrvMsg_GetU32( msg, "F.0", &v ) == TIBRV_OK && v == 1000,
+         "updated F.0 = %u", v );
+  tibrvMsg_AddU32( msg, "dup", 400 );
+  tibrvMsg_RemoveFieldInstance( msg, "dup", 1 );
+  tibrvMsg_RemoveField( msg, "one" );
+  check_dup( msg, dup2, 3 );
+  CHECK( tibrvMsg_GetFieldInstance( msg, "one", &f, 1 ) == TIBRV_NOT_FOUND,
+         "removed one found" );
+  tibrvMsg_GetNumFields( msg, &n );
+  CHECK( n == nflds + 3, "num fields %u != %u after update", n, nflds + 3 );
+  CHECK( tibrvMsg_GetFieldByIndex( msg, &f, n - 1 ) == TIBRV_OK &&
+         strcmp( f.name, "dup" ) == 0 && f.data.u32 == 400,
+         "last index not the added dup" );
+  snprintf( name, sizeof( name ), "F.%u", nflds - 1 );
+  CHECK( tibrvMsg_GetU32( msg, name, &v ) == TIBRV_OK && v == nflds - 1,
+         "%s = %u after update", name, v );
+
+  /* copy */
+  tibrvMsg_CreateCopy( msg, &copy );
+  check_dup( copy, dup2, 3 );
+  CHECK( tibrvMsg_GetU32( copy, "F.0", &v ) == TIBRV_OK && v == 1000,
+         "copy F.0 = %u", v );
+  tibrvMsg_Destroy( copy );
+  tibrvMsg_Destroy( msg );
+}
+
+static void
+usage( void )
+{
+  fprintf( stderr,
+    "fidxrv7test [-fields N] [-count C]\n"
+    "\n"
+    "  -fields N    F.<i> fields in the message (default 200)\n"
+    "  -count C     times the checks run (default 10)\n" );
+  exit( 1 );
+}
+
+int
+main( int argc, char **argv )
+{
+  tibrv_u32 nflds = 200, count = 10, k;
+  int       i = 1;
+
+  while ( i < argc && *argv[ i ] == '-' ) {
+    if ( strcmp( argv[ i ], "-fields" ) == 0 && i + 1 < argc ) {
+      nflds = (tibrv_u32) strtoul( argv[ ++i ], NULL, 10 );
+    } else if ( strcmp( argv[ i ], "-count" ) == 0 && i + 1 < argc ) {
+      count = (tibrv_u32) strtoul( argv[ ++i ], NULL, 10 );
+    } else {
+      usage();
+    }
+    i++;
+  }
+  if ( i < argc || nflds < 3 || count == 0 )
+    usage();
+
+  tibrv_Open();
+  for ( k = 0; k < count; k++ )
+    run( nflds );
+  tibrv_Close();
+  printf( "fidxrv7test: %s, %d failed\n", g_fail == 0 ? "ok" : "FAIL", g_fail );
+  return g_fail != 0;
+}
@@ -0,0 +1,247 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#include <poll.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+
+#include <sassrv/rv7api.h>
+
+/*
+ * ftfailrv7test -- FT fast mode failover time.
+ *
+ * This process is a fault tolerant member with weight 50.  Each trial starts
+ * a primary, a copy of this program run with -primary and weight 100, waits
+ * for it to activate and take over, then kills it and times how long this
+ * member takes to get TIBRVFT_ACTIVATE.  After T trials it prints the time to
+ * activate distribution.
+ *
+ * SIGKILL closes the primary's daemon connection, so the daemon may report
+ * the session stop before the heartbeats are missed.  -hang sends SIGSTOP
+ * instead, a hung primary that is only detected by missed heartbeats.
+ * Without -fast the members use only the hb and activate intervals.
+ */
+
+static tibrv_u64 g_act_ns;   /* when this member activated, 0 = inactive */
+static int       g_active;
+
+static tibrv_u64
+mono_ns( void )
+{
+  struct timespec ts;
+  clock_gettime( CLOCK_MONOTONIC, &ts );
+  return (tibrv_u64) ts.tv_sec * 1000000000ULL + (tibrv_u64) ts.tv_nsec;
+}
+
+static void
+sleep_ms( long ms )
+{
+  struct timespec r;
+  r.tv_sec  = ms / 1000;
+  r.tv_nsec = ( ms % 1000 ) * 1000000L;
+  nanosleep( &r, NULL );
+}
+
+static void
+on_ft( tibrvftMember memb, const char *group, tibrvftAction action, void *cl )
+{
+  int fd = (int) (intptr_t) cl;
+  (void) memb; (void) group;
+  if ( action == TIBRVFT_ACTIVATE ) {
+    __atomic_store_n( &g_act_ns, mono_ns(), __ATOMIC_RELEASE );
+    __atomic_store_n( &g_active, 1, __ATOMIC_RELEASE );
+    if ( fd >= 0 && write( fd, "A", 1 ) != 1 )
+      exit( 1 );
+  }
+  else if ( action == TIBRVFT_DEACTIVATE )
+    __atomic_store_n( &g_active, 0, __ATOMIC_RELEASE );
+}
+
+static int
+cmp_u64( const void *a, const void *b )
+{
+  tibrv_u64 x = *(const tibrv_u64 *) a, y = *(const tibrv_u64 *) b;
+  return x < y ? -1 : x > y ? 1 : 0;
+}
+
+static void
+usage( void )
+{
+  fprintf( stderr,
+    "ftfailrv7test [-daemon D] [-group G] [-trials T] [-hb S] [-activate S]\n"
+    "              [-fast MS] [-miss N] [-recover N] [-settle MS] [-hang]\n"
+    "\n"
+    "  -daemon D    daemon to connect (default tcp:7500)\n"
+    "  -group G     ft group name (default FTFAIL)\n"
+    "  -trials T    primaries killed (default 200)\n"
+    "  -hb S        heartbeat interval seconds (default 0.1)\n"
+    "  -activate S  activate interval seconds (default 0.5)\n"
+    "  -fast MS     fast mode heartbeat ms, 0 is off (default 10)\n"
+    "  -miss N      fast mode intervals missed to lose a peer (default 3)\n"
+    "  -recover N   fast mode intervals heard to restore it (default 2)\n"
+    "  -settle MS   wait after the takeover before the kill (default 200)\n"
+    "  -hang        stop the primary instead of killing it\n" );
+  exit( 1 );
+}
+
+int
+main( int argc, char **argv )
+{
+  const char   * daemon = "tcp:7500",
+               * group  = "FTFAIL";
+  tibrvTransport tport;
+  tibrvftMember  memb;
+  tibrvDispatcher disp;
+  tibrv_status   err;
+  tibrv_u64    * lat;
+  double         hb = 0.1, act = 0.5, fast = 10, sum = 0;
+  unsigned long  trials = 200, miss = 3, recover = 2, settle = 200, n = 0,
+                 fail = 0, t;
+  int            i = 1, j, primary_fd = -1, hang = 0;
+  char           fast_s[ 32 ], miss_s[ 32 ], rec_s[ 32 ], hb_s[ 32 ],
+                 act_s[ 32 ], fd_s[ 32 ];
+
+  while ( i < argc && *argv[ i ] == '-' ) {
+    if ( strcmp( argv[ i ], "-daemon" ) == 0 && i + 1 < argc ) {
+      daemon = argv[ ++i ];
+    } else if ( strcmp( argv[ i ], "-group" ) == 0 && i + 1 < argc ) {
+      group = argv[ ++i ];
+    } else if ( strcmp( argv[ i ], "-trials" ) == 0 && i + 1 < argc ) {
+      trials = strtoul( argv[ ++i ], NULL, 10 );
+    } else if ( strcmp( argv[ i ], "-hb" ) == 0 && i + 1 < argc ) {
+      hb = strtod( argv[ ++i ], NULL );
+    } else if ( strcmp( argv[ i ], "-activate" ) == 0 && i + 1 < argc ) {
+      act = strtod( argv[ ++i ], NULL );
+    } else if ( strcmp( argv[ i ], "-fast" ) == 0 && i + 1 < argc ) {
+      fast = strtod( argv[ ++i ], NULL );
+    } else if ( strcmp( argv[ i ], "-miss" ) == 0 && i + 1 < argc ) {
+      miss = strtoul( argv[ ++i ], NULL, 10 );
+    } else if ( strcmp( argv[ i ], "-recover" ) == 0 && i + 1 < argc ) {
+      recover = strtoul( argv[ ++i ], NULL, 10 );
+    } else if ( strcmp( argv[ i ], "-settle" ) == 0 && i + 1 < argc ) {
+      settle = strtoul( argv[ ++i ], NULL, 10 );
+    } else if ( strcmp( argv[ i ], "-hang" ) == 0 ) {
+      hang = 1;
+    } else if ( strcmp( argv[ i ], "-primary" ) == 0 && i + 1 < argc ) {
+      primary_fd = atoi( argv[ ++i ] );
+    } else {
+      usage();
+    }
+    i++;
+  }
+  if ( i < argc || trials == 0 || hb <= 0 || act <= hb )
+    usage();
+
+  if ( (err = tibrv_Open()) != TIBRV_OK ||
+       (err = tibrvTransport_Create( &tport, NULL, NULL, daemon )) != TIBRV_OK ||
+       (err = tibrvftMember_Create( &memb, TIBRV_DEFAULT_QUEUE, on_ft, tport,
+                                    group, primary_fd >= 0 ? 100 : 50, 1, hb,
+                                    0, act, (void *) (intptr_t) primary_fd ))
+         != TIBRV_OK ) {
+    fprintf( stderr, "ftfailrv7test: %s\n", tibrvStatus_GetText( err ) );
+    return 1;
+  }
+  if ( fast > 0 &&
+       (err = tibrvftMember_SetFastMode( memb, fast / 1000.0,
+                                         (tibrv_u32) miss,
+                                         (tibrv_u32) recover )) != TIBRV_OK ) {
+    fprintf( stderr, "ftfailrv7test: fast mode: %s\n",
+             tibrvStatus_GetText( err ) );
+    return 1;
+  }
+  if ( primary_fd >= 0 ) { /* run until killed */
+    for (;;)
+      tibrvQueue_Dispatch( TIBRV_DEFAULT_QUEUE );
+  }
+  tibrvDispatcher_Create( &disp, TIBRV_DEFAULT_QUEUE );
+
+  snprintf( hb_s, sizeof( hb_s ), "%g", hb );
+  snprintf( act_s, sizeof( act_s ), "%g", act );
+  snprintf( fast_s, sizeof( fast_s ), "%g", fast );
+  snprintf( miss_s, sizeof( miss_s ), "%lu", miss );
+  snprintf( rec_s, sizeof( rec_s ), "%lu", recover );
+  lat = (tibrv_u64 *) malloc( sizeof( lat[ 0 ] ) * trials );
+
+  printf( "ftfailrv7test: hb=%gs activate=%gs fast=%gms miss=%lu recover=%lu"
+          " %s\n", hb, act, fast, miss, recover, hang ? "hang" : "kill" );
+  fflush( stdout );
+  for ( t = 0; t < trials; t++ ) {
+    struct pollfd pfd;
+    tibrv_u64     start, end;
+    int           pp[ 2 ];
+    pid_t         pid;
+    char          c;
+
+    if ( pipe( pp ) != 0 )
+      break;
+    snprintf( fd_s, sizeof( fd_s ), "%d", pp[ 1 ] );
+    if ( (pid = fork()) == 0 ) {
+      char * av[] = { argv[ 0 ], "-primary", fd_s, "-daemon", (char *) daemon,
+                      "-group", (char *) group, "-hb", hb_s, "-activate",
+                      act_s, "-fast", fast_s, "-miss", miss_s, "-recover",
+                      rec_s, NULL };
+      close( pp[ 0 ] );
+      execv( "/proc/self/exe", av );
+      _exit( 1 );
+    }
+    close( pp[ 1 ] );
+    /* the primary activated and this member deactivated */
+    pfd.fd     = pp[ 0 ];
+    pfd.events = POLLIN;
+    if ( pid < 0 || poll( &pfd, 1, 10000 ) != 1 || read( pp[ 0 ], &c, 1 ) != 1 ) {
+      fprintf( stderr, "ftfailrv7test: primary did not activate\n" );
+      if ( pid > 0 ) {
+        kill( pid, SIGKILL );
+        waitpid( pid, NULL, 0 );
+      }
+      close( pp[ 0 ] );
+      fail++;
+      continue;
+    }
+    for ( j = 0; j < 2000 && __atomic_load_n( &g_active, __ATOMIC_ACQUIRE );
+          j++ )
+      sleep_ms( 1 );
+    sleep_ms( (long) settle );
+
+    __atomic_store_n( &g_act_ns, 0, __ATOMIC_RELEASE );
+    start = mono_ns();
+    kill( pid, hang ? SIGSTOP : SIGKILL );
+    end = 0;
+    for ( j = 0; j < 5000; j++ ) {
+      if ( (end = __atomic_load_n( &g_act_ns, __ATOMIC_ACQUIRE )) != 0 )
+        break;
+      sleep_ms( 1 );
+    }
+    kill( pid, SIGKILL );
+    waitpid( pid, NULL, 0 );
+    close( pp[ 0 ] );
+    if ( end == 0 || end < start ) {
+      fail++;
+      continue;
+    }
+    lat[ n++ ] = end - start;
+    sum += (double) ( end - start );
+  }
+  if ( n > 0 ) {
+    qsort( lat, n, sizeof( lat[ 0 ] ), cmp_u64 );
+    printf( "%lu trials, %lu failed, time to activate ms: min %.2f avg %.2f"
+            " p50 %.2f p90 %.2f p99 %.2f max %.2f\n",
+            trials, fail, (double) lat[ 0 ] / 1e6, sum / (double) n / 1e6,
+            (double) lat[ n / 2 ] / 1e6, (double) lat[ n * 9 / 10 ] / 1e6,
+            (double) lat[ n * 99 / 100 ] / 1e6, (double) lat[ n - 1 ] / 1e6 );
+  }
+  else
+    printf( "%lu trials, all failed\n", trials );
+  tibrvDispatcher_Destroy( disp );
+  tibrvftMember_Destroy( memb );
+  tibrvTransport_Destroy( tport );
+  tibrv_Close();
+  free( lat );
+  return fail == 0 ? 0 : 1;
+}
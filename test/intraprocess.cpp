@@ -1,17 +1,25 @@
 #include <cstdio>
+#include <cstdlib>
 #include <thread>
 #include <chrono>
+#include <atomic>
 
 #include <sassrv/rv7api.h>
 
 #define IN_SUBJECT "TEST"
 
+/* intra_test [count] : with a count, publish that many without the sleep
+ * and print messages/sec when all are received */
+static unsigned long count = 0;
+static std::atomic<unsigned long> received( 0 );
+
 void
 pubthread(void )
 {
-  for (;;)
+  for ( unsigned long i = 0; count == 0 || i < count; i++ )
   {
-    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    if ( count == 0 )
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
     tibrvMsg msg;
     tibrvMsg_Create(&msg);
     tibrvMsg_SetSendSubject(msg, IN_SUBJECT);
@@ -36,11 +44,14 @@ onMsg( tibrvEvent event, tibrvMsg msg, void *closure )
   tibrvMsg_ConvertToString(msg, &buffer);
   printf("RECEIVED [%s] %s\n", subject, buffer);
   #endif
+  received++;
 }
 
 int
 main(int argc, const char** argv) 
 {
+  if ( argc > 1 )
+    count = strtoul( argv[ 1 ], NULL, 10 );
   tibrv_Open();
 
   tibrvQueue queue;
@@ -57,13 +68,25 @@ main(int argc, const char** argv)
   );
   printf("START LISTENING : %s\n", IN_SUBJECT);
 
+  auto start = std::chrono::steady_clock::now();
   std::thread th(pubthread);
 
   tibrv_status status = TIBRV_OK;
 
-  for (status = tibrvQueue_Dispatch(queue); status == TIBRV_OK; status = tibrvQueue_Dispatch(queue));
-
-  printf("STOP - %d : %s", status, tibrvStatus_GetText(status));
+  for (status = tibrvQueue_Dispatch(queue); status == TIBRV_OK; status = tibrvQueue_Dispatch(queue))
+  {
+    if ( count != 0 && received == count )
+      break;
+  }
+  if ( count != 0 ) {
+    std::chrono::duration<double> secs =
+      std::chrono::steady_clock::now() - start;
+    printf( "received %lu in %.3fs: %.0f msgs/sec\n", count, secs.count(),
+            (double) count / secs.count() );
+    th.join();
+  }
+  else
+    printf("STOP - %d : %s", status, tibrvStatus_GetText(status));
 
   tibrvEvent_Destroy(listener);
   tibrvQueue_Destroy(queue);
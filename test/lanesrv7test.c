@@ -0,0 +1,196 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+
+#include <sassrv/rv7api.h>
+
+/*
+ * lanesrv7test -- receive lane ingest scaling.
+ *
+ * For each k from 1 to K, a subscriber transport with k receive lanes
+ * listens to N subjects LANES.<i> on an inline dispatch queue, so the
+ * callbacks run on the I/O threads of the lanes.  A second transport
+ * publishes C msgs round-robin over the subjects, the test reports the msgs
+ * per second received from the first to the last and the msgs which arrived
+ * out of order within their subject, which should always be 0.
+ */
+
+typedef struct {
+  tibrv_u32 * last;      /* last seq + 1 of each subject */
+  tibrv_u64   reorder;   /* updated only by the lane of the subject */
+} subj_state_t;
+
+static subj_state_t       g_st;
+static volatile tibrv_u64 g_recv, g_first_ns;
+static tibrv_u32          g_subjects = 1000;
+
+static tibrv_u64
+mono_ns( void )
+{
+  struct timespec ts;
+  clock_gettime( CLOCK_MONOTONIC, &ts );
+  return (tibrv_u64) ts.tv_sec * 1000000000ULL + (tibrv_u64) ts.tv_nsec;
+}
+
+static void
+on_msg( tibrvEvent ev,  tibrvMsg msg,  void *cl )
+{
+  tibrv_u32 i = (tibrv_u32) (uintptr_t) cl, seq = 0;
+  (void) ev;
+  tibrvMsg_GetU32( msg, "seq", &seq );
+  if ( seq < g_st.last[ i ] )
+    __atomic_fetch_add( &g_st.reorder, 1, __ATOMIC_RELAXED );
+  g_st.last[ i ] = seq + 1;
+  if ( __atomic_fetch_add( &g_recv, 1, __ATOMIC_RELAXED ) == 0 )
+    g_first_ns = mono_ns();
+}
+
+static void
+sleep_ms( long ms )
+{
+  struct timespec r;
+  r.tv_sec  = ms / 1000;
+  r.tv_nsec = ( ms % 1000 ) * 1000000L;
+  nanosleep( &r, NULL );
+}
+
+static int
+run( tibrvTransport pub,  const char *daemon,  tibrv_u32 lanes,
+     tibrv_u32 count,  double *rate )
+{
+  tibrvTransport sub;
+  tibrvQueue     q;
+  tibrvEvent   * ev;
+  tibrvMsg       msg;
+  tibrv_status   err;
+  char           subj[ 64 ];
+  tibrv_u64      last_recv = 0, last_ns, end_ns;
+  tibrv_u32      i;
+
+  if ( (err = tibrvTransport_Create( &sub, NULL, NULL, daemon )) != TIBRV_OK ||
+       (err = tibrvTransport_SetReceiveLanes( sub, lanes )) != TIBRV_OK ) {
+    fprintf( stderr, "lanesrv7test: lanes %u: %s\n", lanes,
+             tibrvStatus_GetText( err ) );
+    return -1;
+  }
+  tibrvQueue_Create( &q );
+  tibrvQueue_SetInlineDispatch( q, TIBRV_TRUE );
+  ev = (tibrvEvent *) malloc( sizeof( ev[ 0 ] ) * g_subjects );
+  memset( g_st.last, 0, sizeof( g_st.last[ 0 ] ) * g_subjects );
+  g_st.reorder = 0;
+  g_recv       = 0;
+  for ( i = 0; i < g_subjects; i++ ) {
+    snprintf( subj, sizeof( subj ), "LANES.%u", i );
+    tibrvEvent_CreateListener( &ev[ i ], q, on_msg, sub, subj,
+                               (const void *) (uintptr_t) i );
+  }
+  sleep_ms( 500 ); /* the subscriptions reach the daemon */
+
+  tibrvMsg_Create( &msg );
+  for ( i = 0; i < count; i++ ) {
+    snprintf( subj, sizeof( subj ), "LANES.%u", i % g_subjects );
+    tibrvMsg_SetSendSubject( msg, subj );
+    tibrvMsg_UpdateU32( msg, "seq", i / g_subjects );
+    tibrvTransport_Send( pub, msg );
+  }
+  tibrvMsg_Destroy( msg );
+
+  /* wait for all, or until nothing arrives for a second */
+  last_ns = mono_ns();
+  for (;;) {
+    tibrv_u64 n = g_recv;
+    end_ns = mono_ns();
+    if ( n >= count )
+      break;
+    if ( n != last_recv ) {
+      last_recv = n;
+      last_ns   = end_ns;
+    }
+    else if ( end_ns - last_ns > 1000000000ULL )
+      break;
+    sleep_ms( 1 );
+  }
+  *rate = ( g_recv > 0 && end_ns > g_first_ns ) ?
+          (double) g_recv * 1e9 / (double) ( end_ns - g_first_ns ) : 0.0;
+  printf( "lanes %2u: received %llu of %u, %.0f msgs/sec, reordered %llu\n",
+          lanes, (unsigned long long) g_recv, count, *rate,
+          (unsigned long long) g_st.reorder );
+  fflush( stdout );
+
+  for ( i = 0; i < g_subjects; i++ )
+    tibrvEvent_DestroyEx( ev[ i ], NULL );
+  free( ev );
+  tibrvQueue_DestroyEx( q, NULL, NULL );
+  tibrvTransport_Destroy( sub );
+  return ( g_recv == count && g_st.reorder == 0 ) ? 0 : 1;
+}
+
+static void
+usage( void )
+{
+  fprintf( stderr,
+    "lanesrv7test [-daemon D] [-lanes K] [-subjects N] [-count C]\n"
+    "\n"
+    "  -daemon D    daemon to connect (default tcp:7500)\n"
+    "  -lanes K     run 1 to K receive lanes (default 4)\n"
+    "  -subjects N  subjects published round-robin (default 1000)\n"
+    "  -count C     msgs published for each run (default 1000000)\n" );
+  exit( 1 );
+}
+
+int
+main( int argc, char **argv )
+{
+  const char   * daemon = "tcp:7500";
+  tibrvTransport pub;
+  tibrv_status   err;
+  tibrv_u32      lanes = 4, count = 1000000, k;
+  double         rate, base = 0;
+  int            i = 1, status = 0;
+
+  while ( i < argc && *argv[ i ] == '-' ) {
+    if ( strcmp( argv[ i ], "-daemon" ) == 0 && i + 1 < argc ) {
+      daemon = argv[ ++i ];
+    } else if ( strcmp( argv[ i ], "-lanes" ) == 0 && i + 1 < argc ) {
+      lanes = (tibrv_u32) strtoul( argv[ ++i ], NULL, 10 );
+    } else if ( strcmp( argv[ i ], "-subjects" ) == 0 && i + 1 < argc ) {
+      g_subjects = (tibrv_u32) strtoul( argv[ ++i ], NULL, 10 );
+    } else if ( strcmp( argv[ i ], "-count" ) == 0 && i + 1 < argc ) {
+      count = (tibrv_u32) strtoul( argv[ ++i ], NULL, 10 );
+    } else {
+      usage();
+    }
+    i++;
+  }
+  if ( i < argc || lanes == 0 || lanes > 16 || g_subjects == 0 || count == 0 )
+    usage();
+  g_st.last = (tibrv_u32 *) malloc( sizeof( g_st.last[ 0 ] ) * g_subjects );
+
+  /* a thread for each lane and one for the publisher */
+  tibrv_SetIoThreads( lanes + 1, NULL );
+  tibrv_SetTransportSharing( TIBRV_FALSE );
+  if ( (err = tibrv_Open()) != TIBRV_OK ||
+       (err = tibrvTransport_Create( &pub, NULL, NULL, daemon )) != TIBRV_OK ) {
+    fprintf( stderr, "lanesrv7test: %s: %s\n", daemon,
+             tibrvStatus_GetText( err ) );
+    return 1;
+  }
+  for ( k = 1; k <= lanes; k++ ) {
+    int r = run( pub, daemon, k, count, &rate );
+    if ( r < 0 )
+      return 1;
+    if ( k == 1 )
+      base = rate;
+    else if ( base > 0 )
+      printf( "          %.2fx of 1 lane\n", rate / base );
+    status |= r;
+  }
+  tibrvTransport_Destroy( pub );
+  tibrv_Close();
+  free( g_st.last );
+  return status;
+}
@@ -315,7 +315,8 @@ usage( void )
     "  -libbatch B    rate mode: library TIMER_BATCH, flush every B bytes\n"
     "  -singlebatch B library SINGLE_BATCH: one shared buffer, inline flush on\n"
     "                 E every B bytes (0=timer-only)\n"
-    "  -binterval S   SINGLE_BATCH flush-timer period in seconds (default 0)\n" );
+    "  -binterval S   SINGLE_BATCH flush-timer period in seconds (default 0)\n"
+    "  -inline        reflect: echo from the I/O thread, no queue dispatch\n" );
   exit( 1 );
 }
 
@@ -325,7 +326,8 @@ get_InitParms( int argc, char * argv[], int min_parms, char ** serviceStr,
                double * rate, unsigned long * count, unsigned long * size,
                double * interval, double * timeout, int * quiet,
                unsigned long * batch, unsigned long * libbatch, int * spin,
-               unsigned long * singlebatch, double * binterval )
+               unsigned long * singlebatch, double * binterval,
+               int * inline_disp )
 {
   int i = 1;
 
@@ -381,6 +383,9 @@ get_InitParms( int argc, char * argv[], int min_parms, char ** serviceStr,
     else if ( strcmp( argv[ i ], "-binterval" ) == 0 && i + 2 <= argc ) {
       *binterval = strtod( argv[ i + 1 ], NULL ); i += 2;
     }
+    else if ( strcmp( argv[ i ], "-inline" ) == 0 ) {
+      *inline_disp = 1; i += 1;
+    }
     else {
       usage();
     }
@@ -410,12 +415,14 @@ main( int argc, char ** argv )
   int            spin       = 0;
   unsigned long  singlebatch = 0;
   double         binterval  = 0.0;
+  int            inline_disp = 0;
   char *         progname   = argv[ 0 ];
 
   currentArg = get_InitParms( argc, argv, MIN_PARMS, &serviceStr, &networkStr,
                               &daemonStr, &reflect, &rate, &count, &size,
                               &interval, &timeout, &quiet, &batch,
-                              &libbatch, &spin, &singlebatch, &binterval );
+                              &libbatch, &spin, &singlebatch, &binterval,
+                              &inline_disp );
 
   if ( argc - currentArg < 2 ) {
     fprintf( stderr, "%s: need ping_subject and pong_subject\n", progname );
@@ -486,6 +493,12 @@ main( int argc, char ** argv )
 
   if ( reflect ) {
     /* Responder: listen on the bare ping subject, echo to pong subject. */
+    if ( inline_disp ) {
+      /* Echo straight from the I/O thread, skipping the queue hand-off;
+       * the dispatch loop below then only waits for a signal. */
+      tibrvQueue_SetInlineDispatch( TIBRV_DEFAULT_QUEUE, TIBRV_TRUE );
+      printf( "pingrv7test: inline dispatch on the I/O thread\n" );
+    }
     err = tibrvEvent_CreateListener( &listenId, TIBRV_DEFAULT_QUEUE,
                                      reflect_callback, st.transport,
                                      st.ping_subject, &st );
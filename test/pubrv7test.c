@@ -1,3 +1,5 @@
+#define _POSIX_C_SOURCE 200809L
+
 #include <stdlib.h>
 #include <stdio.h>
 #include <signal.h>
@@ -31,6 +33,40 @@ static field_spec_t g_msg_type   = { "MSG_TYPE"  , 'i', 2,    "1" },
                     g_rec_status = { "REC_STATUS", 'i', 2,    "0" },
                     g_fields[ MAX_FIELDS ];
 static int          g_field_count = 0;
+static unsigned long g_count      = 0; /* -count: publish rate test */
+static int          g_prepared    = 0; /* -prepared: use slots, not Add */
+static unsigned long g_initial    = 0; /* -initial: tibrvMsg_CreateEx size */
+static int          g_async       = 0; /* -async: TIBRV_TRANSPORT_ASYNC_BATCH */
+
+#if defined( __GLIBC__ )
+/* Count the allocator calls made while publishing, by wrapping the glibc
+ * entry points. */
+extern void * __libc_malloc( size_t sz );
+extern void * __libc_calloc( size_t n, size_t sz );
+extern void * __libc_realloc( void * p, size_t sz );
+extern void   __libc_free( void * p );
+static unsigned long g_alloc_calls = 0;
+
+void * malloc( size_t sz ) {
+  __sync_fetch_and_add( &g_alloc_calls, 1 );
+  return __libc_malloc( sz );
+}
+void * calloc( size_t n, size_t sz ) {
+  __sync_fetch_and_add( &g_alloc_calls, 1 );
+  return __libc_calloc( n, sz );
+}
+void * realloc( void * p, size_t sz ) {
+  __sync_fetch_and_add( &g_alloc_calls, 1 );
+  return __libc_realloc( p, sz );
+}
+void free( void * p ) {
+  if ( p != NULL )
+    __sync_fetch_and_add( &g_alloc_calls, 1 );
+  __libc_free( p );
+}
+#else
+static unsigned long g_alloc_calls = 0;
+#endif
 
 /* Backing storage for parsed field specs.  parse_field_spec needs a
  * mutable buffer to insert '\0' separators; we copy each argv string
@@ -43,8 +79,15 @@ usage( void )
 {
   fprintf( stderr, "pubrv7test [-service service] [-network network]\n" );
   fprintf( stderr, "           [-daemon daemon] [-field name=tz:value]...\n" );
+  fprintf( stderr, "           [-count N] [-prepared] [-initial Z] [-pool P] [-async]\n" );
   fprintf( stderr, "           subject_list\n" );
   fprintf( stderr, "\n" );
+  fprintf( stderr, "  -count N   publish N msgs to each subject and print msgs/sec\n" );
+  fprintf( stderr, "  -prepared  with -count, build the msg once and set SEQ_NO through\n" );
+  fprintf( stderr, "             a slot, instead of Create/Add/Send/Destroy each time\n" );
+  fprintf( stderr, "  -initial Z create msgs with tibrvMsg_CreateEx( Z )\n" );
+  fprintf( stderr, "  -pool P    keep P free msgs per size class (0 = no pooling)\n" );
+  fprintf( stderr, "  -async     queue sends in a ring drained by the I/O thread\n" );
   fprintf( stderr, "  -field name=tz:value  (repeatable) add a field to each published msg\n" );
   fprintf( stderr, "    t = i (signed int), u (unsigned int), s (string),\n" );
   fprintf( stderr, "        o (opaque, hex digits), f (float)\n" );
@@ -206,6 +249,104 @@ apply_default_fields( tibrvMsg msg )
   return TIBRV_OK;
 }
 
+/* Apply the default fields and the -field list. */
+static tibrv_status
+apply_all_fields( tibrvMsg msg, const char * progname )
+{
+  tibrv_status err = apply_default_fields( msg );
+  int j;
+  for ( j = 0; j < g_field_count && err == TIBRV_OK; j++ ) {
+    err = apply_field( msg, &g_fields[ j ] );
+    if ( err != TIBRV_OK ) {
+      fprintf( stderr,
+               "%s: failed to add field %s (type=%c size=%d): %s\n",
+               progname, g_fields[ j ].name, g_fields[ j ].type,
+               g_fields[ j ].size, tibrvStatus_GetText( err ) );
+    }
+  }
+  return err;
+}
+
+static double
+mono_secs( void )
+{
+  struct timespec ts;
+  clock_gettime( CLOCK_MONOTONIC, &ts );
+  return (double) ts.tv_sec + (double) ts.tv_nsec / 1e9;
+}
+
+/* Store seq in the SEQ_NO slot, whatever integer size it was declared as. */
+static tibrv_status
+set_seq( tibrvMsg msg, const tibrvMsgSlot * slot, unsigned long seq )
+{
+  tibrv_i8  i8  = (tibrv_i8) seq;
+  tibrv_i16 i16 = (tibrv_i16) seq;
+  tibrv_i32 i32 = (tibrv_i32) seq;
+  tibrv_i64 i64 = (tibrv_i64) seq;
+  switch ( slot->size ) {
+    case 1: return tibrvMsg_SetSlot( msg, slot, &i8, 1 );
+    case 2: return tibrvMsg_SetSlot( msg, slot, &i16, 2 );
+    case 4: return tibrvMsg_SetSlot( msg, slot, &i32, 4 );
+    case 8: return tibrvMsg_SetSlot( msg, slot, &i64, 8 );
+  }
+  return TIBRV_INVALID_ARG;
+}
+
+/* Publish g_count msgs to subject, either rebuilding the msg with Add for
+ * each send, or preparing it once and only updating SEQ_NO in place. */
+static tibrv_status
+publish_count( tibrvTransport transport, const char * subject,
+               const char * progname )
+{
+  tibrvMsg      msg;
+  tibrvMsgSlot  seq;
+  tibrv_status  err = TIBRV_OK;
+  unsigned long n   = 0, calls;
+  tibrv_u64     hits0, miss0, hits, miss;
+  double        start, secs, total;
+
+  tibrvMsg_GetPoolStats( &hits0, &miss0, NULL );
+  calls = g_alloc_calls;
+  start = mono_secs();
+  if ( ! g_prepared ) {
+    for ( ; n < g_count && err == TIBRV_OK; n++ ) {
+      tibrvMsg_CreateEx( &msg, (tibrv_u32) g_initial );
+      tibrvMsg_SetSendSubject( msg, subject );
+      if ( (err = apply_all_fields( msg, progname )) == TIBRV_OK )
+        err = tibrvTransport_Send( transport, msg );
+      tibrvMsg_Destroy( msg );
+    }
+  }
+  else {
+    tibrvMsg_CreateEx( &msg, (tibrv_u32) g_initial );
+    tibrvMsg_SetSendSubject( msg, subject );
+    if ( (err = apply_all_fields( msg, progname )) == TIBRV_OK )
+      err = tibrvMsg_GetSlot( msg, g_seq_no.name, 0, &seq );
+    for ( ; n < g_count && err == TIBRV_OK; n++ ) {
+      if ( (err = set_seq( msg, &seq, n )) == TIBRV_OK )
+        err = tibrvTransport_Send( transport, msg );
+    }
+    tibrvMsg_Destroy( msg );
+  }
+  secs  = mono_secs() - start;    /* time seen by the caller of Send */
+  calls = g_alloc_calls - calls;
+  tibrvTransport_Flush( transport );
+  total = mono_secs() - start;   /* until everything is published */
+  tibrvMsg_GetPoolStats( &hits, &miss, NULL );
+  hits -= hits0;
+  miss -= miss0;
+  printf( "pubrv7test: %s%s %lu msgs in %.3fs, %.0f msgs/sec, %.0f ns/send\n",
+          g_prepared ? "prepared" : "add/send", g_async ? " async" : "",
+          n, total, total > 0 ? (double) n / total : 0.0,
+          n > 0 ? secs * 1e9 / (double) n : 0.0 );
+  printf( "pubrv7test: msg pool hit rate %.1f%% (%llu/%llu), "
+          "%.2f allocator calls/msg\n",
+          hits + miss > 0 ? 100.0 * (double) hits / (double) ( hits + miss ) : 0.0,
+          (unsigned long long) hits, (unsigned long long) ( hits + miss ),
+          n > 0 ? (double) calls / (double) n : 0.0 );
+  return err;
+}
+
 int
 get_InitParms( int argc, char* argv[], int min_parms, char** serviceStr,
                char** networkStr, char** daemonStr )
@@ -228,6 +369,26 @@ get_InitParms( int argc, char* argv[], int min_parms, char** serviceStr,
       *daemonStr = argv[ i + 1 ];
       i += 2;
     }
+    else if ( strcmp( argv[ i ], "-count" ) == 0 ) {
+      g_count = strtoul( argv[ i + 1 ], NULL, 0 );
+      i += 2;
+    }
+    else if ( strcmp( argv[ i ], "-initial" ) == 0 ) {
+      g_initial = strtoul( argv[ i + 1 ], NULL, 0 );
+      i += 2;
+    }
+    else if ( strcmp( argv[ i ], "-pool" ) == 0 ) {
+      tibrvMsg_SetPoolSize( (tibrv_u32) strtoul( argv[ i + 1 ], NULL, 0 ) );
+      i += 2;
+    }
+    else if ( strcmp( argv[ i ], "-async" ) == 0 ) {
+      g_async = 1;
+      i += 1;
+    }
+    else if ( strcmp( argv[ i ], "-prepared" ) == 0 ) {
+      g_prepared = 1;
+      i += 1;
+    }
     else if ( strcmp( argv[ i ], "-field" ) == 0 ) {
       size_t n;
       field_spec_t * f;
@@ -311,6 +472,8 @@ main( int argc, char** argv )
   }
 
   tibrvTransport_SetDescription( transport, progname );
+  if ( g_async )
+    tibrvTransport_SetBatchMode( transport, TIBRV_TRANSPORT_ASYNC_BATCH );
   i = ( argc - currentArg );
   if ( i == 0 ) {
     fprintf( stderr, "%s: No subscriptions\n", progname );
@@ -320,24 +483,21 @@ main( int argc, char** argv )
   for ( i = 0; i + currentArg < argc; i++ ) {
 
     printf( "pubrv7test: Publishing to subject %s\n", argv[ i + currentArg ] );
-
-    tibrvMsg_Create( &pubMsg );
     snprintf( pubSubject, sizeof( pubSubject ), "%s", argv[ i + currentArg ] );
-    tibrvMsg_SetSendSubject( pubMsg, pubSubject );
 
-    err = apply_default_fields( pubMsg );
-    if ( err == TIBRV_OK ) {
-      int j;
-      for ( j = 0; j < g_field_count && err == TIBRV_OK; j++ ) {
-        err = apply_field( pubMsg, &g_fields[ j ] );
-        if ( err != TIBRV_OK ) {
-          fprintf( stderr,
-                   "%s: failed to add field %s (type=%c size=%d): %s\n",
-                   progname, g_fields[ j ].name, g_fields[ j ].type,
-                   g_fields[ j ].size, tibrvStatus_GetText( err ) );
-        }
+    if ( g_count > 0 ) {
+      err = publish_count( transport, pubSubject, progname );
+      if ( err != TIBRV_OK ) {
+        fprintf( stderr, "%s: Error %s publishing to \"%s\"\n", progname,
+                 tibrvStatus_GetText( err ), pubSubject );
+        exit( 2 );
       }
+      continue;
     }
+    tibrvMsg_Create( &pubMsg );
+    tibrvMsg_SetSendSubject( pubMsg, pubSubject );
+
+    err = apply_all_fields( pubMsg, progname );
     if ( err != TIBRV_OK ) {
       tibrvMsg_Destroy( pubMsg );
       exit( 2 );
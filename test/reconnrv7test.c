@@ -0,0 +1,238 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+
+#include <sassrv/rv7api.h>
+
+/*
+ * reconnrv7test -- transports reconnect after the daemon drops.
+ *
+ * The test runs its own daemon, rv_server -r P, so it can kill it.  A
+ * subscriber transport listens to RECONN.X and a publisher sends to it, both
+ * with a short reconnect interval.  Each trial:
+ *   up       : C msgs sent are all received.
+ *   down     : the daemon is killed, C msgs sent while it is down are
+ *              counted as buffered or dropped, not lost silently.
+ *   restart  : the daemon is started again, both transports count a
+ *              reconnect within the max interval and the listener is
+ *              subscribed again, so C msgs sent after are all received.
+ * The exit status is 0 when all pass.
+ */
+
+static tibrv_u32 g_recv;
+static int       g_fail;
+
+static tibrv_u64
+mono_ns( void )
+{
+  struct timespec ts;
+  clock_gettime( CLOCK_MONOTONIC, &ts );
+  return (tibrv_u64) ts.tv_sec * 1000000000ULL + (tibrv_u64) ts.tv_nsec;
+}
+
+static void
+sleep_ms( long ms )
+{
+  struct timespec r;
+  r.tv_sec  = ms / 1000;
+  r.tv_nsec = ( ms % 1000 ) * 1000000L;
+  nanosleep( &r, NULL );
+}
+
+static void
+on_msg( tibrvEvent ev,  tibrvMsg msg,  void *cl )
+{
+  (void) ev; (void) msg; (void) cl;
+  g_recv++;
+}
+
+static pid_t
+start_server( const char *server,  const char *port )
+{
+  pid_t pid = fork();
+  if ( pid == 0 ) {
+    execlp( server, server, "-r", port, (char *) NULL );
+    _exit( 1 );
+  }
+  sleep_ms( 500 ); /* listening */
+  return pid;
+}
+
+static void
+stop_server( pid_t pid )
+{
+  if ( pid > 0 ) {
+    kill( pid, SIGKILL );
+    waitpid( pid, NULL, 0 );
+  }
+}
+
+static void
+publish( tibrvTransport tport,  tibrv_u32 count )
+{
+  tibrvMsg  msg;
+  tibrv_u32 k;
+  tibrvMsg_Create( &msg );
+  tibrvMsg_SetSendSubject( msg, "RECONN.X" );
+  for ( k = 0; k < count; k++ ) {
+    tibrvMsg_UpdateU32( msg, "seq", k );
+    tibrvTransport_Send( tport, msg );
+  }
+  tibrvMsg_Destroy( msg );
+}
+
+/* dispatch q until want msgs are received or secs passed */
+static void
+check_recv( tibrvQueue q,  const char *step,  tibrv_u32 t,  tibrv_u32 want,
+            double secs )
+{
+  tibrv_u64 end = mono_ns() + (tibrv_u64) ( secs * 1e9 );
+  while ( g_recv < want && mono_ns() < end )
+    tibrvQueue_TimedDispatch( q, 0.01 );
+  if ( g_recv != want ) {
+    printf( "%s %u: received %u, not %u: FAIL\n", step, t, g_recv, want );
+    g_fail++;
+  }
+}
+
+static tibrv_u64
+reconnects( tibrvTransport tport )
+{
+  tibrvTransportStats st;
+  memset( &st, 0, sizeof( st ) );
+  tibrvTransport_GetStats( tport, &st );
+  return st.reconnects;
+}
+
+static void
+usage( void )
+{
+  fprintf( stderr,
+    "reconnrv7test [-server S] [-port P] [-count C] [-trials T] [-down MS]\n"
+    "\n"
+    "  -server S    daemon program run with -r P (default rv_server)\n"
+    "  -port P      daemon port (default 7599)\n"
+    "  -count C     msgs sent in each step (default 100)\n"
+    "  -trials T    times the daemon is killed (default 3)\n"
+    "  -down MS     time the daemon is down (default 500)\n" );
+  exit( 1 );
+}
+
+int
+main( int argc, char **argv )
+{
+  const char        * server = "rv_server",
+                    * port   = "7599";
+  char                daemon[ 64 ];
+  tibrvTransport      sub, pub;
+  tibrvQueue          q;
+  tibrvEvent          ev;
+  tibrvTransportStats st;
+  tibrv_status        err;
+  tibrv_u32           count = 100, trials = 3, t;
+  tibrv_u64           r_sub, r_pub, end, down_msgs;
+  long                down = 500;
+  pid_t               pid;
+  int                 i = 1;
+
+  while ( i < argc && *argv[ i ] == '-' ) {
+    if ( strcmp( argv[ i ], "-server" ) == 0 && i + 1 < argc ) {
+      server = argv[ ++i ];
+    } else if ( strcmp( argv[ i ], "-port" ) == 0 && i + 1 < argc ) {
+      port = argv[ ++i ];
+    } else if ( strcmp( argv[ i ], "-count" ) == 0 && i + 1 < argc ) {
+      count = (tibrv_u32) strtoul( argv[ ++i ], NULL, 10 );
+    } else if ( strcmp( argv[ i ], "-trials" ) == 0 && i + 1 < argc ) {
+      trials = (tibrv_u32) strtoul( argv[ ++i ], NULL, 10 );
+    } else if ( strcmp( argv[ i ], "-down" ) == 0 && i + 1 < argc ) {
+      down = strtol( argv[ ++i ], NULL, 10 );
+    } else {
+      usage();
+    }
+    i++;
+  }
+  if ( i < argc || count == 0 || trials == 0 || down < 0 )
+    usage();
+  snprintf( daemon, sizeof( daemon ), "tcp:%s", port );
+
+  pid = start_server( server, port );
+  if ( (err = tibrv_Open()) != TIBRV_OK ||
+       (err = tibrvTransport_Create( &sub, NULL, NULL, daemon )) != TIBRV_OK ||
+       (err = tibrvTransport_Create( &pub, NULL, NULL, daemon )) != TIBRV_OK ) {
+    fprintf( stderr, "reconnrv7test: %s %s: %s\n", server, daemon,
+             tibrvStatus_GetText( err ) );
+    stop_server( pid );
+    return 1;
+  }
+  tibrvTransport_SetReconnect( sub, 0.1, 1.0, 1024 * 1024 );
+  tibrvTransport_SetReconnect( pub, 0.1, 1.0, 1024 * 1024 );
+  tibrvQueue_Create( &q );
+  tibrvEvent_CreateListener( &ev, q, on_msg, sub, "RECONN.X", NULL );
+  sleep_ms( 500 ); /* the listener reaches the daemon */
+
+  for ( t = 0; t < trials; t++ ) {
+    /* up */
+    g_recv = 0;
+    publish( pub, count );
+    check_recv( q, "up", t, count, 2.0 );
+
+    /* down */
+    r_sub = reconnects( sub );
+    r_pub = reconnects( pub );
+    stop_server( pid );
+    sleep_ms( 100 ); /* the transports see the close */
+    memset( &st, 0, sizeof( st ) );
+    tibrvTransport_GetStats( pub, &st );
+    down_msgs = st.msgs_buffered + st.msgs_dropped;
+    publish( pub, count );
+    end = mono_ns() + 1000000000ULL; /* the sends reach the I/O thread */
+    do {
+      sleep_ms( 10 );
+      tibrvTransport_GetStats( pub, &st );
+    } while ( st.msgs_buffered + st.msgs_dropped < down_msgs + count &&
+              mono_ns() < end );
+    if ( st.msgs_buffered + st.msgs_dropped != down_msgs + count ) {
+      printf( "down %u: buffered %lu dropped %lu of %u: FAIL\n", t,
+              (unsigned long) ( st.msgs_buffered + st.msgs_dropped -
+                                down_msgs ),
+              (unsigned long) st.msgs_dropped, count );
+      g_fail++;
+    }
+    sleep_ms( down );
+
+    /* restart */
+    pid = start_server( server, port );
+    end = mono_ns() + 5000000000ULL;
+    while ( ( reconnects( sub ) == r_sub || reconnects( pub ) == r_pub ) &&
+            mono_ns() < end )
+      tibrvQueue_TimedDispatch( q, 0.01 );
+    if ( reconnects( sub ) == r_sub || reconnects( pub ) == r_pub ) {
+      printf( "restart %u: no reconnect: FAIL\n", t );
+      g_fail++;
+      continue;
+    }
+    sleep_ms( 200 ); /* resubscribed, replayed msgs delivered */
+    while ( tibrvQueue_TimedDispatch( q, 0.01 ) == TIBRV_OK )
+      ;
+    g_recv = 0;
+    publish( pub, count );
+    check_recv( q, "restart", t, count, 2.0 );
+    printf( "trial %u: %s\n", t, g_fail == 0 ? "ok" : "FAIL" );
+  }
+
+  tibrvEvent_DestroyEx( ev, NULL );
+  tibrvQueue_DestroyEx( q, NULL, NULL );
+  tibrvTransport_Destroy( pub );
+  tibrvTransport_Destroy( sub );
+  tibrv_Close();
+  stop_server( pid );
+  return g_fail != 0;
+}
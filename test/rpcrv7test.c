@@ -0,0 +1,221 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+
+#include <sassrv/rv7api.h>
+
+/*
+ * rpcrv7test -- tibrvTransport_SendRequestAsync() cases.
+ *
+ * A listener on RPC.ECHO replies with the "seq" of the request.
+ *   reply    : a request to RPC.ECHO is answered, the callback gets the
+ *              reply with the same seq before the timeout.
+ *   timeout  : a request to RPC.NONE is not answered, the callback gets a
+ *              NULL msg after the timeout and not before it.
+ *   destroy  : a request to RPC.NONE is pending when its transport is
+ *              destroyed, the callback is dropped and never runs.
+ * Each case is repeated -count times, the exit status is 0 when all pass.
+ */
+
+typedef struct {
+  tibrv_u32 calls,     /* callbacks run */
+            replies,   /* with a msg */
+            seq;       /* seq of the last reply */
+  tibrv_u64 cb_ns;     /* when the last callback ran */
+} rpc_state_t;
+
+static double g_timeout = 0.25;
+
+static tibrv_u64
+mono_ns( void )
+{
+  struct timespec ts;
+  clock_gettime( CLOCK_MONOTONIC, &ts );
+  return (tibrv_u64) ts.tv_sec * 1000000000ULL + (tibrv_u64) ts.tv_nsec;
+}
+
+static void
+on_echo( tibrvEvent ev,  tibrvMsg msg,  void *cl )
+{
+  tibrvTransport tport = (tibrvTransport) (uintptr_t) cl;
+  tibrvMsg       reply;
+  tibrv_u32      seq = 0;
+  (void) ev;
+  tibrvMsg_GetU32( msg, "seq", &seq );
+  tibrvMsg_Create( &reply );
+  tibrvMsg_UpdateU32( reply, "seq", seq );
+  tibrvTransport_SendReply( tport, reply, msg );
+  tibrvMsg_Destroy( reply );
+}
+
+static void
+on_reply( tibrvEvent ev,  tibrvMsg msg,  void *cl )
+{
+  rpc_state_t * st = (rpc_state_t *) cl;
+  (void) ev;
+  st->calls++;
+  st->cb_ns = mono_ns();
+  if ( msg != NULL ) {
+    st->replies++;
+    tibrvMsg_GetU32( msg, "seq", &st->seq );
+  }
+}
+
+/* dispatch q until the callback ran or secs passed */
+static void
+wait_cb( tibrvQueue q,  rpc_state_t *st,  double secs )
+{
+  tibrv_u64 end = mono_ns() + (tibrv_u64) ( secs * 1e9 );
+  while ( st->calls == 0 && mono_ns() < end )
+    tibrvQueue_TimedDispatch( q, 0.01 );
+}
+
+static int
+request( tibrvTransport tport,  tibrvQueue q,  const char *subj,
+         tibrv_u32 seq,  rpc_state_t *st )
+{
+  tibrvMsg     msg;
+  tibrv_status err;
+  memset( st, 0, sizeof( *st ) );
+  tibrvMsg_Create( &msg );
+  tibrvMsg_SetSendSubject( msg, subj );
+  tibrvMsg_UpdateU32( msg, "seq", seq );
+  err = tibrvTransport_SendRequestAsync( tport, msg, on_reply, q, g_timeout,
+                                         st );
+  tibrvMsg_Destroy( msg );
+  if ( err != TIBRV_OK ) {
+    fprintf( stderr, "rpcrv7test: SendRequestAsync %s: %s\n", subj,
+             tibrvStatus_GetText( err ) );
+    return -1;
+  }
+  return 0;
+}
+
+static int
+test_reply( tibrvTransport tport,  tibrvQueue q,  tibrv_u32 seq )
+{
+  rpc_state_t st;
+  if ( request( tport, q, "RPC.ECHO", seq, &st ) != 0 )
+    return 1;
+  wait_cb( q, &st, g_timeout * 4 );
+  if ( st.calls != 1 || st.replies != 1 || st.seq != seq ) {
+    printf( "reply %u: calls %u replies %u seq %u: FAIL\n", seq, st.calls,
+            st.replies, st.seq );
+    return 1;
+  }
+  return 0;
+}
+
+static int
+test_timeout( tibrvTransport tport,  tibrvQueue q,  tibrv_u32 seq )
+{
+  rpc_state_t st;
+  tibrv_u64   start = mono_ns();
+  double      secs;
+  if ( request( tport, q, "RPC.NONE", seq, &st ) != 0 )
+    return 1;
+  wait_cb( q, &st, g_timeout * 4 );
+  secs = (double) ( st.cb_ns - start ) / 1e9;
+  if ( st.calls != 1 || st.replies != 0 || secs < g_timeout * 0.9 ) {
+    printf( "timeout %u: calls %u replies %u after %.3f secs: FAIL\n", seq,
+            st.calls, st.replies, st.calls != 0 ? secs : 0.0 );
+    return 1;
+  }
+  return 0;
+}
+
+static int
+test_destroy( const char *daemon,  tibrvQueue q,  tibrv_u32 seq )
+{
+  tibrvTransport tport;
+  tibrv_status   err;
+  rpc_state_t    st;
+  if ( (err = tibrvTransport_Create( &tport, NULL, NULL, daemon )) != TIBRV_OK ) {
+    fprintf( stderr, "rpcrv7test: %s: %s\n", daemon,
+             tibrvStatus_GetText( err ) );
+    return 1;
+  }
+  if ( request( tport, q, "RPC.NONE", seq, &st ) != 0 )
+    return 1;
+  tibrvTransport_Destroy( tport );
+  wait_cb( q, &st, g_timeout * 2 ); /* past the timeout */
+  if ( st.calls != 0 ) {
+    printf( "destroy %u: calls %u after destroy: FAIL\n", seq, st.calls );
+    return 1;
+  }
+  return 0;
+}
+
+static void
+usage( void )
+{
+  fprintf( stderr,
+    "rpcrv7test [-daemon D] [-count C] [-timeout T]\n"
+    "\n"
+    "  -daemon D    daemon to connect (default tcp:7500)\n"
+    "  -count C     times each case runs (default 10)\n"
+    "  -timeout T   request timeout in seconds (default 0.25)\n" );
+  exit( 1 );
+}
+
+int
+main( int argc, char **argv )
+{
+  const char   * daemon = "tcp:7500";
+  tibrvTransport tport;
+  tibrvQueue     q, eq;
+  tibrvEvent     echo;
+  tibrv_status   err;
+  tibrv_u32      count = 10, k, fail[ 3 ] = { 0, 0, 0 };
+  int            i = 1;
+
+  while ( i < argc && *argv[ i ] == '-' ) {
+    if ( strcmp( argv[ i ], "-daemon" ) == 0 && i + 1 < argc ) {
+      daemon = argv[ ++i ];
+    } else if ( strcmp( argv[ i ], "-count" ) == 0 && i + 1 < argc ) {
+      count = (tibrv_u32) strtoul( argv[ ++i ], NULL, 10 );
+    } else if ( strcmp( argv[ i ], "-timeout" ) == 0 && i + 1 < argc ) {
+      g_timeout = strtod( argv[ ++i ], NULL );
+    } else {
+      usage();
+    }
+    i++;
+  }
+  if ( i < argc || count == 0 || g_timeout <= 0 )
+    usage();
+
+  if ( (err = tibrv_Open()) != TIBRV_OK ||
+       (err = tibrvTransport_Create( &tport, NULL, NULL, daemon )) != TIBRV_OK ) {
+    fprintf( stderr, "rpcrv7test: %s: %s\n", daemon,
+             tibrvStatus_GetText( err ) );
+    return 1;
+  }
+  tibrvQueue_Create( &q );
+  tibrvQueue_Create( &eq ); /* replies from the I/O thread */
+  tibrvQueue_SetInlineDispatch( eq, TIBRV_TRUE );
+  tibrvEvent_CreateListener( &echo, eq, on_echo, tport, "RPC.ECHO",
+                             (const void *) (uintptr_t) tport );
+  {
+    struct timespec r = { 0, 500000000L }; /* the listener reaches the daemon */
+    nanosleep( &r, NULL );
+  }
+  for ( k = 0; k < count; k++ ) {
+    fail[ 0 ] += test_reply( tport, q, k );
+    fail[ 1 ] += test_timeout( tport, q, k );
+    fail[ 2 ] += test_destroy( daemon, q, k );
+  }
+  printf( "reply   %u of %u ok\n", count - fail[ 0 ], count );
+  printf( "timeout %u of %u ok\n", count - fail[ 1 ], count );
+  printf( "destroy %u of %u ok\n", count - fail[ 2 ], count );
+
+  tibrvEvent_DestroyEx( echo, NULL );
+  tibrvQueue_DestroyEx( eq, NULL, NULL );
+  tibrvQueue_DestroyEx( q, NULL, NULL );
+  tibrvTransport_Destroy( tport );
+  tibrv_Close();
+  return ( fail[ 0 ] | fail[ 1 ] | fail[ 2 ] ) != 0;
+}
@@ -15,10 +15,36 @@ onMessage( rv_Listener listener, rv_Name subject, rv_Name reply,
           reply ? reply : "None" );
 }
 
+// Callback function for the msgs of one poll, with -vector
+void
+onVector( rv_Listener listener, rv_Message *vec, size_t count, void *cl )
+{
+  size_t i;
+  printf( "Vector of %u msgs\n", (unsigned) count );
+  for ( i = 0; i < count; i++ )
+    printf( "  Send Subject: %s, Reply Subject: %s\n", vec[ i ].subject,
+            vec[ i ].reply ? vec[ i ].reply : "None" );
+}
+
+static const char * batch_subject; /* with -batch, sent by the timer */
+
 void
 timerCallback( rv_Timer timer, void* closure )
 {
+  rv_Session session = (rv_Session) closure;
+  static char data[] = "batched";
+  rv_Status status = RV_OK;
+  int i;
   printf( "Timer callback\n" );
+  if ( batch_subject == NULL )
+    return;
+  // Three sends stay in the batch until the flush
+  for ( i = 0; i < 3 && status == RV_OK; i++ )
+    status = rv_Send( session, batch_subject, RVMSG_OPAQUE, sizeof( data ),
+                      data );
+  if ( status == RV_OK )
+    status = rv_Flush( session );
+  printf( "Batch send and flush: %s\n", rv_ErrorText( session, status ) );
 }
 
 void
@@ -37,7 +63,8 @@ main( int argc, const char *argv[] )
   rv_Listener * listener;
   const char  * service = NULL, * network = NULL, * daemon = NULL,
              ** subject = NULL;
-  int count = 0, i;
+  int count = 0, i, vector = 0;
+  size_t batch = 0;
 
   for ( i = 1; i < argc && *argv[ i ] == '-'; ) {
     if ( strcmp( argv[ i ], "-service" ) == 0 ) {
@@ -52,6 +79,14 @@ main( int argc, const char *argv[] )
       daemon = argv[ i + 1 ];
       i += 2;
     }
+    else if ( strcmp( argv[ i ], "-vector" ) == 0 ) {
+      vector = 1;
+      i += 1;
+    }
+    else if ( strcmp( argv[ i ], "-batch" ) == 0 ) {
+      batch = (size_t) atoi( argv[ i + 1 ] );
+      i += 2;
+    }
     else if ( strcmp( argv[ i ], "-subject" ) == 0 ) {
       subject = &argv[ i + 1 ];
       count = argc - ( i + 1 );
@@ -76,17 +111,32 @@ main( int argc, const char *argv[] )
   }
   listener = (rv_Listener *) calloc( count, sizeof( rv_Listener ) );
   for ( i = 0; i < count; i++ ) {
-    status = rv_ListenSubject( session, &listener[ i ], subject[ i ], onMessage,
-                               NULL, NULL );
+    if ( vector )
+      status = rv_ListenSubjectVector( session, &listener[ i ], subject[ i ],
+                                       onVector, NULL, NULL );
+    else
+      status = rv_ListenSubject( session, &listener[ i ], subject[ i ],
+                                 onMessage, NULL, NULL );
   }
   if ( status != RV_OK ) {
     fprintf( stderr, "Error creating listener: %s\n", rv_ErrorText( NULL, status ) );
     rv_Term( session );
     exit( 1 );
   }
+  if ( batch > 0 ) {
+    // Batch the timer's sends to the first subject, the listener gets them
+    status = rv_SetSendBatch( session, batch, 0 );
+    if ( status != RV_OK ) {
+      fprintf( stderr, "Error setting send batch: %s\n",
+               rv_ErrorText( NULL, status ) );
+      rv_Term( session );
+      exit( 1 );
+    }
+    batch_subject = subject[ 0 ];
+  }
   rv_Timer timer;
   rv_Signal shandle;
-  rv_CreateTimer( session, &timer, 5 * 1000, timerCallback, NULL );
+  rv_CreateTimer( session, &timer, 5 * 1000, timerCallback, session );
   rv_CreateSignal( session, &shandle, SIGINT, signalCallback, session );
   // Start the main event loop
   rv_MainLoop( session );
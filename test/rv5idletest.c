@@ -0,0 +1,189 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include <signal.h>
+#include <time.h>
+#include <pthread.h>
+
+#include <rv5api.h>
+
+/*
+ * rv5idletest -- rv_MainLoop idle strategy test.
+ *
+ * Runs rv_MainLoop on a null daemon session with one idle strategy for D
+ * seconds.  A thread signals the loop every P milliseconds after it went
+ * idle and a timer of the same period runs, the test reports how long the
+ * signal callback took to run after the signal was sent, how late the timer
+ * callbacks ran and the cpu used by the process against the wall clock.
+ */
+
+static rv_Session        g_session;
+static pthread_t         g_main;
+static volatile uint64_t g_sent = 0;   /* ns the signal was sent, 0 = done */
+static volatile int      g_done = 0;
+static uint64_t          g_ival_ns,
+                         g_due,
+                         g_sig_cnt = 0, g_sig_sum = 0, g_sig_max = 0,
+                         g_tmr_cnt = 0, g_tmr_sum = 0, g_tmr_max = 0;
+
+static uint64_t
+clock_ns( clockid_t id )
+{
+  struct timespec ts;
+  clock_gettime( id, &ts );
+  return (uint64_t) ts.tv_sec * 1000000000ULL + (uint64_t) ts.tv_nsec;
+}
+
+static void
+on_signal( rv_Signal sig, void *cl )
+{
+  uint64_t now = clock_ns( CLOCK_MONOTONIC ), d;
+  (void) sig; (void) cl;
+  if ( g_sent == 0 )
+    return;
+  d = now - g_sent;
+  g_sig_sum += d;
+  if ( d > g_sig_max )
+    g_sig_max = d;
+  g_sig_cnt++;
+  g_sent = 0;
+}
+
+static void
+on_stop( rv_Signal sig, void *cl )
+{
+  (void) sig; (void) cl;
+  rv_Term( g_session );
+}
+
+static void
+on_timer( rv_Timer timer, void *cl )
+{
+  uint64_t now = clock_ns( CLOCK_MONOTONIC );
+  (void) timer; (void) cl;
+  if ( now > g_due ) {
+    uint64_t d = now - g_due;
+    g_tmr_sum += d;
+    if ( d > g_tmr_max )
+      g_tmr_max = d;
+  }
+  g_due = now + g_ival_ns;
+  g_tmr_cnt++;
+}
+
+static void *
+sender( void *arg )
+{
+  uint64_t end = *(uint64_t *) arg;
+  struct timespec r;
+  r.tv_sec  = (time_t) ( g_ival_ns / 1000000000ULL );
+  r.tv_nsec = (long) ( g_ival_ns % 1000000000ULL );
+  while ( clock_ns( CLOCK_MONOTONIC ) < end ) {
+    nanosleep( &r, NULL ); /* the loop is idle by now */
+    if ( g_sent == 0 ) {
+      g_sent = clock_ns( CLOCK_MONOTONIC );
+      pthread_kill( g_main, SIGUSR1 );
+    }
+  }
+  g_done = 1;
+  pthread_kill( g_main, SIGUSR2 );
+  return NULL;
+}
+
+static void
+usage( void )
+{
+  fprintf( stderr,
+    "rv5idletest [-idle sleep|spin|yield|block] [-spin N] [-secs D]"
+    " [-ival P]\n"
+    "\n"
+    "  -idle S   idle strategy (default sleep)\n"
+    "  -spin N   idle polls before the strategy applies (default 255)\n"
+    "  -secs D   seconds to run (default 5)\n"
+    "  -ival P   milliseconds between signals and timers (default 10)\n" );
+  exit( 1 );
+}
+
+int
+main( int argc, char **argv )
+{
+  const char    * idle = "sleep";
+  rv_IdleStrategy strategy;
+  rv_Signal       s1, s2;
+  rv_Timer        timer;
+  pthread_t       thr;
+  sigset_t        set;
+  unsigned long   spin = 255, secs = 5, ival = 10;
+  uint64_t        start, cpu, end;
+  double          wall;
+  int             i = 1;
+
+  while ( i < argc && *argv[ i ] == '-' ) {
+    if ( strcmp( argv[ i ], "-idle" ) == 0 && i + 1 < argc ) {
+      idle = argv[ ++i ];
+    } else if ( strcmp( argv[ i ], "-spin" ) == 0 && i + 1 < argc ) {
+      spin = strtoul( argv[ ++i ], NULL, 10 );
+    } else if ( strcmp( argv[ i ], "-secs" ) == 0 && i + 1 < argc ) {
+      secs = strtoul( argv[ ++i ], NULL, 10 );
+    } else if ( strcmp( argv[ i ], "-ival" ) == 0 && i + 1 < argc ) {
+      ival = strtoul( argv[ ++i ], NULL, 10 );
+    } else {
+      usage();
+    }
+    i++;
+  }
+  if ( i < argc )
+    usage();
+  if ( strcmp( idle, "sleep" ) == 0 )
+    strategy = RV_IDLE_SLEEP;
+  else if ( strcmp( idle, "spin" ) == 0 )
+    strategy = RV_IDLE_SPIN;
+  else if ( strcmp( idle, "yield" ) == 0 )
+    strategy = RV_IDLE_YIELD;
+  else if ( strcmp( idle, "block" ) == 0 )
+    strategy = RV_IDLE_BLOCK;
+  else
+    usage();
+  if ( ival == 0 || secs == 0 )
+    usage();
+  g_ival_ns = (uint64_t) ival * 1000000ULL;
+
+  if ( rv_Init( &g_session, NULL, NULL, "null" ) != RV_OK ) {
+    fprintf( stderr, "rv5idletest: rv_Init failed\n" );
+    return 1;
+  }
+  rv_SetIdleStrategy( g_session, strategy, (unsigned int) spin );
+  rv_CreateSignal( g_session, &s1, SIGUSR1, on_signal, NULL );
+  rv_CreateSignal( g_session, &s2, SIGUSR2, on_stop, NULL );
+  g_main = pthread_self();
+
+  start = clock_ns( CLOCK_MONOTONIC );
+  cpu   = clock_ns( CLOCK_PROCESS_CPUTIME_ID );
+  end   = start + (uint64_t) secs * 1000000000ULL;
+  g_due = start + g_ival_ns;
+  rv_CreateTimer( g_session, &timer, (float) ival, on_timer, NULL );
+
+  sigemptyset( &set ); /* the signals go to the loop thread */
+  sigaddset( &set, SIGUSR1 );
+  sigaddset( &set, SIGUSR2 );
+  pthread_sigmask( SIG_BLOCK, &set, NULL );
+  pthread_create( &thr, NULL, sender, &end );
+  pthread_sigmask( SIG_UNBLOCK, &set, NULL );
+
+  rv_MainLoop( g_session );
+  pthread_join( thr, NULL );
+
+  wall = (double) ( clock_ns( CLOCK_MONOTONIC ) - start );
+  cpu  = clock_ns( CLOCK_PROCESS_CPUTIME_ID ) - cpu;
+  printf( "idle=%s spin=%lu: cpu %.1f%%, signal wakeup avg %.1fus max %.1fus"
+          " (%llu), timer late avg %.1fus max %.1fus (%llu)\n",
+          idle, spin, (double) cpu * 100.0 / wall,
+          g_sig_cnt ? (double) g_sig_sum / (double) g_sig_cnt / 1e3 : 0.0,
+          (double) g_sig_max / 1e3, (unsigned long long) g_sig_cnt,
+          g_tmr_cnt ? (double) g_tmr_sum / (double) g_tmr_cnt / 1e3 : 0.0,
+          (double) g_tmr_max / 1e3, (unsigned long long) g_tmr_cnt );
+  return g_done ? 0 : 1;
+}
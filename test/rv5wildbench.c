@@ -0,0 +1,142 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+
+#include <rv5api.h>
+
+/*
+ * rv5wildbench -- wildcard listener match benchmark.
+ *
+ * Creates W wildcard listeners on shapes BENCH.S<i>.*, BENCH.S<i>.> and
+ * BENCH.*.T<i>, then publishes C messages round-robin over the subjects
+ * BENCH.S<i>.T<i> through the daemon, B per timer tick.  Each subject matches
+ * up to 3 listeners, the bench reports the deliveries per second from the
+ * first receive until all are in.
+ */
+
+static rv_Session        g_session;
+static unsigned long     g_wild = 3000, g_count = 100000, g_burst = 1000,
+                         g_subjects, g_sent = 0;
+static volatile uint64_t g_recv = 0;
+static uint64_t          g_expect = 0, g_first = 0;
+
+static uint64_t
+mono_ns( void )
+{
+  struct timespec ts;
+  clock_gettime( CLOCK_MONOTONIC, &ts );
+  return (uint64_t) ts.tv_sec * 1000000000ULL + (uint64_t) ts.tv_nsec;
+}
+
+/* listeners matching BENCH.S<i>.T<i> */
+static unsigned long
+match_count( unsigned long i )
+{
+  unsigned long n = 0;
+  if ( i * 3 < g_wild )     n++; /* BENCH.S<i>.* */
+  if ( i * 3 + 1 < g_wild ) n++; /* BENCH.S<i>.> */
+  if ( i * 3 + 2 < g_wild ) n++; /* BENCH.*.T<i> */
+  return n;
+}
+
+static void
+on_msg( rv_Listener listener, rv_Name subject, rv_Name reply,
+        rvmsg_Type type, size_t data_len, void *data, void *cl )
+{
+  (void) listener; (void) subject; (void) reply; (void) type;
+  (void) data_len; (void) data; (void) cl;
+  if ( g_recv++ == 0 )
+    g_first = mono_ns();
+  if ( g_recv == g_expect )
+    rv_Term( g_session );
+}
+
+static void
+on_timer( rv_Timer timer, void *cl )
+{
+  char          subj[ 64 ];
+  unsigned long n;
+  (void) cl;
+  for ( n = 0; n < g_burst && g_sent < g_count; n++, g_sent++ ) {
+    unsigned long i = g_sent % g_subjects;
+    snprintf( subj, sizeof( subj ), "BENCH.S%lu.T%lu", i, i );
+    rv_Send( g_session, subj, RVMSG_OPAQUE, 8, &g_sent );
+  }
+  if ( g_sent == g_count )
+    rv_DestroyTimer( timer );
+}
+
+static void
+usage( void )
+{
+  fprintf( stderr,
+    "rv5wildbench [-daemon D] [-wild W] [-count C] [-burst B]\n"
+    "\n"
+    "  -daemon D  daemon to connect (default tcp:7500)\n"
+    "  -wild W    wildcard listeners (default 3000)\n"
+    "  -count C   messages to publish (default 100000)\n"
+    "  -burst B   messages published per 1ms timer tick (default 1000)\n" );
+  exit( 1 );
+}
+
+int
+main( int argc, char **argv )
+{
+  const char  * daemon = "tcp:7500";
+  char          subj[ 64 ];
+  rv_Listener   l;
+  rv_Timer      timer;
+  unsigned long i;
+  double        secs;
+  int           j = 1;
+
+  while ( j < argc && *argv[ j ] == '-' ) {
+    if ( strcmp( argv[ j ], "-daemon" ) == 0 && j + 1 < argc ) {
+      daemon = argv[ ++j ];
+    } else if ( strcmp( argv[ j ], "-wild" ) == 0 && j + 1 < argc ) {
+      g_wild = strtoul( argv[ ++j ], NULL, 10 );
+    } else if ( strcmp( argv[ j ], "-count" ) == 0 && j + 1 < argc ) {
+      g_count = strtoul( argv[ ++j ], NULL, 10 );
+    } else if ( strcmp( argv[ j ], "-burst" ) == 0 && j + 1 < argc ) {
+      g_burst = strtoul( argv[ ++j ], NULL, 10 );
+    } else {
+      usage();
+    }
+    j++;
+  }
+  if ( j < argc || g_wild == 0 || g_count == 0 || g_burst == 0 )
+    usage();
+  g_subjects = ( g_wild + 2 ) / 3;
+  for ( i = 0; i < g_count; i++ )
+    g_expect += match_count( i % g_subjects );
+
+  if ( rv_Init( &g_session, NULL, NULL, daemon ) != RV_OK ) {
+    fprintf( stderr, "rv5wildbench: rv_Init %s failed\n", daemon );
+    return 1;
+  }
+  for ( i = 0; i < g_wild; i++ ) {
+    unsigned long k = i / 3;
+    switch ( i % 3 ) {
+      case 0:  snprintf( subj, sizeof( subj ), "BENCH.S%lu.*", k ); break;
+      case 1:  snprintf( subj, sizeof( subj ), "BENCH.S%lu.>", k ); break;
+      default: snprintf( subj, sizeof( subj ), "BENCH.*.T%lu", k ); break;
+    }
+    rv_ListenSubject( g_session, &l, subj, on_msg, NULL, NULL );
+  }
+  printf( "rv5wildbench: wild=%lu subjects=%lu count=%lu expect=%llu\n",
+          g_wild, g_subjects, g_count, (unsigned long long) g_expect );
+  fflush( stdout );
+
+  rv_CreateTimer( g_session, &timer, 1.0f, on_timer, NULL );
+  rv_MainLoop( g_session );
+
+  secs = (double) ( mono_ns() - g_first ) / 1e9;
+  printf( "received %llu of %llu in %.3fs, %.0f deliveries/sec\n",
+          (unsigned long long) g_recv, (unsigned long long) g_expect,
+          secs, secs > 0 ? (double) g_recv / secs : 0.0 );
+  return g_recv == g_expect ? 0 : 1;
+}
@@ -0,0 +1,206 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+
+#include <sassrv/rv7api.h>
+
+/*
+ * sharerv7test -- two transports sharing one daemon connection.
+ *
+ * With tibrv_SetTransportSharing( TIBRV_TRUE ), transports A and B are
+ * created on the same daemon, A first, so B attaches to A's connection.  A
+ * third transport P is created after sharing is turned off and publishes.
+ *   both     : A and B listen to SHARE.ALL, A to SHARE.A, B to SHARE.B, and
+ *              each has an inbox, every msg reaches only its listeners.
+ *   destroy  : A is destroyed with its listeners still in place, B still
+ *              gets SHARE.ALL, SHARE.B and its inbox, A's get nothing.
+ *   rejoin   : C is created sharing after A is gone and gets SHARE.ALL.
+ * The exit status is 0 when all pass.
+ */
+
+enum { A_ALL, A_ONE, A_INBOX, B_ALL, B_ONE, B_INBOX, C_ALL, NUM_CNT };
+
+static const char * cnt_name[ NUM_CNT ] =
+  { "A all", "A one", "A inbox", "B all", "B one", "B inbox", "C all" };
+static tibrv_u32 g_cnt[ NUM_CNT ];
+static int       g_fail;
+
+static tibrv_u64
+mono_ns( void )
+{
+  struct timespec ts;
+  clock_gettime( CLOCK_MONOTONIC, &ts );
+  return (tibrv_u64) ts.tv_sec * 1000000000ULL + (tibrv_u64) ts.tv_nsec;
+}
+
+static void
+sleep_ms( long ms )
+{
+  struct timespec r;
+  r.tv_sec  = ms / 1000;
+  r.tv_nsec = ( ms % 1000 ) * 1000000L;
+  nanosleep( &r, NULL );
+}
+
+static void
+on_msg( tibrvEvent ev,  tibrvMsg msg,  void *cl )
+{
+  (void) ev; (void) msg;
+  g_cnt[ (uintptr_t) cl ]++;
+}
+
+static void
+publish( tibrvTransport tport,  const char *subj,  tibrv_u32 count )
+{
+  tibrvMsg  msg;
+  tibrv_u32 k;
+  tibrvMsg_Create( &msg );
+  tibrvMsg_SetSendSubject( msg, subj );
+  for ( k = 0; k < count; k++ ) {
+    tibrvMsg_UpdateU32( msg, "seq", k );
+    tibrvTransport_Send( tport, msg );
+  }
+  tibrvMsg_Destroy( msg );
+}
+
+/* dispatch q until the counts match want or 2 seconds passed, then a little
+ * longer to catch extra msgs */
+static void
+check( tibrvQueue q,  const char *step,  const tibrv_u32 *want )
+{
+  tibrv_u64 end = mono_ns() + 2000000000ULL;
+  int       i, done = 0, fail = g_fail;
+  while ( ! done && mono_ns() < end ) {
+    tibrvQueue_TimedDispatch( q, 0.01 );
+    for ( done = 1, i = 0; i < NUM_CNT; i++ )
+      if ( g_cnt[ i ] < want[ i ] )
+        done = 0;
+  }
+  for ( i = 0; i < 10; i++ )
+    tibrvQueue_TimedDispatch( q, 0.01 );
+  for ( i = 0; i < NUM_CNT; i++ ) {
+    if ( g_cnt[ i ] != want[ i ] ) {
+      printf( "%s: %s got %u, not %u: FAIL\n", step, cnt_name[ i ],
+              g_cnt[ i ], want[ i ] );
+      g_fail++;
+    }
+  }
+  printf( "%s: %s\n", step, g_fail == fail ? "ok" : "FAIL" );
+}
+
+static tibrv_status
+add_listener( tibrvEvent *ev,  tibrvQueue q,  tibrvTransport tport,
+              const char *subj,  uintptr_t i )
+{
+  return tibrvEvent_CreateListener( ev, q, on_msg, tport, subj,
+                                    (const void *) i );
+}
+
+static void
+usage( void )
+{
+  fprintf( stderr,
+    "sharerv7test [-daemon D] [-count C]\n"
+    "\n"
+    "  -daemon D    daemon to connect (default tcp:7500)\n"
+    "  -count C     msgs sent to each subject in each step (default 100)\n" );
+  exit( 1 );
+}
+
+int
+main( int argc, char **argv )
+{
+  const char   * daemon = "tcp:7500";
+  tibrvTransport ta, tb, tc, tp;
+  tibrvQueue     q;
+  tibrvEvent     ev[ NUM_CNT ];
+  tibrv_status   err;
+  tibrv_u32      count = 100, want[ NUM_CNT ];
+  char           inbox_a[ 64 ], inbox_b[ 64 ];
+  int            i = 1;
+
+  while ( i < argc && *argv[ i ] == '-' ) {
+    if ( strcmp( argv[ i ], "-daemon" ) == 0 && i + 1 < argc ) {
+      daemon = argv[ ++i ];
+    } else if ( strcmp( argv[ i ], "-count" ) == 0 && i + 1 < argc ) {
+      count = (tibrv_u32) strtoul( argv[ ++i ], NULL, 10 );
+    } else {
+      usage();
+    }
+    i++;
+  }
+  if ( i < argc || count == 0 )
+    usage();
+
+  if ( (err = tibrv_Open()) != TIBRV_OK ||
+       (err = tibrv_SetTransportSharing( TIBRV_TRUE )) != TIBRV_OK ||
+       (err = tibrvTransport_Create( &ta, NULL, NULL, daemon )) != TIBRV_OK ||
+       (err = tibrvTransport_Create( &tb, NULL, NULL, daemon )) != TIBRV_OK ||
+       (err = tibrv_SetTransportSharing( TIBRV_FALSE )) != TIBRV_OK ||
+       (err = tibrvTransport_Create( &tp, NULL, NULL, daemon )) != TIBRV_OK ) {
+    fprintf( stderr, "sharerv7test: %s: %s\n", daemon,
+             tibrvStatus_GetText( err ) );
+    return 1;
+  }
+  tibrvQueue_Create( &q );
+  tibrvTransport_CreateInbox( ta, inbox_a, sizeof( inbox_a ) );
+  tibrvTransport_CreateInbox( tb, inbox_b, sizeof( inbox_b ) );
+  add_listener( &ev[ A_ALL ], q, ta, "SHARE.ALL", A_ALL );
+  add_listener( &ev[ A_ONE ], q, ta, "SHARE.A", A_ONE );
+  add_listener( &ev[ A_INBOX ], q, ta, inbox_a, A_INBOX );
+  add_listener( &ev[ B_ALL ], q, tb, "SHARE.ALL", B_ALL );
+  add_listener( &ev[ B_ONE ], q, tb, "SHARE.B", B_ONE );
+  add_listener( &ev[ B_INBOX ], q, tb, inbox_b, B_INBOX );
+  sleep_ms( 500 ); /* the listeners reach the daemon */
+
+  /* both */
+  publish( tp, "SHARE.ALL", count );
+  publish( tp, "SHARE.A", count );
+  publish( tp, "SHARE.B", count );
+  publish( tp, inbox_a, count );
+  publish( tp, inbox_b, count );
+  memset( want, 0, sizeof( want ) );
+  for ( i = A_ALL; i <= B_INBOX; i++ )
+    want[ i ] = count;
+  check( q, "both", want );
+
+  /* destroy */
+  tibrvTransport_Destroy( ta );
+  sleep_ms( 100 );
+  publish( tp, "SHARE.ALL", count );
+  publish( tp, "SHARE.A", count );
+  publish( tp, "SHARE.B", count );
+  publish( tp, inbox_a, count );
+  publish( tp, inbox_b, count );
+  want[ B_ALL ] += count;
+  want[ B_ONE ] += count;
+  want[ B_INBOX ] += count;
+  check( q, "destroy", want );
+
+  /* rejoin */
+  tibrv_SetTransportSharing( TIBRV_TRUE );
+  if ( (err = tibrvTransport_Create( &tc, NULL, NULL, daemon )) != TIBRV_OK ) {
+    fprintf( stderr, "sharerv7test: rejoin %s: %s\n", daemon,
+             tibrvStatus_GetText( err ) );
+    return 1;
+  }
+  add_listener( &ev[ C_ALL ], q, tc, "SHARE.ALL", C_ALL );
+  sleep_ms( 500 );
+  publish( tp, "SHARE.ALL", count );
+  want[ B_ALL ] += count;
+  want[ C_ALL ] += count;
+  check( q, "rejoin", want );
+
+  for ( i = 0; i < NUM_CNT; i++ )
+    tibrvEvent_DestroyEx( ev[ i ], NULL );
+  tibrvTransport_Destroy( tc );
+  tibrvTransport_Destroy( tb );
+  tibrvTransport_Destroy( tp );
+  tibrvQueue_DestroyEx( q, NULL, NULL );
+  tibrv_Close();
+  return g_fail != 0;
+}
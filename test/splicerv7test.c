@@ -0,0 +1,185 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+
+#include <sassrv/rv7api.h>
+
+/*
+ * splicerv7test -- updates and copies of a message that is still in the
+ * encoding it was received with.
+ *
+ * No daemon is needed, a submessage from tibrvMsg_GetMsg() is held the same
+ * way as a received message.  The outer message has "sub" with the fields
+ * x = 1, s = "abc" and deep = { y = 2 }.  The checks:
+ *   inplace  : an update of x with the same size is seen by the sub, not by
+ *              a copy taken before or by the outer message.
+ *   splice   : an update of s with a new size keeps x and deep.
+ *   reread   : a read between two updates doesn't lose the first update.
+ *   copy     : a copy of the updated sub, and the sub added to a new message
+ *              and got back, have the same fields and size.
+ * The exit status is 0 when all pass.
+ */
+
+static int g_fail;
+
+#define CHECK( cond, ... ) do { \
+    if ( ! ( cond ) ) { \
+      printf( "FAIL line %d: ", __LINE__ ); \
+      printf( __VA_ARGS__ ); \
+      printf( "\n" ); \
+      g_fail++; \
+    } \
+  } while ( 0 )
+
+static tibrv_u32
+u32_of( tibrvMsg msg,  const char *name )
+{
+  tibrv_u32 v = ~(tibrv_u32) 0;
+  tibrvMsg_GetU32( msg, name, &v );
+  return v;
+}
+
+static const char *
+str_of( tibrvMsg msg,  const char *name )
+{
+  const char * s = NULL;
+  if ( tibrvMsg_GetString( msg, name, &s ) != TIBRV_OK || s == NULL )
+    return "";
+  return s;
+}
+
+static tibrv_u32
+deep_y( tibrvMsg msg )
+{
+  tibrvMsg deep = NULL;
+  if ( tibrvMsg_GetMsg( msg, "deep", &deep ) != TIBRV_OK || deep == NULL )
+    return ~(tibrv_u32) 0;
+  return u32_of( deep, "y" );
+}
+
+/* x, s, deep.y and the number of fields */
+static void
+check_sub( int line,  tibrvMsg msg,  tibrv_u32 x,  const char *s,
+           tibrv_u32 nflds )
+{
+  tibrv_u32 n = 0;
+  tibrvMsg_GetNumFields( msg, &n );
+  CHECK( u32_of( msg, "x" ) == x, "from %d: x = %u, not %u", line,
+         u32_of( msg, "x" ), x );
+  CHECK( strcmp( str_of( msg, "s" ), s ) == 0, "from %d: s = \"%s\", not "
+         "\"%s\"", line, str_of( msg, "s" ), s );
+  CHECK( deep_y( msg ) == 2, "from %d: deep.y = %u", line, deep_y( msg ) );
+  CHECK( n == nflds, "from %d: %u fields, not %u", line, n, nflds );
+}
+
+static void
+run( void )
+{
+  tibrvMsg  outer, inner, deep, sub, sub2, copy0, copy1, outer2;
+  tibrv_u32 sz = 0, sz1 = 0;
+
+  tibrvMsg_Create( &deep );
+  tibrvMsg_AddU32( deep, "y", 2 );
+  tibrvMsg_Create( &inner );
+  tibrvMsg_AddU32( inner, "x", 1 );
+  tibrvMsg_AddString( inner, "s", "abc" );
+  tibrvMsg_AddMsg( inner, "deep", deep );
+  tibrvMsg_Create( &outer );
+  tibrvMsg_AddU32( outer, "seq", 7 );
+  tibrvMsg_AddMsg( outer, "sub", inner );
+  tibrvMsg_AddString( outer, "tail", "end" );
+  tibrvMsg_Destroy( inner );
+  tibrvMsg_Destroy( deep );
+
+  if ( tibrvMsg_GetMsg( outer, "sub", &sub ) != TIBRV_OK || sub == NULL ) {
+    CHECK( 0, "no sub" );
+    tibrvMsg_Destroy( outer );
+    return;
+  }
+  check_sub( __LINE__, sub, 1, "abc", 3 );
+  tibrvMsg_CreateCopy( sub, &copy0 );
+
+  /* inplace */
+  tibrvMsg_UpdateU32( sub, "x", 5 );
+  check_sub( __LINE__, sub, 5, "abc", 3 );
+  check_sub( __LINE__, copy0, 1, "abc", 3 );
+  tibrvMsg_GetMsg( outer, "sub", &sub2 );
+  check_sub( __LINE__, sub2, 1, "abc", 3 );
+
+  /* splice */
+  tibrvMsg_UpdateString( sub, "s", "abcdefgh" );
+  check_sub( __LINE__, sub, 5, "abcdefgh", 3 );
+
+  /* reread, then a second update */
+  tibrvMsg_AddU32( sub, "z", 9 );
+  check_sub( __LINE__, sub, 5, "abcdefgh", 4 );
+  CHECK( u32_of( sub, "z" ) == 9, "z = %u", u32_of( sub, "z" ) );
+  tibrvMsg_UpdateString( sub, "s", "ab" );
+  check_sub( __LINE__, sub, 5, "ab", 4 );
+  CHECK( u32_of( sub, "z" ) == 9, "z = %u after update", u32_of( sub, "z" ) );
+
+  /* copy */
+  tibrvMsg_CreateCopy( sub, &copy1 );
+  check_sub( __LINE__, copy1, 5, "ab", 4 );
+  check_sub( __LINE__, copy0, 1, "abc", 3 );
+  tibrvMsg_GetByteSize( sub, &sz );
+  tibrvMsg_GetByteSize( copy1, &sz1 );
+  CHECK( sz == sz1, "copy size %u != %u", sz1, sz );
+
+  tibrvMsg_Create( &outer2 );
+  tibrvMsg_AddMsg( outer2, "sub", sub );
+  if ( tibrvMsg_GetMsg( outer2, "sub", &sub2 ) == TIBRV_OK && sub2 != NULL ) {
+    check_sub( __LINE__, sub2, 5, "ab", 4 );
+    tibrvMsg_GetByteSize( sub2, &sz1 );
+    CHECK( sz == sz1, "nested size %u != %u", sz1, sz );
+  }
+  else {
+    CHECK( 0, "no sub in outer2" );
+  }
+  CHECK( u32_of( outer, "seq" ) == 7 && strcmp( str_of( outer, "tail" ),
+         "end" ) == 0, "outer changed" );
+
+  tibrvMsg_Destroy( outer2 );
+  tibrvMsg_Destroy( copy1 );
+  tibrvMsg_Destroy( copy0 );
+  tibrvMsg_Destroy( outer );
+}
+
+static void
+usage( void )
+{
+  fprintf( stderr,
+    "splicerv7test [-count C]\n"
+    "\n"
+    "  -count C     times the checks run (default 10)\n" );
+  exit( 1 );
+}
+
+int
+main( int argc, char **argv )
+{
+  tibrv_u32 count = 10, k;
+  int       i = 1;
+
+  while ( i < argc && *argv[ i ] == '-' ) {
+    if ( strcmp( argv[ i ], "-count" ) == 0 && i + 1 < argc ) {
+      count = (tibrv_u32) strtoul( argv[ ++i ], NULL, 10 );
+    } else {
+      usage();
+    }
+    i++;
+  }
+  if ( i < argc || count == 0 )
+    usage();
+
+  tibrv_Open();
+  for ( k = 0; k < count; k++ )
+    run();
+  tibrv_Close();
+  printf( "splicerv7test: %s, %d failed\n", g_fail == 0 ? "ok" : "FAIL",
+          g_fail );
+  return g_fail != 0;
+}
@@ -0,0 +1,158 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+
+#include <sassrv/rv7api.h>
+
+/*
+ * stalerv7test -- a handle is rejected after its object is destroyed.
+ *
+ * No daemon is needed.  A handle is a 20 bit slot and a 12 bit generation,
+ * destroy frees the slot and bumps its generation, so the next object made
+ * there has a new handle.  The checks:
+ *   destroy  : a destroyed timer's handle is not found by GetType, GetQueue
+ *              or a second destroy, and its callback no longer runs.
+ *   reuse    : N timers are made and destroyed in turn, which reuses the
+ *              slot of the first, the first handle is still rejected and a
+ *              destroy with it leaves the live timer in place.
+ *   type     : a queue handle is not an event and an event not a queue.
+ *   queue    : a destroyed queue's handle is rejected.
+ * A stale handle matches again after 4096 reuses of its slot, -reuse stays
+ * under that.  The exit status is 0 when all pass.
+ */
+
+static tibrv_u32 g_fired[ 2 ];
+static int       g_fail;
+
+#define CHECK( cond, ... ) do { \
+    if ( ! ( cond ) ) { \
+      printf( "FAIL line %d: ", __LINE__ ); \
+      printf( __VA_ARGS__ ); \
+      printf( "\n" ); \
+      g_fail++; \
+    } \
+  } while ( 0 )
+
+static void
+on_timer( tibrvEvent ev,  tibrvMsg msg,  void *cl )
+{
+  (void) ev; (void) msg;
+  g_fired[ (uintptr_t) cl ]++;
+}
+
+/* stale is not a live event */
+static void
+check_stale( tibrvEvent stale,  const char *step )
+{
+  tibrvEventType type = 0;
+  tibrvQueue     q    = 0;
+  CHECK( tibrvEvent_GetType( stale, &type ) == TIBRV_INVALID_EVENT,
+         "%s: GetType found %u", step, type );
+  CHECK( tibrvEvent_GetQueue( stale, &q ) != TIBRV_OK,
+         "%s: GetQueue found %u", step, q );
+  CHECK( tibrvEvent_DestroyEx( stale, NULL ) == TIBRV_INVALID_EVENT,
+         "%s: destroyed again", step );
+}
+
+static void
+dispatch_ms( tibrvQueue q,  int ms )
+{
+  int i;
+  for ( i = 0; i < ms / 10; i++ )
+    tibrvQueue_TimedDispatch( q, 0.01 );
+}
+
+static void
+usage( void )
+{
+  fprintf( stderr,
+    "stalerv7test [-reuse N]\n"
+    "\n"
+    "  -reuse N     timers made and destroyed after the first (default 4000)\n" );
+  exit( 1 );
+}
+
+int
+main( int argc, char **argv )
+{
+  tibrvQueue     q, q2;
+  tibrvEvent     first, ev, last = 0;
+  tibrvEventType type;
+  tibrv_u32      reuse = 4000, k, same_slot = 0, num;
+  int            i = 1;
+
+  while ( i < argc && *argv[ i ] == '-' ) {
+    if ( strcmp( argv[ i ], "-reuse" ) == 0 && i + 1 < argc ) {
+      reuse = (tibrv_u32) strtoul( argv[ ++i ], NULL, 10 );
+    } else {
+      usage();
+    }
+    i++;
+  }
+  if ( i < argc || reuse == 0 || reuse >= 4096 )
+    usage();
+
+  tibrv_Open();
+  tibrvQueue_Create( &q );
+
+  /* destroy */
+  tibrvEvent_CreateTimer( &first, q, on_timer, 0.01, (const void *) 0 );
+  dispatch_ms( q, 50 );
+  CHECK( g_fired[ 0 ] > 0, "first timer did not fire" );
+  CHECK( tibrvEvent_DestroyEx( first, NULL ) == TIBRV_OK, "destroy first" );
+  dispatch_ms( q, 20 ); /* one already queued may still run */
+  g_fired[ 0 ] = 0;
+  dispatch_ms( q, 50 );
+  CHECK( g_fired[ 0 ] == 0, "destroyed timer fired %u", g_fired[ 0 ] );
+  check_stale( first, "destroy" );
+
+  /* reuse */
+  for ( k = 0; k < reuse; k++ ) {
+    if ( last != 0 )
+      tibrvEvent_DestroyEx( last, NULL );
+    tibrvEvent_CreateTimer( &ev, q, on_timer, 0.01, (const void *) 1 );
+    CHECK( ev != first, "reuse %u: same handle %u", k, ev );
+    if ( ( ev & 0xfffff ) == ( first & 0xfffff ) )
+      same_slot++;
+    type = 0;
+    CHECK( tibrvEvent_GetType( first, &type ) == TIBRV_INVALID_EVENT,
+           "reuse %u: stale %u found as %u", k, first, type );
+    last = ev;
+  }
+  CHECK( same_slot > 0, "the first slot was not reused" );
+  check_stale( first, "reuse" );
+  CHECK( tibrvEvent_GetType( last, &type ) == TIBRV_OK &&
+         type == TIBRV_TIMER_EVENT, "live timer lost" );
+  g_fired[ 1 ] = 0;
+  dispatch_ms( q, 50 );
+  CHECK( g_fired[ 1 ] > 0 && g_fired[ 0 ] == 0,
+         "live fired %u, stale fired %u", g_fired[ 1 ], g_fired[ 0 ] );
+  tibrvEvent_DestroyEx( last, NULL );
+  check_stale( last, "last" );
+
+  /* type */
+  tibrvEvent_CreateTimer( &ev, q, on_timer, 1.0, (const void *) 1 );
+  CHECK( tibrvEvent_GetType( (tibrvEvent) q, &type ) == TIBRV_INVALID_EVENT,
+         "queue %u is an event", q );
+  CHECK( tibrvQueue_GetCount( (tibrvQueue) ev, &num ) == TIBRV_INVALID_QUEUE,
+         "event %u is a queue", ev );
+  tibrvEvent_DestroyEx( ev, NULL );
+
+  /* queue */
+  tibrvQueue_Create( &q2 );
+  CHECK( tibrvQueue_GetCount( q2, &num ) == TIBRV_OK, "new queue" );
+  tibrvQueue_DestroyEx( q2, NULL, NULL );
+  CHECK( tibrvQueue_GetCount( q2, &num ) == TIBRV_INVALID_QUEUE,
+         "destroyed queue %u found", q2 );
+  CHECK( tibrvQueue_DestroyEx( q2, NULL, NULL ) == TIBRV_INVALID_QUEUE,
+         "queue destroyed again" );
+
+  printf( "stalerv7test: first slot reused %u of %u, %s, %d failed\n",
+          same_slot, reuse, g_fail == 0 ? "ok" : "FAIL", g_fail );
+  tibrvQueue_DestroyEx( q, NULL, NULL );
+  tibrv_Close();
+  return g_fail != 0;
+}
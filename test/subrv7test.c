@@ -105,20 +105,22 @@ usage( void )
 {
   fprintf( stderr, "subrv7test [-service service] [-network network] \n" );
   fprintf( stderr, "            [-daemon daemon] [-x|-nodict] [-3|-sass3]\n" );
-  fprintf( stderr, "            [-feed feed] subject_list\n" );
+  fprintf( stderr, "            [-feed feed] [-filter expr] subject_list\n" );
   fprintf( stderr, "  -x, -nodict : don't fetch a SASS dictionary at startup\n" );
   fprintf( stderr, "  -3, -sass3  : use the SASS3 protocol (_SASS.<feed>.SUB\n" );
   fprintf( stderr, "                SUBSCRIBE|INITIAL_VALUES) instead of rv7 _SNAP;\n" );
   fprintf( stderr, "                feed = first segment of the subject\n" );
   fprintf( stderr, "                (FEED.DOMAIN.INSTRUMENT.EXCHANGE)\n" );
   fprintf( stderr, "  -feed feed  : override the SASS3 feed name\n" );
+  fprintf( stderr, "  -filter expr: drop msgs unless expr is true, ex:\n" );
+  fprintf( stderr, "                \"MKT_ST == 1 && REC_TYPE in { 2, 5 }\"\n" );
   exit( 1 );
 }
 
 int
 get_InitParms( int argc, char* argv[], int min_parms, char** serviceStr,
                char** networkStr, char** daemonStr, int* noDict,
-               int* useSass3 )
+               int* useSass3, char** filterStr )
 {
   int i = 1;
 
@@ -151,6 +153,10 @@ get_InitParms( int argc, char* argv[], int min_parms, char** serviceStr,
       *daemonStr = argv[ i + 1 ];
       i += 2;
     }
+    else if ( strcmp( argv[ i ], "-filter" ) == 0 ) {
+      *filterStr = argv[ i + 1 ];
+      i += 2;
+    }
     else {
       usage();
     }
@@ -178,13 +184,14 @@ main( int argc, char** argv )
   char* serviceStr = NULL;
   char* networkStr = NULL;
   char* daemonStr  = NULL;
+  char* filterStr  = NULL;
   int   noDict     = 0;
   int   useSass3   = 0;
 
   char* progname = argv[ 0 ];
 
   currentArg = get_InitParms( argc, argv, MIN_PARMS, &serviceStr, &networkStr,
-                              &daemonStr, &noDict, &useSass3 );
+                              &daemonStr, &noDict, &useSass3, &filterStr );
   err        = tibrv_Open();
   if ( err != TIBRV_OK ) {
     fprintf( stderr, "%s: Failed to open TIB/Rendezvous: %s\n", progname,
@@ -280,6 +287,8 @@ main( int argc, char** argv )
       err = tibrvEvent_CreateListener( &listenId[ i ], TIBRV_DEFAULT_QUEUE,
                                        my_callback, transport,
                                        argv[ i + currentArg ], &closure );
+    if ( err == TIBRV_OK && filterStr != NULL )
+      err = tibrvEvent_SetListenerFilter( listenId[ i ], filterStr );
     if ( err == TIBRV_OK ) {
       if ( useSass3 ) {
         /* SASS3: _SASS.<feed>.SUB, magic 23176, T = QueryFlags
@@ -0,0 +1,164 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+
+#include <sassrv/rv7api.h>
+
+/*
+ * timerrv7test -- timer wheel scale test.
+ *
+ * Creates N timers (default 1M) with intervals spread over [S/2, 3S/2)
+ * seconds, as an order book with a timeout per order would, then measures
+ * the cost of create, ResetTimerInterval and destroy from the application
+ * thread.  While dispatching for D seconds it resets R timers per dispatch
+ * round (orders that were touched) and reports how many expired and how late
+ * their callbacks ran against the deadline the test expects.
+ */
+
+static tibrv_u64 * g_due;      /* expected deadline of each timer, ns */
+static tibrv_u64 * g_ival;     /* interval of each timer, ns */
+static tibrv_u64   g_fired = 0,
+                   g_late_sum = 0,
+                   g_late_max = 0;
+
+static tibrv_u64
+mono_ns( void )
+{
+  struct timespec ts;
+  clock_gettime( CLOCK_MONOTONIC, &ts );
+  return (tibrv_u64) ts.tv_sec * 1000000000ULL + (tibrv_u64) ts.tv_nsec;
+}
+
+static void
+on_timer( tibrvEvent event, tibrvMsg msg, void * closure )
+{
+  size_t    i   = (size_t) closure;
+  tibrv_u64 now = mono_ns();
+  (void) event; (void) msg;
+
+  if ( now > g_due[ i ] ) {
+    tibrv_u64 late = now - g_due[ i ];
+    g_late_sum += late;
+    if ( late > g_late_max )
+      g_late_max = late;
+  }
+  g_due[ i ] = now + g_ival[ i ];
+  g_fired++;
+}
+
+static void
+usage( void )
+{
+  fprintf( stderr,
+    "timerrv7test [-count N] [-ival S] [-secs D] [-resets R]\n"
+    "\n"
+    "  -count N    timers to keep active (default 1000000)\n"
+    "  -ival S     mean timer interval in seconds (default 5)\n"
+    "  -secs D     seconds to dispatch (default 10)\n"
+    "  -resets R   timers reset per dispatch round (default 1000)\n" );
+  exit( 1 );
+}
+
+int
+main( int argc, char ** argv )
+{
+  tibrvQueue    queue;
+  tibrvEvent  * ev;
+  unsigned long count = 1000000, resets = 1000, secs = 10, i, r = 0,
+                nreset = 0;
+  double        ival = 5.0, * iv;
+  tibrv_u64     start, end, t;
+  tibrv_status  err;
+  int           j = 1;
+
+  while ( j < argc && *argv[ j ] == '-' ) {
+    if ( strcmp( argv[ j ], "-count" ) == 0 && j + 1 < argc ) {
+      count = strtoul( argv[ ++j ], NULL, 10 );
+    } else if ( strcmp( argv[ j ], "-ival" ) == 0 && j + 1 < argc ) {
+      ival = strtod( argv[ ++j ], NULL );
+    } else if ( strcmp( argv[ j ], "-secs" ) == 0 && j + 1 < argc ) {
+      secs = strtoul( argv[ ++j ], NULL, 10 );
+    } else if ( strcmp( argv[ j ], "-resets" ) == 0 && j + 1 < argc ) {
+      resets = strtoul( argv[ ++j ], NULL, 10 );
+    } else {
+      usage();
+    }
+    j++;
+  }
+  if ( j < argc || count == 0 || ival <= 0 )
+    usage();
+  ev     = (tibrvEvent *) malloc( sizeof( ev[ 0 ] ) * count );
+  iv     = (double *) malloc( sizeof( iv[ 0 ] ) * count );
+  g_due  = (tibrv_u64 *) malloc( sizeof( g_due[ 0 ] ) * count );
+  g_ival = (tibrv_u64 *) malloc( sizeof( g_ival[ 0 ] ) * count );
+  if ( ev == NULL || iv == NULL || g_due == NULL || g_ival == NULL ) {
+    fprintf( stderr, "timerrv7test: no memory\n" );
+    return 1;
+  }
+  tibrv_Open();
+  tibrvQueue_Create( &queue );
+
+  for ( i = 0; i < count; i++ ) {
+    iv[ i ]     = ival * ( 0.5 + (double) ( i % 1000 ) / 1000.0 );
+    g_ival[ i ] = (tibrv_u64) ( iv[ i ] * 1e9 );
+  }
+  start = mono_ns();
+  for ( i = 0; i < count; i++ ) {
+    g_due[ i ] = mono_ns() + g_ival[ i ];
+    err = tibrvEvent_CreateTimer( &ev[ i ], queue, on_timer, iv[ i ],
+                                  (void *) (size_t) i );
+    if ( err != TIBRV_OK ) {
+      fprintf( stderr, "timerrv7test: %s\n", tibrvStatus_GetText( err ) );
+      return 1;
+    }
+  }
+  end = mono_ns();
+  printf( "created %lu timers: %.0f ns/create\n", count,
+          (double) ( end - start ) / (double) count );
+
+  start = mono_ns();
+  for ( i = 0; i < count; i++ ) {
+    g_due[ i ] = mono_ns() + g_ival[ i ];
+    tibrvEvent_ResetTimerInterval( ev[ i ], iv[ i ] );
+  }
+  end = mono_ns();
+  printf( "reset %lu timers: %.0f ns/reset\n", count,
+          (double) ( end - start ) / (double) count );
+  fflush( stdout );
+
+  start = mono_ns();
+  end   = start + (tibrv_u64) secs * 1000000000ULL;
+  while ( mono_ns() < end ) {
+    tibrvQueue_TimedDispatch( queue, 0.001 );
+    for ( j = 0; (unsigned long) j < resets; j++ ) {
+      i = r++ % count; /* touched order, push its timeout out */
+      g_due[ i ] = mono_ns() + g_ival[ i ];
+      tibrvEvent_ResetTimerInterval( ev[ i ], iv[ i ] );
+      nreset++;
+    }
+  }
+  t = mono_ns() - start;
+  printf( "dispatched %.3fs: fired %llu (%.0f/s), reset %lu (%.0f/s),"
+          " late avg %.3fms max %.3fms\n",
+          (double) t / 1e9, (unsigned long long) g_fired,
+          (double) g_fired * 1e9 / (double) t, nreset,
+          (double) nreset * 1e9 / (double) t,
+          g_fired ? (double) g_late_sum / (double) g_fired / 1e6 : 0.0,
+          (double) g_late_max / 1e6 );
+
+  start = mono_ns();
+  for ( i = 0; i < count; i++ )
+    tibrvEvent_Destroy( ev[ i ] );
+  end = mono_ns();
+  printf( "destroyed %lu timers: %.0f ns/destroy\n", count,
+          (double) ( end - start ) / (double) count );
+
+  tibrvQueue_Destroy( queue );
+  tibrv_Close();
+  free( ev ); free( iv ); free( g_due ); free( g_ival );
+  return 0;
+}